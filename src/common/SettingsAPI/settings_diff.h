@@ -0,0 +1,52 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "../utils/json_native.h"
+
+namespace PTSettingsHelper
+{
+    // Remembers the settings last applied to each module, so that settings
+    // sent again unchanged can be skipped. Settings are compared as JSON
+    // values, so member order doesn't matter.
+    class applied_settings_cache
+    {
+    public:
+        // Returns false if settings equal the ones applied to the module
+        // before, and remembers them as applied.
+        bool update(const std::wstring& module_key, std::wstring_view settings)
+        {
+            auto document = json::native::document::parse(json::native::to_utf8(settings));
+
+            std::unique_lock lock{ mutex };
+            if (!document)
+            {
+                applied.erase(module_key);
+                return true;
+            }
+
+            if (const auto previous = applied.find(module_key); previous != applied.end())
+            {
+                const bool changed = !json::native::equal(previous->second.root(), document->root());
+                previous->second = std::move(*document);
+                return changed;
+            }
+            applied.emplace(module_key, std::move(*document));
+            return true;
+        }
+
+        // Makes the next update of the module count as changed, for when the
+        // module may no longer have the settings applied last.
+        void forget(const std::wstring& module_key)
+        {
+            std::unique_lock lock{ mutex };
+            applied.erase(module_key);
+        }
+
+    private:
+        std::mutex mutex;
+        std::unordered_map<std::wstring, json::native::document> applied;
+    };
+}
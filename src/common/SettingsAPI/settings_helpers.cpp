@@ -1,6 +1,9 @@
 #include "pch.h"
 #include "settings_helpers.h"
 
+#include <mutex>
+#include <unordered_map>
+
 namespace PTSettingsHelper
 {
     constexpr inline const wchar_t* settings_filename = L"\\settings.json";
@@ -11,49 +14,65 @@ namespace PTSettingsHelper
     constexpr inline const wchar_t* DataDiagnosticsRegKey = L"Software\\Classes\\PowerToys";
     constexpr inline const wchar_t* DataDiagnosticsRegValueName = L"AllowDataDiagnostics";
 
-    std::wstring get_root_save_folder_location()
+    namespace
     {
-        PWSTR local_app_path;
-        winrt::check_hresult(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, NULL, &local_app_path));
-        std::wstring result{ local_app_path };
-        CoTaskMemFree(local_app_path);
+        std::wstring resolve_folder_location(REFKNOWNFOLDERID folder_id)
+        {
+            PWSTR known_folder_path;
+            winrt::check_hresult(SHGetKnownFolderPath(folder_id, 0, NULL, &known_folder_path));
+            std::wstring result{ known_folder_path };
+            CoTaskMemFree(known_folder_path);
+
+            result += L"\\Microsoft\\PowerToys";
+            std::filesystem::create_directories(result);
+            return result;
+        }
 
-        result += L"\\Microsoft\\PowerToys";
-        std::filesystem::path save_path(result);
-        if (!std::filesystem::exists(save_path))
+        // The folders are resolved once per process but may be deleted while
+        // it runs, so every caller of a cached folder gets it recreated. An
+        // existing folder costs one attribute query.
+        const std::wstring& ensure_folder_exists(const std::wstring& folder)
         {
-            std::filesystem::create_directories(save_path);
+            std::error_code err;
+            if (!std::filesystem::is_directory(folder, err))
+            {
+                std::filesystem::create_directories(folder, err);
+            }
+            return folder;
         }
-        return result;
     }
 
-    std::wstring get_local_low_folder_location()
+    // The folders are resolved and created on first use; a failure throws and
+    // is retried on the next call.
+    std::wstring get_root_save_folder_location()
     {
-        PWSTR local_app_path;
-        winrt::check_hresult(SHGetKnownFolderPath(FOLDERID_LocalAppDataLow, 0, NULL, &local_app_path));
-        std::wstring result{ local_app_path };
-        CoTaskMemFree(local_app_path);
+        static const std::wstring location = resolve_folder_location(FOLDERID_LocalAppData);
+        return ensure_folder_exists(location);
+    }
 
-        result += L"\\Microsoft\\PowerToys";
-        std::filesystem::path save_path(result);
-        if (!std::filesystem::exists(save_path))
-        {
-            std::filesystem::create_directories(save_path);
-        }
-        return result;
+    std::wstring get_local_low_folder_location()
+    {
+        static const std::wstring location = resolve_folder_location(FOLDERID_LocalAppDataLow);
+        return ensure_folder_exists(location);
     }
 
     std::wstring get_module_save_folder_location(std::wstring_view powertoy_key)
     {
+        static std::mutex mutex;
+        static std::unordered_map<std::wstring, std::wstring> locations;
+
+        std::wstring key{ powertoy_key };
+        std::unique_lock lock{ mutex };
+        if (const auto it = locations.find(key); it != locations.end())
+        {
+            return ensure_folder_exists(it->second);
+        }
+
         std::wstring result = get_root_save_folder_location();
         result += L"\\";
         result += powertoy_key;
-        std::filesystem::path save_path(result);
-        if (!std::filesystem::exists(save_path))
-        {
-            std::filesystem::create_directories(save_path);
-        }
-        return result;
+        std::filesystem::create_directories(result);
+        return locations.emplace(std::move(key), std::move(result)).first->second;
     }
 
     std::wstring get_module_save_file_location(std::wstring_view powertoy_key)
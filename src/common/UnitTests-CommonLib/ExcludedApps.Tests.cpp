@@ -0,0 +1,73 @@
+#include "pch.h"
+
+#include <common/utils/excluded_apps.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsExcludedApps
+{
+    const std::vector<std::wstring> apps = { L"NOTEPAD.EXE", L"CODE", L"A", L"SNIPPINGTOOL", L"TEAMS.EXE", L"\\OUTLOOK" };
+
+    const std::vector<std::wstring> paths = {
+        L"C:\\WINDOWS\\SYSTEM32\\NOTEPAD.EXE",
+        L"C:\\PROGRAM FILES\\NOTEPAD++\\NOTEPAD++.EXE",
+        L"C:\\USERS\\ME\\APPDATA\\LOCAL\\PROGRAMS\\MICROSOFT VS CODE\\CODE.EXE",
+        L"C:\\CODE\\TOOLS\\EXPLORER.EXE",
+        L"C:\\TOOLS\\A.EXE",
+        L"C:\\TOOLS\\AA.EXE",
+        L"C:\\TOOLS\\BA.EXE",
+        L"C:\\PROGRAM FILES\\WINDOWSAPPS\\MICROSOFT.SCREENSKETCH\\SNIPPINGTOOL\\SNIPPINGTOOL.EXE",
+        L"C:\\PROGRAM FILES\\MICROSOFT OFFICE\\OUTLOOK.EXE",
+        L"C:\\PROGRAM FILES\\TEAMS.EXE\\UPDATE.EXE",
+        L"NOTEPAD.EXE",
+        L"C:\\TOOLS\\",
+        L"",
+    };
+
+    TEST_CLASS (ExcludedAppsMatcherTests)
+    {
+    public:
+        TEST_METHOD (MatchesLikeFindAppNameInPath)
+        {
+            excluded_apps_matcher matcher{ apps };
+            for (const auto& path : paths)
+            {
+                Assert::AreEqual(find_app_name_in_path(path, apps), matcher.matches_path(path));
+            }
+
+            // Each name on its own, so a match isn't hidden by another one
+            for (const auto& app : apps)
+            {
+                excluded_apps_matcher single{ { app } };
+                for (const auto& path : paths)
+                {
+                    Assert::AreEqual(find_app_name_in_path(path, { app }), single.matches_path(path));
+                }
+            }
+        }
+
+        TEST_METHOD (OnlyTheLastOccurrenceCounts)
+        {
+            excluded_apps_matcher matcher{ { L"A" } };
+            Assert::IsTrue(matcher.matches_path(L"C:\\TOOLS\\A.EXE"));
+            Assert::IsFalse(matcher.matches_path(L"C:\\TOOLS\\AA.EXE"));
+            Assert::IsFalse(matcher.matches_path(L"C:\\A\\TOOLS.EXE"));
+        }
+
+        TEST_METHOD (SetAppsReplacesNamesAndCachedResults)
+        {
+            excluded_apps_matcher matcher;
+            Assert::IsTrue(matcher.empty());
+            Assert::IsFalse(matcher.matches_path(paths[0]));
+
+            matcher.set_apps(apps);
+            Assert::IsFalse(matcher.empty());
+            Assert::IsTrue(matcher.matches_path(paths[0]));
+            Assert::IsTrue(matcher.matches_path(paths[0]));
+
+            matcher.set_apps({ L"CALC.EXE" });
+            Assert::IsFalse(matcher.matches_path(paths[0]));
+            Assert::IsTrue(matcher.matches_path(L"C:\\WINDOWS\\SYSTEM32\\CALC.EXE"));
+        }
+    };
+}
@@ -0,0 +1,120 @@
+#include "pch.h"
+
+#include <common/utils/gpo_snapshot.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace powertoys_gpo;
+
+namespace Microsoft::VisualStudio::CppUnitTestFramework
+{
+    template<>
+    inline std::wstring ToString<gpo_rule_configured_t>(const gpo_rule_configured_t& rule)
+    {
+        return std::to_wstring(static_cast<int>(rule));
+    }
+}
+
+namespace UnitTestsGpoSnapshot
+{
+    // Stands in for the registry.
+    class fake_policy_source : public policy_source
+    {
+    public:
+        policy_scope_values machine;
+        policy_scope_values user;
+        bool has_changed = false;
+        int reads = 0;
+
+        policy_snapshot read() override
+        {
+            reads++;
+            has_changed = false;
+            return policy_snapshot(machine, user);
+        }
+
+        bool changed() override
+        {
+            return has_changed;
+        }
+    };
+
+    policy_scope_values scope(std::initializer_list<std::pair<const wchar_t*, uint32_t>> values)
+    {
+        policy_scope_values result;
+        result.state = policy_scope_values::key_state::present;
+        for (const auto& [name, value] : values)
+        {
+            result.set_value(name, &value, sizeof(value));
+        }
+        return result;
+    }
+
+    TEST_CLASS (GpoSnapshotTests)
+    {
+    public:
+        TEST_METHOD (MachinePolicyWinsOverUserPolicy)
+        {
+            policy_snapshot snapshot(scope({ { L"A", 0 } }), scope({ { L"A", 1 }, { L"B", 1 } }));
+
+            Assert::AreEqual(gpo_rule_configured_disabled, snapshot.get(L"A"));
+            Assert::AreEqual(gpo_rule_configured_enabled, snapshot.get(L"B"));
+        }
+
+        TEST_METHOD (UnknownValuesAreWrongValue)
+        {
+            policy_snapshot snapshot(scope({ { L"A", 2 } }), scope({}));
+
+            Assert::AreEqual(gpo_rule_configured_wrong_value, snapshot.get(L"A"));
+        }
+
+        TEST_METHOD (NamesAreCaseInsensitive)
+        {
+            policy_snapshot snapshot(scope({ { L"ConfigureEnabledUtilityPeek", 1 } }), scope({}));
+
+            Assert::AreEqual(gpo_rule_configured_enabled, snapshot.get(L"configureenabledutilitypeek"));
+        }
+
+        TEST_METHOD (ShortValuesAreReadIntoDword)
+        {
+            // RegQueryValueExW only overwrites the bytes it reads
+            policy_scope_values machine = scope({});
+            const uint8_t enabled = 1;
+            machine.set_value(L"A", &enabled, sizeof(enabled));
+            const uint64_t too_large = 1;
+            machine.set_value(L"B", &too_large, sizeof(too_large));
+            policy_snapshot snapshot(machine, scope({}));
+
+            Assert::AreEqual(gpo_rule_configured_wrong_value, snapshot.get(L"A"));
+            Assert::AreEqual(gpo_rule_configured_not_configured, snapshot.get(L"B"));
+        }
+
+        TEST_METHOD (UnsetPoliciesFollowUserKeyState)
+        {
+            policy_scope_values user;
+            user.state = policy_scope_values::key_state::missing;
+            Assert::AreEqual(gpo_rule_configured_not_configured, policy_snapshot(scope({}), user).get(L"A"));
+
+            user.state = policy_scope_values::key_state::unavailable;
+            Assert::AreEqual(gpo_rule_configured_unavailable, policy_snapshot(scope({}), user).get(L"A"));
+            Assert::AreEqual(gpo_rule_configured_enabled, policy_snapshot(scope({ { L"A", 1 } }), user).get(L"A"));
+        }
+
+        TEST_METHOD (CacheReadsOnlyAfterChange)
+        {
+            fake_policy_source source;
+            source.machine = scope({ { L"A", 1 } });
+            policy_cache cache(source);
+
+            Assert::AreEqual(gpo_rule_configured_enabled, cache.get(L"A"));
+            Assert::AreEqual(gpo_rule_configured_not_configured, cache.get(L"B"));
+            Assert::AreEqual(1, source.reads);
+
+            source.machine = scope({ { L"A", 0 } });
+            Assert::AreEqual(gpo_rule_configured_enabled, cache.get(L"A"));
+
+            source.has_changed = true;
+            Assert::AreEqual(gpo_rule_configured_disabled, cache.get(L"A"));
+            Assert::AreEqual(2, source.reads);
+        }
+    };
+}
@@ -0,0 +1,121 @@
+#include "pch.h"
+
+#include <common/utils/json.h>
+#include <common/utils/json_native.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsNativeJson
+{
+    const std::string sample = R"({"name":"Layout \"1\" \u00e9\ud83d\ude00","enabled":true,"count":3,"ratio":-1.5e3,"zones":[{"X":0,"Y":0},{"X":960,"Y":0}],"info":{"rows":2},"empty":{},"none":null})";
+
+    TEST_CLASS (NativeJsonTests)
+    {
+    public:
+        TEST_METHOD (ParsesValues)
+        {
+            const auto doc = json::native::document::parse(sample);
+            Assert::IsTrue(doc.has_value());
+
+            const auto root = doc->root();
+            Assert::IsTrue(root.is_object());
+            Assert::AreEqual(size_t{ 8 }, root.size());
+            Assert::IsTrue(*root["enabled"].as_bool());
+            Assert::AreEqual(-1500.0, *root["ratio"].as_number());
+            Assert::AreEqual(size_t{ 2 }, root["zones"].size());
+            Assert::AreEqual(960.0, *root["zones"].at(1)["X"].as_number());
+            Assert::IsTrue(root["none"].is_null());
+            Assert::IsFalse(static_cast<bool>(root["missing"]["deeper"]));
+            Assert::AreEqual(std::wstring(L"Layout \"1\" \u00e9\U0001F600"), json::native::to_wstring(*root["name"].as_string()));
+        }
+
+        TEST_METHOD (RejectsInvalidDocuments)
+        {
+            for (const char* text : { "", "{", "[1,]", "{\"a\":}", "01", "1.", "tru", "\"\\x\"", "\"\\ud800\"", "[1] 2", "\"a\nb\"" })
+            {
+                Assert::IsFalse(json::native::document::parse(text).has_value());
+            }
+            Assert::IsFalse(json::native::document::parse(std::string(600, '[') + std::string(600, ']')).has_value());
+        }
+
+        TEST_METHOD (DecodesUnicodeEscapes)
+        {
+            // Code points above the surrogate range stand on their own
+            Assert::AreEqual(std::string("\xEF\xBF\xBD"), std::string(*json::native::document::parse(R"("\uFFFD")")->root().as_string()));
+            Assert::AreEqual(std::string("\xEE\x80\x80"), std::string(*json::native::document::parse(R"("\uE000")")->root().as_string()));
+            Assert::AreEqual(std::string("\xF0\x9F\x98\x80"), std::string(*json::native::document::parse(R"("\uD83D\uDE00")")->root().as_string()));
+
+            // A surrogate that is not part of a pair
+            for (const char* text : { R"("\uD83D")", R"("\uD83Dx")", R"("\uD83D\u0041")", R"("\uDE00")", R"("\uDE00\uD83D")" })
+            {
+                Assert::IsFalse(json::native::document::parse(text).has_value());
+            }
+        }
+
+        TEST_METHOD (GetMatchesWinRtGet)
+        {
+            const auto doc = json::native::document::parse(sample);
+            const auto winrt_root = json::JsonValue::Parse(winrt::to_hstring(sample)).GetObjectW();
+
+            int native_count = 0;
+            int winrt_count = 0;
+            json::native::get(doc->root(), "count", native_count);
+            json::get(winrt_root, L"count", winrt_count);
+            Assert::AreEqual(winrt_count, native_count);
+
+            // Wrong type without a default leaves the destination alone
+            native_count = winrt_count = 7;
+            json::native::get(doc->root(), "enabled", native_count);
+            json::get(winrt_root, L"enabled", winrt_count);
+            Assert::AreEqual(winrt_count, native_count);
+
+            // Missing with a default takes the default
+            bool native_flag = true;
+            bool winrt_flag = true;
+            json::native::get(doc->root(), "missing", native_flag, false);
+            json::get(winrt_root, L"missing", winrt_flag, false);
+            Assert::AreEqual(winrt_flag, native_flag);
+
+            std::wstring native_name;
+            std::wstring winrt_name;
+            json::native::get(doc->root(), "name", native_name);
+            json::get(winrt_root, L"name", winrt_name);
+            Assert::AreEqual(winrt_name, native_name);
+        }
+
+        TEST_METHOD (WriterOutputParsesBackTheSame)
+        {
+            const auto doc = json::native::document::parse(sample);
+
+            json::native::writer first;
+            first.value(doc->root());
+            const auto reparsed = json::native::document::parse(first.str());
+            Assert::IsTrue(reparsed.has_value());
+
+            json::native::writer second;
+            second.value(reparsed->root());
+            Assert::AreEqual(first.str(), second.str());
+
+            // WinRT must read what the writer produces
+            const auto winrt_root = json::JsonValue::Parse(winrt::to_hstring(first.str())).GetObjectW();
+            Assert::AreEqual(std::wstring(L"Layout \"1\" \u00e9\U0001F600"), std::wstring(winrt_root.GetNamedString(L"name")));
+        }
+
+        TEST_METHOD (EqualIgnoresMemberOrder)
+        {
+            const auto a = json::native::document::parse(R"({"a":[1,{"b":null,"c":"x"}],"d":true})");
+            const auto b = json::native::document::parse(R"({"d":true,"a":[1,{"c":"x","b":null}]})");
+            const auto c = json::native::document::parse(R"({"d":true,"a":[{"c":"x","b":null},1]})");
+            Assert::IsTrue(json::native::equal(a->root(), b->root()));
+            Assert::IsFalse(json::native::equal(a->root(), c->root()));
+            Assert::IsFalse(json::native::equal(a->root()["a"], a->root()["missing"]));
+        }
+
+        TEST_METHOD (WriterEscapesStrings)
+        {
+            json::native::writer writer;
+            writer.start_object().key("text").value(L"a\"b\\c\n\x01").key("list").start_array().value(1).value(0.5).value(nullptr).end_array().end_object();
+            Assert::AreEqual(std::string(R"({"text":"a\"b\\c\n\u0001","list":[1,0.5,null]})"), writer.str());
+        }
+    };
+}
@@ -0,0 +1,78 @@
+#include "pch.h"
+
+#include <common/interop/pipe_message_framing.h>
+#include <common/interop/spsc_ring.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTestsPipeMessageFraming
+{
+    std::vector<std::wstring> read_frames(std::string_view payload, bool& complete)
+    {
+        std::vector<std::wstring> messages;
+        complete = pipe_message_framing::for_each_frame(payload, [&](std::string_view frame) {
+            std::wstring message;
+            utf8::append_wide(frame, message);
+            messages.push_back(std::move(message));
+        });
+        return messages;
+    }
+
+    TEST_CLASS (PipeMessageFramingTests)
+    {
+    public:
+        TEST_METHOD (BatchedFramesReadBackInOrder)
+        {
+            const std::vector<std::wstring> messages = { L"{\"action\":{}}", L"", L"caf\u00e9 \U0001F600" };
+            std::string payload;
+            for (const auto& message : messages)
+            {
+                pipe_message_framing::append_frame(payload, message);
+            }
+
+            bool complete = false;
+            const auto read = read_frames(payload, complete);
+            Assert::IsTrue(complete);
+            Assert::IsTrue(messages == read);
+        }
+
+        TEST_METHOD (TruncatedFrameIsReported)
+        {
+            std::string payload;
+            pipe_message_framing::append_frame(payload, L"first");
+            pipe_message_framing::append_frame(payload, L"second");
+            payload.pop_back();
+
+            bool complete = true;
+            const auto read = read_frames(payload, complete);
+            Assert::IsFalse(complete);
+            Assert::AreEqual(size_t{ 1 }, read.size());
+            Assert::AreEqual(std::wstring(L"first"), read[0]);
+        }
+
+        TEST_METHOD (RingKeepsOrderAndReusesBuffers)
+        {
+            spsc_ring<std::string, 2> ring;
+            std::string value = "a";
+            Assert::IsTrue(ring.try_push(value));
+            value = "b";
+            Assert::IsTrue(ring.try_push(value));
+            value = "c";
+            Assert::IsFalse(ring.try_push(value));
+            Assert::AreEqual(std::string("c"), value);
+
+            std::string popped(100, 'x');
+            const auto capacity = popped.capacity();
+            Assert::IsTrue(ring.try_pop(popped));
+            Assert::AreEqual(std::string("a"), popped);
+
+            // The consumer's old buffer comes back to the producer
+            Assert::IsTrue(ring.try_push(value));
+            Assert::AreEqual(capacity, value.capacity());
+
+            ring.interrupt();
+            Assert::IsFalse(ring.pop(popped));
+            Assert::IsFalse(ring.push(value));
+        }
+    };
+}
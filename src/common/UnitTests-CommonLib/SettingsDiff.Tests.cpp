@@ -0,0 +1,69 @@
+#include "pch.h"
+
+#include <common/SettingsAPI/settings_diff.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace PTSettingsHelper;
+
+namespace UnitTestsSettingsDiff
+{
+    const std::wstring applied = LR"({"name":"FindMyMouse","version":"1.1","properties":{"activation_method":{"value":0},"spotlight_radius":{"value":100},"excluded_apps":{"value":""}}})";
+
+    TEST_CLASS (SettingsDiffTests)
+    {
+    public:
+        TEST_METHOD (FirstSettingsAreChanged)
+        {
+            applied_settings_cache cache;
+            Assert::IsTrue(cache.update(L"FindMyMouse", applied));
+        }
+
+        TEST_METHOD (SameSettingsAreUnchanged)
+        {
+            applied_settings_cache cache;
+            cache.update(L"FindMyMouse", applied);
+
+            // Member order doesn't matter
+            const auto reordered = LR"({"version":"1.1","name":"FindMyMouse","properties":{"excluded_apps":{"value":""},"spotlight_radius":{"value":100},"activation_method":{"value":0}}})";
+            Assert::IsFalse(cache.update(L"FindMyMouse", reordered));
+        }
+
+        TEST_METHOD (ChangedSettingsAreChanged)
+        {
+            applied_settings_cache cache;
+            cache.update(L"FindMyMouse", applied);
+
+            const auto changed = LR"({"name":"FindMyMouse","version":"1.1","properties":{"activation_method":{"value":0},"spotlight_radius":{"value":120},"excluded_apps":{"value":""}}})";
+            Assert::IsTrue(cache.update(L"FindMyMouse", changed));
+
+            // The changed settings are now the applied ones
+            Assert::IsFalse(cache.update(L"FindMyMouse", changed));
+
+            const auto removed_property = LR"({"name":"FindMyMouse","version":"1.1","properties":{"activation_method":{"value":0},"spotlight_radius":{"value":120}}})";
+            Assert::IsTrue(cache.update(L"FindMyMouse", removed_property));
+
+            const auto new_version = LR"({"name":"FindMyMouse","version":"1.2","properties":{"activation_method":{"value":0},"spotlight_radius":{"value":120}}})";
+            Assert::IsTrue(cache.update(L"FindMyMouse", new_version));
+        }
+
+        TEST_METHOD (InvalidSettingsAreChanged)
+        {
+            applied_settings_cache cache;
+            cache.update(L"FindMyMouse", applied);
+            Assert::IsTrue(cache.update(L"FindMyMouse", L"{"));
+            Assert::IsTrue(cache.update(L"FindMyMouse", L"{"));
+            Assert::IsTrue(cache.update(L"FindMyMouse", applied));
+        }
+
+        TEST_METHOD (ModulesAreTrackedSeparately)
+        {
+            applied_settings_cache cache;
+            cache.update(L"FindMyMouse", applied);
+            Assert::IsTrue(cache.update(L"MouseHighlighter", applied));
+
+            cache.forget(L"FindMyMouse");
+            Assert::IsTrue(cache.update(L"FindMyMouse", applied));
+            Assert::IsFalse(cache.update(L"MouseHighlighter", applied));
+        }
+    };
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <common/utils/utf8.h>
+
+// Wire format of the TwoWayPipeMessageIPC pipes. Each pipe message carries
+// one or more frames, and each frame is a 4 byte little-endian length
+// followed by that many bytes of UTF-8 text. Several queued messages can
+// then go out in one write and still be told apart by the reader.
+namespace pipe_message_framing
+{
+    constexpr size_t header_size = sizeof(uint32_t);
+
+    // Appends message to buffer as one frame.
+    inline void append_frame(std::string& buffer, std::wstring_view message)
+    {
+        const size_t header_offset = buffer.size();
+        buffer.append(header_size, '\0');
+        utf8::append_utf8(message, buffer);
+
+        const auto length = static_cast<uint32_t>(buffer.size() - header_offset - header_size);
+        for (size_t i = 0; i < header_size; ++i)
+        {
+            buffer[header_offset + i] = static_cast<char>((length >> (8 * i)) & 0xFF);
+        }
+    }
+
+    // Calls on_frame with the UTF-8 text of every frame in buffer, in order.
+    // Returns false if buffer ends in the middle of a frame; the frames before
+    // that point have been passed to on_frame by then.
+    template<typename F>
+    bool for_each_frame(std::string_view buffer, F&& on_frame)
+    {
+        while (!buffer.empty())
+        {
+            if (buffer.size() < header_size)
+            {
+                return false;
+            }
+
+            uint32_t length = 0;
+            for (size_t i = 0; i < header_size; ++i)
+            {
+                length |= static_cast<uint32_t>(static_cast<uint8_t>(buffer[i])) << (8 * i);
+            }
+            buffer.remove_prefix(header_size);
+            if (length > buffer.size())
+            {
+                return false;
+            }
+
+            on_frame(buffer.substr(0, length));
+            buffer.remove_prefix(length);
+        }
+        return true;
+    }
+}
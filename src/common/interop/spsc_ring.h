@@ -0,0 +1,120 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Values are swapped in and out of the slots instead of copied, so a
+// value handed back by push holds whatever the consumer left in that slot;
+// for strings that is the capacity of a buffer popped earlier, which lets
+// both sides reuse their buffers.
+template<typename T, size_t Capacity>
+class spsc_ring
+{
+    static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    spsc_ring() = default;
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    // Producer side. Returns false without touching value if the ring is full.
+    bool try_push(T& value)
+    {
+        const size_t current_tail = tail.load(std::memory_order_relaxed);
+        if (current_tail - head.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+        std::swap(slots[current_tail & mask], value);
+        tail.store(current_tail + 1, std::memory_order_release);
+        wake();
+        return true;
+    }
+
+    // Producer side. Waits while the ring is full. Returns false if the ring
+    // was interrupted before there was room.
+    bool push(T& value)
+    {
+        return wait_for([&] { return try_push(value); });
+    }
+
+    // Consumer side. Returns false without touching value if the ring is empty.
+    bool try_pop(T& value)
+    {
+        const size_t current_head = head.load(std::memory_order_relaxed);
+        if (current_head == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        std::swap(slots[current_head & mask], value);
+        head.store(current_head + 1, std::memory_order_release);
+        wake();
+        return true;
+    }
+
+    // Consumer side. Waits while the ring is empty. Returns false once the
+    // ring is interrupted, even if values are left.
+    bool pop(T& value)
+    {
+        return wait_for([&] { return try_pop(value); });
+    }
+
+    // Makes every current and future push and pop return false.
+    void interrupt()
+    {
+        interrupted.store(true);
+        signal.fetch_add(1);
+        signal.notify_all();
+    }
+
+private:
+    static constexpr size_t mask = Capacity - 1;
+
+    // Keeps the fields each side writes on different cache lines. Padding is
+    // used rather than alignas, which would also over-align every class that
+    // holds a ring.
+    static constexpr size_t cache_line_size = 64;
+
+    // Bumps the signal so a side that is about to wait sees the change, and
+    // only pays for the notify when a side is actually waiting.
+    void wake()
+    {
+        signal.fetch_add(1);
+        if (waiters.load() != 0)
+        {
+            signal.notify_all();
+        }
+    }
+
+    template<typename Attempt>
+    bool wait_for(Attempt attempt)
+    {
+        while (!interrupted.load())
+        {
+            const uint32_t seen = signal.load();
+            if (attempt())
+            {
+                return true;
+            }
+            waiters.fetch_add(1);
+            if (!interrupted.load())
+            {
+                signal.wait(seen);
+            }
+            waiters.fetch_sub(1);
+        }
+        return false;
+    }
+
+    std::atomic<size_t> head = 0; // Written by the consumer
+    char head_padding[cache_line_size - sizeof(std::atomic<size_t>)] = {};
+    std::atomic<size_t> tail = 0; // Written by the producer
+    char tail_padding[cache_line_size - sizeof(std::atomic<size_t>)] = {};
+    std::atomic<uint32_t> signal = 0;
+    std::atomic<uint32_t> waiters = 0;
+    std::atomic<bool> interrupted = false;
+    std::array<T, Capacity> slots;
+};
@@ -1,7 +1,7 @@
 #include "pch.h"
 #include "two_way_pipe_message_ipc_impl.h"
 
-#include <iterator>
+#include <string_view>
 
 constexpr DWORD BUFSIZE = 1024;
 
@@ -48,7 +48,10 @@ TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::TwoWayPipeMessageIPCImpl(
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send(std::wstring msg)
 {
-    output_queue.queue_message(msg);
+    std::unique_lock lock(send_mutex);
+    send_buffer.clear();
+    pipe_message_framing::append_frame(send_buffer, msg);
+    output_queue.push(send_buffer);
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start(HANDLE _restricted_pipe_token)
@@ -75,11 +78,10 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::end()
     input_pipe_thread.join();
 }
 
-void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(std::wstring message)
+void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(const std::string& payload)
 {
     // Adapted from https://learn.microsoft.com/windows/win32/ipc/named-pipe-client
     HANDLE output_pipe_handle;
-    const wchar_t* message_send = message.c_str();
     BOOL fSuccess = FALSE;
     DWORD cbToWrite, cbWritten, dwMode;
     const wchar_t* lpszPipename = output_pipe_name.c_str();
@@ -123,39 +125,49 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::send_pipe_message(std::wstr
         &dwMode, // new pipe mode
         NULL, // don't set maximum bytes
         NULL); // don't set maximum time
-    if (!fSuccess)
+    if (fSuccess)
     {
-        return;
-    }
-
-    // Send a message to the pipe server.
+        // Send the frames to the pipe server as one message.
 
-    cbToWrite = (lstrlen(message_send)) * sizeof(WCHAR); // no need to send final '\0'. Pipe is in message mode.
+        cbToWrite = static_cast<DWORD>(payload.size());
 
-    fSuccess = WriteFile(
-        output_pipe_handle, // pipe handle
-        message_send, // message
-        cbToWrite, // message length
-        &cbWritten, // bytes written
-        NULL); // not overlapped
-    if (!fSuccess)
-    {
-        return;
+        WriteFile(
+            output_pipe_handle, // pipe handle
+            payload.data(), // message
+            cbToWrite, // message length
+            &cbWritten, // bytes written
+            NULL); // not overlapped
     }
     CloseHandle(output_pipe_handle);
-    return;
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_output_queue_thread()
 {
+    std::string frame;
+    std::string next_frame;
+    std::string batch;
     while (!closed)
     {
-        std::wstring message = output_queue.pop_message();
-        if (message.length() == 0)
+        if (!output_queue.pop(frame))
         {
             break;
         }
-        send_pipe_message(message);
+
+        // Frames queued while the last write was in flight go out together,
+        // which saves a connection per message during bursts.
+        if (frame.size() >= max_batch_bytes || !output_queue.try_pop(next_frame))
+        {
+            send_pipe_message(frame);
+            continue;
+        }
+
+        batch.assign(frame);
+        batch += next_frame;
+        while (batch.size() < max_batch_bytes && output_queue.try_pop(next_frame))
+        {
+            batch += next_frame;
+        }
+        send_pipe_message(batch);
     }
 }
 
@@ -347,44 +359,51 @@ HANDLE TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::create_medium_integrity_t
     return restricted_token_handle;
 }
 
-void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::handle_pipe_connection(HANDLE input_pipe_handle)
+bool TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::read_pipe_message(HANDLE input_pipe_handle, std::string& payload)
 {
-    if (!input_pipe_handle)
-    {
-        return;
-    }
-    constexpr DWORD readBlockBytes = BUFSIZE;
-    std::wstring message;
-    size_t iBlock = 0;
-    message.reserve(BUFSIZE);
-    bool ok;
-    do
+    // The pipe is in message mode, so a message that doesn't fit fails the
+    // read with ERROR_MORE_DATA and the pipe can tell how much is left.
+    payload.resize(payload.capacity() > BUFSIZE ? payload.capacity() : BUFSIZE);
+    size_t received = 0;
+    while (true)
     {
-        constexpr size_t charsPerBlock = readBlockBytes / sizeof(message[0]);
-        message.resize(message.size() + charsPerBlock);
         DWORD bytesRead = 0;
-        ok = ReadFile(
+        const BOOL ok = ReadFile(
             input_pipe_handle,
-            // read the message directly into the string block by block simultaneously resizing it
-            message.data() + iBlock * charsPerBlock,
-            readBlockBytes,
+            payload.data() + received,
+            static_cast<DWORD>(payload.size() - received),
             &bytesRead,
             nullptr);
+        received += bytesRead;
 
-        if (!ok && GetLastError() != ERROR_MORE_DATA)
+        if (ok)
         {
             break;
         }
-        iBlock++;
-    } while (!ok);
-    // trim the message's buffer
-    const auto nullCharPos = message.find_last_not_of(L'\0');
-    if (nullCharPos != std::wstring::npos)
-    {
-        message.resize(nullCharPos + 1);
+        if (GetLastError() != ERROR_MORE_DATA)
+        {
+            return false;
+        }
+
+        DWORD bytesLeft = 0;
+        if (!PeekNamedPipe(input_pipe_handle, nullptr, 0, nullptr, nullptr, &bytesLeft))
+        {
+            return false;
+        }
+        payload.resize(received + (bytesLeft != 0 ? bytesLeft : BUFSIZE));
     }
+    payload.resize(received);
+    return true;
+}
 
-    input_queue.queue_message(std::move(message));
+void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::handle_pipe_connection(HANDLE input_pipe_handle)
+{
+    if (!input_pipe_handle)
+    {
+        return;
+    }
+    std::string payload;
+    const bool received = read_pipe_message(input_pipe_handle, payload);
 
     // Flush the pipe to allow the client to read the pipe's contents
     // before disconnecting. Then disconnect the pipe, and close the
@@ -393,6 +412,12 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::handle_pipe_connection(HAND
     FlushFileBuffers(input_pipe_handle);
     DisconnectNamedPipe(input_pipe_handle);
     CloseHandle(input_pipe_handle);
+
+    if (received)
+    {
+        std::unique_lock lock(input_mutex);
+        input_queue.push(payload);
+    }
 }
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start_named_pipe_server(HANDLE token)
@@ -436,6 +461,7 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start_named_pipe_server(HAN
         }
         if (connected)
         {
+            // A client that stalls before writing must not hold up the others
             std::thread(&TwoWayPipeMessageIPCImpl::handle_pipe_connection, this, connect_pipe_handle).detach();
         }
         else
@@ -448,21 +474,27 @@ void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::start_named_pipe_server(HAN
 
 void TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl::consume_input_queue_thread()
 {
+    std::string payload;
+    std::wstring message;
     while (!closed)
     {
-        outgoing_message = L"";
-        std::wstring message = input_queue.pop_message();
-        if (message.length() == 0)
+        if (!input_queue.pop(payload))
         {
             break;
         }
 
-        // Check if callback method exists first before trying to call it.
-        // otherwise just store the response message in a variable.
-        if (dispatch_inc_message_function != nullptr)
-        {
+        // A payload that ends in the middle of a frame is cut short; the
+        // complete frames before it are still dispatched.
+        pipe_message_framing::for_each_frame(payload, [&](std::string_view frame) {
+            // Check if callback method exists first before trying to call it.
+            // Empty messages are not dispatched.
+            if (dispatch_inc_message_function == nullptr || frame.empty())
+            {
+                return;
+            }
+            message.clear();
+            utf8::append_wide(frame, message);
             dispatch_inc_message_function(message);
-        }
-        outgoing_message = message;
+        });
     }
 }
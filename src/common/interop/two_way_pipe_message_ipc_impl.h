@@ -1,10 +1,14 @@
 #pragma once
 #include <Windows.h>
-#include "async_message_queue.h"
 #include <WinSafer.h>
 #include <accctrl.h>
 #include <aclapi.h>
 #include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "pipe_message_framing.h"
+#include "spsc_ring.h"
 #include "two_way_pipe_message_ipc.h"
 
 class TwoWayPipeMessageIPC::TwoWayPipeMessageIPCImpl
@@ -16,26 +20,35 @@ public:
     void end();
 
 private:
-    AsyncMessageQueue input_queue;
-    AsyncMessageQueue output_queue;
+    // Both rings hold payloads already in the pipe_message_framing format.
+    static constexpr size_t queue_capacity = 1024;
+
+    // Queued frames are written together until a batch reaches this size.
+    static constexpr size_t max_batch_bytes = 64 * 1024;
+
+    spsc_ring<std::string, queue_capacity> input_queue; // Filled by the connection threads, under input_mutex
+    spsc_ring<std::string, queue_capacity> output_queue; // Filled by send, under send_mutex
     std::wstring output_pipe_name;
     std::wstring input_pipe_name;
     std::thread input_queue_thread;
     std::thread output_queue_thread;
     std::thread input_pipe_thread;
     std::mutex pipe_connect_handle_mutex; // For manipulating the current_connect_pipe
-    std::wstring outgoing_message; // Store the updated json settings.
+    std::mutex input_mutex; // Each connection is read on its own thread, the input queue takes one producer
+    std::mutex send_mutex; // send may be called from any thread, the output queue takes one producer
+    std::string send_buffer; // Guarded by send_mutex
 
     HANDLE current_connect_pipe_handle = NULL;
     bool closed = false;
     TwoWayPipeMessageIPC::callback_function dispatch_inc_message_function;
 
-    void send_pipe_message(std::wstring message);
+    void send_pipe_message(const std::string& payload);
     void consume_output_queue_thread();
     BOOL GetLogonSID(HANDLE hToken, PSID* ppsid);
     VOID FreeLogonSID(PSID* ppsid);
     int change_pipe_security_allow_restricted_token(HANDLE handle, HANDLE token);
     HANDLE create_medium_integrity_token();
+    bool read_pipe_message(HANDLE input_pipe_handle, std::string& payload);
     void handle_pipe_connection(HANDLE input_pipe_handle);
     void start_named_pipe_server(HANDLE token);
     void consume_input_queue_thread();
@@ -0,0 +1,218 @@
+#include "pch.h"
+#include "async_sink.h"
+
+#include <chrono>
+#include <thread>
+
+namespace
+{
+    // Keeps the module that holds the callbacks loaded while one of them
+    // runs, so a module can be unloaded without a callback running in it.
+    HMODULE current_module()
+    {
+        HMODULE module = nullptr;
+        GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                           reinterpret_cast<LPCWSTR>(&current_module),
+                           &module);
+        return module;
+    }
+}
+
+async_sink::async_sink(std::vector<spdlog::sink_ptr> sinks) :
+    sinks(std::move(sinks)), cells(std::make_unique<cell[]>(capacity))
+{
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    InitializeThreadpoolEnvironment(&environment);
+    if (const auto module = current_module())
+    {
+        SetThreadpoolCallbackLibrary(&environment, module);
+    }
+    timer = CreateThreadpoolTimer(on_timer, this, &environment);
+    batch_work = CreateThreadpoolWork(on_batch, this, &environment);
+}
+
+async_sink::~async_sink()
+{
+    if (timer)
+    {
+        SetThreadpoolTimer(timer, nullptr, 0, 0);
+        WaitForThreadpoolTimerCallbacks(timer, TRUE);
+        CloseThreadpoolTimer(timer);
+    }
+    if (batch_work)
+    {
+        WaitForThreadpoolWorkCallbacks(batch_work, TRUE);
+        CloseThreadpoolWork(batch_work);
+    }
+    DestroyThreadpoolEnvironment(&environment);
+
+    flush();
+}
+
+void async_sink::log(const spdlog::details::log_msg& msg)
+{
+    // Without a thread pool there's nothing to write the queue later
+    if (!timer || !batch_work)
+    {
+        std::unique_lock lock(drain_mutex);
+        drain();
+        for (auto& sink : sinks)
+        {
+            sink->log(msg);
+        }
+        return;
+    }
+
+    // When the ring is full the caller writes the queue itself, which keeps
+    // every message at the cost of one slow call
+    while (!try_push(msg))
+    {
+        std::unique_lock lock(drain_mutex);
+        drain();
+    }
+
+    const size_t queued = enqueue_position.load(std::memory_order_relaxed) - dequeue_position.load(std::memory_order_relaxed);
+    if (queued >= batch_size && !batch_requested.exchange(true))
+    {
+        SubmitThreadpoolWork(batch_work);
+    }
+    else if (!timer_armed.exchange(true))
+    {
+        // Negative due times are relative, in 100 ns units
+        ULARGE_INTEGER due;
+        due.QuadPart = static_cast<ULONGLONG>(-static_cast<LONGLONG>(flush_delay_ms) * 10000);
+        FILETIME due_time;
+        due_time.dwLowDateTime = due.LowPart;
+        due_time.dwHighDateTime = due.HighPart;
+        SetThreadpoolTimer(timer, &due_time, 0, flush_delay_ms / 4);
+    }
+}
+
+void async_sink::flush()
+{
+    // Bounded so a crash handler can't hang on a drain that will never end
+    std::unique_lock lock(drain_mutex, std::defer_lock);
+    if (lock.try_lock_for(std::chrono::seconds(1)))
+    {
+        drain();
+    }
+}
+
+void async_sink::set_pattern(const std::string& pattern)
+{
+    std::unique_lock lock(drain_mutex);
+    for (auto& sink : sinks)
+    {
+        sink->set_pattern(pattern);
+    }
+}
+
+void async_sink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter)
+{
+    std::unique_lock lock(drain_mutex);
+    for (auto& sink : sinks)
+    {
+        sink->set_formatter(sink_formatter->clone());
+    }
+}
+
+bool async_sink::try_push(const spdlog::details::log_msg& msg)
+{
+    size_t position = enqueue_position.load(std::memory_order_relaxed);
+    while (true)
+    {
+        cell& target = cells[position & mask];
+        const size_t sequence = target.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+        if (difference == 0)
+        {
+            if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                try
+                {
+                    target.message = spdlog::details::log_msg_buffer(msg);
+                }
+                catch (...)
+                {
+                    // The claimed cell has to be published either way
+                    target.message = spdlog::details::log_msg_buffer();
+                }
+                target.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            position = enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void async_sink::drain()
+{
+    size_t position = dequeue_position.load(std::memory_order_relaxed);
+    bool written = false;
+    while (true)
+    {
+        cell& source = cells[position & mask];
+        if (source.sequence.load(std::memory_order_acquire) != position + 1)
+        {
+            break;
+        }
+
+        for (auto& sink : sinks)
+        {
+            try
+            {
+                sink->log(source.message);
+            }
+            catch (...)
+            {
+                // A failing sink must not stop the others or leave the cell taken
+            }
+        }
+        source.sequence.store(position + capacity, std::memory_order_release);
+        dequeue_position.store(++position, std::memory_order_relaxed);
+        written = true;
+    }
+
+    if (written)
+    {
+        for (auto& sink : sinks)
+        {
+            try
+            {
+                sink->flush();
+            }
+            catch (...)
+            {
+            }
+        }
+    }
+}
+
+void CALLBACK async_sink::on_timer(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PTP_TIMER /*timer*/)
+{
+    auto self = static_cast<async_sink*>(context);
+
+    // Cleared first: a message queued from here on arms the timer again
+    self->timer_armed = false;
+    std::unique_lock lock(self->drain_mutex);
+    self->drain();
+}
+
+void CALLBACK async_sink::on_batch(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PTP_WORK /*work*/)
+{
+    auto self = static_cast<async_sink*>(context);
+    self->batch_requested = false;
+    std::unique_lock lock(self->drain_mutex);
+    self->drain();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <Windows.h>
+#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/sinks/sink.h>
+
+// Queues messages in a lock-free ring and writes them to the inner sinks on a
+// thread pool thread, so logging from hooks doesn't wait for the disk.
+// Messages are written and flushed once a batch has built up or shortly after
+// the first queued message, whichever comes first. flush() writes everything
+// queued on the calling thread, which is what the crash handlers rely on.
+class async_sink final : public spdlog::sinks::sink
+{
+public:
+    explicit async_sink(std::vector<spdlog::sink_ptr> sinks);
+    ~async_sink() override;
+
+    async_sink(const async_sink&) = delete;
+    async_sink& operator=(const async_sink&) = delete;
+
+    void log(const spdlog::details::log_msg& msg) override;
+    void flush() override;
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+private:
+    static constexpr size_t capacity = 512;
+    static constexpr size_t mask = capacity - 1;
+
+    // Queued messages that get written without waiting for the timer.
+    static constexpr size_t batch_size = capacity / 4;
+
+    // How long the first message of a batch may wait to be written.
+    static constexpr DWORD flush_delay_ms = 250;
+
+    struct cell
+    {
+        // Equals the position a producer may fill the cell at, and that
+        // position + 1 once it's filled.
+        std::atomic<size_t> sequence = 0;
+        spdlog::details::log_msg_buffer message;
+    };
+
+    bool try_push(const spdlog::details::log_msg& msg);
+
+    // Writes every queued message to the inner sinks and flushes them.
+    // Must be called with drain_mutex held.
+    void drain();
+
+    static void CALLBACK on_timer(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_TIMER timer);
+    static void CALLBACK on_batch(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WORK work);
+
+    std::vector<spdlog::sink_ptr> sinks;
+    std::unique_ptr<cell[]> cells;
+
+    // Producers claim positions with enqueue_position. The drain is the only
+    // consumer and publishes its progress so producers can size the batch.
+    std::atomic<size_t> enqueue_position = 0;
+    char enqueue_padding[64 - sizeof(std::atomic<size_t>)] = {};
+    std::atomic<size_t> dequeue_position = 0;
+    char dequeue_padding[64 - sizeof(std::atomic<size_t>)] = {};
+
+    std::atomic<bool> timer_armed = false;
+    std::atomic<bool> batch_requested = false;
+    std::timed_mutex drain_mutex;
+
+    TP_CALLBACK_ENVIRON environment;
+    PTP_TIMER timer = nullptr;
+    PTP_WORK batch_work = nullptr;
+};
@@ -1,8 +1,7 @@
 #include "pch.h"
 #include "call_tracer.h"
 
-#include <map>
-#include <thread>
+#include <string_view>
 
 namespace
 {
@@ -10,46 +9,40 @@ namespace
     const std::string entering = " Enter";
     const std::string exiting = " Exit";
 
-    std::mutex indentLevelMutex;
-    std::map<std::thread::id, int> indentLevel;
+    constexpr int maxIndentLevel = 64;
 
-    std::string GetIndentation()
+    // Each thread traces its own call stack, so no locking is needed
+    thread_local int indentLevel = 0;
+
+    std::string_view GetIndentation()
     {
-        std::unique_lock lock(indentLevelMutex);
-        int level = indentLevel[std::this_thread::get_id()];
+        static const std::string spaces(static_cast<size_t>(2) * maxIndentLevel - 1, ' ');
 
+        const int level = indentLevel;
         if (level <= 0)
         {
             return {};
         }
-        else
-        {
-            return std::string(static_cast<int64_t>(2) * min(level, 64) - 1, ' ') + " - ";
-        }
-    }
-
-    void Indent()
-    {
-        std::unique_lock lock(indentLevelMutex);
-        indentLevel[std::this_thread::get_id()]++;
+        return std::string_view(spaces).substr(0, static_cast<size_t>(2) * min(level, maxIndentLevel) - 1);
     }
 
-    void Unindent()
+    void Log(const std::string& functionName, const std::string& action)
     {
-        std::unique_lock lock(indentLevelMutex);
-        indentLevel[std::this_thread::get_id()]--;
+        // Formatted by the logger, so nothing is built when tracing is off
+        const auto indentation = GetIndentation();
+        Logger::trace("{}{}{}{}", indentation, indentation.empty() ? "" : " - ", functionName, action);
     }
 }
 
 CallTracer::CallTracer(const char* functionName) :
     functionName(functionName)
 {
-    Logger::trace((GetIndentation() + functionName + entering).c_str());
-    Indent();
+    Log(this->functionName, entering);
+    indentLevel++;
 }
 
 CallTracer::~CallTracer()
 {
-    Unindent();
-    Logger::trace((GetIndentation() + functionName + exiting).c_str());
+    indentLevel--;
+    Log(functionName, exiting);
 }
@@ -3,6 +3,7 @@
 #include "pch.h"
 #include "framework.h"
 #include "logger.h"
+#include "async_sink.h"
 #include <unordered_map>
 #include <spdlog/sinks/daily_file_sink.h>
 #include <spdlog/sinks/msvc_sink.h>
@@ -10,7 +11,6 @@
 #include <spdlog/sinks/stdout_color_sinks-inl.h>
 #include <iostream>
 
-using spdlog::sinks_init_list;
 using spdlog::level::level_enum;
 using spdlog::sinks::daily_file_sink_mt;
 using spdlog::sinks::msvc_sink_mt;
@@ -29,9 +29,9 @@ namespace
     };
 }
 
-level_enum getLogLevel(std::wstring_view logSettingsPath)
+level_enum getLogLevel(const LogSettings& logSettings)
 {
-    auto logLevel = get_log_settings(logSettingsPath).logLevel;
+    const auto& logLevel = logSettings.logLevel;
     if (auto it = logLevelMapping.find(logLevel); it != logLevelMapping.end())
     {
         return it->second;
@@ -57,23 +57,29 @@ bool Logger::wasLogFailedShown()
 
 void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring_view logSettingsPath)
 {
-    auto logLevel = getLogLevel(logSettingsPath);
+    const auto logSettings = get_log_settings(logSettingsPath);
+    auto logLevel = getLogLevel(logSettings);
     bool newLoggerCreated = false;
     try
     {
         logger = spdlog::get(loggerName);
         if (logger == nullptr)
         {
-            auto sink = make_shared<daily_file_sink_mt>(logFilePath, 0, 0, false, LogSettings::retention);
+            std::vector<spdlog::sink_ptr> sinks{ make_shared<daily_file_sink_mt>(logFilePath, 0, 0, false, LogSettings::retention) };
             if (IsDebuggerPresent())
             {
                 auto msvc_sink = make_shared<msvc_sink_mt>();
                 msvc_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [%n] [t-%t] [%l] %v");
-                logger = make_shared<spdlog::logger>(loggerName, sinks_init_list{ sink, msvc_sink });
+                sinks.push_back(msvc_sink);
+            }
+
+            if (logSettings.asyncLogging)
+            {
+                logger = make_shared<spdlog::logger>(loggerName, make_shared<async_sink>(std::move(sinks)));
             }
             else
             {
-                logger = make_shared<spdlog::logger>(loggerName, sink);
+                logger = make_shared<spdlog::logger>(loggerName, begin(sinks), end(sinks));
             }
             newLoggerCreated = true;
         }
@@ -99,7 +105,9 @@ void Logger::init(std::string loggerName, std::wstring logFilePath, std::wstring
     {
         logger->set_level(logLevel);
         logger->set_pattern("[%Y-%m-%d %H:%M:%S.%f] [p-%P] [t-%t] [%l] %v");
-        logger->flush_on(logLevel); // Auto flush on every log message.
+        // Synchronous logging flushes on every message. Asynchronous logging
+        // writes in batches and only waits for the disk on errors.
+        logger->flush_on(logSettings.asyncLogging && logLevel < level_enum::err ? level_enum::err : logLevel);
         spdlog::register_logger(logger);
     }
 
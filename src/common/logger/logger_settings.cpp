@@ -47,6 +47,7 @@ JsonObject to_json(LogSettings settings)
 {
     JsonObject result;
     result.SetNamedValue(LogSettings::logLevelOption, JsonValue::CreateStringValue(settings.logLevel));
+    result.SetNamedValue(LogSettings::asyncLoggingOption, JsonValue::CreateBooleanValue(settings.asyncLogging));
 
     return result;
 }
@@ -62,6 +63,15 @@ LogSettings to_settings(JsonObject jobject)
     {
         result.logLevel = LogSettings::defaultLogLevel;
     }
+
+    try
+    {
+        result.asyncLogging = jobject.GetNamedBoolean(LogSettings::asyncLoggingOption, true);
+    }
+    catch (...)
+    {
+        result.asyncLogging = true;
+    }
     
     return result;
 }
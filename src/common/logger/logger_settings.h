@@ -6,6 +6,7 @@ struct LogSettings
     // The following strings are not localizable
     inline const static std::wstring defaultLogLevel = L"trace";
     inline const static std::wstring logLevelOption = L"logLevel";
+    inline const static std::wstring asyncLoggingOption = L"asyncLogging";
     inline const static std::string runnerLoggerName = "runner";
     inline const static std::wstring logPath = L"Logs\\";
     inline const static std::wstring runnerLogPath = L"RunnerLogs\\runner-log.log";
@@ -85,6 +86,7 @@ struct LogSettings
     inline const static std::string lightSwitchLoggerName = "light-switch";
     inline const static int retention = 30;
     std::wstring logLevel;
+    bool asyncLogging = true;
     LogSettings();
 };
 
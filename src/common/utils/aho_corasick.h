@@ -0,0 +1,214 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Aho-Corasick automaton: finds every occurrence of a set of patterns in one
+// pass over the text, however many patterns there are. Patterns are numbered
+// by their position in the list they're built from; a pattern listed twice
+// keeps its first number. Empty patterns are never reported as matches, only
+// remembered by has_empty_pattern.
+//
+// The automaton is a full transition table, so a step is one lookup.
+// Characters that appear in no pattern share symbol 0, which keeps the table
+// as wide as the patterns' alphabet rather than all of UTF-16.
+class aho_corasick
+{
+public:
+    aho_corasick() = default;
+
+    explicit aho_corasick(const std::vector<std::wstring>& patterns)
+    {
+        for (const auto& pattern : patterns)
+        {
+            symbols.insert(symbols.end(), pattern.begin(), pattern.end());
+        }
+        std::sort(symbols.begin(), symbols.end());
+        symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+        width = symbols.size() + 1;
+        for (size_t i = 0; i < symbols.size(); ++i)
+        {
+            if (symbols[i] < ascii_symbols.size())
+            {
+                ascii_symbols[symbols[i]] = static_cast<uint32_t>(i + 1);
+            }
+        }
+
+        add_node();
+        lengths.reserve(patterns.size());
+        for (const auto& pattern : patterns)
+        {
+            lengths.push_back(pattern.length());
+            if (pattern.empty())
+            {
+                empty_pattern = true;
+                continue;
+            }
+
+            uint32_t node = 0;
+            for (const auto c : pattern)
+            {
+                const size_t edge = node * width + symbol(c);
+                if (transitions[edge] == missing)
+                {
+                    // add_node grows the table, so no reference is held across it
+                    const uint32_t child = add_node();
+                    transitions[edge] = child;
+                }
+                node = transitions[edge];
+            }
+            if (terminal[node] == none)
+            {
+                terminal[node] = static_cast<uint32_t>(lengths.size() - 1);
+                longest = (std::max)(longest, pattern.length());
+            }
+        }
+
+        // Breadth first, so each node's fail link is finished before its
+        // children's. Missing transitions become the fail link's ones.
+        std::vector<uint32_t> fail(terminal.size(), 0);
+        std::vector<uint32_t> queue;
+        queue.reserve(terminal.size());
+        for (size_t s = 0; s < width; ++s)
+        {
+            auto& next = transitions[s];
+            if (next == missing)
+            {
+                next = 0;
+            }
+            else
+            {
+                queue.push_back(next);
+            }
+        }
+        for (size_t i = 0; i < queue.size(); ++i)
+        {
+            const uint32_t node = queue[i];
+            for (size_t s = 0; s < width; ++s)
+            {
+                auto& next = transitions[node * width + s];
+                const uint32_t fallback = transitions[fail[node] * width + s];
+                if (next == missing)
+                {
+                    next = fallback;
+                    continue;
+                }
+
+                fail[next] = fallback;
+                output[next] = terminal[fallback] != none ? fallback : output[fallback];
+                queue.push_back(next);
+            }
+        }
+    }
+
+    // No patterns at all, empty or not
+    bool empty() const
+    {
+        return lengths.empty();
+    }
+
+    bool has_empty_pattern() const
+    {
+        return empty_pattern;
+    }
+
+    size_t length(uint32_t pattern) const
+    {
+        return lengths[pattern];
+    }
+
+    // The length of the longest non-empty pattern
+    size_t max_length() const
+    {
+        return longest;
+    }
+
+    // Calls on_match(pattern, end) for each occurrence of a non-empty pattern,
+    // in the order they end. end is the position right after the occurrence.
+    template<typename F>
+    void for_each_match(std::wstring_view text, F&& on_match) const
+    {
+        if (terminal.empty())
+        {
+            return;
+        }
+
+        uint32_t node = 0;
+        for (size_t i = 0; i < text.length(); ++i)
+        {
+            node = transitions[node * width + symbol(text[i])];
+            for (uint32_t match = terminal[node] != none ? node : output[node]; match != 0; match = output[match])
+            {
+                on_match(terminal[match], i + 1);
+            }
+        }
+    }
+
+    // Whether the text contains any pattern. An empty pattern is part of any
+    // text but an empty one.
+    bool contains_any(std::wstring_view text) const
+    {
+        if (empty_pattern && !text.empty())
+        {
+            return true;
+        }
+        if (terminal.empty())
+        {
+            return false;
+        }
+
+        uint32_t node = 0;
+        for (const auto c : text)
+        {
+            node = transitions[node * width + symbol(c)];
+            if (terminal[node] != none || output[node] != 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static constexpr uint32_t missing = UINT32_MAX;
+    static constexpr uint32_t none = UINT32_MAX;
+
+    uint32_t add_node()
+    {
+        transitions.resize(transitions.size() + width, missing);
+        terminal.push_back(none);
+        output.push_back(0);
+        return static_cast<uint32_t>(terminal.size() - 1);
+    }
+
+    uint32_t symbol(wchar_t c) const
+    {
+        if (c < ascii_symbols.size())
+        {
+            return ascii_symbols[c];
+        }
+        const auto found = std::lower_bound(symbols.begin(), symbols.end(), c);
+        return found != symbols.end() && *found == c ? static_cast<uint32_t>(found - symbols.begin() + 1) : 0;
+    }
+
+    std::vector<wchar_t> symbols;
+    std::array<uint32_t, 128> ascii_symbols{};
+    size_t width = 1;
+
+    // width entries per node
+    std::vector<uint32_t> transitions;
+
+    // The pattern that ends at the node, or none
+    std::vector<uint32_t> terminal;
+
+    // The nearest node on the fail chain that ends a pattern, or 0
+    std::vector<uint32_t> output;
+
+    // Per pattern, including empty and repeated ones
+    std::vector<size_t> lengths;
+    size_t longest = 0;
+    bool empty_pattern = false;
+};
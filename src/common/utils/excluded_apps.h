@@ -1,6 +1,13 @@
 #pragma once
-#include <vector>
+#include <common/utils/aho_corasick.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 // Checks if a process path is included in a list of strings.
 inline bool find_app_name_in_path(const std::wstring& where, const std::vector<std::wstring>& what)
@@ -65,3 +72,131 @@ inline bool check_excluded_app(const HWND& hwnd, const std::wstring& processPath
 
     return res;
 }
+
+// Matches process paths and window titles against a list of uppercase app
+// names the same way check_excluded_app does, but with one pass over the text
+// however many names there are. Build it once per settings change with
+// set_apps; lookups may come from any thread.
+class excluded_apps_matcher
+{
+public:
+    excluded_apps_matcher() = default;
+
+    explicit excluded_apps_matcher(const std::vector<std::wstring>& apps)
+    {
+        set_apps(apps);
+    }
+
+    excluded_apps_matcher(const excluded_apps_matcher&) = delete;
+    excluded_apps_matcher& operator=(const excluded_apps_matcher&) = delete;
+
+    void set_apps(const std::vector<std::wstring>& apps)
+    {
+        aho_corasick built(apps);
+        std::unique_lock lock{ mutex };
+        current = std::move(built);
+        path_results.clear();
+    }
+
+    bool empty() const
+    {
+        std::unique_lock lock{ mutex };
+        return current.empty();
+    }
+
+    // Same result as find_app_name_in_path. processPath must be uppercase.
+    bool matches_path(const std::wstring& processPath) const
+    {
+        std::unique_lock lock{ mutex };
+        if (current.empty())
+        {
+            return false;
+        }
+        if (const auto cached = path_results.find(processPath); cached != path_results.end())
+        {
+            return cached->second;
+        }
+
+        const bool result = matches_path(current, processPath);
+        if (path_results.size() >= max_cached_paths)
+        {
+            path_results.clear();
+        }
+        path_results.emplace(processPath, result);
+        return result;
+    }
+
+    // Same result as check_excluded_app_with_title.
+    bool matches_title(HWND hwnd) const
+    {
+        if (empty())
+        {
+            return false;
+        }
+
+        WCHAR title[MAX_TITLE_LENGTH];
+        const int len = GetWindowTextW(hwnd, title, MAX_TITLE_LENGTH);
+        if (len <= 0)
+        {
+            return false;
+        }
+        CharUpperBuffW(title, static_cast<DWORD>(len));
+
+        std::unique_lock lock{ mutex };
+        return current.contains_any(std::wstring_view(title, len));
+    }
+
+    // Same result as check_excluded_app. processPath must be uppercase.
+    bool is_excluded(HWND hwnd, const std::wstring& processPath) const
+    {
+        return matches_path(processPath) || matches_title(hwnd);
+    }
+
+private:
+    // A process usually owns many windows, so a path is checked many times.
+    static constexpr size_t max_cached_paths = 256;
+
+    // Same result as find_app_name_in_path
+    static bool matches_path(const aho_corasick& apps, std::wstring_view path)
+    {
+        const auto last_slash = path.rfind(L'\\');
+        if (last_slash == std::wstring_view::npos)
+        {
+            return false;
+        }
+        if (apps.has_empty_pattern() && last_slash + 1 == path.length())
+        {
+            return true;
+        }
+
+        // A name has to reach past the last backslash, and only its last
+        // occurrence counts, so the folders before that don't matter.
+        const size_t start = last_slash + 1 > apps.max_length() ? last_slash + 1 - apps.max_length() : 0;
+        std::vector<std::pair<uint32_t, size_t>> last_ends;
+        apps.for_each_match(path.substr(start), [&](uint32_t app, size_t end) {
+            const auto found = std::find_if(last_ends.begin(), last_ends.end(), [app](const auto& entry) { return entry.first == app; });
+            if (found != last_ends.end())
+            {
+                found->second = start + end;
+            }
+            else
+            {
+                last_ends.emplace_back(app, start + end);
+            }
+        });
+
+        for (const auto& [app, end] : last_ends)
+        {
+            const size_t pos = end - apps.length(app);
+            if (pos <= last_slash + 1 && end > last_slash)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    mutable std::mutex mutex;
+    aho_corasick current;
+    mutable std::unordered_map<std::wstring, bool> path_results;
+};
@@ -5,17 +5,10 @@
 #include <vector>
 #include <string>
 
+#include "gpo_snapshot.h"
+
 namespace powertoys_gpo
 {
-    enum gpo_rule_configured_t
-    {
-        gpo_rule_configured_wrong_value = -3, // The policy is set to an unrecognized value
-        gpo_rule_configured_unavailable = -2, // Couldn't access registry
-        gpo_rule_configured_not_configured = -1, // Policy is not configured
-        gpo_rule_configured_disabled = 0, // Policy is disabled
-        gpo_rule_configured_enabled = 1, // Policy is enabled
-    };
-
     // Registry path where gpo policy values are stored.
     const std::wstring POLICIES_PATH = L"SOFTWARE\\Policies\\PowerToys";
     const std::wstring POWER_LAUNCHER_INDIVIDUAL_PLUGIN_ENABLED_LIST_PATH = POLICIES_PATH + L"\\PowerLauncherIndividualPluginEnabledList";
@@ -160,61 +153,141 @@ namespace powertoys_gpo
         return string_value;
     }
 
-    inline gpo_rule_configured_t getConfiguredValue(const std::wstring& registry_value_name)
+    // Reads the policy values of both scopes from the registry and watches
+    // the policy keys, so a snapshot is only read again after they change.
+    class registry_policy_source : public policy_source
     {
-        HKEY key{};
-        DWORD value = 0xFFFFFFFE;
-        DWORD valueSize = sizeof(value);
+    public:
+        registry_policy_source() = default;
 
-        bool machine_key_found = true;
-        if (auto res = RegOpenKeyExW(POLICIES_SCOPE_MACHINE, POLICIES_PATH.c_str(), 0, KEY_READ, &key); res != ERROR_SUCCESS)
+        ~registry_policy_source()
         {
-            machine_key_found = false;
+            for (auto& watch : watches)
+            {
+                watch.close();
+            }
         }
 
-        if (machine_key_found)
-        {
-            // If the path was found in the machine, we need to check if the value for the policy exists.
-            auto res = RegQueryValueExW(key, registry_value_name.c_str(), nullptr, nullptr, reinterpret_cast<LPBYTE>(&value), &valueSize);
+        registry_policy_source(const registry_policy_source&) = delete;
+        registry_policy_source& operator=(const registry_policy_source&) = delete;
 
-            RegCloseKey(key);
+        policy_snapshot read() override
+        {
+            // Watch before reading, so a change made while reading is not missed
+            watching = watch_scope(watches[0], POLICIES_SCOPE_MACHINE);
+            watching = watch_scope(watches[1], POLICIES_SCOPE_USER) && watching;
+            return policy_snapshot(read_scope(POLICIES_SCOPE_MACHINE), read_scope(POLICIES_SCOPE_USER));
+        }
 
-            if (res != ERROR_SUCCESS)
+        bool changed() override
+        {
+            if (!watching)
             {
-                // Value not found on the path.
-                machine_key_found = false;
+                return true;
             }
+            for (const auto& watch : watches)
+            {
+                if (WaitForSingleObject(watch.event, 0) != WAIT_TIMEOUT)
+                {
+                    return true;
+                }
+            }
+            return false;
         }
 
-        if (!machine_key_found)
+    private:
+        struct key_watch
         {
-            // If there's no value found on the machine scope, try to get it from the user scope.
-            if (auto res = RegOpenKeyExW(POLICIES_SCOPE_USER, POLICIES_PATH.c_str(), 0, KEY_READ, &key); res != ERROR_SUCCESS)
+            HKEY key = nullptr;
+            HANDLE event = nullptr;
+
+            void close()
             {
-                if (res == ERROR_FILE_NOT_FOUND)
+                if (key)
+                {
+                    RegCloseKey(key);
+                    key = nullptr;
+                }
+                if (event)
                 {
-                    return gpo_rule_configured_not_configured;
+                    CloseHandle(event);
+                    event = nullptr;
                 }
-                return gpo_rule_configured_unavailable;
             }
-            auto res = RegQueryValueExW(key, registry_value_name.c_str(), nullptr, nullptr, reinterpret_cast<LPBYTE>(&value), &valueSize);
-            RegCloseKey(key);
+        };
 
-            if (res != ERROR_SUCCESS)
+        static bool watch_scope(key_watch& watch, HKEY scope)
+        {
+            watch.close();
+            watch.event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            if (!watch.event)
             {
-                return gpo_rule_configured_not_configured;
+                return false;
             }
+
+            // Watch the parent key while the policies key doesn't exist, so its creation is noticed
+            for (const wchar_t* path : { POLICIES_PATH.c_str(), L"SOFTWARE\\Policies" })
+            {
+                if (RegOpenKeyExW(scope, path, 0, KEY_NOTIFY, &watch.key) == ERROR_SUCCESS)
+                {
+                    const DWORD filter = REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_THREAD_AGNOSTIC;
+                    return RegNotifyChangeKeyValue(watch.key, TRUE, filter, watch.event, TRUE) == ERROR_SUCCESS;
+                }
+            }
+            return false;
         }
 
-        switch (value)
+        static policy_scope_values read_scope(HKEY scope)
         {
-        case 0:
-            return gpo_rule_configured_disabled;
-        case 1:
-            return gpo_rule_configured_enabled;
-        default:
-            return gpo_rule_configured_wrong_value;
+            policy_scope_values result;
+
+            HKEY key{};
+            if (auto res = RegOpenKeyExW(scope, POLICIES_PATH.c_str(), 0, KEY_READ, &key); res != ERROR_SUCCESS)
+            {
+                result.state = res == ERROR_FILE_NOT_FOUND ? policy_scope_values::key_state::missing : policy_scope_values::key_state::unavailable;
+                return result;
+            }
+            result.state = policy_scope_values::key_state::present;
+
+            DWORD max_name_length = 0;
+            RegQueryInfoKeyW(key, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &max_name_length, nullptr, nullptr, nullptr);
+            std::wstring name(static_cast<size_t>(max_name_length) + 1, L'\0');
+
+            for (DWORD index = 0;; index++)
+            {
+                DWORD name_length = static_cast<DWORD>(name.size());
+                BYTE data[sizeof(DWORD)];
+                DWORD data_size = sizeof(data);
+                const auto res = RegEnumValueW(key, index, name.data(), &name_length, nullptr, nullptr, data, &data_size);
+                if (res == ERROR_SUCCESS)
+                {
+                    result.set_value(std::wstring(name.data(), name_length), data, data_size);
+                }
+                else if (res != ERROR_MORE_DATA) // A value too large for a DWORD is skipped
+                {
+                    break;
+                }
+            }
+
+            RegCloseKey(key);
+            return result;
         }
+
+        key_watch watches[2];
+        bool watching = false;
+    };
+
+    // The policies of this process, shared by all the getters below.
+    inline policy_cache& policies()
+    {
+        static registry_policy_source source;
+        static policy_cache cache(source);
+        return cache;
+    }
+
+    inline gpo_rule_configured_t getConfiguredValue(const std::wstring& registry_value_name)
+    {
+        return policies().get(registry_value_name);
     }
 
     inline std::optional<std::wstring> getPolicyListValue(const std::wstring& registry_list_path, const std::wstring& registry_list_value_name)
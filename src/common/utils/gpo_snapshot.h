@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cwctype>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+// Policy values read from both registry scopes in one pass and kept until the
+// policies change. Nothing here touches the registry, so the same code runs
+// against the real registry (see gpo.h) or against a test double.
+
+namespace powertoys_gpo
+{
+    enum gpo_rule_configured_t
+    {
+        gpo_rule_configured_wrong_value = -3, // The policy is set to an unrecognized value
+        gpo_rule_configured_unavailable = -2, // Couldn't access registry
+        gpo_rule_configured_not_configured = -1, // Policy is not configured
+        gpo_rule_configured_disabled = 0, // Policy is disabled
+        gpo_rule_configured_enabled = 1, // Policy is enabled
+    };
+
+    // The values of the policies key in one registry scope.
+    struct policy_scope_values
+    {
+        enum class key_state
+        {
+            present,
+            missing, // The policies key does not exist
+            unavailable, // The policies key exists but couldn't be opened
+        };
+
+        key_state state = key_state::missing;
+
+        // Only values of at most 4 bytes, as read into a DWORD initialized to
+        // 0xFFFFFFFE; larger values can't be read as a DWORD and are left out.
+        std::unordered_map<std::wstring, uint32_t> values;
+
+        void set_value(const std::wstring& name, const void* data, size_t size)
+        {
+            if (size <= sizeof(uint32_t))
+            {
+                uint32_t value = 0xFFFFFFFE;
+                memcpy(&value, data, size);
+                values[name] = value;
+            }
+        }
+    };
+
+    // Registry value names are case insensitive. Policy names are ASCII, so
+    // that case is folded without a call into the CRT.
+    inline wchar_t fold_policy_name_char(wchar_t c) noexcept
+    {
+        if (c < 0x80)
+        {
+            return c >= L'a' && c <= L'z' ? static_cast<wchar_t>(c - (L'a' - L'A')) : c;
+        }
+        return static_cast<wchar_t>(towupper(c));
+    }
+
+    struct policy_name_hash
+    {
+        size_t operator()(const std::wstring& name) const noexcept
+        {
+            uint64_t hash = 14695981039346656037ull;
+            for (const wchar_t c : name)
+            {
+                hash ^= static_cast<uint64_t>(fold_policy_name_char(c));
+                hash *= 1099511628211ull;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    struct policy_name_equal
+    {
+        bool operator()(const std::wstring& a, const std::wstring& b) const noexcept
+        {
+            return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](wchar_t x, wchar_t y) { return fold_policy_name_char(x) == fold_policy_name_char(y); });
+        }
+    };
+
+    // Resolved policy values. A policy set for the machine wins over the same
+    // policy set for the user.
+    class policy_snapshot
+    {
+    public:
+        policy_snapshot(const policy_scope_values& machine, const policy_scope_values& user)
+        {
+            for (const auto& [name, value] : user.values)
+            {
+                rules[name] = to_rule(value);
+            }
+            for (const auto& [name, value] : machine.values)
+            {
+                rules[name] = to_rule(value);
+            }
+
+            switch (user.state)
+            {
+            case policy_scope_values::key_state::present:
+            case policy_scope_values::key_state::missing:
+                unset_rule = gpo_rule_configured_not_configured;
+                break;
+            case policy_scope_values::key_state::unavailable:
+                unset_rule = gpo_rule_configured_unavailable;
+                break;
+            }
+        }
+
+        gpo_rule_configured_t get(const std::wstring& registry_value_name) const
+        {
+            const auto it = rules.find(registry_value_name);
+            return it != rules.end() ? it->second : unset_rule;
+        }
+
+    private:
+        static gpo_rule_configured_t to_rule(uint32_t value)
+        {
+            switch (value)
+            {
+            case 0:
+                return gpo_rule_configured_disabled;
+            case 1:
+                return gpo_rule_configured_enabled;
+            default:
+                return gpo_rule_configured_wrong_value;
+            }
+        }
+
+        std::unordered_map<std::wstring, gpo_rule_configured_t, policy_name_hash, policy_name_equal> rules;
+
+        // For policies that are not set in either scope.
+        gpo_rule_configured_t unset_rule = gpo_rule_configured_not_configured;
+    };
+
+    // Where the policy values come from.
+    class policy_source
+    {
+    public:
+        virtual ~policy_source() = default;
+
+        // Reads the policies of both scopes. Changes made after read starts
+        // must make the next call to changed return true.
+        virtual policy_snapshot read() = 0;
+
+        // Whether the policies may have changed since the last read.
+        virtual bool changed() = 0;
+    };
+
+    // Serves policy lookups from a snapshot that is only read again after the
+    // source reports a change.
+    class policy_cache
+    {
+    public:
+        explicit policy_cache(policy_source& policies) :
+            source(policies)
+        {
+        }
+
+        gpo_rule_configured_t get(const std::wstring& registry_value_name)
+        {
+            std::unique_lock lock{ mutex };
+            if (!snapshot || source.changed())
+            {
+                snapshot = source.read();
+            }
+            return snapshot->get(registry_value_name);
+        }
+
+    private:
+        policy_source& source;
+        std::mutex mutex;
+        std::optional<policy_snapshot> snapshot;
+    };
+}
@@ -0,0 +1,1094 @@
+#pragma once
+
+// Header only UTF-8 JSON reader and writer that does not depend on WinRT.
+//
+// json::native::document parses a whole file in place: strings are unescaped
+// inside the document's own buffer and all values live in one flat array, so
+// a parse makes two allocations that grow with the input and none per value.
+// value_ref is a cheap view into a document, and json::native::get mirrors
+// json::get from json.h so code can move over one module at a time.
+//
+// parse() is the underlying SAX layer for callers that don't need a DOM, and
+// writer produces compact JSON without building one.
+
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "utf8.h"
+
+namespace json::native
+{
+    enum class value_type : uint8_t
+    {
+        null,
+        boolean,
+        number,
+        string,
+        array,
+        object,
+    };
+
+    // Deeper documents are rejected rather than risk running out of stack.
+    constexpr unsigned max_depth = 512;
+
+    inline std::wstring to_wstring(std::string_view text)
+    {
+        std::wstring result;
+        utf8::append_wide(text, result);
+        return result;
+    }
+
+    inline std::string to_utf8(std::wstring_view text)
+    {
+        std::string result;
+        utf8::append_utf8(text, result);
+        return result;
+    }
+
+#pragma region Reader
+    namespace details
+    {
+        class parser
+        {
+        public:
+            parser(char* text, size_t size) :
+                cur(text), end(text + size)
+            {
+            }
+
+            template<typename Handler>
+            bool parse_document(Handler& handler)
+            {
+                // Tolerate the byte order mark some editors write
+                if (end - cur >= 3 && memcmp(cur, "\xEF\xBB\xBF", 3) == 0)
+                {
+                    cur += 3;
+                }
+
+                skip_whitespace();
+                if (!parse_value(handler, 0))
+                {
+                    return false;
+                }
+                skip_whitespace();
+                return cur == end;
+            }
+
+        private:
+            void skip_whitespace()
+            {
+                while (cur != end && (*cur == ' ' || *cur == '\n' || *cur == '\r' || *cur == '\t'))
+                {
+                    cur++;
+                }
+            }
+
+            bool consume(char c)
+            {
+                skip_whitespace();
+                if (cur != end && *cur == c)
+                {
+                    cur++;
+                    return true;
+                }
+                return false;
+            }
+
+            bool parse_literal(std::string_view literal)
+            {
+                if (static_cast<size_t>(end - cur) < literal.size() || memcmp(cur, literal.data(), literal.size()) != 0)
+                {
+                    return false;
+                }
+                cur += literal.size();
+                return true;
+            }
+
+            template<typename Handler>
+            bool parse_value(Handler& handler, unsigned depth)
+            {
+                if (cur == end)
+                {
+                    return false;
+                }
+
+                switch (*cur)
+                {
+                case '{':
+                    return parse_object(handler, depth + 1);
+                case '[':
+                    return parse_array(handler, depth + 1);
+                case '"':
+                {
+                    std::string_view text;
+                    if (!parse_string(text))
+                    {
+                        return false;
+                    }
+                    handler.string(text);
+                    return true;
+                }
+                case 't':
+                    if (!parse_literal("true"))
+                    {
+                        return false;
+                    }
+                    handler.boolean(true);
+                    return true;
+                case 'f':
+                    if (!parse_literal("false"))
+                    {
+                        return false;
+                    }
+                    handler.boolean(false);
+                    return true;
+                case 'n':
+                    if (!parse_literal("null"))
+                    {
+                        return false;
+                    }
+                    handler.null();
+                    return true;
+                default:
+                    return parse_number(handler);
+                }
+            }
+
+            template<typename Handler>
+            bool parse_object(Handler& handler, unsigned depth)
+            {
+                if (depth > max_depth)
+                {
+                    return false;
+                }
+
+                cur++;
+                handler.start_object();
+                if (consume('}'))
+                {
+                    handler.end_object();
+                    return true;
+                }
+
+                do
+                {
+                    skip_whitespace();
+                    std::string_view key;
+                    if (cur == end || *cur != '"' || !parse_string(key) || !consume(':'))
+                    {
+                        return false;
+                    }
+                    handler.key(key);
+
+                    skip_whitespace();
+                    if (!parse_value(handler, depth))
+                    {
+                        return false;
+                    }
+                } while (consume(','));
+
+                if (!consume('}'))
+                {
+                    return false;
+                }
+                handler.end_object();
+                return true;
+            }
+
+            template<typename Handler>
+            bool parse_array(Handler& handler, unsigned depth)
+            {
+                if (depth > max_depth)
+                {
+                    return false;
+                }
+
+                cur++;
+                handler.start_array();
+                if (consume(']'))
+                {
+                    handler.end_array();
+                    return true;
+                }
+
+                do
+                {
+                    skip_whitespace();
+                    if (!parse_value(handler, depth))
+                    {
+                        return false;
+                    }
+                } while (consume(','));
+
+                if (!consume(']'))
+                {
+                    return false;
+                }
+                handler.end_array();
+                return true;
+            }
+
+            static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+            template<typename Handler>
+            bool parse_number(Handler& handler)
+            {
+                const char* start = cur;
+                if (cur != end && *cur == '-')
+                {
+                    cur++;
+                }
+
+                if (cur == end || !is_digit(*cur))
+                {
+                    return false;
+                }
+                if (*cur == '0')
+                {
+                    cur++;
+                }
+                else
+                {
+                    while (cur != end && is_digit(*cur))
+                    {
+                        cur++;
+                    }
+                }
+
+                if (cur != end && *cur == '.')
+                {
+                    cur++;
+                    if (cur == end || !is_digit(*cur))
+                    {
+                        return false;
+                    }
+                    while (cur != end && is_digit(*cur))
+                    {
+                        cur++;
+                    }
+                }
+
+                if (cur != end && (*cur == 'e' || *cur == 'E'))
+                {
+                    cur++;
+                    if (cur != end && (*cur == '+' || *cur == '-'))
+                    {
+                        cur++;
+                    }
+                    if (cur == end || !is_digit(*cur))
+                    {
+                        return false;
+                    }
+                    while (cur != end && is_digit(*cur))
+                    {
+                        cur++;
+                    }
+                }
+
+                double number = 0;
+                const auto result = std::from_chars(start, cur, number);
+                if (result.ec != std::errc{} || result.ptr != cur)
+                {
+                    return false;
+                }
+                handler.number(number);
+                return true;
+            }
+
+            static int hex_digit(char c)
+            {
+                if (c >= '0' && c <= '9')
+                {
+                    return c - '0';
+                }
+                if (c >= 'a' && c <= 'f')
+                {
+                    return c - 'a' + 10;
+                }
+                if (c >= 'A' && c <= 'F')
+                {
+                    return c - 'A' + 10;
+                }
+                return -1;
+            }
+
+            bool parse_hex4(char32_t& value)
+            {
+                if (end - cur < 4)
+                {
+                    return false;
+                }
+                value = 0;
+                for (int i = 0; i < 4; i++)
+                {
+                    const int digit = hex_digit(*cur++);
+                    if (digit < 0)
+                    {
+                        return false;
+                    }
+                    value = (value << 4) | static_cast<char32_t>(digit);
+                }
+                return true;
+            }
+
+            // Unescapes the string in place. An escape never takes less room
+            // than the UTF-8 it stands for, so the output can't overtake the input.
+            bool parse_string(std::string_view& text)
+            {
+                cur++;
+                char* const start = cur;
+
+                // Most strings have no escapes and need no copying
+                while (cur != end && *cur != '"' && *cur != '\\' && static_cast<uint8_t>(*cur) >= 0x20)
+                {
+                    cur++;
+                }
+
+                char* out = cur;
+                while (cur != end)
+                {
+                    const char c = *cur;
+                    if (c == '"')
+                    {
+                        cur++;
+                        text = std::string_view(start, static_cast<size_t>(out - start));
+                        return true;
+                    }
+                    if (static_cast<uint8_t>(c) < 0x20)
+                    {
+                        return false;
+                    }
+                    if (c != '\\')
+                    {
+                        *out++ = *cur++;
+                        continue;
+                    }
+
+                    cur++;
+                    if (cur == end)
+                    {
+                        return false;
+                    }
+                    switch (*cur++)
+                    {
+                    case '"':
+                        *out++ = '"';
+                        break;
+                    case '\\':
+                        *out++ = '\\';
+                        break;
+                    case '/':
+                        *out++ = '/';
+                        break;
+                    case 'b':
+                        *out++ = '\b';
+                        break;
+                    case 'f':
+                        *out++ = '\f';
+                        break;
+                    case 'n':
+                        *out++ = '\n';
+                        break;
+                    case 'r':
+                        *out++ = '\r';
+                        break;
+                    case 't':
+                        *out++ = '\t';
+                        break;
+                    case 'u':
+                    {
+                        char32_t code_point;
+                        if (!parse_hex4(code_point))
+                        {
+                            return false;
+                        }
+                        if (code_point >= 0xDC00 && code_point <= 0xDFFF)
+                        {
+                            return false;
+                        }
+                        if (code_point >= 0xD800 && code_point <= 0xDBFF)
+                        {
+                            // A high surrogate must be followed by an escaped low one
+                            char32_t low;
+                            if (end - cur < 2 || cur[0] != '\\' || cur[1] != 'u')
+                            {
+                                return false;
+                            }
+                            cur += 2;
+                            if (!parse_hex4(low) || low < 0xDC00 || low > 0xDFFF)
+                            {
+                                return false;
+                            }
+                            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        out += utf8::encode(code_point, out);
+                        break;
+                    }
+                    default:
+                        return false;
+                    }
+                }
+                return false;
+            }
+
+            char* cur;
+            char* const end;
+        };
+    }
+
+    // Parses text in place, calling the handler for each value as it is read:
+    //   null(), boolean(bool), number(double), string(std::string_view),
+    //   key(std::string_view), start_object(), end_object(), start_array(), end_array()
+    // The string views point into text, which is modified. Returns false if
+    // text is not a single valid JSON value; the handler may have seen part
+    // of it by then.
+    template<typename Handler>
+    bool parse(char* text, size_t size, Handler& handler)
+    {
+        details::parser parser(text, size);
+        return parser.parse_document(handler);
+    }
+#pragma endregion Reader
+
+#pragma region Document
+    class value_ref;
+
+    class document
+    {
+    public:
+        // Takes the text so strings can be unescaped inside it.
+        static std::optional<document> parse(std::string text);
+
+        value_ref root() const;
+
+    private:
+        friend class value_ref;
+
+        struct node
+        {
+            value_type type = value_type::null;
+            bool boolean = false;
+
+            // Length of a string; number of elements or members of a container.
+            uint32_t size = 0;
+
+            // Index of the node after this value, so siblings are one step apart.
+            uint32_t end = 0;
+
+            union
+            {
+                double number = 0;
+                uint32_t offset; // Of a string in buffer
+            };
+        };
+
+        // Lays values out in document order: a container is followed by its
+        // children, and each object member by its key as a string node.
+        class builder
+        {
+        public:
+            builder(std::vector<node>& nodes, const char* base) :
+                nodes(nodes), base(base)
+            {
+            }
+
+            void null() { add(value_type::null); }
+
+            void boolean(bool value) { add(value_type::boolean).boolean = value; }
+
+            void number(double value) { add(value_type::number).number = value; }
+
+            void string(std::string_view value) { add_string(value); }
+
+            void key(std::string_view value)
+            {
+                nodes[open.back()].size++;
+                add_string(value);
+            }
+
+            void start_object() { open_container(value_type::object); }
+
+            void end_object() { close_container(); }
+
+            void start_array() { open_container(value_type::array); }
+
+            void end_array() { close_container(); }
+
+        private:
+            node& add(value_type type)
+            {
+                if (!open.empty() && nodes[open.back()].type == value_type::array)
+                {
+                    nodes[open.back()].size++;
+                }
+                node& added = nodes.emplace_back();
+                added.type = type;
+                added.end = static_cast<uint32_t>(nodes.size());
+                return added;
+            }
+
+            void add_string(std::string_view value)
+            {
+                node& added = add(value_type::string);
+                added.size = static_cast<uint32_t>(value.size());
+                added.offset = static_cast<uint32_t>(value.data() - base);
+            }
+
+            void open_container(value_type type)
+            {
+                add(type);
+                open.push_back(static_cast<uint32_t>(nodes.size() - 1));
+            }
+
+            void close_container()
+            {
+                nodes[open.back()].end = static_cast<uint32_t>(nodes.size());
+                open.pop_back();
+            }
+
+            std::vector<node>& nodes;
+            const char* base;
+            std::vector<uint32_t> open;
+        };
+
+        std::string_view string_at(uint32_t index) const
+        {
+            return std::string_view(buffer.data() + nodes[index].offset, nodes[index].size);
+        }
+
+        std::string buffer;
+        std::vector<node> nodes;
+    };
+
+    // A value in a document, or no value at all (for instance the result of
+    // looking up a missing key); any query on no value returns nothing.
+    // Only valid while the document lives.
+    class value_ref
+    {
+    public:
+        struct member;
+
+        template<typename T>
+        class iterator
+        {
+        public:
+            iterator(const document* doc, uint32_t index) :
+                doc(doc), index(index)
+            {
+            }
+
+            T operator*() const
+            {
+                if constexpr (std::is_same_v<T, member>)
+                {
+                    return member{ doc->string_at(index), value_ref(doc, index + 1) };
+                }
+                else
+                {
+                    return value_ref(doc, index);
+                }
+            }
+
+            iterator& operator++()
+            {
+                // Skip the key of a member, then the value
+                if constexpr (std::is_same_v<T, member>)
+                {
+                    index++;
+                }
+                index = doc->nodes[index].end;
+                return *this;
+            }
+
+            bool operator==(const iterator& other) const { return index == other.index; }
+
+        private:
+            const document* doc;
+            uint32_t index;
+        };
+
+        template<typename T>
+        struct range
+        {
+            iterator<T> first;
+            iterator<T> last;
+
+            iterator<T> begin() const { return first; }
+            iterator<T> end() const { return last; }
+        };
+
+        value_ref() = default;
+
+        value_ref(const document* doc, uint32_t index) :
+            doc(doc), index(index)
+        {
+        }
+
+        explicit operator bool() const noexcept { return doc != nullptr; }
+
+        value_type type() const noexcept { return doc ? node().type : value_type::null; }
+
+        bool is_null() const noexcept { return doc && node().type == value_type::null; }
+        bool is_object() const noexcept { return type() == value_type::object; }
+        bool is_array() const noexcept { return type() == value_type::array; }
+
+        std::optional<bool> as_bool() const
+        {
+            return type() == value_type::boolean ? std::optional<bool>(node().boolean) : std::nullopt;
+        }
+
+        std::optional<double> as_number() const
+        {
+            return type() == value_type::number ? std::optional<double>(node().number) : std::nullopt;
+        }
+
+        std::optional<std::string_view> as_string() const
+        {
+            return type() == value_type::string ? std::optional<std::string_view>(doc->string_at(index)) : std::nullopt;
+        }
+
+        // Number of elements or members; 0 for anything else.
+        size_t size() const noexcept
+        {
+            return is_object() || is_array() ? node().size : 0;
+        }
+
+        // The member with this key, or no value. Objects are searched in
+        // order; the first of duplicate keys wins.
+        value_ref find(std::string_view key) const
+        {
+            if (!is_object())
+            {
+                return {};
+            }
+            for (uint32_t i = index + 1; i < node().end; i = doc->nodes[i + 1].end)
+            {
+                if (doc->string_at(i) == key)
+                {
+                    return value_ref(doc, i + 1);
+                }
+            }
+            return {};
+        }
+
+        value_ref operator[](std::string_view key) const { return find(key); }
+
+        // The element at position, or no value.
+        value_ref at(size_t position) const
+        {
+            if (!is_array() || position >= node().size)
+            {
+                return {};
+            }
+            uint32_t i = index + 1;
+            for (; position > 0; position--)
+            {
+                i = doc->nodes[i].end;
+            }
+            return value_ref(doc, i);
+        }
+
+        range<value_ref> elements() const
+        {
+            return is_array() ? range<value_ref>{ { doc, index + 1 }, { doc, node().end } } : range<value_ref>{ { doc, 0 }, { doc, 0 } };
+        }
+
+        range<member> members() const
+        {
+            return is_object() ? range<member>{ { doc, index + 1 }, { doc, node().end } } : range<member>{ { doc, 0 }, { doc, 0 } };
+        }
+
+    private:
+        const document::node& node() const { return doc->nodes[index]; }
+
+        const document* doc = nullptr;
+        uint32_t index = 0;
+    };
+
+    struct value_ref::member
+    {
+        std::string_view key;
+        value_ref value;
+    };
+
+    inline std::optional<document> document::parse(std::string text)
+    {
+        document result;
+        result.buffer = std::move(text);
+
+        // Roughly one value per 8 bytes of typical settings files
+        result.nodes.reserve(result.buffer.size() / 8 + 1);
+
+        builder handler(result.nodes, result.buffer.data());
+        if (!native::parse(result.buffer.data(), result.buffer.size(), handler))
+        {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    inline value_ref document::root() const
+    {
+        return nodes.empty() ? value_ref() : value_ref(this, 0);
+    }
+
+    inline std::optional<document> from_file(const std::filesystem::path& file_name)
+    {
+        try
+        {
+            std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+            if (!file.is_open())
+            {
+                return std::nullopt;
+            }
+
+            std::string text(static_cast<size_t>(file.tellg()), '\0');
+            file.seekg(0);
+            if (!file.read(text.data(), static_cast<std::streamsize>(text.size())))
+            {
+                return std::nullopt;
+            }
+            return document::parse(std::move(text));
+        }
+        catch (...)
+        {
+            return std::nullopt;
+        }
+    }
+
+    inline bool has(const value_ref& o, std::string_view name, const value_type type = value_type::object)
+    {
+        const value_ref member = o.find(name);
+        return member && member.type() == type;
+    }
+
+    // Whether both are the same JSON value. Object members are matched by
+    // key, so their order doesn't matter.
+    inline bool equal(const value_ref& a, const value_ref& b)
+    {
+        if (static_cast<bool>(a) != static_cast<bool>(b) || a.type() != b.type())
+        {
+            return false;
+        }
+
+        switch (a.type())
+        {
+        case value_type::null:
+            return true;
+        case value_type::boolean:
+            return a.as_bool() == b.as_bool();
+        case value_type::number:
+            return a.as_number() == b.as_number();
+        case value_type::string:
+            return a.as_string() == b.as_string();
+        case value_type::array:
+        {
+            if (a.size() != b.size())
+            {
+                return false;
+            }
+            auto other = b.elements().begin();
+            for (const auto element : a.elements())
+            {
+                if (!equal(element, *other))
+                {
+                    return false;
+                }
+                ++other;
+            }
+            return true;
+        }
+        case value_type::object:
+            if (a.size() != b.size())
+            {
+                return false;
+            }
+            for (const auto& [key, value] : a.members())
+            {
+                if (!equal(value, b.find(key)))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // Same contract as json::get: destination is set from the member with
+    // this name if it has the right type, and to default_value otherwise,
+    // unless there's no default.
+    template<typename T, typename D = std::optional<T>>
+        requires std::constructible_from<std::optional<T>, D>
+    void get(const value_ref& o, std::string_view name, T& destination, D default_value = std::nullopt)
+    {
+        const value_ref member = o.find(name);
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            if (const auto value = member.as_bool())
+            {
+                destination = *value;
+                return;
+            }
+        }
+        else if constexpr (std::is_arithmetic_v<T>)
+        {
+            if (const auto value = member.as_number())
+            {
+                destination = static_cast<T>(*value);
+                return;
+            }
+        }
+        else if constexpr (std::is_same_v<T, std::wstring>)
+        {
+            if (const auto value = member.as_string())
+            {
+                destination = to_wstring(*value);
+                return;
+            }
+        }
+        else if constexpr (std::is_same_v<T, std::string>)
+        {
+            if (const auto value = member.as_string())
+            {
+                destination = *value;
+                return;
+            }
+        }
+        else if constexpr (std::is_same_v<T, value_ref>)
+        {
+            if (member.is_object())
+            {
+                destination = member;
+                return;
+            }
+        }
+        else
+        {
+            static_assert(std::bool_constant<std::is_same_v<T, T&>>::value, "Unsupported type");
+        }
+
+        std::optional<T> maybe_default{ std::move(default_value) };
+        if (maybe_default.has_value())
+            destination = std::move(*maybe_default);
+    }
+#pragma endregion Document
+
+#pragma region Writer
+    // Writes compact JSON. The caller is responsible for balancing the
+    // start and end calls and for writing a key before each member value.
+    class writer
+    {
+    public:
+        writer& start_object()
+        {
+            separate();
+            out += '{';
+            first.push_back(true);
+            return *this;
+        }
+
+        writer& end_object()
+        {
+            out += '}';
+            first.pop_back();
+            return *this;
+        }
+
+        writer& start_array()
+        {
+            separate();
+            out += '[';
+            first.push_back(true);
+            return *this;
+        }
+
+        writer& end_array()
+        {
+            out += ']';
+            first.pop_back();
+            return *this;
+        }
+
+        writer& key(std::string_view name)
+        {
+            separate();
+            write_string(name);
+            out += ':';
+            after_key = true;
+            return *this;
+        }
+
+        writer& value(std::nullptr_t)
+        {
+            separate();
+            out += "null";
+            return *this;
+        }
+
+        writer& value(bool boolean)
+        {
+            separate();
+            out += boolean ? "true" : "false";
+            return *this;
+        }
+
+        template<typename T>
+            requires(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+        writer& value(T number)
+        {
+            separate();
+            char digits[24];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), number);
+            out.append(digits, result.ptr);
+            return *this;
+        }
+
+        // Written in the shortest form that reads back as the same double.
+        // JSON has no NaN or infinity, so those are written as null.
+        writer& value(double number)
+        {
+            if (!std::isfinite(number))
+            {
+                return value(nullptr);
+            }
+            separate();
+            char digits[32];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), number);
+            out.append(digits, result.ptr);
+            return *this;
+        }
+
+        writer& value(std::string_view text)
+        {
+            separate();
+            write_string(text);
+            return *this;
+        }
+
+        writer& value(const char* text) { return value(std::string_view(text)); }
+
+        writer& value(std::wstring_view text) { return value(std::string_view(to_utf8(text))); }
+
+        writer& value(const wchar_t* text) { return value(std::wstring_view(text)); }
+
+        // Copies a value from a document.
+        writer& value(const value_ref& source)
+        {
+            switch (source.type())
+            {
+            case value_type::null:
+                return value(nullptr);
+            case value_type::boolean:
+                return value(*source.as_bool());
+            case value_type::number:
+                return value(*source.as_number());
+            case value_type::string:
+                return value(*source.as_string());
+            case value_type::array:
+                start_array();
+                for (const value_ref element : source.elements())
+                {
+                    value(element);
+                }
+                return end_array();
+            case value_type::object:
+                start_object();
+                for (const auto& [name, member] : source.members())
+                {
+                    key(name);
+                    value(member);
+                }
+                return end_object();
+            }
+            return *this;
+        }
+
+        const std::string& str() const noexcept { return out; }
+
+        std::string take() noexcept { return std::move(out); }
+
+    private:
+        void separate()
+        {
+            if (after_key)
+            {
+                after_key = false;
+                return;
+            }
+            if (!first.empty())
+            {
+                if (!first.back())
+                {
+                    out += ',';
+                }
+                first.back() = false;
+            }
+        }
+
+        void write_string(std::string_view text)
+        {
+            static constexpr char hex[] = "0123456789abcdef";
+
+            out += '"';
+            size_t plain = 0;
+            for (size_t i = 0; i < text.size(); i++)
+            {
+                const auto c = static_cast<uint8_t>(text[i]);
+                if (c >= 0x20 && c != '"' && c != '\\')
+                {
+                    continue;
+                }
+
+                out.append(text.data() + plain, i - plain);
+                plain = i + 1;
+                switch (c)
+                {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xF];
+                    break;
+                }
+            }
+            out.append(text.data() + plain, text.size() - plain);
+            out += '"';
+        }
+
+        std::string out;
+        std::vector<bool> first;
+        bool after_key = false;
+    };
+
+    inline bool to_file(const std::filesystem::path& file_name, std::string_view text)
+    {
+        std::ofstream file(file_name, std::ios::binary);
+        return file.write(text.data(), static_cast<std::streamsize>(text.size())).good();
+    }
+#pragma endregion Writer
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+// UTF-8 conversions that work the same on any platform and append to a
+// caller's buffer, so hot paths can reuse their strings.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace utf8
+{
+    // Writes the code point to out, which needs room for 4 bytes. Returns
+    // the number of bytes written.
+    inline size_t encode(char32_t code_point, char* out)
+    {
+        if (code_point < 0x80)
+        {
+            out[0] = static_cast<char>(code_point);
+            return 1;
+        }
+        if (code_point < 0x800)
+        {
+            out[0] = static_cast<char>(0xC0 | (code_point >> 6));
+            out[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+            return 2;
+        }
+        if (code_point < 0x10000)
+        {
+            out[0] = static_cast<char>(0xE0 | (code_point >> 12));
+            out[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+            return 3;
+        }
+        out[0] = static_cast<char>(0xF0 | (code_point >> 18));
+        out[1] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+        return 4;
+    }
+
+    namespace details
+    {
+        // Copies the run of ASCII characters that starts at begin to the end
+        // of result in one resize instead of one append per character.
+        // Returns where the run ends. Settings payloads are almost all ASCII,
+        // so the run is found a block at a time, which compilers vectorize.
+        template<typename From, typename To>
+        size_t append_ascii_run(std::basic_string_view<From> text, size_t begin, std::basic_string<To>& result)
+        {
+            using unit = std::make_unsigned_t<From>;
+            constexpr size_t block_size = 16;
+
+            size_t end = begin;
+            while (end + block_size <= text.size())
+            {
+                uint32_t bits = 0;
+                for (size_t i = 0; i < block_size; i++)
+                {
+                    bits |= static_cast<uint32_t>(static_cast<unit>(text[end + i]));
+                }
+                if (bits >= 0x80)
+                {
+                    break;
+                }
+                end += block_size;
+            }
+            while (end < text.size() && static_cast<uint32_t>(static_cast<unit>(text[end])) < 0x80)
+            {
+                end++;
+            }
+
+            const size_t offset = result.size();
+            result.resize(offset + (end - begin));
+            To* out = result.data() + offset;
+            for (size_t i = begin; i < end; i++)
+            {
+                *out++ = static_cast<To>(text[i]);
+            }
+            return end;
+        }
+    }
+
+    // Appends the UTF-16 (UTF-32 where wchar_t is 4 bytes) form of the text
+    // to result. Invalid sequences become U+FFFD.
+    inline void append_wide(std::string_view utf8, std::wstring& result)
+    {
+        result.reserve(result.size() + utf8.size());
+        for (size_t i = 0; i < utf8.size();)
+        {
+            const auto lead = static_cast<uint8_t>(utf8[i]);
+            if (lead < 0x80)
+            {
+                i = details::append_ascii_run(utf8, i, result);
+                continue;
+            }
+
+            size_t length = 0;
+            char32_t code_point = 0;
+            char32_t min_code_point = 0;
+            if ((lead & 0xE0) == 0xC0)
+            {
+                length = 2;
+                code_point = lead & 0x1F;
+                min_code_point = 0x80;
+            }
+            else if ((lead & 0xF0) == 0xE0)
+            {
+                length = 3;
+                code_point = lead & 0x0F;
+                min_code_point = 0x800;
+            }
+            else if ((lead & 0xF8) == 0xF0)
+            {
+                length = 4;
+                code_point = lead & 0x07;
+                min_code_point = 0x10000;
+            }
+
+            size_t read = 1;
+            while (read < length && i + read < utf8.size() && (static_cast<uint8_t>(utf8[i + read]) & 0xC0) == 0x80)
+            {
+                code_point = (code_point << 6) | (static_cast<uint8_t>(utf8[i + read]) & 0x3F);
+                read++;
+            }
+            i += read;
+
+            if (length == 0 || read != length || code_point < min_code_point || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF))
+            {
+                code_point = 0xFFFD;
+            }
+
+            if constexpr (sizeof(wchar_t) == 2)
+            {
+                if (code_point >= 0x10000)
+                {
+                    code_point -= 0x10000;
+                    result += static_cast<wchar_t>(0xD800 + (code_point >> 10));
+                    result += static_cast<wchar_t>(0xDC00 + (code_point & 0x3FF));
+                    continue;
+                }
+            }
+            result += static_cast<wchar_t>(code_point);
+        }
+    }
+
+    // Appends the UTF-8 form of the text to result. Unpaired surrogates
+    // become U+FFFD.
+    inline void append_utf8(std::wstring_view text, std::string& result)
+    {
+        result.reserve(result.size() + text.size());
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            if (static_cast<char32_t>(text[i]) < 0x80)
+            {
+                i = details::append_ascii_run(text, i, result) - 1;
+                continue;
+            }
+
+            auto code_point = static_cast<char32_t>(text[i]);
+            if (code_point >= 0xD800 && code_point <= 0xDBFF && i + 1 < text.size() && text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF)
+            {
+                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (static_cast<char32_t>(text[i + 1]) - 0xDC00);
+                i++;
+            }
+            else if ((code_point >= 0xD800 && code_point <= 0xDFFF) || code_point > 0x10FFFF)
+            {
+                code_point = 0xFFFD;
+            }
+            char encoded[4];
+            result.append(encoded, encode(code_point, encoded));
+        }
+    }
+}
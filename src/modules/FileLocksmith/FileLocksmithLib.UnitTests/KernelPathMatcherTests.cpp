@@ -0,0 +1,135 @@
+#include "pch.h"
+#include <KernelPathMatcher.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FileLocksmithLibUnitTests
+{
+    TEST_CLASS(KernelPathMatcherTests)
+    {
+    public:
+        TEST_METHOD(Find_ExactFile_ReturnsItsPath)
+        {
+            // Arrange
+            KernelPathMatcher matcher;
+            matcher.add(L"\\Device\\HarddiskVolume3\\Users\\A\\x.txt", L"C:\\Users\\A\\x.txt", false);
+
+            // Act & Assert
+            Assert::AreEqual(std::wstring(L"C:\\Users\\A\\x.txt"), matcher.find(L"\\Device\\HarddiskVolume3\\Users\\A\\x.txt"));
+            Assert::AreEqual(std::wstring(), matcher.find(L"\\Device\\HarddiskVolume3\\Users\\A\\x.txt\\y"));
+            Assert::AreEqual(std::wstring(), matcher.find(L"\\Device\\HarddiskVolume3\\Users\\A"));
+        }
+
+        TEST_METHOD(Find_InsideFolder_MapsDeviceNameToDosPath)
+        {
+            // Arrange
+            KernelPathMatcher matcher;
+            matcher.add(L"\\Device\\HarddiskVolume3\\Users\\A", L"C:\\Users\\A", true);
+
+            // Act & Assert
+            Assert::AreEqual(std::wstring(L"C:\\Users\\A"), matcher.find(L"\\Device\\HarddiskVolume3\\Users\\A"));
+            Assert::AreEqual(std::wstring(L"C:\\Users\\A\\x.txt"), matcher.find(L"\\Device\\HarddiskVolume3\\Users\\A\\x.txt"));
+            Assert::AreEqual(std::wstring(L"C:\\Users\\A\\Docs\\y.txt"), matcher.find(L"\\Device\\HarddiskVolume3\\Users\\A\\Docs\\y.txt"));
+        }
+
+        TEST_METHOD(Find_SiblingWithSamePrefix_DoesNotMatch)
+        {
+            // Arrange
+            KernelPathMatcher matcher;
+            matcher.add(L"\\Device\\HarddiskVolume3\\Dir", L"C:\\Dir", true);
+            matcher.add(L"\\Device\\HarddiskVolume3\\file", L"C:\\file", false);
+
+            // Act & Assert
+            Assert::AreEqual(std::wstring(), matcher.find(L"\\Device\\HarddiskVolume3\\Directory\\x.txt"));
+            Assert::AreEqual(std::wstring(), matcher.find(L"\\Device\\HarddiskVolume3\\Dir2"));
+            Assert::AreEqual(std::wstring(), matcher.find(L"\\Device\\HarddiskVolume3\\file.txt"));
+            Assert::AreEqual(std::wstring(), matcher.find(L"\\Device\\HarddiskVolume4\\Dir\\x.txt"));
+        }
+
+        TEST_METHOD(Find_NestedFolders_OuterFolderWins)
+        {
+            // Arrange
+            KernelPathMatcher matcher;
+            matcher.add(L"\\Device\\HarddiskVolume3\\A\\B", L"C:\\A\\B", true);
+            matcher.add(L"\\Device\\HarddiskVolume3\\A", L"C:\\A", true);
+
+            // Act & Assert
+            Assert::AreEqual(std::wstring(L"C:\\A\\B\\x.txt"), matcher.find(L"\\Device\\HarddiskVolume3\\A\\B\\x.txt"));
+            Assert::AreEqual(std::wstring(L"C:\\A\\C\\x.txt"), matcher.find(L"\\Device\\HarddiskVolume3\\A\\C\\x.txt"));
+        }
+
+        TEST_METHOD(Find_ExactMatch_WinsOverFolder)
+        {
+            // Arrange
+            KernelPathMatcher matcher;
+            matcher.add(L"\\Device\\HarddiskVolume3\\A", L"C:\\A", true);
+            matcher.add(L"\\Device\\HarddiskVolume3\\A\\B\\x.txt", L"X:\\x.txt", false);
+            matcher.add(L"\\Device\\HarddiskVolume3\\A\\C", L"Y:\\C", true);
+
+            // Act & Assert
+            Assert::AreEqual(std::wstring(L"X:\\x.txt"), matcher.find(L"\\Device\\HarddiskVolume3\\A\\B\\x.txt"));
+            Assert::AreEqual(std::wstring(L"Y:\\C"), matcher.find(L"\\Device\\HarddiskVolume3\\A\\C"));
+            Assert::AreEqual(std::wstring(L"C:\\A\\C\\y.txt"), matcher.find(L"\\Device\\HarddiskVolume3\\A\\C\\y.txt"));
+        }
+
+        TEST_METHOD(Find_FolderWithTrailingSeparator_MatchesItsContents)
+        {
+            // Arrange
+            KernelPathMatcher matcher;
+            matcher.add(L"\\Device\\HarddiskVolume3\\", L"C:\\", true);
+            matcher.add(L"\\Device\\HarddiskVolume4\\Data\\", L"D:\\Data\\", true);
+
+            // Act & Assert
+            Assert::AreEqual(std::wstring(L"C:\\"), matcher.find(L"\\Device\\HarddiskVolume3\\"));
+            Assert::AreEqual(std::wstring(L"C:\\Windows\\x.dll"), matcher.find(L"\\Device\\HarddiskVolume3\\Windows\\x.dll"));
+            Assert::AreEqual(std::wstring(L"D:\\Data\\x.txt"), matcher.find(L"\\Device\\HarddiskVolume4\\Data\\x.txt"));
+            Assert::AreEqual(std::wstring(), matcher.find(L"\\Device\\HarddiskVolume4\\Database\\x.txt"));
+        }
+
+        TEST_METHOD(Find_DifferentCase_MatchesAndKeepsTheNameCase)
+        {
+            // Arrange
+            KernelPathMatcher matcher;
+            matcher.add(L"\\Device\\HarddiskVolume3\\Users\\A", L"C:\\Users\\A", true);
+            matcher.add(L"\\Device\\HarddiskVolume3\\Temp\\Log.txt", L"C:\\Temp\\Log.txt", false);
+
+            // Act & Assert
+            Assert::AreEqual(std::wstring(L"C:\\Users\\A\\Docs\\X.TXT"), matcher.find(L"\\DEVICE\\HARDDISKVOLUME3\\USERS\\a\\Docs\\X.TXT"));
+            Assert::AreEqual(std::wstring(L"C:\\Temp\\Log.txt"), matcher.find(L"\\Device\\HarddiskVolume3\\TEMP\\LOG.TXT"));
+            Assert::AreEqual(std::wstring(L"C:\\Users\\A"), matcher.find(L"\\device\\harddiskvolume3\\users\\a"));
+        }
+
+        TEST_METHOD(Find_CaseSensitive_DifferentCaseDoesNotMatch)
+        {
+            // Arrange
+            KernelPathMatcher matcher(L'/', false);
+            matcher.add(L"/home/a", L"/home/a", true);
+
+            // Act & Assert
+            Assert::AreEqual(std::wstring(L"/home/a/x.txt"), matcher.find(L"/home/a/x.txt"));
+            Assert::AreEqual(std::wstring(), matcher.find(L"/home/A/x.txt"));
+            Assert::AreEqual(std::wstring(), matcher.find(L"/HOME/a"));
+        }
+
+        TEST_METHOD(Find_OtherSeparator_SplitsOnlyAtIt)
+        {
+            // Arrange
+            KernelPathMatcher matcher(L'/', false);
+            matcher.add(L"/srv/data", L"/srv/data", true);
+
+            // Act & Assert
+            Assert::AreEqual(std::wstring(L"/srv/data/a\\b"), matcher.find(L"/srv/data/a\\b"));
+            Assert::AreEqual(std::wstring(), matcher.find(L"/srv/data\\a"));
+        }
+
+        TEST_METHOD(Find_NothingAdded_ReturnsEmpty)
+        {
+            // Arrange
+            KernelPathMatcher matcher;
+
+            // Act & Assert
+            Assert::AreEqual(std::wstring(), matcher.find(L"\\Device\\HarddiskVolume3\\x.txt"));
+            Assert::AreEqual(std::wstring(), matcher.find(L""));
+        }
+    };
+}
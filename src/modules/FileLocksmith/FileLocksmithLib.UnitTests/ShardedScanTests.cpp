@@ -0,0 +1,250 @@
+#include "pch.h"
+#include <ShardedScan.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace FileLocksmithLibUnitTests
+{
+    namespace
+    {
+        // Stands in for the system handle table. Querying a handle marked
+        // as hanging blocks until the table is released, as NtQueryObject
+        // does on the machines it hangs on.
+        class FakeHandleTable
+        {
+        public:
+            struct Handle
+            {
+                size_t pid;
+                bool hangs;
+            };
+
+            void add(size_t pid, size_t count)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    handles.push_back({ pid, false });
+                }
+            }
+
+            void hang_at(size_t position)
+            {
+                handles[position].hangs = true;
+            }
+
+            size_t size() const
+            {
+                return handles.size();
+            }
+
+            std::vector<size_t> pids() const
+            {
+                std::vector<size_t> result;
+                for (const auto& handle : handles)
+                {
+                    result.push_back(handle.pid);
+                }
+                return result;
+            }
+
+            // Returns the position, once the table is released if it hangs
+            size_t query(size_t position)
+            {
+                if (handles[position].hangs)
+                {
+                    std::unique_lock lock{ mutex };
+                    ++hung;
+                    released.wait(lock, [this] { return open; });
+                    --hung;
+                    returned.notify_all();
+                }
+                return position;
+            }
+
+            // Lets the hung queries return and waits until they have
+            void release()
+            {
+                std::unique_lock lock{ mutex };
+                open = true;
+                released.notify_all();
+                returned.wait(lock, [this] { return hung == 0; });
+            }
+
+        private:
+            std::vector<Handle> handles;
+            std::mutex mutex;
+            std::condition_variable released;
+            std::condition_variable returned;
+            bool open = false;
+            size_t hung = 0;
+        };
+
+        struct ScanContext
+        {
+            std::vector<size_t> positions;
+        };
+
+        struct ScanResult
+        {
+            std::vector<size_t> positions;
+            size_t abandoned = 0;
+            std::chrono::milliseconds elapsed;
+        };
+
+        ScanResult Scan(const std::shared_ptr<FakeHandleTable>& table, size_t max_shard_size, const ShardedScanOptions& options)
+        {
+            ScanResult result;
+            const auto start = std::chrono::steady_clock::now();
+
+            // The table is shared with the scan, which outlives this call on
+            // the abandoned threads
+            auto contexts = run_sharded_scan<ScanContext>(
+                make_scan_shards(table->pids(), max_shard_size),
+                [table](ScanContext& context, size_t position) {
+                    context.positions.push_back(table->query(position));
+                },
+                [&result](std::thread&, ScanContext&) {
+                    ++result.abandoned;
+                },
+                options);
+
+            result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            for (const auto& context : contexts)
+            {
+                result.positions.insert(result.positions.end(), context->positions.begin(), context->positions.end());
+            }
+            std::sort(result.positions.begin(), result.positions.end());
+            return result;
+        }
+
+        std::vector<size_t> AllBut(size_t count, std::vector<size_t> skipped)
+        {
+            std::vector<size_t> result;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (std::find(skipped.begin(), skipped.end(), i) == skipped.end())
+                {
+                    result.push_back(i);
+                }
+            }
+            return result;
+        }
+
+        ShardedScanOptions TestOptions()
+        {
+            ShardedScanOptions options;
+            options.workers = 4;
+            options.hang_timeout = std::chrono::milliseconds{ 50 };
+            return options;
+        }
+    }
+
+    TEST_CLASS(ShardedScanTests)
+    {
+    public:
+        TEST_METHOD(MakeScanShards_SplitsAtKeyChangesAndMaxSize)
+        {
+            // Arrange
+            const std::vector<int> keys{ 1, 1, 1, 1, 1, 2, 3, 3 };
+
+            // Act
+            const auto shards = make_scan_shards(keys, 2);
+
+            // Assert
+            const std::vector<std::pair<size_t, size_t>> expected{ { 0, 2 }, { 2, 4 }, { 4, 5 }, { 5, 6 }, { 6, 8 } };
+            Assert::AreEqual(expected.size(), shards.size());
+            for (size_t i = 0; i < expected.size(); ++i)
+            {
+                Assert::AreEqual(expected[i].first, shards[i].begin);
+                Assert::AreEqual(expected[i].second, shards[i].end);
+            }
+        }
+
+        TEST_METHOD(RunShardedScan_NoHang_ScansEveryPositionOnce)
+        {
+            // Arrange
+            auto table = std::make_shared<FakeHandleTable>();
+            table->add(4, 100);
+            table->add(8, 7);
+            table->add(12, 30);
+
+            // Act
+            const auto result = Scan(table, 16, TestOptions());
+
+            // Assert
+            Assert::AreEqual(size_t{ 0 }, result.abandoned);
+            Assert::IsTrue(AllBut(table->size(), {}) == result.positions);
+        }
+
+        TEST_METHOD(RunShardedScan_HungHandle_IsAbandonedAndOtherResultsAreReturned)
+        {
+            // Arrange
+            auto table = std::make_shared<FakeHandleTable>();
+            table->add(4, 40);
+            table->add(8, 40);
+            table->add(12, 40);
+            table->hang_at(50);
+
+            // Act
+            const auto result = Scan(table, 16, TestOptions());
+            table->release();
+
+            // Assert
+            // Positions 48 to 63 are one shard: the handles before the hung
+            // one were scanned by the abandoned worker, the ones after it by
+            // a new one
+            Assert::AreEqual(size_t{ 1 }, result.abandoned);
+            Assert::IsTrue(AllBut(table->size(), { 50 }) == result.positions);
+            Assert::IsTrue(result.elapsed < std::chrono::seconds{ 5 });
+        }
+
+        TEST_METHOD(RunShardedScan_HangsInSeveralShards_AreEachAbandoned)
+        {
+            // Arrange
+            auto table = std::make_shared<FakeHandleTable>();
+            table->add(4, 20);
+            table->add(8, 20);
+            table->hang_at(0);
+            table->hang_at(1);
+            table->hang_at(25);
+            table->hang_at(39);
+
+            // Act
+            const auto result = Scan(table, 8, TestOptions());
+            table->release();
+
+            // Assert
+            Assert::AreEqual(size_t{ 4 }, result.abandoned);
+            Assert::IsTrue(AllBut(table->size(), { 0, 1, 25, 39 }) == result.positions);
+            Assert::IsTrue(result.elapsed < std::chrono::seconds{ 5 });
+        }
+
+        TEST_METHOD(RunShardedScan_EveryWorkerHangs_StillFinishes)
+        {
+            // Arrange
+            auto table = std::make_shared<FakeHandleTable>();
+            table->add(4, 3);
+            table->add(8, 3);
+            table->hang_at(0);
+            table->hang_at(3);
+
+            auto options = TestOptions();
+            options.workers = 2;
+
+            // Act
+            const auto result = Scan(table, 16, options);
+            table->release();
+
+            // Assert
+            Assert::AreEqual(size_t{ 2 }, result.abandoned);
+            Assert::IsTrue(AllBut(table->size(), { 0, 3 }) == result.positions);
+        }
+    };
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "targetver.h"
+
+// Headers for CppUnitTest
+#pragma warning(disable : 26466)
+#include "CppUnitTest.h"
+
+// Windows headers
+#define NOMINMAX
+#include <windows.h>
+#include <string>
+#include <vector>
@@ -1,17 +1,26 @@
 #pragma once
 
 #include "pch.h"
+#include "NtHandleSource.h"
+#include "ProcessSearch.h"
 
-struct ProcessResult
+#include <mutex>
+
+// Checks handles towards the given files and all subfiles and folders of given
+// dirs, if any. A Locksmith window keeps one session for its paths, so that
+// searching again when it reloads only rescans what changed.
+class FileLocksmithSession
 {
-    std::wstring name;
-    DWORD pid;
-    std::wstring user;
-    std::vector<std::wstring> files;
-};
+public:
+    explicit FileLocksmithSession(std::vector<std::wstring> paths);
 
-// Second version, checks handles towards files and all subfiles and folders of given dirs, if any.
-std::vector<ProcessResult> find_processes_recursive(const std::vector<std::wstring>& paths);
+    std::vector<ProcessResult> find_processes();
+
+private:
+    std::mutex search_mutex;
+    NtHandleSource source;
+    ProcessSearch search;
+};
 
 // Gives the full path of the executable, given the process id
 std::wstring pid_to_full_path(DWORD pid);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Tells the search which processes use which files. The search itself doesn't
+// depend on the platform: every name it compares comes from here.
+//
+// canonical_name and modules are called from several threads at once.
+class HandleSource
+{
+public:
+    struct Process
+    {
+        std::uint32_t pid = 0;
+        std::wstring name;
+    };
+
+    struct OpenFile
+    {
+        std::uint32_t pid = 0;
+
+        // In the form canonical_name gives
+        std::wstring name;
+    };
+
+    virtual ~HandleSource() = default;
+
+    // The separator of the components of canonical names
+    virtual wchar_t path_separator() const = 0;
+
+    // Whether canonical names that differ only in case name different files
+    virtual bool case_sensitive() const = 0;
+
+    // Gives the name open files are reported under for this path, or an empty
+    // string if the path can't be opened.
+    virtual std::wstring canonical_name(const std::wstring& path) = 0;
+
+    virtual bool is_directory(const std::wstring& path) = 0;
+
+    // Returns the files that processes have open.
+    virtual std::vector<OpenFile> open_files() = 0;
+
+    // Returns the ids and names of all processes.
+    virtual std::vector<Process> processes() = 0;
+
+    // Gives the paths of the modules loaded by this process, as they would be
+    // passed to canonical_name.
+    virtual std::vector<std::wstring> modules(std::uint32_t pid) = 0;
+
+    // Gives the user name of the account running this process
+    virtual std::wstring user(std::uint32_t pid) = 0;
+};
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cwctype>
+#endif
+
+// Finds which of the selected files and folders a kernel file name refers to.
+// The kernel names of the selection are kept in a trie of path components, so
+// a name is classified in one walk however many paths are selected.
+// Components are split at backslashes unless another separator is given.
+//
+// Kernel names keep the case the opening process spelled the path in, so
+// unless ignore_case is false, names that differ only in case match.
+class KernelPathMatcher
+{
+public:
+    explicit KernelPathMatcher(wchar_t path_separator = L'\\', bool ignore_case = true) :
+        separator(path_separator), fold_case(ignore_case)
+    {
+        nodes.emplace_back();
+    }
+
+    // Adds a selected path. A file matches its own kernel name only, a folder
+    // also matches everything inside it.
+    void add(std::wstring_view kernel_name, std::wstring path, bool is_directory)
+    {
+        const size_t entry = entries.size();
+        entries.push_back({ kernel_name.length(), std::move(path) });
+
+        auto& exact = nodes[insert(kernel_name)];
+        (is_directory ? exact.directory : exact.file) = entry;
+
+        if (is_directory)
+        {
+            // A trailing separator is part of the prefix but not a component
+            // of its own. Of two folders on one node, the shorter name wins.
+            auto& prefix = nodes[insert(kernel_name.ends_with(separator) ? kernel_name.substr(0, kernel_name.length() - 1) : kernel_name)];
+            if (prefix.folder == none || entries[prefix.folder].kernel_length >= kernel_name.length())
+            {
+                prefix.folder = entry;
+            }
+        }
+    }
+
+    // Returns the normal path of the file with the given kernel name if it's
+    // one of the selected paths or inside a selected folder. Otherwise returns
+    // an empty string. Exact matches win over folders, and outer folders win
+    // over the folders inside them.
+    std::wstring find(std::wstring_view kernel_name) const
+    {
+        const Node* node = &nodes[0];
+        const Entry* folder = nullptr;
+        std::wstring component;
+        size_t start = 0;
+        while (true)
+        {
+            const size_t next = kernel_name.find(separator, start);
+            const size_t end = next == std::wstring_view::npos ? kernel_name.length() : next;
+
+            component.assign(kernel_name.substr(start, end - start));
+            fold(component);
+            const auto child = node->children.find(component);
+            if (child == node->children.end())
+            {
+                break;
+            }
+            node = &nodes[child->second];
+
+            if (end == kernel_name.length())
+            {
+                if (node->file != none)
+                {
+                    return entries[node->file].path;
+                }
+                if (node->directory != none)
+                {
+                    return entries[node->directory].path;
+                }
+                break;
+            }
+
+            if (!folder && node->folder != none)
+            {
+                folder = &entries[node->folder];
+            }
+            start = end + 1;
+        }
+
+        if (folder)
+        {
+            return folder->path + std::wstring(kernel_name.substr(folder->kernel_length));
+        }
+        return {};
+    }
+
+private:
+    static constexpr size_t none = static_cast<size_t>(-1);
+
+    struct Entry
+    {
+        size_t kernel_length;
+        std::wstring path;
+    };
+
+    struct Node
+    {
+        std::map<std::wstring, size_t, std::less<>> children;
+
+        // Entries whose kernel name ends at this node
+        size_t file = none;
+        size_t directory = none;
+
+        // The folder whose contents start after this node
+        size_t folder = none;
+    };
+
+    // Returns the node for the kernel name, adding the missing ones
+    size_t insert(std::wstring_view kernel_name)
+    {
+        size_t node = 0;
+        size_t start = 0;
+        while (true)
+        {
+            const size_t next = kernel_name.find(separator, start);
+            const size_t end = next == std::wstring_view::npos ? kernel_name.length() : next;
+            std::wstring component(kernel_name.substr(start, end - start));
+            fold(component);
+
+            auto child = nodes[node].children.find(component);
+            if (child == nodes[node].children.end())
+            {
+                child = nodes[node].children.emplace(std::move(component), nodes.size()).first;
+                nodes.emplace_back();
+            }
+            node = child->second;
+
+            if (end == kernel_name.length())
+            {
+                return node;
+            }
+            start = end + 1;
+        }
+    }
+
+    // Components are kept in the trie folded to upper case
+    void fold(std::wstring& component) const
+    {
+        if (!fold_case || component.empty())
+        {
+            return;
+        }
+#ifdef _WIN32
+        CharUpperBuffW(component.data(), static_cast<DWORD>(component.length()));
+#else
+        for (auto& c : component)
+        {
+            c = static_cast<wchar_t>(std::towupper(c));
+        }
+#endif
+    }
+
+    wchar_t separator;
+    bool fold_case;
+    std::deque<Node> nodes;
+    std::vector<Entry> entries;
+};
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "NativeMethods.h"
 #include "FileLocksmith.h"
+#include "SearchSession.h"
 #include "../FileLocksmithLib/Constants.h"
 
 namespace winrt::PowerToys::FileLocksmithLib::Interop::implementation
@@ -25,33 +26,8 @@ namespace winrt::PowerToys::FileLocksmithLib::Interop::implementation
 
     com_array<winrt::PowerToys::FileLocksmithLib::Interop::ProcessResult> NativeMethods::FindProcessesRecursive(array_view<hstring const> paths)
     {
-        std::vector<std::wstring> paths_cpp{ paths.begin(), paths.end() };
-
-        auto result_cpp = find_processes_recursive(paths_cpp);
-        const auto result_size = static_cast<int>(result_cpp.size());
-
-        std::vector<ProcessResult> result;
-
-        if (result_size == 0)
-        {
-            return com_array<ProcessResult>();
-        }
-
-        for (int i = 0; i < result_size; i++)
-        {
-            result.push_back(ProcessResult
-            {
-                hstring { result_cpp[i].name },
-                result_cpp[i].pid,
-                hstring{ result_cpp[i].user },
-                    winrt::com_array<hstring>
-                {
-                    result_cpp[i].files.begin(), result_cpp[i].files.end()
-                }
-            });
-        }
-
-        return com_array<ProcessResult>{ result.begin(), result.end() };
+        // A single search. Callers that search the same paths again keep a SearchSession.
+        return make<SearchSession>(paths).FindProcesses();
     }
 
     hstring NativeMethods::PidToFullPath(uint32_t pid)
@@ -0,0 +1,57 @@
+#include "pch.h"
+
+#include "NtHandleSource.h"
+
+wchar_t NtHandleSource::path_separator() const
+{
+    return L'\\';
+}
+
+bool NtHandleSource::case_sensitive() const
+{
+    return false;
+}
+
+std::wstring NtHandleSource::canonical_name(const std::wstring& path)
+{
+    return nt_ext.path_to_kernel_name(path.c_str());
+}
+
+bool NtHandleSource::is_directory(const std::wstring& path)
+{
+    DWORD attributes = GetFileAttributesW(path.c_str());
+    return attributes != INVALID_FILE_ATTRIBUTES && attributes & FILE_ATTRIBUTE_DIRECTORY;
+}
+
+std::vector<HandleSource::OpenFile> NtHandleSource::open_files()
+{
+    std::vector<OpenFile> result;
+    for (auto& handle_info : nt_ext.handles())
+    {
+        if (handle_info.type_name == L"File")
+        {
+            result.push_back({ static_cast<std::uint32_t>(handle_info.pid), std::move(handle_info.kernel_file_name) });
+        }
+    }
+    return result;
+}
+
+std::vector<HandleSource::Process> NtHandleSource::processes()
+{
+    std::vector<Process> result;
+    for (auto& process_info : nt_ext.processes())
+    {
+        result.push_back({ process_info.pid, std::move(process_info.name) });
+    }
+    return result;
+}
+
+std::vector<std::wstring> NtHandleSource::modules(std::uint32_t pid)
+{
+    return nt_ext.pid_to_modules(pid);
+}
+
+std::wstring NtHandleSource::user(std::uint32_t pid)
+{
+    return nt_ext.pid_to_user(pid);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "HandleSource.h"
+#include "NtdllExtensions.h"
+
+// Finds open files through the system handle table, and names them by their
+// kernel names.
+class NtHandleSource : public HandleSource
+{
+public:
+    wchar_t path_separator() const override;
+    bool case_sensitive() const override;
+    std::wstring canonical_name(const std::wstring& path) override;
+    bool is_directory(const std::wstring& path) override;
+    std::vector<OpenFile> open_files() override;
+    std::vector<Process> processes() override;
+    std::vector<std::wstring> modules(std::uint32_t pid) override;
+    std::wstring user(std::uint32_t pid) override;
+
+private:
+    NtdllExtensions nt_ext;
+};
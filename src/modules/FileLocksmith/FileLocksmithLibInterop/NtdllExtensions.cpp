@@ -1,8 +1,10 @@
 #include "pch.h"
 
 #include "NtdllExtensions.h"
+#include "ShardedScan.h"
 #include <thread>
 #include <atomic>
+#include <mutex>
 
 #define STATUS_INFO_LENGTH_MISMATCH ((LONG)0xC0000004)
 
@@ -60,6 +62,7 @@ namespace
             if (!status)
             {
                 // Give up
+                CloseHandle(process);
                 return {};
             }
 
@@ -84,6 +87,50 @@ namespace
         CloseHandle(process);
         return result;
     }
+
+    // Account names looked up so far, by SID. Looking an account up can mean
+    // asking a domain controller, and the same few accounts own most processes.
+    std::mutex sid_names_mutex;
+    std::map<std::vector<BYTE>, std::wstring> sid_names;
+
+    std::wstring sid_to_user(PSID psid)
+    {
+        const auto sid_bytes = static_cast<const BYTE*>(psid);
+        std::vector<BYTE> sid(sid_bytes, sid_bytes + GetLengthSid(psid));
+        {
+            std::unique_lock lock{ sid_names_mutex };
+            if (auto it = sid_names.find(sid); it != sid_names.end())
+            {
+                return it->second;
+            }
+        }
+
+        std::wstring user;
+        std::wstring domain;
+        DWORD user_buf_size = 0;
+        DWORD domain_buf_size = 0;
+        SID_NAME_USE sid_name;
+        LookupAccountSidW(nullptr, psid, nullptr, &user_buf_size, nullptr, &domain_buf_size, &sid_name);
+        if (user_buf_size && domain_buf_size)
+        {
+            user.resize(user_buf_size);
+            domain.resize(domain_buf_size);
+            if (LookupAccountSidW(nullptr, psid, user.data(), &user_buf_size, domain.data(), &domain_buf_size, &sid_name))
+            {
+                user.resize(user_buf_size);
+            }
+            else
+            {
+                user.clear();
+            }
+        }
+
+        // Failures are remembered too, so an unreachable domain controller
+        // only stalls the first lookup
+        std::unique_lock lock{ sid_names_mutex };
+        sid_names.emplace(std::move(sid), user);
+        return user;
+    }
 }
 
 NtdllExtensions::MemoryLoopResult NtdllExtensions::NtQuerySystemInformationMemoryLoop(ULONG SystemInformationClass)
@@ -152,6 +199,84 @@ std::wstring NtdllExtensions::path_to_kernel_name(LPCWSTR path)
     return kernel_name;
 }
 
+// State of one handle scan worker
+struct NtdllExtensions::HandleScanContext
+{
+    std::vector<BYTE> buffer = std::vector<BYTE>(DefaultResultBufferSize);
+
+    // The process the handles being scanned belong to. The handle is null if
+    // the process couldn't be opened.
+    ULONG_PTR pid = static_cast<ULONG_PTR>(-1);
+    HANDLE process = nullptr;
+
+    // The handle being queried, closed by the watchdog if the query hangs
+    std::atomic<HANDLE> handle_copy = nullptr;
+
+    std::vector<HandleInfo> handles;
+
+    ~HandleScanContext()
+    {
+        if (process)
+        {
+            CloseHandle(process);
+        }
+    }
+};
+
+void NtdllExtensions::scan_handle(HandleScanContext& context, const SYSTEM_HANDLE_TABLE_ENTRY_INFO_EX& handle_info)
+{
+    const auto pid = handle_info.UniqueProcessId;
+    if (context.pid != pid)
+    {
+        if (context.process)
+        {
+            CloseHandle(context.process);
+        }
+        context.pid = pid;
+        context.process = OpenProcess(PROCESS_DUP_HANDLE, FALSE, static_cast<DWORD>(pid));
+    }
+    if (!context.process)
+    {
+        return;
+    }
+
+    // According to this:
+    // https://stackoverflow.com/questions/46384048/enumerate-handles
+    // NtQueryObject could hang
+
+    // TODO uncomment and investigate
+    // if (handle_info.GrantedAccess == 0x0012019f) {
+    //     return;
+    // }
+
+    HANDLE handle_copy;
+    auto dh_result = DuplicateHandle(context.process, reinterpret_cast<HANDLE>(handle_info.HandleValue), GetCurrentProcess(), &handle_copy, 0, 0, DUPLICATE_SAME_ACCESS);
+    if (dh_result == 0)
+    {
+        // Ignore this handle.
+        return;
+    }
+    context.handle_copy = handle_copy;
+
+    ULONG return_length;
+    auto status = NtQueryObject(handle_copy, ObjectTypeInformation, context.buffer.data(), static_cast<ULONG>(context.buffer.size()), &return_length);
+    if (NT_SUCCESS(status))
+    {
+        auto object_type_info = reinterpret_cast<OBJECT_TYPE_INFORMATION*>(context.buffer.data());
+        if (unicode_to_view(object_type_info->Name) == L"File")
+        {
+            auto file_name = file_handle_to_kernel_name(handle_copy, context.buffer);
+            context.handles.push_back(HandleInfo{ pid, handle_info.HandleValue, L"File", std::move(file_name) });
+        }
+    }
+
+    // Exchanged so that the handle is closed once, here or by the watchdog
+    if (auto lingering = context.handle_copy.exchange(nullptr))
+    {
+        CloseHandle(lingering);
+    }
+}
+
 std::vector<NtdllExtensions::HandleInfo> NtdllExtensions::handles() noexcept
 {
     auto get_info_result = NtQuerySystemInformationMemoryLoop(SystemExtendedHandleInformation);
@@ -161,185 +286,99 @@ std::vector<NtdllExtensions::HandleInfo> NtdllExtensions::handles() noexcept
     }
 
     auto info_ptr = reinterpret_cast<SYSTEM_HANDLE_INFORMATION_EX*>(get_info_result.memory.data());
+    const auto handle_count = static_cast<size_t>(info_ptr->NumberOfHandles);
 
-    std::map<ULONG_PTR, HANDLE> pid_to_handle;
-    std::vector<HandleInfo> result;
-
-    std::vector<BYTE> object_info_buffer(DefaultResultBufferSize);
-
-    std::atomic<ULONG> i = 0;
-    std::atomic<ULONG_PTR> handle_count = info_ptr->NumberOfHandles;
-    std::atomic<HANDLE> process_handle = NULL;
-    std::atomic<HANDLE> handle_copy = NULL;
-    ULONG previous_i;
-
-
-    while (i < handle_count)
+    // Handles of one process go to one worker, which opens the process once
+    std::vector<size_t> order(handle_count);
+    for (size_t i = 0; i < handle_count; ++i)
     {
-        previous_i = i;
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [info_ptr](size_t a, size_t b) {
+        return info_ptr->Handles[a].UniqueProcessId < info_ptr->Handles[b].UniqueProcessId;
+    });
 
-        // The system calls we use in this block were reported to hang on some machines.
-        // We need to offload the cycle to another thread and keep track of progress to terminate and resume when needed.
-        // Unfortunately, there are no alternative APIs to what we're using that accept timeouts. (NtQueryObject and GetFileType)
-        auto offload_function = std::thread([&] {
-            for (; i < handle_count; i++)
-            {
-                process_handle = NULL;
-                handle_copy = NULL;
-
-                auto handle_info = info_ptr->Handles + i;
-                auto pid = handle_info->UniqueProcessId;
-
-                auto iter = pid_to_handle.find(pid);
-                if (iter != pid_to_handle.end())
-                {
-                    process_handle = iter->second;
-                }
-                else
-                {
-                    process_handle = OpenProcess(PROCESS_DUP_HANDLE, FALSE, static_cast<DWORD>(pid));
-                    if (!process_handle)
-                    {
-                        continue;
-                    }
-                    pid_to_handle[pid] = process_handle;
-                }
-
-                // According to this:
-                // https://stackoverflow.com/questions/46384048/enumerate-handles
-                // NtQueryObject could hang
-
-                // TODO uncomment and investigate
-                // if (handle_info->GrantedAccess == 0x0012019f) {
-                //     continue;
-                // }
-
-                HANDLE local_handle_copy;
-                auto dh_result = DuplicateHandle(process_handle, reinterpret_cast<HANDLE>(handle_info->HandleValue), GetCurrentProcess(), &local_handle_copy, 0, 0, DUPLICATE_SAME_ACCESS);
-                if (dh_result == 0)
-                {
-                    // Ignore this handle.
-                    continue;
-                }
-                handle_copy = local_handle_copy;
-
-                ULONG return_length;
-                auto status = NtQueryObject(handle_copy, ObjectTypeInformation, object_info_buffer.data(), static_cast<ULONG>(object_info_buffer.size()), &return_length);
-                if (NT_ERROR(status))
-                {
-                    // Ignore this handle.
-                    CloseHandle(handle_copy);
-                    handle_copy = NULL;
-                    continue;
-                }
-
-                auto object_type_info = reinterpret_cast<OBJECT_TYPE_INFORMATION*>(object_info_buffer.data());
-                auto type_name = unicode_to_str(object_type_info->Name);
-
-                std::wstring file_name;
-
-                if (type_name == L"File")
-                {
-                    file_name = file_handle_to_kernel_name(handle_copy, object_info_buffer);
-                    result.push_back(HandleInfo{ pid, handle_info->HandleValue, type_name, file_name });
-                }
-
-                CloseHandle(handle_copy);
-                handle_copy = NULL;
-            }
-        });
+    std::vector<ULONG_PTR> pids(handle_count);
+    for (size_t i = 0; i < handle_count; ++i)
+    {
+        pids[i] = info_ptr->Handles[order[i]].UniqueProcessId;
+    }
 
-        offload_function.detach();
-        do
-        {
-            Sleep(200); // Timeout in milliseconds for detecting that the system hang on getting information for a handle.
-            if (i >= handle_count)
+    // The system calls we use for each handle were reported to hang on some machines,
+    // and there are no alternative APIs that accept timeouts (NtQueryObject and GetFileType).
+    // Workers that hang are terminated and the rest of their handles go to a new worker.
+    auto contexts = run_sharded_scan<HandleScanContext>(
+        make_scan_shards(pids, MaxHandlesPerScanShard),
+        [this, info_ptr, &order](HandleScanContext& context, size_t position) {
+            scan_handle(context, info_ptr->Handles[order[position]]);
+        },
+        [](std::thread& thread, HandleScanContext& context) {
+            // HACK: This is unsafe and may leak something, but looks like there's no way to properly clean up a thread when it's hanging on a system call.
+            TerminateThread(thread.native_handle(), 1);
+
+            // Close Handles that might be lingering.
+            if (auto lingering = context.handle_copy.exchange(nullptr))
             {
-                // We're done.
-                break;
+                CloseHandle(lingering);
             }
-
-            if (previous_i >= i)
+            if (context.process)
             {
-                // The thread looks like it's hanging on some handle. Let's kill it and resume.
-
-                // HACK: This is unsafe and may leak something, but looks like there's no way to properly clean up a thread when it's hanging on a system call.
-                TerminateThread(offload_function.native_handle(), 1);
-
-                // Close Handles that might be lingering.
-                if (handle_copy!=NULL)
-                {
-                    CloseHandle(handle_copy);
-                }
-                i++;
-                break;
+                CloseHandle(context.process);
+                context.process = nullptr;
             }
-            previous_i = i;
-        } while (1);
-
-    }
+        });
 
-    for (auto [pid, handle] : pid_to_handle)
+    std::vector<HandleInfo> result;
+    for (auto& context : contexts)
     {
-        CloseHandle(handle);
+        result.insert(result.end(), std::make_move_iterator(context->handles.begin()), std::make_move_iterator(context->handles.end()));
     }
 
     return result;
 }
 
-// Returns the list of all processes.
-// On failure, returns an empty vector.
-
 std::wstring NtdllExtensions::pid_to_user(DWORD pid)
 {
     HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
-    std::wstring user;
-    std::wstring domain;
-
     if (process == nullptr)
     {
-        return user;
+        return {};
     }
 
+    std::vector<BYTE> token_buffer;
     HANDLE token = nullptr;
-
-    if (!OpenProcessToken(process, TOKEN_QUERY, &token))
+    if (OpenProcessToken(process, TOKEN_QUERY, &token))
     {
-        return user;
+        DWORD token_size = 0;
+        const bool ok = GetTokenInformation(token, TokenUser, nullptr, 0, &token_size);
+        if ((ok || GetLastError() == ERROR_INSUFFICIENT_BUFFER) && token_size)
+        {
+            token_buffer.resize(token_size);
+            if (!GetTokenInformation(token, TokenUser, token_buffer.data(), token_size, &token_size))
+            {
+                token_buffer.clear();
+            }
+        }
+        CloseHandle(token);
     }
+    CloseHandle(process);
 
-    DWORD token_size = 0;
-    const bool ok = GetTokenInformation(token, TokenUser, nullptr, 0, &token_size);
-    if ((!ok && GetLastError() != ERROR_INSUFFICIENT_BUFFER) || !token_size)
+    if (token_buffer.empty())
     {
-        return user;
+        return {};
     }
 
-    std::vector<BYTE> token_buffer(token_size);
-    GetTokenInformation(token, TokenUser, token_buffer.data(), token_size, &token_size);
     TOKEN_USER* user_ptr = reinterpret_cast<TOKEN_USER*>(token_buffer.data());
-    PSID psid = user_ptr->User.Sid;
-    DWORD user_buf_size = 0;
-    DWORD domain_buf_size = 0;
-    SID_NAME_USE sid_name;
-    LookupAccountSidW(nullptr, psid, nullptr, &user_buf_size, nullptr, &domain_buf_size, &sid_name);
-    if (!user_buf_size || !domain_buf_size)
-    {
-        return user;
-    }
-
-    user.resize(user_buf_size);
-    domain.resize(domain_buf_size);
-    LookupAccountSidW(nullptr, psid, user.data(), &user_buf_size, domain.data(), &domain_buf_size, &sid_name);
-    user.resize(user.size() - 1);
-    domain.resize(domain.size() - 1);
-    CloseHandle(token);
-    CloseHandle(process);
-
-    return user;
+    return sid_to_user(user_ptr->User.Sid);
 }
 
+std::vector<std::wstring> NtdllExtensions::pid_to_modules(DWORD pid)
+{
+    return process_modules(pid);
+}
 
+// Returns the list of all processes.
+// On failure, returns an empty vector.
 std::vector<NtdllExtensions::ProcessInfo> NtdllExtensions::processes() noexcept
 {
     auto get_info_result = NtQuerySystemInformationMemoryLoop(SystemProcessInformation);
@@ -359,10 +398,8 @@ std::vector<NtdllExtensions::ProcessInfo> NtdllExtensions::processes() noexcept
         ProcessInfo item;
         item.name = unicode_to_str(info_ptr->ImageName);
         item.pid = static_cast<DWORD>(reinterpret_cast<uintptr_t>(info_ptr->UniqueProcessId));
-        item.modules = process_modules(item.pid);
-        item.user = pid_to_user(item.pid);
 
-        result.push_back(item);
+        result.push_back(std::move(item));
     }
 
     return result;
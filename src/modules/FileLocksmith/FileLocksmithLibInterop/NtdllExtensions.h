@@ -24,13 +24,19 @@ private:
 
     std::wstring file_handle_to_kernel_name(HANDLE file_handle, std::vector<BYTE>& buffer);
 
+    // Handles scanned in a row by one worker
+    constexpr static size_t MaxHandlesPerScanShard = 4096;
+
+    struct HandleScanContext;
+
+    // Adds the handle to context.handles if it's a file
+    void scan_handle(HandleScanContext& context, const SYSTEM_HANDLE_TABLE_ENTRY_INFO_EX& handle_info);
+
 public:
     struct ProcessInfo
     {
         DWORD pid = 0;
         std::wstring name;
-        std::wstring user;
-        std::vector<std::wstring> modules;
     };
 
     struct HandleInfo
@@ -45,12 +51,16 @@ public:
 
     std::wstring path_to_kernel_name(LPCWSTR path);
 
-    // Gives the user name of the account running this process
+    // Gives the user name of the account running this process.
+    // Account names are cached for the lifetime of the process.
     std::wstring pid_to_user(DWORD pid);
 
+    // Gives the paths of the modules loaded by this process
+    std::vector<std::wstring> pid_to_modules(DWORD pid);
+
     std::vector<HandleInfo> handles() noexcept;
 
-    // Returns the list of all processes.
+    // Returns the ids and names of all processes.
     // On failure, returns an empty vector.
     std::vector<ProcessInfo> processes() noexcept;
 };
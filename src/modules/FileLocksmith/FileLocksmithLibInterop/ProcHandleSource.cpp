@@ -0,0 +1,316 @@
+#include "ProcHandleSource.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include <dirent.h>
+#include <pwd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    // File names are bytes. Bytes that aren't valid UTF-8 become the code
+    // points U+DC80 to U+DCFF, so every name converts back unchanged.
+    constexpr wchar_t EscapedByte = 0xDC00;
+
+    std::wstring from_native(std::string_view bytes)
+    {
+        std::wstring result;
+        result.reserve(bytes.size());
+
+        size_t i = 0;
+        while (i < bytes.size())
+        {
+            const auto lead = static_cast<unsigned char>(bytes[i]);
+            size_t length = 0;
+            char32_t code_point = 0;
+            char32_t minimum = 0;
+            if (lead < 0x80)
+            {
+                length = 1;
+                code_point = lead;
+            }
+            else if (lead >= 0xC2 && lead < 0xE0)
+            {
+                length = 2;
+                code_point = lead & 0x1F;
+                minimum = 0x80;
+            }
+            else if (lead >= 0xE0 && lead < 0xF0)
+            {
+                length = 3;
+                code_point = lead & 0x0F;
+                minimum = 0x800;
+            }
+            else if (lead >= 0xF0 && lead < 0xF5)
+            {
+                length = 4;
+                code_point = lead & 0x07;
+                minimum = 0x10000;
+            }
+
+            bool valid = length != 0 && i + length <= bytes.size();
+            for (size_t j = 1; valid && j < length; ++j)
+            {
+                const auto next = static_cast<unsigned char>(bytes[i + j]);
+                valid = (next & 0xC0) == 0x80;
+                code_point = (code_point << 6) | (next & 0x3F);
+            }
+            valid = valid && code_point >= minimum && code_point <= 0x10FFFF && (code_point < 0xD800 || code_point > 0xDFFF);
+
+            if (valid)
+            {
+                result += static_cast<wchar_t>(code_point);
+                i += length;
+            }
+            else
+            {
+                result += static_cast<wchar_t>(EscapedByte + lead);
+                ++i;
+            }
+        }
+        return result;
+    }
+
+    std::string to_native(std::wstring_view text)
+    {
+        std::string result;
+        result.reserve(text.size());
+        for (const auto character : text)
+        {
+            const auto code_point = static_cast<char32_t>(character);
+            if (code_point >= EscapedByte + 0x80 && code_point <= EscapedByte + 0xFF)
+            {
+                result += static_cast<char>(code_point - EscapedByte);
+            }
+            else if (code_point < 0x80)
+            {
+                result += static_cast<char>(code_point);
+            }
+            else if (code_point < 0x800)
+            {
+                result += static_cast<char>(0xC0 | (code_point >> 6));
+                result += static_cast<char>(0x80 | (code_point & 0x3F));
+            }
+            else if (code_point < 0x10000)
+            {
+                result += static_cast<char>(0xE0 | (code_point >> 12));
+                result += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+                result += static_cast<char>(0x80 | (code_point & 0x3F));
+            }
+            else
+            {
+                result += static_cast<char>(0xF0 | (code_point >> 18));
+                result += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+                result += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+                result += static_cast<char>(0x80 | (code_point & 0x3F));
+            }
+        }
+        return result;
+    }
+
+    struct DirectoryCloser
+    {
+        void operator()(DIR* stream) const
+        {
+            closedir(stream);
+        }
+    };
+
+    // Calls function(name) for every entry of the directory but . and ..
+    template<typename Function>
+    void for_each_entry(const std::string& directory, Function function)
+    {
+        std::unique_ptr<DIR, DirectoryCloser> stream{ opendir(directory.c_str()) };
+        if (!stream)
+        {
+            return;
+        }
+
+        while (const auto entry = readdir(stream.get()))
+        {
+            const std::string_view name = entry->d_name;
+            if (name != "." && name != "..")
+            {
+                function(name);
+            }
+        }
+    }
+
+    // Returns the ids of all processes
+    std::vector<std::uint32_t> pids()
+    {
+        std::vector<std::uint32_t> result;
+        for_each_entry("/proc", [&](std::string_view name) {
+            if (std::all_of(name.begin(), name.end(), [](char c) { return c >= '0' && c <= '9'; }))
+            {
+                result.push_back(static_cast<std::uint32_t>(std::strtoul(std::string(name).c_str(), nullptr, 10)));
+            }
+        });
+        return result;
+    }
+
+    // Gives the target of a symbolic link, or an empty string on failure
+    std::string read_link(const std::string& path)
+    {
+        std::string target(256, '\0');
+        while (true)
+        {
+            const auto length = readlink(path.c_str(), target.data(), target.size());
+            if (length < 0)
+            {
+                return {};
+            }
+            if (static_cast<size_t>(length) < target.size())
+            {
+                target.resize(static_cast<size_t>(length));
+                return target;
+            }
+            target.resize(target.size() * 2);
+        }
+    }
+
+    std::string process_directory(std::uint32_t pid)
+    {
+        return "/proc/" + std::to_string(pid);
+    }
+
+    // Account names are cached for the lifetime of the process, failures included
+    std::mutex user_names_mutex;
+    std::map<uid_t, std::wstring> user_names;
+
+    std::wstring uid_to_user(uid_t uid)
+    {
+        std::scoped_lock lock{ user_names_mutex };
+        if (auto cached = user_names.find(uid); cached != user_names.end())
+        {
+            return cached->second;
+        }
+
+        std::wstring name;
+        passwd entry{};
+        passwd* found = nullptr;
+        std::vector<char> buffer(16 * 1024);
+        if (getpwuid_r(uid, &entry, buffer.data(), buffer.size(), &found) == 0 && found)
+        {
+            name = from_native(found->pw_name);
+        }
+
+        return user_names.emplace(uid, std::move(name)).first->second;
+    }
+}
+
+wchar_t ProcHandleSource::path_separator() const
+{
+    return L'/';
+}
+
+bool ProcHandleSource::case_sensitive() const
+{
+    return true;
+}
+
+std::wstring ProcHandleSource::canonical_name(const std::wstring& path)
+{
+    std::unique_ptr<char, decltype(&std::free)> resolved{ realpath(to_native(path).c_str(), nullptr), &std::free };
+    return resolved ? from_native(resolved.get()) : std::wstring{};
+}
+
+bool ProcHandleSource::is_directory(const std::wstring& path)
+{
+    struct stat status{};
+    return stat(to_native(path).c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+}
+
+std::vector<HandleSource::OpenFile> ProcHandleSource::open_files()
+{
+    std::vector<OpenFile> result;
+    for (const auto pid : pids())
+    {
+        const auto fd_directory = process_directory(pid) + "/fd/";
+        for_each_entry(fd_directory, [&](std::string_view fd) {
+            // Sockets, pipes and the like aren't files and don't start with a slash
+            auto target = read_link(fd_directory + std::string(fd));
+            if (target.starts_with('/'))
+            {
+                result.push_back({ pid, from_native(target) });
+            }
+        });
+    }
+    return result;
+}
+
+std::vector<HandleSource::Process> ProcHandleSource::processes()
+{
+    std::vector<Process> result;
+    for (const auto pid : pids())
+    {
+        const auto directory = process_directory(pid);
+
+        // Names in comm are cut at 15 characters, so the executable is preferred
+        std::string name;
+        if (auto executable = read_link(directory + "/exe"); !executable.empty())
+        {
+            name = executable.substr(executable.rfind('/') + 1);
+        }
+        else if (std::ifstream comm{ directory + "/comm" }; !std::getline(comm, name))
+        {
+            // The process has exited
+            continue;
+        }
+
+        result.push_back({ pid, from_native(name) });
+    }
+    return result;
+}
+
+std::vector<std::wstring> ProcHandleSource::modules(std::uint32_t pid)
+{
+    // Each line is "address perms offset dev inode path", and mapped files
+    // usually take several lines
+    std::vector<std::string> paths;
+    std::ifstream maps{ process_directory(pid) + "/maps" };
+    std::string line;
+    while (std::getline(maps, line))
+    {
+        size_t position = 0;
+        for (int field = 0; field < 5 && position != std::string::npos; ++field)
+        {
+            position = line.find(' ', line.find_first_not_of(' ', position));
+        }
+
+        position = line.find_first_not_of(' ', position);
+        if (position != std::string::npos && line[position] == '/')
+        {
+            paths.push_back(line.substr(position));
+        }
+    }
+
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    std::vector<std::wstring> result;
+    result.reserve(paths.size());
+    for (const auto& path : paths)
+    {
+        result.push_back(from_native(path));
+    }
+    return result;
+}
+
+std::wstring ProcHandleSource::user(std::uint32_t pid)
+{
+    struct stat status{};
+    if (stat(process_directory(pid).c_str(), &status) != 0)
+    {
+        return {};
+    }
+    return uid_to_user(status.st_uid);
+}
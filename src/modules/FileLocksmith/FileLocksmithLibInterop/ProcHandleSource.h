@@ -0,0 +1,22 @@
+#pragma once
+
+#include "HandleSource.h"
+
+// Finds open files through /proc/<pid>/fd and loaded modules through
+// /proc/<pid>/maps, so that the search can run, be benchmarked and be fuzzed
+// on Linux. Only processes the caller may inspect are seen.
+//
+// Linux only, so it isn't part of the Windows build. It's built with
+// tools/FileLocksmith_ProcessSearchBenchmark, which runs the search on it.
+class ProcHandleSource : public HandleSource
+{
+public:
+    wchar_t path_separator() const override;
+    bool case_sensitive() const override;
+    std::wstring canonical_name(const std::wstring& path) override;
+    bool is_directory(const std::wstring& path) override;
+    std::vector<OpenFile> open_files() override;
+    std::vector<Process> processes() override;
+    std::vector<std::wstring> modules(std::uint32_t pid) override;
+    std::wstring user(std::uint32_t pid) override;
+};
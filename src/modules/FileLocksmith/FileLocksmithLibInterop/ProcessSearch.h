@@ -0,0 +1,276 @@
+#pragma once
+
+#include "HandleSource.h"
+#include "KernelPathMatcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <compare>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct ProcessResult
+{
+    std::wstring name;
+    std::uint32_t pid;
+    std::wstring user;
+    std::vector<std::wstring> files;
+};
+
+namespace process_search_details
+{
+    // Calls function(i) for every i below count on a few threads
+    template<typename Function>
+    void parallel_for(size_t count, Function function)
+    {
+        const size_t thread_count = std::min<size_t>(std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 8), count);
+        std::atomic<size_t> next = 0;
+        auto work = [&] {
+            for (size_t i = next++; i < count; i = next++)
+            {
+                function(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < thread_count; ++i)
+        {
+            threads.emplace_back(work);
+        }
+        work();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+}
+
+// Finds the processes that use the selected files, or anything inside the
+// selected folders, either through an open handle or as a loaded module.
+//
+// The search keeps a snapshot of the selected files that were in use during its
+// last scan. Scanning again only counts what changed since then, and module
+// paths that were already translated to canonical names aren't translated again.
+class ProcessSearch
+{
+public:
+    ProcessSearch(HandleSource& handle_source, std::vector<std::wstring> paths) :
+        source(handle_source), selected_paths(std::move(paths)), matcher(handle_source.path_separator(), !handle_source.case_sensitive())
+    {
+        for (const auto& path : selected_paths)
+        {
+            auto name = source.canonical_name(path);
+            if (!name.empty())
+            {
+                matcher.add(name, path, source.is_directory(path));
+            }
+        }
+    }
+
+    const std::vector<std::wstring>& paths() const noexcept
+    {
+        return selected_paths;
+    }
+
+    // Returns the processes that use any of the selected paths right now
+    std::vector<ProcessResult> scan()
+    {
+        auto processes = source.processes();
+        update(open_files(processes));
+
+        std::vector<ProcessResult> result;
+        std::map<std::pair<std::uint32_t, std::wstring>, std::wstring> found_users;
+
+        for (auto& process : processes)
+        {
+            const auto files = pid_files.find(process.pid);
+            if (files == pid_files.end())
+            {
+                continue;
+            }
+
+            // Only processes that use one of the files get their user looked up
+            auto key = std::pair{ process.pid, process.name };
+            const auto cached = users.find(key);
+            auto user = cached != users.end() ? cached->second : source.user(process.pid);
+            found_users.emplace(std::move(key), user);
+
+            std::vector<std::wstring> paths;
+            paths.reserve(files->second.size());
+            for (const auto& [path, count] : files->second)
+            {
+                paths.push_back(path);
+            }
+
+            result.push_back(ProcessResult
+                {
+                    std::move(process.name),
+                    process.pid,
+                    std::move(user),
+                    std::move(paths)
+                });
+        }
+
+        users = std::move(found_users);
+        return result;
+    }
+
+private:
+    // A process id, the canonical name of a file it uses and the selected
+    // path that name matches
+    struct UsedFile
+    {
+        std::uint32_t pid;
+        std::wstring name;
+        std::wstring path;
+
+        auto operator<=>(const UsedFile&) const = default;
+    };
+
+    // Returns the selected files open in or loaded by processes, sorted and
+    // without duplicates. Names are matched before they're kept, so the
+    // snapshot only holds the few that are selected.
+    std::vector<UsedFile> open_files(const std::vector<HandleSource::Process>& processes)
+    {
+        std::vector<UsedFile> files;
+        for (auto& file : source.open_files())
+        {
+            if (auto path = matcher.find(file.name); !path.empty())
+            {
+                files.push_back({ file.pid, std::move(file.name), std::move(path) });
+            }
+        }
+
+        std::vector<std::vector<std::wstring>> modules(processes.size());
+        process_search_details::parallel_for(processes.size(), [&](size_t i) {
+            modules[i] = source.modules(processes[i].pid);
+        });
+
+        // Most modules are loaded by many processes, and by the same ones in
+        // the next scan, so each path is only translated the first time it's seen
+        std::unordered_map<std::wstring, std::wstring> names;
+        std::vector<std::pair<const std::wstring, std::wstring>*> missing;
+        for (const auto& paths : modules)
+        {
+            for (const auto& path : paths)
+            {
+                if (auto [name, inserted] = names.try_emplace(path); inserted)
+                {
+                    if (auto cached = module_names.find(path); cached != module_names.end())
+                    {
+                        name->second = std::move(cached->second);
+                    }
+                    else
+                    {
+                        missing.push_back(&*name);
+                    }
+                }
+            }
+        }
+
+        process_search_details::parallel_for(missing.size(), [&](size_t i) {
+            missing[i]->second = source.canonical_name(missing[i]->first);
+        });
+
+        // Each module is matched once, however many processes load it
+        std::unordered_map<std::wstring_view, std::pair<std::wstring_view, std::wstring>> matches;
+        for (const auto& [path, name] : names)
+        {
+            if (name.empty())
+            {
+                continue;
+            }
+            if (auto match = matcher.find(name); !match.empty())
+            {
+                matches.emplace(path, std::pair{ std::wstring_view{ name }, std::move(match) });
+            }
+        }
+
+        for (size_t i = 0; i < processes.size(); ++i)
+        {
+            for (const auto& path : modules[i])
+            {
+                if (const auto match = matches.find(path); match != matches.end())
+                {
+                    files.push_back({ processes[i].pid, std::wstring{ match->second.first }, match->second.second });
+                }
+            }
+        }
+
+        // Failed translations are tried again next time
+        std::erase_if(names, [](const auto& name) { return name.second.empty(); });
+        module_names = std::move(names);
+
+        std::sort(files.begin(), files.end());
+        files.erase(std::unique(files.begin(), files.end()), files.end());
+        return files;
+    }
+
+    // Applies the difference between the last snapshot and this one to pid_files
+    void update(std::vector<UsedFile> files)
+    {
+        auto old_file = snapshot.cbegin();
+        auto new_file = files.cbegin();
+        while (old_file != snapshot.cend() || new_file != files.cend())
+        {
+            if (old_file == snapshot.cend() || (new_file != files.cend() && *new_file < *old_file))
+            {
+                count(*new_file++, true);
+            }
+            else if (new_file == files.cend() || *old_file < *new_file)
+            {
+                count(*old_file++, false);
+            }
+            else
+            {
+                ++old_file;
+                ++new_file;
+            }
+        }
+
+        snapshot = std::move(files);
+    }
+
+    void count(const UsedFile& file, bool added)
+    {
+        if (added)
+        {
+            ++pid_files[file.pid][file.path];
+            return;
+        }
+
+        auto files = pid_files.find(file.pid);
+        auto found = files->second.find(file.path);
+        if (--found->second == 0)
+        {
+            files->second.erase(found);
+            if (files->second.empty())
+            {
+                pid_files.erase(files);
+            }
+        }
+    }
+
+    HandleSource& source;
+    std::vector<std::wstring> selected_paths;
+    KernelPathMatcher matcher;
+
+    // The selected files used during the last scan
+    std::vector<UsedFile> snapshot;
+
+    // For every process, the selected paths it uses, with the number of files
+    // in the snapshot that match each of them
+    std::map<std::uint32_t, std::map<std::wstring, size_t>> pid_files;
+
+    // Canonical names of module paths
+    std::unordered_map<std::wstring, std::wstring> module_names;
+
+    // User names of the processes found in the last scan
+    std::map<std::pair<std::uint32_t, std::wstring>, std::wstring> users;
+};
@@ -0,0 +1,35 @@
+#include "pch.h"
+#include "SearchSession.h"
+
+namespace winrt::PowerToys::FileLocksmithLib::Interop::implementation
+{
+    SearchSession::SearchSession(array_view<hstring const> paths)
+    {
+        _session = std::make_unique<FileLocksmithSession>(std::vector<std::wstring>{ paths.begin(), paths.end() });
+    }
+
+    com_array<winrt::PowerToys::FileLocksmithLib::Interop::ProcessResult> SearchSession::FindProcesses()
+    {
+        if (!_session)
+        {
+            return com_array<ProcessResult>();
+        }
+
+        auto result_cpp = _session->find_processes();
+
+        std::vector<ProcessResult> result;
+        result.reserve(result_cpp.size());
+        for (auto& process : result_cpp)
+        {
+            result.push_back(ProcessResult
+            {
+                hstring{ process.name },
+                process.pid,
+                hstring{ process.user },
+                winrt::com_array<hstring>{ process.files.begin(), process.files.end() }
+            });
+        }
+
+        return com_array<ProcessResult>{ result.begin(), result.end() };
+    }
+}
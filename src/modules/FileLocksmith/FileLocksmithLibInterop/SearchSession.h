@@ -0,0 +1,25 @@
+#pragma once
+#include "SearchSession.g.h"
+#include "FileLocksmith.h"
+
+#include <memory>
+
+namespace winrt::PowerToys::FileLocksmithLib::Interop::implementation
+{
+    struct SearchSession : SearchSessionT<SearchSession>
+    {
+        SearchSession() = default;
+
+        SearchSession(array_view<hstring const> paths);
+        com_array<winrt::PowerToys::FileLocksmithLib::Interop::ProcessResult> FindProcesses();
+
+    private:
+        std::unique_ptr<FileLocksmithSession> _session;
+    };
+}
+namespace winrt::PowerToys::FileLocksmithLib::Interop::factory_implementation
+{
+    struct SearchSession : SearchSessionT<SearchSession, implementation::SearchSession>
+    {
+    };
+}
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A range of positions that one worker scans in order.
+struct ScanShard
+{
+    size_t begin;
+    size_t end;
+};
+
+struct ShardedScanOptions
+{
+    size_t workers = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 8);
+
+    // A worker that spends this long on one item, measured between two
+    // checks, is considered hung.
+    std::chrono::milliseconds hang_timeout{ 200 };
+};
+
+// Splits positions 0..keys.size() into shards of consecutive positions with
+// equal keys, none larger than max_shard_size.
+template<typename Key>
+std::vector<ScanShard> make_scan_shards(const std::vector<Key>& keys, size_t max_shard_size)
+{
+    std::vector<ScanShard> shards;
+    size_t begin = 0;
+    for (size_t i = 1; i <= keys.size(); ++i)
+    {
+        if (i == keys.size() || !(keys[i] == keys[begin]) || i - begin == max_shard_size)
+        {
+            shards.push_back({ begin, i });
+            begin = i;
+        }
+    }
+    return shards;
+}
+
+namespace sharded_scan_details
+{
+    // Values of Worker::next that aren't positions
+    constexpr size_t idle = std::numeric_limits<size_t>::max() - 1;
+    constexpr size_t abandoned = std::numeric_limits<size_t>::max();
+
+    template<typename Context>
+    struct Worker
+    {
+        std::shared_ptr<Context> context = std::make_shared<Context>();
+
+        // The next position of the shard to scan. Workers claim positions
+        // one at a time, so the watchdog can take the rest of the shard over
+        // with a single exchange.
+        std::atomic<size_t> next = idle;
+
+        // The end of the current shard. Guarded by the shared mutex.
+        size_t end = 0;
+
+        // Progress, read by the watchdog
+        std::atomic<bool> scanning = false;
+        std::atomic<size_t> scanned = 0;
+
+        // Watchdog only
+        std::thread thread;
+        bool was_scanning = false;
+        size_t last_scanned = 0;
+    };
+
+    template<typename Context, typename Scan>
+    struct Shared
+    {
+        explicit Shared(Scan scan) :
+            scan(std::move(scan))
+        {
+        }
+
+        Scan scan;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::deque<ScanShard> queue;
+        size_t running = 0;
+    };
+
+    // The state is shared with the worker so that one which was given up on
+    // but returns later doesn't touch freed memory.
+    template<typename Context, typename Scan>
+    void work(std::shared_ptr<Shared<Context, Scan>> shared, std::shared_ptr<Worker<Context>> worker)
+    {
+        while (true)
+        {
+            {
+                std::unique_lock lock{ shared->mutex };
+                if (worker->next == abandoned)
+                {
+                    return;
+                }
+                if (shared->queue.empty())
+                {
+                    worker->next = idle;
+                    --shared->running;
+                    shared->finished.notify_all();
+                    return;
+                }
+
+                const auto shard = shared->queue.front();
+                shared->queue.pop_front();
+                worker->end = shard.end;
+                worker->next = shard.begin;
+            }
+
+            while (true)
+            {
+                size_t position = worker->next;
+                if (position >= worker->end || !worker->next.compare_exchange_strong(position, position + 1))
+                {
+                    // Shard done, or the watchdog took it over
+                    break;
+                }
+
+                worker->scanning = true;
+                shared->scan(*worker->context, position);
+                worker->scanning = false;
+                ++worker->scanned;
+            }
+        }
+    }
+}
+
+// Calls scan(context, position) for every position of the shards, on a pool
+// of worker threads that each have their own Context.
+//
+// Some system calls can hang without a timeout. A worker that makes no
+// progress for options.hang_timeout is given up on:
+// - abandon(thread, context) is called for it, which should stop the thread;
+// - the item it hung on is skipped;
+// - the rest of its shard is queued again for a new worker.
+// The other workers carry on undisturbed.
+//
+// Returns the contexts of all workers, including the abandoned ones, so that
+// none of the results is lost.
+template<typename Context, typename Scan, typename Abandon>
+std::vector<std::shared_ptr<Context>> run_sharded_scan(std::vector<ScanShard> shards, Scan scan, Abandon abandon, const ShardedScanOptions& options = {})
+{
+    using namespace sharded_scan_details;
+    using WorkerPtr = std::shared_ptr<Worker<Context>>;
+
+    auto shared = std::make_shared<Shared<Context, Scan>>(std::move(scan));
+    shared->queue.assign(shards.begin(), shards.end());
+
+    std::vector<std::shared_ptr<Context>> contexts;
+    std::vector<WorkerPtr> workers;
+
+    std::unique_lock lock{ shared->mutex };
+    auto start_worker = [&] {
+        auto worker = std::make_shared<Worker<Context>>();
+        contexts.push_back(worker->context);
+        ++shared->running;
+        worker->thread = std::thread(work<Context, Scan>, shared, worker);
+        workers.push_back(std::move(worker));
+    };
+
+    const size_t worker_count = std::min(std::max<size_t>(options.workers, 1), shards.size());
+    for (size_t i = 0; i < worker_count; ++i)
+    {
+        start_worker();
+    }
+
+    while (!shared->finished.wait_for(lock, options.hang_timeout, [&] { return shared->running == 0; }))
+    {
+        const size_t count = workers.size();
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto& worker = *workers[i];
+            if (!worker.thread.joinable())
+            {
+                continue;
+            }
+
+            const bool scanning = worker.scanning;
+            const size_t scanned = worker.scanned;
+            if (scanning && worker.was_scanning && scanned == worker.last_scanned)
+            {
+                // Workers only change shards with the mutex held, so next
+                // and end belong to the same shard here
+                const size_t next = worker.next.exchange(abandoned);
+                if (next < worker.end)
+                {
+                    shared->queue.push_front({ next, worker.end });
+                }
+
+                abandon(worker.thread, *worker.context);
+                worker.thread.detach();
+                --shared->running;
+                if (!shared->queue.empty())
+                {
+                    start_worker();
+                }
+                continue;
+            }
+
+            worker.was_scanning = scanning;
+            worker.last_scanned = scanned;
+        }
+    }
+    lock.unlock();
+
+    for (auto& worker : workers)
+    {
+        if (worker->thread.joinable())
+        {
+            worker->thread.join();
+        }
+    }
+
+    return contexts;
+}
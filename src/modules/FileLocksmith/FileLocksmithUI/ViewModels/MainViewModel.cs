@@ -29,6 +29,9 @@ namespace PowerToys.FileLocksmithUI.ViewModels
         private bool _disposed;
         private CancellationTokenSource _cancelProcessWatching;
 
+        // Kept for the selected paths, so that reloading only rescans what changed
+        private SearchSession _search;
+
         public ObservableCollection<ProcessResult> Processes { get; } = new();
 
         public bool IsLoading
@@ -65,6 +68,7 @@ namespace PowerToys.FileLocksmithUI.ViewModels
             set
             {
                 paths = value;
+                _search = null;
                 OnPropertyChanged(nameof(Paths));
             }
         }
@@ -112,9 +116,10 @@ namespace PowerToys.FileLocksmithUI.ViewModels
         private async Task<List<ProcessResult>> FindProcesses(string[] paths)
         {
             var results = new List<ProcessResult>();
+            var search = _search ??= new SearchSession(paths);
             await Task.Run(() =>
             {
-                results = NativeMethods.FindProcessesRecursive(paths)?.ToList();
+                results = search.FindProcesses()?.ToList();
             });
             return results;
         }
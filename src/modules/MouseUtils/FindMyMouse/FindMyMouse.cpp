@@ -78,7 +78,7 @@ protected:
     int m_sonarZoomFactor = FIND_MY_MOUSE_DEFAULT_SPOTLIGHT_INITIAL_ZOOM;
     DWORD m_fadeDuration = FIND_MY_MOUSE_DEFAULT_ANIMATION_DURATION_MS;
     int m_finalAlphaNumerator = 100; // legacy (root now always animates to 1.0; kept for GDI fallback compatibility)
-    std::vector<std::wstring> m_excludedApps;
+    excluded_apps_matcher m_excludedApps;
     int m_shakeMinimumDistance = FIND_MY_MOUSE_DEFAULT_SHAKE_MINIMUM_DISTANCE;
     static constexpr int FinalAlphaDenominator = 100;
     winrt::Microsoft::UI::Dispatching::DispatcherQueueController m_dispatcherQueueController{ nullptr };
@@ -622,7 +622,7 @@ void SuperSonar<D>::UpdateMouseSnooping()
 template<typename D>
 bool SuperSonar<D>::IsForegroundAppExcluded()
 {
-    if (m_excludedApps.size() < 1)
+    if (m_excludedApps.empty())
     {
         return false;
     }
@@ -631,7 +631,7 @@ bool SuperSonar<D>::IsForegroundAppExcluded()
         auto processPath = get_process_path(foregroundApp);
         CharUpperBuffW(processPath.data(), static_cast<DWORD>(processPath.length()));
 
-        return check_excluded_app(foregroundApp, processPath, m_excludedApps);
+        return m_excludedApps.is_excluded(foregroundApp, processPath);
     }
     else
     {
@@ -917,7 +917,7 @@ public:
             m_doNotActivateOnGameMode = settings.doNotActivateOnGameMode;
             m_fadeDuration = settings.animationDurationMs > 0 ? settings.animationDurationMs : 1;
             m_sonarZoomFactor = settings.spotlightInitialZoom;
-            m_excludedApps = settings.excludedApps;
+            m_excludedApps.set_apps(settings.excludedApps);
             m_shakeMinimumDistance = settings.shakeMinimumDistance;
             m_shakeIntervalMs = settings.shakeIntervalMs;
             m_shakeFactor = settings.shakeFactor;
@@ -943,7 +943,7 @@ public:
                     m_doNotActivateOnGameMode = localSettings.doNotActivateOnGameMode;
                     m_fadeDuration = localSettings.animationDurationMs > 0 ? localSettings.animationDurationMs : 1;
                     m_sonarZoomFactor = localSettings.spotlightInitialZoom;
-                    m_excludedApps = localSettings.excludedApps;
+                    m_excludedApps.set_apps(localSettings.excludedApps);
                     m_shakeMinimumDistance = localSettings.shakeMinimumDistance;
                     m_shakeIntervalMs = localSettings.shakeIntervalMs;
                     m_shakeFactor = localSettings.shakeFactor;
@@ -2,6 +2,7 @@
 
 #include "pch.h"
 #include <template_folder.h>
+#include <template_index.h>
 
 using namespace Microsoft::WRL;
 
@@ -36,10 +37,10 @@ public:
 protected:
     void add_open_templates_to_context_menu(HMENU sub_menu_of_templates, int sub_menu_index, const std::filesystem::path& template_folder_root, int menu_id, int index);
     void add_separator_to_context_menu(HMENU sub_menu_of_templates, int sub_menu_index);
-    void add_template_item_to_context_menu(HMENU sub_menu_of_templates, int sub_menu_index, newplus::template_item* const template_item, int menu_id, int index);
+    void add_template_item_to_context_menu(HMENU sub_menu_of_templates, int sub_menu_index, const newplus::template_item* const template_item, int menu_id, int index);
 
     HINSTANCE instance_handle = 0;
     ComPtr<IUnknown> site_of_folder;
-    newplus::template_folder* templates = nullptr;
+    std::shared_ptr<const newplus::template_folder> templates;
     std::vector<HBITMAP> bitmap_handles;
 };
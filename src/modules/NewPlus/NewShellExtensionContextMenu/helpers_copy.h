@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cwctype>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace newplus::helpers::copy
+{
+    // Gives the name an entry of a copied template gets, from its path and the final name of the
+    // folder it's in
+    using resolve_name_function = std::function<std::wstring(const std::filesystem::path& entry, const std::wstring& parent_name)>;
+
+    namespace details
+    {
+        inline std::wstring to_lower(std::wstring string)
+        {
+            std::transform(string.begin(), string.end(), string.begin(), towlower);
+            return string;
+        }
+
+        // Names a duplicate like make_unique_path_name: "name (1).ext"
+        inline std::wstring make_unique_name(const std::wstring& name, const std::unordered_set<std::wstring>& used_lowercase_names)
+        {
+            const std::filesystem::path name_based_on(name);
+            std::wstring unique_name = name;
+
+            for (int counter = 1; used_lowercase_names.contains(to_lower(unique_name)); counter++)
+            {
+                unique_name = name_based_on.stem().wstring() + L" (" + std::to_wstring(counter) + L")";
+                if (name_based_on.has_extension())
+                {
+                    unique_name += name_based_on.extension().wstring();
+                }
+            }
+
+            return unique_name;
+        }
+
+        // Renames the entries of a copied folder to their resolved names, sets their last write
+        // time, and returns its subfolders under their final names
+        inline std::vector<std::filesystem::path> resolve_folder_entries(const std::filesystem::path& folder, const resolve_name_function& resolve_name, const std::filesystem::file_time_type write_time)
+        {
+            std::vector<std::filesystem::directory_entry> entries(std::filesystem::directory_iterator(folder), {});
+            std::sort(entries.begin(), entries.end());
+            const std::wstring parent_name = folder.filename().wstring();
+
+            // A resolved name mustn't be taken by an entry, renamed or not yet, as when renaming checked the disk
+            std::unordered_set<std::wstring> used_lowercase_names;
+            for (const auto& entry : entries)
+            {
+                used_lowercase_names.insert(to_lower(entry.path().filename().wstring()));
+            }
+
+            std::vector<std::filesystem::path> subfolders;
+            for (const auto& entry : entries)
+            {
+                std::filesystem::path path = entry.path();
+                if (resolve_name)
+                {
+                    const std::wstring name = path.filename().wstring();
+                    const std::wstring resolved_name = resolve_name(path, parent_name);
+                    if (to_lower(resolved_name) != to_lower(name))
+                    {
+                        const std::wstring unique_name = make_unique_name(resolved_name, used_lowercase_names);
+                        std::filesystem::rename(path, folder / unique_name);
+                        used_lowercase_names.erase(to_lower(name));
+                        used_lowercase_names.insert(to_lower(unique_name));
+                        path = folder / unique_name;
+                    }
+                }
+
+                if (entry.is_directory())
+                {
+                    subfolders.push_back(std::move(path));
+                }
+                else
+                {
+                    std::filesystem::last_write_time(path, write_time);
+                }
+            }
+
+            // Renaming the entries changed the last write time of the folder
+            std::filesystem::last_write_time(folder, write_time);
+
+            return subfolders;
+        }
+    }
+
+    // Resolves the names of the entries of a template folder that was just copied to folder, and
+    // gives every entry write_time as last write time, in one pass. Folders are renamed before their
+    // entries, so $PARENT_FOLDER_NAME resolves to the parent's final name. Subfolders are handled on
+    // several threads.
+    inline void resolve_copied_folder(const std::filesystem::path& folder, const resolve_name_function& resolve_name, const std::filesystem::file_time_type write_time)
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<std::filesystem::path> folders{ folder };
+        size_t folders_being_resolved = 0;
+        std::exception_ptr error;
+
+        const auto work = [&]() {
+            std::unique_lock lock(mutex);
+            while (true)
+            {
+                condition.wait(lock, [&]() { return !folders.empty() || folders_being_resolved == 0 || error; });
+                if (error || folders.empty())
+                {
+                    return;
+                }
+
+                std::filesystem::path current = std::move(folders.front());
+                folders.pop_front();
+                folders_being_resolved++;
+                lock.unlock();
+
+                std::vector<std::filesystem::path> subfolders;
+                std::exception_ptr folder_error;
+                try
+                {
+                    subfolders = details::resolve_folder_entries(current, resolve_name, write_time);
+                }
+                catch (...)
+                {
+                    folder_error = std::current_exception();
+                }
+
+                lock.lock();
+                folders_being_resolved--;
+                if (folder_error && !error)
+                {
+                    error = folder_error;
+                }
+
+                folders.insert(folders.end(), std::make_move_iterator(subfolders.begin()), std::make_move_iterator(subfolders.end()));
+                condition.notify_all();
+            }
+        };
+
+        const unsigned thread_count = (std::min)((std::max)(std::thread::hardware_concurrency(), 1u), 8u);
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < thread_count; i++)
+        {
+            threads.emplace_back(work);
+        }
+
+        work();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
@@ -52,7 +52,7 @@ namespace newplus::helpers::variables
     {
         // Do case-insensitive string replacement of environment variables being consistent with normal %eNV_VaR% behavior
         std::wstring return_string = string;
-        const std::wregex reg_expression(L"%([^%]+)%");
+        static const std::wregex reg_expression(L"%([^%]+)%");
         std::wsmatch match;
 
         size_t start = 0;
@@ -128,42 +128,4 @@ namespace newplus::helpers::variables
 
         return result;
     }
-
-    inline void resolve_variables_in_filename_and_rename_files(const std::filesystem::path& path, const bool do_rename = true)
-    {
-        // Depth first recursion, so that we start renaming the leaves, and avoid having to rescan
-        for (const auto& entry : std::filesystem::directory_iterator(path))
-        {
-            if (std::filesystem::is_directory(entry.status()))
-            {
-                resolve_variables_in_filename_and_rename_files(entry.path(), do_rename);
-            }
-        }
-
-        // Perform the actual rename
-        for (const auto& current : std::filesystem::directory_iterator(path))
-        {
-            if (!newplus::helpers::filesystem::is_hidden(current))
-            {
-                const std::filesystem::path resolved_path = resolve_variables_in_path(current.path());
-
-                // Only rename if the filename is actually different
-                const std::wstring non_resolved_leaf = current.path().filename();
-                const std::wstring resolved_leaf = resolved_path.filename();
-
-                if (StrCmpIW(non_resolved_leaf.c_str(), resolved_leaf.c_str()) != 0)
-                {
-                    const std::wstring org_name = current.path();
-                    const std::wstring new_name = current.path().parent_path() / resolved_leaf;
-                    const std::wstring really_new_name = helpers::filesystem::make_unique_path_name(new_name);
-
-                    // To aid with testing, only conditionally rename
-                    if (do_rename)
-                    {
-                        std::filesystem::rename(org_name, really_new_name);
-                    }
-                }
-            }
-        }
-    }
 }
\ No newline at end of file
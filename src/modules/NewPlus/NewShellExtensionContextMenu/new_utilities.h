@@ -10,6 +10,7 @@
 #include "template_item.h"
 #include "trace.h"
 #include "helpers_variables.h"
+#include "helpers_copy.h"
 
 #pragma comment(lib, "Shlwapi.lib")
 
@@ -376,14 +377,30 @@ namespace newplus::utilities
             // Finally copy file/folder/subfolders
             std::filesystem::path target_final_fullpath = template_entry->copy_object_to(GetActiveWindow(), target_fullpath);
 
-            // Resolve variables and rename files in newly copied folders and subfolders and files
-            if (utilities::get_newplus_setting_resolve_variables() && helpers::filesystem::is_directory(target_final_fullpath))
+            if (helpers::filesystem::is_directory(target_final_fullpath))
             {
-                helpers::variables::resolve_variables_in_filename_and_rename_files(target_final_fullpath);
-            }
+                // Resolve variables in the names of the copied folders and files, and set their
+                // last modified to "now", in one pass
+                helpers::copy::resolve_name_function resolve_name;
+                if (utilities::get_newplus_setting_resolve_variables())
+                {
+                    resolve_name = [](const std::filesystem::path& entry, const std::wstring& parent_name) -> std::wstring {
+                        if (helpers::filesystem::is_hidden(entry))
+                        {
+                            return entry.filename().wstring();
+                        }
 
-            // Touch all files and set last modified to "now"
-            update_last_write_time(target_final_fullpath);
+                        return helpers::variables::resolve_variables_in_filename(entry.filename().wstring(), parent_name).wstring();
+                    };
+                }
+
+                helpers::copy::resolve_copied_folder(target_final_fullpath, resolve_name, std::filesystem::file_time_type::clock::now());
+            }
+            else
+            {
+                // Touch the file and set last modified to "now"
+                update_last_write_time(target_final_fullpath);
+            }
 
             // Consider copy completed. If we do tracing after enter_rename_mode, then rename mode won't consistently work
             trace.UpdateState(true);
@@ -2,12 +2,15 @@
 #include "shell_context_sub_menu.h"
 #include "trace.h"
 #include "new_utilities.h"
+#include <chrono>
 
 using namespace Microsoft::WRL;
 
 // // Sub context menu command enumerator
 shell_context_sub_menu::shell_context_sub_menu(const ComPtr<IUnknown> site_of_folder)
 {
+    const auto start = std::chrono::steady_clock::now();
+
     this->site_of_folder = site_of_folder;
 
     // Determine the New+ Template folder location
@@ -16,9 +19,8 @@ shell_context_sub_menu::shell_context_sub_menu(const ComPtr<IUnknown> site_of_fo
     // Create the New+ Template folder location if it doesn't exist (very rare scenario)
     utilities::create_folder_if_not_exist(root);
 
-    // Scan the folder for any files and folders (the templates)
-    templates = new template_folder(root);
-    templates->rescan_template_folder();
+    // Get the files and folders (the templates), only scanned again if the folder changed
+    templates = template_index::instance().get_templates(root);
 
     // Add template items to context menu
     const auto number_of_templates = templates->list_of_templates.size();
@@ -39,6 +41,9 @@ shell_context_sub_menu::shell_context_sub_menu(const ComPtr<IUnknown> site_of_fo
     // Save how many item templates we have so it can be sent later when we do something with New+.
     // We don't send it here or it would send an event every time we open a context menu.
     newplus::utilities::set_saved_number_of_templates(static_cast<size_t>(number_of_templates));
+
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    Logger::trace(L"Built New+ sub menu in {} us", duration.count());
 }
 
 // IEnumExplorerCommand
@@ -3,6 +3,7 @@
 #include "pch.h"
 
 #include "template_folder.h"
+#include "template_index.h"
 #include "new_utilities.h"
 #include "shell_context_sub_menu_item.h"
 
@@ -24,6 +25,6 @@ public:
 protected:
     std::vector<ComPtr<IExplorerCommand>> explorer_menu_item_commands;
     std::vector<ComPtr<IExplorerCommand>>::const_iterator current_command;
-    template_folder* templates;
+    std::shared_ptr<const template_folder> templates;
     ComPtr<IUnknown> site_of_folder;
 };
@@ -12,7 +12,7 @@ shell_context_sub_menu_item::shell_context_sub_menu_item()
     this->template_entry = nullptr;
 }
 
-shell_context_sub_menu_item::shell_context_sub_menu_item(const template_item* template_entry, const ComPtr<IUnknown> site_of_folder)
+shell_context_sub_menu_item::shell_context_sub_menu_item(const std::shared_ptr<const template_item> template_entry, const ComPtr<IUnknown> site_of_folder)
 {
     this->template_entry = template_entry;
     this->site_of_folder = site_of_folder;
@@ -64,7 +64,7 @@ IFACEMETHODIMP shell_context_sub_menu_item::GetState(_In_opt_ IShellItemArray* s
 
 IFACEMETHODIMP shell_context_sub_menu_item::Invoke(_In_opt_ IShellItemArray*, _In_opt_ IBindCtx*) noexcept
 {
-    return newplus::utilities::copy_template(template_entry, site_of_folder);
+    return newplus::utilities::copy_template(template_entry.get(), site_of_folder);
 }
 
 IFACEMETHODIMP shell_context_sub_menu_item::GetFlags(_Out_ EXPCMDFLAGS* returned_flags)
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include <shellapi.h>
 #include "template_folder.h"
+#include <unordered_map>
 
 using namespace newplus;
 
@@ -21,23 +22,47 @@ void template_folder::init()
     rescan_template_folder();
 }
 
-void template_folder::rescan_template_folder()
+void template_folder::rescan_template_folder(const template_folder* previous_templates)
 {
     list_of_templates.clear();
 
-    std::list<std::pair<std::wstring, template_item*>> dirs;
-    std::list<std::pair<std::wstring, template_item*>> files;
+    std::unordered_map<std::wstring, std::shared_ptr<template_item>> previous_items;
+    if (previous_templates)
+    {
+        for (const auto& [path, item] : previous_templates->list_of_templates)
+        {
+            previous_items.emplace(path, item);
+        }
+    }
+
+    const auto get_item = [&](const std::filesystem::directory_entry& entry) {
+        std::error_code error;
+        const auto last_write_time = entry.last_write_time(error);
+
+        const auto previous_item = previous_items.find(entry.path().wstring());
+        if (!error && previous_item != previous_items.end() && previous_item->second->last_write_time == last_write_time)
+        {
+            return previous_item->second;
+        }
+
+        auto item = std::make_shared<template_item>(entry);
+        item->last_write_time = error ? std::filesystem::file_time_type::min() : last_write_time;
+        return item;
+    };
+
+    std::list<std::pair<std::wstring, std::shared_ptr<template_item>>> dirs;
+    std::list<std::pair<std::wstring, std::shared_ptr<template_item>>> files;
     for (const auto& entry : std::filesystem::directory_iterator(template_folder_path))
     {
         if (entry.is_directory())
         {
-            dirs.push_back({ entry.path().wstring(), new template_item(entry) });
+            dirs.push_back({ entry.path().wstring(), get_item(entry) });
         }
         else
         {
             if (!helpers::filesystem::is_hidden(entry.path()))
             {
-                files.push_back({ entry.path().wstring(), new template_item(entry) });
+                files.push_back({ entry.path().wstring(), get_item(entry) });
             }
         }
     }
@@ -49,7 +74,7 @@ void template_folder::rescan_template_folder()
     list_of_templates.splice(list_of_templates.end(), files);
 }
 
-template_item* template_folder::get_template_item(const int index) const
+std::shared_ptr<template_item> template_folder::get_template_item(const int index) const
 {
     auto it = list_of_templates.begin();
     std::advance(it, index);
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <string>
 #include <list>
+#include <memory>
 #include "template_item.h"
 
 namespace newplus
@@ -15,12 +16,13 @@ namespace newplus
         template_folder(const std::filesystem::path newplus_template_folder);
         ~template_folder();
 
-        void rescan_template_folder();
+        // Items of previous_templates whose files haven't changed are reused, with their resolved icons
+        void rescan_template_folder(const template_folder* previous_templates = nullptr);
 
         std::filesystem::path template_folder_path;
-        std::list<std::pair<std::wstring, template_item*>> list_of_templates;
+        std::list<std::pair<std::wstring, std::shared_ptr<template_item>>> list_of_templates;
 
-        template_item* get_template_item(const int index) const;
+        std::shared_ptr<template_item> get_template_item(const int index) const;
 
     protected:
         template_folder();
@@ -0,0 +1,75 @@
+#include "pch.h"
+#include "template_index.h"
+#include <chrono>
+
+using namespace newplus;
+
+template_index& template_index::instance()
+{
+    static template_index index;
+    return index;
+}
+
+template_index::~template_index()
+{
+    close_change_notification();
+}
+
+std::shared_ptr<const template_folder> template_index::get_templates(const std::filesystem::path& template_folder_path)
+{
+    std::lock_guard lock(mutex);
+
+    // The template folder location is a setting and may have changed
+    if (templates && templates->template_folder_path != template_folder_path)
+    {
+        close_change_notification();
+        templates = nullptr;
+    }
+
+    bool changed = !templates;
+    if (change_notification == INVALID_HANDLE_VALUE)
+    {
+        // Names cover added, removed and renamed templates, attributes hidden ones, and last write
+        // the ones whose content, and so maybe icon, changed
+        change_notification = FindFirstChangeNotificationW(
+            template_folder_path.c_str(),
+            FALSE,
+            FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_ATTRIBUTES | FILE_NOTIFY_CHANGE_LAST_WRITE);
+
+        // Without notifications the folder is scanned every time
+        changed = true;
+    }
+    else if (WaitForSingleObject(change_notification, 0) == WAIT_OBJECT_0)
+    {
+        // Wait for the next change before scanning, so the changes made during the scan aren't missed
+        if (!FindNextChangeNotification(change_notification))
+        {
+            close_change_notification();
+        }
+
+        changed = true;
+    }
+
+    if (changed)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        auto scanned_templates = std::make_shared<template_folder>(template_folder_path);
+        scanned_templates->rescan_template_folder(templates.get());
+        templates = scanned_templates;
+
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        Logger::trace(L"Scanned {} templates in {} us", templates->list_of_templates.size(), duration.count());
+    }
+
+    return templates;
+}
+
+void template_index::close_change_notification()
+{
+    if (change_notification != INVALID_HANDLE_VALUE)
+    {
+        FindCloseChangeNotification(change_notification);
+        change_notification = INVALID_HANDLE_VALUE;
+    }
+}
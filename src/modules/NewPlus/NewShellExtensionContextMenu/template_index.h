@@ -0,0 +1,34 @@
+#pragma once
+
+#include "pch.h"
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include "template_folder.h"
+
+namespace newplus
+{
+    // The templates, shared by every context menu of the process.
+    // The template folder is only scanned again after Windows reported a change
+    // in it, so building a menu usually just reads the current snapshot.
+    class template_index
+    {
+    public:
+        static template_index& instance();
+
+        ~template_index();
+
+        // Returns the templates in the folder, scanned again if it changed since the last call.
+        // The returned snapshot isn't modified afterwards.
+        std::shared_ptr<const template_folder> get_templates(const std::filesystem::path& template_folder_path);
+
+    private:
+        template_index() = default;
+
+        void close_change_notification();
+
+        std::mutex mutex;
+        std::shared_ptr<const template_folder> templates;
+        HANDLE change_notification = INVALID_HANDLE_VALUE;
+    };
+}
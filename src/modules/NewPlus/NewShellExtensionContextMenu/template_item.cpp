@@ -68,7 +68,9 @@ std::wstring template_item::remove_starting_digits_from_filename(std::wstring fi
 
 std::wstring template_item::get_explorer_icon() const
 {
-    return utilities::get_explorer_icon(path);
+    // Items are shared by every menu built from the same templates, so the icon is only resolved once
+    std::call_once(explorer_icon_resolved, [this]() { explorer_icon = utilities::get_explorer_icon(path); });
+    return explorer_icon;
 }
 
 HICON template_item::get_explorer_icon_handle() const
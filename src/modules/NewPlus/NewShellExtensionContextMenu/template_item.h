@@ -5,6 +5,7 @@
 #include <iostream>
 #include <string>
 #include <map>
+#include <mutex>
 
 using namespace Microsoft::WRL;
 
@@ -31,7 +32,13 @@ namespace newplus
 
         std::filesystem::path path;
 
+        // When the template was last changed, to tell whether the item is still up to date
+        std::filesystem::file_time_type last_write_time;
+
     private:
+        mutable std::once_flag explorer_icon_resolved;
+        mutable std::wstring explorer_icon;
+
         static void rename_on_other_thread_workaround(const std::filesystem::path target_fullpath);
 
         std::wstring remove_starting_digits_from_filename(std::wstring filename) const;
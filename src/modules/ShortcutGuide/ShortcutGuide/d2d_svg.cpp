@@ -27,9 +27,48 @@ D2DSVG& D2DSVG::load(const std::wstring& filename, ID2D1DeviceContext5* d2d_dc)
     svg_width = static_cast<int>(tmp);
     winrt::check_hresult(root->GetAttributeValue(L"height", &tmp));
     svg_height =  static_cast<int>(tmp);
+
+    filled_elements.clear();
+    std::function<void(ID2D1SvgElement * element)> recurse = [&](ID2D1SvgElement* element) {
+        if (element->IsAttributeSpecified(L"fill"))
+        {
+            filled_elements.emplace_back().copy_from(element);
+        }
+        winrt::com_ptr<ID2D1SvgElement> sub;
+        element->GetFirstChild(sub.put());
+        while (sub)
+        {
+            recurse(sub.get());
+            winrt::com_ptr<ID2D1SvgElement> next;
+            element->GetNextChild(sub.get(), next.put());
+            sub = next;
+        }
+    };
+    recurse(root.get());
     return *this;
 }
 
+void D2DSVG::save(const std::wstring& filename)
+{
+    // Written next to the file first, so that a failure never leaves half a document behind
+    auto temp_filename = filename + L".tmp";
+    {
+        winrt::com_ptr<IStream> svg_stream;
+        winrt::check_hresult(SHCreateStreamOnFileEx(temp_filename.c_str(),
+                                                    STGM_CREATE | STGM_WRITE,
+                                                    FILE_ATTRIBUTE_NORMAL,
+                                                    TRUE,
+                                                    nullptr,
+                                                    svg_stream.put()));
+        winrt::check_hresult(svg->Serialize(svg_stream.get(), nullptr));
+    }
+    if (!MoveFileExW(temp_filename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        DeleteFileW(temp_filename.c_str());
+        winrt::throw_last_error();
+    }
+}
+
 D2DSVG& D2DSVG::resize(int x, int y, int width, int height, float fill, float max_scale)
 {
     // Center
@@ -49,35 +88,31 @@ D2DSVG& D2DSVG::resize(int x, int y, int width, int height, float fill, float ma
 
 D2DSVG& D2DSVG::recolor(uint32_t oldcolor, uint32_t newcolor)
 {
-    auto new_color = D2D1::ColorF(newcolor & 0xFFFFFF, 1);
-    auto old_color = D2D1::ColorF(oldcolor & 0xFFFFFF, 1);
-    std::function<void(ID2D1SvgElement * element)> recurse = [&](ID2D1SvgElement* element) {
-        if (!element)
-            return;
-        if (element->IsAttributeSpecified(L"fill"))
+    return recolor({ { oldcolor, newcolor } });
+}
+
+D2DSVG& D2DSVG::recolor(const std::vector<std::pair<uint32_t, uint32_t>>& colors)
+{
+    for (auto& element : filled_elements)
+    {
+        // The fill is read again every time, key animations change it after the load
+        D2D1_COLOR_F elem_fill;
+        winrt::com_ptr<ID2D1SvgPaint> paint;
+        if (element->GetAttributeValue(L"fill", paint.put()) != S_OK || !paint)
         {
-            D2D1_COLOR_F elem_fill;
-            winrt::com_ptr<ID2D1SvgPaint> paint;
-            element->GetAttributeValue(L"fill", paint.put());
-            paint->GetColor(&elem_fill);
+            continue;
+        }
+        paint->GetColor(&elem_fill);
+        for (auto [oldcolor, newcolor] : colors)
+        {
+            auto old_color = D2D1::ColorF(oldcolor & 0xFFFFFF, 1);
             if (elem_fill.r == old_color.r && elem_fill.g == old_color.g && elem_fill.b == old_color.b)
             {
-                winrt::check_hresult(element->SetAttributeValue(L"fill", new_color));
+                winrt::check_hresult(element->SetAttributeValue(L"fill", D2D1::ColorF(newcolor & 0xFFFFFF, 1)));
+                break;
             }
         }
-        winrt::com_ptr<ID2D1SvgElement> sub;
-        element->GetFirstChild(sub.put());
-        while (sub)
-        {
-            recurse(sub.get());
-            winrt::com_ptr<ID2D1SvgElement> next;
-            element->GetNextChild(sub.get(), next.put());
-            sub = next;
-        }
-    };
-    winrt::com_ptr<ID2D1SvgElement> root;
-    svg->GetRoot(root.put());
-    recurse(root.get());
+    }
     return *this;
 }
 
@@ -3,14 +3,21 @@
 #include <d2d1_3helper.h>
 #include <winrt/base.h>
 #include <string>
+#include <utility>
+#include <vector>
 
 class D2DSVG
 {
 public:
     D2DSVG& load(const std::wstring& filename, ID2D1DeviceContext5* d2d_dc);
+    // Writes the document, as it is now, to a file that load can read back
+    void save(const std::wstring& filename);
     D2DSVG& resize(int x, int y, int width, int height, float fill, float max_scale = -1.0f);
     D2DSVG& render(ID2D1DeviceContext5* d2d_dc);
     D2DSVG& recolor(uint32_t oldcolor, uint32_t newcolor);
+    // Replaces all the colors in one pass. Each color is replaced at most once,
+    // even if it's also the old color of another pair.
+    D2DSVG& recolor(const std::vector<std::pair<uint32_t, uint32_t>>& colors);
     float get_scale() const { return used_scale; }
     int width() const { return svg_width; }
     int height() const { return svg_height; }
@@ -23,4 +30,6 @@ protected:
     winrt::com_ptr<ID2D1SvgDocument> svg;
     int svg_width = -1, svg_height = -1;
     D2D1::Matrix3x2F transform;
+    // The elements with a fill, found once when the document is loaded
+    std::vector<winrt::com_ptr<ID2D1SvgElement>> filled_elements;
 };
@@ -1,6 +1,7 @@
 ﻿#include "pch.h"
 #include "overlay_window.h"
 #include <common/display/monitors.h>
+#include <common/SettingsAPI/settings_helpers.h>
 #include "tasklist_positions.h"
 #include "start_visible.h"
 #include <common/utils/resources.h>
@@ -9,8 +10,11 @@
 
 #include "shortcut_guide.h"
 #include "trace.h"
+#include "ShortcutGuideConstants.h"
 #include "Generated Files/resource.h"
 
+#include <format>
+
 namespace
 {
     // Gets position of given window.
@@ -93,6 +97,67 @@ namespace
         return RESTORED;
     }
 
+    using ColorChanges = std::vector<std::pair<uint32_t, uint32_t>>;
+
+    // Loads an asset with its colors changed. The recolored asset is saved in
+    // the module's folder, one copy per theme, and as long as the colors and
+    // the asset stay the same the next overlay loads that copy as it is.
+    template<typename SVG>
+    SVG& load_recolored(SVG& svg, const std::wstring& name, const ColorChanges& colors, bool light_mode, ID2D1DeviceContext5* d2d_dc)
+    {
+        const std::filesystem::path asset = L"Assets\\ShortcutGuide\\" + name;
+        std::error_code error;
+        const auto asset_time = std::filesystem::last_write_time(asset, error);
+        if (error)
+        {
+            svg.load(asset.wstring(), d2d_dc).recolor(colors);
+            return svg;
+        }
+
+        // The name tells which theme, colors and version of the asset the copy is for
+        const auto prefix = asset.stem().wstring() + (light_mode ? L"-light-" : L"-dark-");
+        auto cached_name = prefix;
+        for (auto [oldcolor, newcolor] : colors)
+        {
+            cached_name += std::format(L"{:06X}-", newcolor & 0xFFFFFF);
+        }
+        cached_name += std::format(L"{:X}.svg", asset_time.time_since_epoch().count());
+        const auto folder = std::filesystem::path(PTSettingsHelper::get_module_save_folder_location(ShortcutGuideConstants::ModuleKey)) / L"AssetsCache";
+        const auto cached = folder / cached_name;
+
+        if (std::filesystem::exists(cached, error))
+        {
+            try
+            {
+                svg.load(cached.wstring(), d2d_dc);
+                return svg;
+            }
+            catch (...)
+            {
+                Logger::warn(L"Failed to load the cached {}", cached_name);
+            }
+        }
+
+        svg.load(asset.wstring(), d2d_dc).recolor(colors);
+        try
+        {
+            // Copies for other colors or an older version of the asset are no longer needed
+            std::filesystem::create_directories(folder, error);
+            for (const auto& entry : std::filesystem::directory_iterator(folder, error))
+            {
+                if (entry.path().filename().wstring().starts_with(prefix))
+                {
+                    std::filesystem::remove(entry.path(), error);
+                }
+            }
+            svg.save(cached.wstring());
+        }
+        catch (...)
+        {
+            Logger::warn(L"Failed to cache {}", cached_name);
+        }
+        return svg;
+    }
 }
 
 D2DOverlaySVG& D2DOverlaySVG::load(const std::wstring& filename, ID2D1DeviceContext5* d2d_dc)
@@ -311,31 +376,15 @@ void D2DOverlayWindow::show(HWND window, bool snappable)
     auto new_light_mode = (theme_setting == Light) || (theme_setting == System && colors.light_mode);
     if (initialized && (colors_updated || light_mode != new_light_mode))
     {
-        // update background colors
-        landscape.recolor(old_bck, colors.start_color_menu);
-        portrait.recolor(old_bck, colors.start_color_menu);
-        for (auto& arrow : arrows)
-        {
-            arrow.recolor(old_bck, colors.start_color_menu);
-        }
+        // update background and text colors, in one pass over each asset
         light_mode = new_light_mode;
-        if (light_mode)
-        {
-            landscape.recolor(0xDDDDDD, 0x222222);
-            portrait.recolor(0xDDDDDD, 0x222222);
-            for (auto& arrow : arrows)
-            {
-                arrow.recolor(0xDDDDDD, 0x222222);
-            }
-        }
-        else
+        const ColorChanges changes = { { old_bck, colors.start_color_menu },
+                                       light_mode ? std::pair<uint32_t, uint32_t>{ 0xDDDDDD, 0x222222 } : std::pair<uint32_t, uint32_t>{ 0x222222, 0xDDDDDD } };
+        landscape.recolor(changes);
+        portrait.recolor(changes);
+        for (auto& arrow : arrows)
         {
-            landscape.recolor(0x222222, 0xDDDDDD);
-            portrait.recolor(0x222222, 0xDDDDDD);
-            for (auto& arrow : arrows)
-            {
-                arrow.recolor(0x222222, 0xDDDDDD);
-            }
+            arrow.recolor(changes);
         }
     }
     monitors = MonitorInfo::GetMonitors(true);
@@ -501,38 +550,21 @@ float D2DOverlayWindow::get_overlay_opacity()
 void D2DOverlayWindow::init()
 {
     colors.update();
-    landscape.load(L"Assets\\ShortcutGuide\\overlay.svg", d2d_dc.get())
+    light_mode = (theme_setting == Light) || (theme_setting == System && colors.light_mode);
+    const uint32_t text_color = light_mode ? 0x000000 : 0xFFFFFF;
+    const ColorChanges overlay_colors = { { 0x2582FB, colors.start_color_menu }, { 0x2E17FC, text_color } };
+    const ColorChanges arrow_colors = { { 0x2582FB, colors.start_color_menu }, { 0x222222, text_color } };
+    load_recolored(landscape, L"overlay.svg", overlay_colors, light_mode, d2d_dc.get())
         .find_thumbnail(L"monitorRect")
-        .find_window_group(L"WindowControlsGroup")
-        .recolor(0x2582FB, colors.start_color_menu);
-    portrait.load(L"Assets\\ShortcutGuide\\overlay_portrait.svg", d2d_dc.get())
+        .find_window_group(L"WindowControlsGroup");
+    load_recolored(portrait, L"overlay_portrait.svg", overlay_colors, light_mode, d2d_dc.get())
         .find_thumbnail(L"monitorRect")
-        .find_window_group(L"WindowControlsGroup")
-        .recolor(0x2582FB, colors.start_color_menu);
+        .find_window_group(L"WindowControlsGroup");
     no_active.load(L"Assets\\ShortcutGuide\\no_active_window.svg", d2d_dc.get());
     arrows.resize(10);
     for (unsigned i = 0; i < arrows.size(); ++i)
     {
-        arrows[i].load(L"Assets\\ShortcutGuide\\" + std::to_wstring((i + 1) % 10) + L".svg", d2d_dc.get()).recolor(0x2582FB, colors.start_color_menu);
-    }
-    light_mode = (theme_setting == Light) || (theme_setting == System && colors.light_mode);
-    if (light_mode)
-    {
-        landscape.recolor(0x2E17FC, 0x000000);
-        portrait.recolor(0x2E17FC, 0x000000);
-        for (auto& arrow : arrows)
-        {
-            arrow.recolor(0x222222, 0x000000);
-        }
-    }
-    else
-    {
-        landscape.recolor(0x2E17FC, 0xFFFFFF);
-        portrait.recolor(0x2E17FC, 0xFFFFFF);
-        for (auto& arrow : arrows)
-        {
-            arrow.recolor(0x222222, 0xFFFFFF);
-        }
+        load_recolored(arrows[i], std::to_wstring((i + 1) % 10) + L".svg", arrow_colors, light_mode, d2d_dc.get());
     }
 }
 
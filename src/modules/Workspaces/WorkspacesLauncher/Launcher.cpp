@@ -10,6 +10,38 @@
 #include <AppLauncher.h>
 #include <WorkspacesLib/AppUtils.h>
 
+namespace
+{
+    // Instances of the same app are launched one after another: each one waits for the previous one
+    std::vector<std::vector<size_t>> LaunchDependencies(const std::vector<WorkspacesData::WorkspacesProject::Application>& apps)
+    {
+        std::vector<std::vector<size_t>> dependencies(apps.size());
+        for (size_t i = 0; i < apps.size(); i++)
+        {
+            for (size_t j = i; j-- > 0;)
+            {
+                if (apps[j].name == apps[i].name || apps[j].path == apps[i].path)
+                {
+                    dependencies[i].push_back(j);
+                    break;
+                }
+            }
+        }
+
+        return dependencies;
+    }
+
+    std::wstring FormatTime(const std::optional<Utils::LaunchScheduler::Clock::duration>& time)
+    {
+        if (!time.has_value())
+        {
+            return L"-";
+        }
+
+        return std::to_wstring(std::chrono::duration_cast<std::chrono::milliseconds>(time.value()).count()) + L" ms";
+    }
+}
+
 Launcher::Launcher(const WorkspacesData::WorkspacesProject& project, 
     std::vector<WorkspacesData::WorkspacesProject>& workspaces,
     InvokePoint invokePoint) :
@@ -19,7 +51,8 @@ Launcher::Launcher(const WorkspacesData::WorkspacesProject& project,
     m_start(std::chrono::high_resolution_clock::now()),
     m_uiHelper(std::make_unique<LauncherUIHelper>(std::bind(&Launcher::handleUIMessage, this, std::placeholders::_1))),
     m_windowArrangerHelper(std::make_unique<WindowArrangerHelper>(std::bind(&Launcher::handleWindowArrangerMessage, this, std::placeholders::_1))),
-    m_launchingStatus(m_project)
+    m_launchingStatus(m_project),
+    m_launchScheduler(LaunchDependencies(m_project.apps), Utils::LaunchScheduler::Options{})
 {
     // main thread
     Logger::info(L"Launch Workspace {} : {}", m_project.name, m_project.id);
@@ -55,6 +88,18 @@ Launcher::~Launcher()
     // main thread, will wait until arranger is finished
     Logger::trace(L"Finalizing launch");
 
+    m_launchScheduler.Cancel();
+    {
+        std::lock_guard lock(m_launchThreadMutex);
+        if (m_launchThread.joinable())
+        {
+            m_launchThread.join();
+        }
+
+        // A late "ready" from the arranger mustn't start the launch again
+        m_launchThreadJoined = true;
+    }
+
     // update last-launched time
     if (m_invokePoint != InvokePoint::LaunchAndEdit)
     {
@@ -76,6 +121,12 @@ Launcher::~Launcher()
     std::chrono::duration<double> duration = end - m_start;
     Logger::trace(L"Launching time: {} s", duration.count());
 
+    const auto timings = m_launchScheduler.Timings();
+    for (size_t i = 0; i < timings.size(); i++)
+    {
+        Logger::trace(L"{}: started at {}, launched at {}, window at {}", m_project.apps[i].name, FormatTime(timings[i].started), FormatTime(timings[i].launched), FormatTime(timings[i].windowAppeared));
+    }
+
     auto monitors = MonitorUtils::IdentifyMonitors();
     bool differentSetup = monitors.size() != m_project.monitors.size();
     if (!differentSetup)
@@ -97,75 +148,63 @@ Launcher::~Launcher()
 
 void Launcher::Launch() // Launching thread
 {
-    const long maxWaitTimeMs = 3000;
-    const long ms = 100;
+    m_launchScheduler.Run([&](size_t index) { return LaunchApp(m_project.apps[index]); });
+}
 
-    // Launch apps
-    for (auto appState = m_launchingStatus.GetNext(LaunchingState::Waiting);appState.has_value();appState = m_launchingStatus.GetNext(LaunchingState::Waiting))
+bool Launcher::LaunchApp(const WorkspacesData::WorkspacesProject::Application& app) // Launching threads
+{
+    auto state = m_launchingStatus.Get(app);
+    if (!state.has_value() || state.value().state != LaunchingState::Waiting)
     {
-        auto app = appState.value().application;
-        
-        long waitingTime = 0;
-        bool additionalWait = false;
-        while (!m_launchingStatus.AllInstancesOfTheAppLaunchedAndMoved(app) && waitingTime < maxWaitTimeMs)
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
-            waitingTime += ms;
-            additionalWait = true;
-        }
+        // canceled
+        return false;
+    }
 
-        if (additionalWait)
-        {
-            // Resolves an issue when Outlook does not launch when launching one after another.
-            // Launching Outlook instances right one after another causes error message.
-            // Launching Outlook instances with less than 1-second delay causes the second window not to appear
-            // even though there wasn't a launch error.
-            std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-        }
+    AppLauncher::ErrorList launchErrors;
+    bool launched = AppLauncher::Launch(app, launchErrors);
 
-        if (waitingTime >= maxWaitTimeMs)
-        {
-            Logger::info(L"Waiting time for launching next {} instance expired", app.name);
-        }
+    {
+        std::lock_guard lock(m_launchErrorsMutex);
+        m_launchErrors.insert(m_launchErrors.end(), launchErrors.begin(), launchErrors.end());
+    }
 
-        bool launched{ false };
-        {
-            std::lock_guard lock(m_launchErrorsMutex);
-            launched = AppLauncher::Launch(app, m_launchErrors);
-        }
+    if (launched)
+    {
+        m_launchingStatus.Update(app, LaunchingState::Launched);
+    }
+    else
+    {
+        Logger::error(L"Failed to launch {}", app.name);
+        m_launchingStatus.Update(app, LaunchingState::Failed);
+        m_launchedSuccessfully = false;
+    }
 
-        if (launched)
-        {
-            m_launchingStatus.Update(app, LaunchingState::Launched);
-        }
-        else
+    auto status = m_launchingStatus.Get(app); // updated after launch status 
+    if (status.has_value())
+    {
         {
-            Logger::error(L"Failed to launch {}", app.name);
-            m_launchingStatus.Update(app, LaunchingState::Failed);
-            m_launchedSuccessfully = false;
+            std::lock_guard lock(m_windowArrangerHelperMutex);
+            m_windowArrangerHelper->UpdateLaunchStatus(status.value());
         }
+    }
 
-        auto status = m_launchingStatus.Get(app); // updated after launch status 
-        if (status.has_value())
-        {
-            {
-                std::lock_guard lock(m_windowArrangerHelperMutex);
-                m_windowArrangerHelper->UpdateLaunchStatus(status.value());
-            }
-        }
+    {
+        std::lock_guard lock(m_uiHelperMutex);
+        m_uiHelper->UpdateLaunchStatus(m_launchingStatus.Get());
+    };
 
-        {
-            std::lock_guard lock(m_uiHelperMutex);
-            m_uiHelper->UpdateLaunchStatus(m_launchingStatus.Get());
-        };
-    }
+    return launched;
 }
 
 void Launcher::handleWindowArrangerMessage(const std::wstring& msg) // WorkspacesArranger IPC thread
 {
     if (msg == L"ready")
     {
-        std::thread([&]() { Launch(); }).detach();
+        std::lock_guard lock(m_launchThreadMutex);
+        if (!m_launchThread.joinable() && !m_launchThreadJoined)
+        {
+            m_launchThread = std::thread([&]() { Launch(); });
+        }
     }
     else
     {
@@ -175,7 +214,17 @@ void Launcher::handleWindowArrangerMessage(const std::wstring& msg) // Workspace
             if (data.has_value())
             {
                 m_launchingStatus.Update(data.value().application, data.value().state);
-                
+
+                // the next instance of the app doesn't have to wait for this one anymore
+                if (data.value().state != LaunchingState::Waiting && data.value().state != LaunchingState::Launched)
+                {
+                    auto app = std::find(m_project.apps.begin(), m_project.apps.end(), data.value().application);
+                    if (app != m_project.apps.end())
+                    {
+                        m_launchScheduler.WindowAppeared(app - m_project.apps.begin());
+                    }
+                }
+
                 {
                     std::lock_guard lock(m_uiHelperMutex);
                     m_uiHelper->UpdateLaunchStatus(m_launchingStatus.Get());
@@ -198,5 +247,6 @@ void Launcher::handleUIMessage(const std::wstring& msg) // UI IPC thread
     if (msg == L"cancel")
     {
         m_launchingStatus.Cancel();
+        m_launchScheduler.Cancel();
     }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <WorkspacesLib/LaunchScheduler.h>
 #include <WorkspacesLib/LaunchingStatus.h>
 #include <WorkspacesLib/WorkspacesData.h>
 
@@ -21,6 +22,12 @@ private:
     const std::chrono::steady_clock::time_point m_start;
     std::atomic<bool> m_launchedSuccessfully{};
     LaunchingStatus m_launchingStatus;
+    Utils::LaunchScheduler m_launchScheduler;
+
+    // Started on the arranger's IPC thread and joined on the main thread
+    std::thread m_launchThread;
+    bool m_launchThreadJoined = false;
+    std::mutex m_launchThreadMutex;
 
     std::unique_ptr<LauncherUIHelper> m_uiHelper;
     std::mutex m_uiHelperMutex;
@@ -32,6 +39,7 @@ private:
     std::mutex m_launchErrorsMutex;
 
     void Launch();
+    bool LaunchApp(const WorkspacesData::WorkspacesProject::Application& app);
     void handleWindowArrangerMessage(const std::wstring& msg);
     void handleUIMessage(const std::wstring& msg);
 };
@@ -0,0 +1,132 @@
+#include "pch.h"
+#include <WorkspacesLib/AppIndex.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace WorkspacesLibUnitTests
+{
+    TEST_CLASS(AppIndexTests)
+    {
+    public:
+        TEST_METHOD(FindInstallPathIn_ReturnsFirstContainedInstallPath)
+        {
+            // Arrange
+            Utils::Apps::AppIndex index({
+                { .name = L"Other", .installPath = L"C:\\Other" },
+                { .name = L"Tool", .installPath = L"C:\\Program Files\\Vendor\\Tool" },
+                { .name = L"Vendor", .installPath = L"C:\\Program Files\\Vendor" },
+            });
+
+            // Act
+            const auto result = index.FindInstallPathIn(L"C:\\PROGRAM FILES\\VENDOR\\TOOL\\TOOL.EXE");
+
+            // Assert
+            Assert::IsNotNull(result);
+            Assert::AreEqual(std::wstring(L"Tool"), result->name);
+        }
+
+        TEST_METHOD(FindInstallPathIn_MatchesInsideThePath)
+        {
+            // Arrange
+            Utils::Apps::AppIndex index({
+                { .name = L"Empty", .installPath = L"" },
+                { .name = L"App", .installPath = L"apps\\app.exe" },
+            });
+
+            // Act
+            const auto result = index.FindInstallPathIn(L"D:\\PORTABLE\\APPS\\APP.EXE");
+
+            // Assert
+            Assert::IsNotNull(result);
+            Assert::AreEqual(std::wstring(L"App"), result->name);
+        }
+
+        TEST_METHOD(FindInstallPathIn_NoMatch_ReturnsNull)
+        {
+            // Arrange
+            Utils::Apps::AppIndex index({
+                { .name = L"Empty", .installPath = L"" },
+                { .name = L"App", .installPath = L"C:\\Apps\\App.exe" },
+            });
+
+            // Act
+            const auto result = index.FindInstallPathIn(L"C:\\APPS\\OTHER.EXE");
+
+            // Assert
+            Assert::IsNull(result);
+        }
+
+        TEST_METHOD(FindLastByFilename_ReturnsLastApp)
+        {
+            // Arrange
+            Utils::Apps::AppIndex index({
+                { .name = L"First", .installPath = L"C:\\First\\app.exe" },
+                { .name = L"Second", .installPath = L"C:\\Second\\app.exe" },
+                { .name = L"Other", .installPath = L"C:\\Other\\other.exe" },
+            });
+
+            // Act
+            const auto result = index.FindLastByFilename(L"app.exe");
+
+            // Assert
+            Assert::IsNotNull(result);
+            Assert::AreEqual(std::wstring(L"Second"), result->name);
+            Assert::IsNull(index.FindLastByFilename(L"APP.EXE"));
+        }
+
+        TEST_METHOD(FindByName_ReturnsFirstApp)
+        {
+            // Arrange
+            Utils::Apps::AppIndex index({
+                { .name = L"Code", .installPath = L"C:\\First\\Code.exe" },
+                { .name = L"code", .installPath = L"C:\\Second\\code.exe" },
+            });
+
+            // Act
+            const auto result = index.FindByName(L"CODE");
+
+            // Assert
+            Assert::IsNotNull(result);
+            Assert::AreEqual(std::wstring(L"C:\\First\\Code.exe"), result->installPath);
+        }
+
+        TEST_METHOD(FindByInstallFolder_ReturnsFirstApp)
+        {
+            // Arrange
+            Utils::Apps::AppIndex index({
+                { .name = L"Empty", .installPath = L"" },
+                { .name = L"Game", .installPath = L"C:\\Steam\\steamapps\\common\\Game\\game.exe" },
+                { .name = L"Launcher", .installPath = L"C:\\Steam\\steamapps\\common\\Game\\launcher.exe" },
+            });
+
+            // Act
+            const auto result = index.FindByInstallFolder(L"C:\\STEAM\\STEAMAPPS\\COMMON\\GAME");
+
+            // Assert
+            Assert::IsNotNull(result);
+            Assert::AreEqual(std::wstring(L"Game"), result->name);
+            Assert::IsNull(index.FindByInstallFolder(L"C:\\STEAM"));
+        }
+
+        TEST_METHOD(ThousandApps_FindsEachInstallPath)
+        {
+            // Arrange
+            Utils::Apps::AppList apps;
+            for (int i = 0; i < 1000; i++)
+            {
+                apps.push_back({ .name = L"App " + std::to_wstring(i), .installPath = L"C:\\Program Files\\Vendor\\App" + std::to_wstring(i) + L"\\" });
+            }
+            Utils::Apps::AppIndex index(apps);
+
+            for (int i = 0; i < 1000; i++)
+            {
+                // Act
+                const auto result = index.FindInstallPathIn(L"C:\\PROGRAM FILES\\VENDOR\\APP" + std::to_wstring(i) + L"\\BIN\\APP.EXE");
+
+                // Assert
+                Assert::IsNotNull(result);
+                Assert::AreEqual(L"App " + std::to_wstring(i), result->name);
+            }
+        }
+    };
+}
@@ -0,0 +1,164 @@
+#include "pch.h"
+#include <WorkspacesLib/AppsCache.h>
+
+#include <filesystem>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace WorkspacesLibUnitTests
+{
+    class FakeAppSource : public Utils::Apps::AppSource
+    {
+    public:
+        FakeAppSource(uint64_t stamp, Utils::Apps::AppList apps, int& enumerations) :
+            m_stamp(stamp), m_apps(std::move(apps)), m_enumerations(enumerations)
+        {
+        }
+
+        Utils::Apps::AppList GetApps() override
+        {
+            m_enumerations++;
+            return m_apps;
+        }
+
+        uint64_t GetStamp() override
+        {
+            return m_stamp;
+        }
+
+    private:
+        uint64_t m_stamp;
+        Utils::Apps::AppList m_apps;
+        int& m_enumerations;
+    };
+
+    TEST_CLASS(AppsCacheTests)
+    {
+    public:
+        TEST_METHOD_INITIALIZE(Setup)
+        {
+            m_cacheFile = (std::filesystem::temp_directory_path() / L"workspaces-apps-cache-test.bin").wstring();
+            std::filesystem::remove(m_cacheFile);
+        }
+
+        TEST_METHOD_CLEANUP(Cleanup)
+        {
+            std::filesystem::remove(m_cacheFile);
+        }
+
+        TEST_METHOD(Serialize_RoundTrip)
+        {
+            // Arrange
+            Utils::Apps::CachedApps cache{
+                .stamp = 42,
+                .apps = {
+                    { .name = L"App", .installPath = L"C:\\App\\app.exe", .packageFullName = L"Package", .appUserModelId = L"Aumid", .pwaAppId = L"Pwa", .protocolPath = L"steam://rungameid/1", .canLaunchElevated = true },
+                    { .name = L"Other" },
+                }
+            };
+
+            // Act
+            const auto result = Utils::Apps::DeserializeAppsCache(Utils::Apps::SerializeAppsCache(cache));
+
+            // Assert
+            Assert::IsTrue(result.has_value());
+            Assert::AreEqual(static_cast<uint64_t>(42), result->stamp);
+            Assert::AreEqual(static_cast<size_t>(2), result->apps.size());
+            Assert::AreEqual(std::wstring(L"C:\\App\\app.exe"), result->apps[0].installPath);
+            Assert::AreEqual(std::wstring(L"steam://rungameid/1"), result->apps[0].protocolPath);
+            Assert::IsTrue(result->apps[0].canLaunchElevated);
+            Assert::AreEqual(std::wstring(L"Other"), result->apps[1].name);
+            Assert::IsFalse(result->apps[1].canLaunchElevated);
+        }
+
+        TEST_METHOD(Deserialize_TruncatedData_ReturnsNullopt)
+        {
+            // Arrange
+            const auto data = Utils::Apps::SerializeAppsCache({ .stamp = 1, .apps = { { .name = L"App" } } });
+
+            // Act & Assert
+            for (size_t size = 0; size < data.size(); size++)
+            {
+                Assert::IsFalse(Utils::Apps::DeserializeAppsCache(std::string_view(data).substr(0, size)).has_value());
+            }
+            Assert::IsFalse(Utils::Apps::DeserializeAppsCache(data + "x").has_value());
+        }
+
+        TEST_METHOD(GetApps_NoCache_EnumeratesOnce)
+        {
+            // Arrange
+            int enumerations = 0;
+            Utils::Apps::AppsCache cache(m_cacheFile, std::make_unique<FakeAppSource>(1, Utils::Apps::AppList{ { .name = L"App" } }, enumerations));
+
+            // Act
+            const auto first = cache.GetApps();
+            const auto second = cache.GetApps();
+
+            // Assert
+            Assert::AreEqual(1, enumerations);
+            Assert::AreEqual(static_cast<size_t>(1), first.size());
+            Assert::AreEqual(static_cast<size_t>(1), second.size());
+            Assert::IsTrue(std::filesystem::exists(m_cacheFile));
+        }
+
+        TEST_METHOD(GetApps_ValidCache_DoesNotEnumerate)
+        {
+            // Arrange
+            int enumerations = 0;
+            {
+                Utils::Apps::AppsCache cache(m_cacheFile, std::make_unique<FakeAppSource>(1, Utils::Apps::AppList{ { .name = L"Cached" } }, enumerations));
+                cache.GetApps();
+            }
+            Utils::Apps::AppsCache cache(m_cacheFile, std::make_unique<FakeAppSource>(1, Utils::Apps::AppList{ { .name = L"Fresh" } }, enumerations));
+
+            // Act
+            const auto result = cache.GetApps();
+
+            // Assert
+            Assert::AreEqual(1, enumerations);
+            Assert::AreEqual(std::wstring(L"Cached"), result[0].name);
+        }
+
+        TEST_METHOD(GetApps_OutdatedCache_ReturnsCachedAndRefreshes)
+        {
+            // Arrange
+            int enumerations = 0;
+            {
+                Utils::Apps::AppsCache cache(m_cacheFile, std::make_unique<FakeAppSource>(1, Utils::Apps::AppList{ { .name = L"Cached" } }, enumerations));
+                cache.GetApps();
+            }
+            Utils::Apps::AppsCache cache(m_cacheFile, std::make_unique<FakeAppSource>(2, Utils::Apps::AppList{ { .name = L"Fresh" } }, enumerations));
+
+            // Act
+            const auto immediate = cache.GetApps();
+            cache.WaitForRefresh();
+            const auto refreshed = cache.GetApps();
+
+            // Assert
+            Assert::AreEqual(2, enumerations);
+            Assert::AreEqual(std::wstring(L"Cached"), immediate[0].name);
+            Assert::AreEqual(std::wstring(L"Fresh"), refreshed[0].name);
+
+            int laterEnumerations = 0;
+            Utils::Apps::AppsCache later(m_cacheFile, std::make_unique<FakeAppSource>(2, Utils::Apps::AppList{}, laterEnumerations));
+            Assert::AreEqual(std::wstring(L"Fresh"), later.GetApps()[0].name);
+            Assert::AreEqual(0, laterEnumerations);
+        }
+
+        TEST_METHOD(GetApps_EmptyEnumeration_IsNotCached)
+        {
+            // Arrange
+            int enumerations = 0;
+            {
+                Utils::Apps::AppsCache cache(m_cacheFile, std::make_unique<FakeAppSource>(1, Utils::Apps::AppList{}, enumerations));
+                cache.GetApps();
+            }
+
+            // Assert
+            Assert::IsFalse(std::filesystem::exists(m_cacheFile));
+        }
+
+    private:
+        std::wstring m_cacheFile;
+    };
+}
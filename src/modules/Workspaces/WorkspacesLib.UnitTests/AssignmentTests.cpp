@@ -0,0 +1,166 @@
+#include "pch.h"
+#include <WorkspacesLib/Assignment.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace WorkspacesLibUnitTests
+{
+    TEST_CLASS(AssignmentTests)
+    {
+    public:
+        TEST_METHOD(AssignMinCost_Empty_ReturnsEmpty)
+        {
+            // Act
+            const auto result = Utils::AssignMinCost({});
+
+            // Assert
+            Assert::IsTrue(result.empty());
+        }
+
+        TEST_METHOD(AssignMinCost_BeatsGreedy)
+        {
+            // Arrange
+            // Greedy takes the cheapest pair (0, 0) first and leaves row 1 with column 1
+            std::vector<std::vector<std::optional<int64_t>>> costs{
+                { 1, 2 },
+                { 2, 100 },
+            };
+
+            // Act
+            const auto result = Utils::AssignMinCost(costs);
+
+            // Assert
+            Assert::AreEqual(static_cast<size_t>(1), result[0].value());
+            Assert::AreEqual(static_cast<size_t>(0), result[1].value());
+        }
+
+        TEST_METHOD(AssignMinCost_PrefersMorePairsOverLowerCost)
+        {
+            // Arrange
+            std::vector<std::vector<std::optional<int64_t>>> costs{
+                { 0, 10000 },
+                { 0, std::nullopt },
+            };
+
+            // Act
+            const auto result = Utils::AssignMinCost(costs);
+
+            // Assert
+            Assert::AreEqual(static_cast<size_t>(1), result[0].value());
+            Assert::AreEqual(static_cast<size_t>(0), result[1].value());
+        }
+
+        TEST_METHOD(AssignMinCost_ForbiddenPairs_LeaveRowsUnassigned)
+        {
+            // Arrange
+            std::vector<std::vector<std::optional<int64_t>>> costs{
+                { std::nullopt, 5, std::nullopt },
+                { std::nullopt, 3, std::nullopt },
+                { std::nullopt, std::nullopt, std::nullopt },
+            };
+
+            // Act
+            const auto result = Utils::AssignMinCost(costs);
+
+            // Assert
+            Assert::IsFalse(result[0].has_value());
+            Assert::AreEqual(static_cast<size_t>(1), result[1].value());
+            Assert::IsFalse(result[2].has_value());
+        }
+
+        TEST_METHOD(AssignMinCost_MoreRowsThanColumns)
+        {
+            // Arrange
+            std::vector<std::vector<std::optional<int64_t>>> costs{
+                { 7 },
+                { 4 },
+                { 9 },
+            };
+
+            // Act
+            const auto result = Utils::AssignMinCost(costs);
+
+            // Assert
+            Assert::IsFalse(result[0].has_value());
+            Assert::AreEqual(static_cast<size_t>(0), result[1].value());
+            Assert::IsFalse(result[2].has_value());
+        }
+
+        TEST_METHOD(AssignMinCost_MatchesBruteForce)
+        {
+            // Arrange
+            uint32_t seed = 12345;
+            auto next = [&seed]() {
+                seed = seed * 1103515245 + 12345;
+                return (seed >> 16) & 0x7FFF;
+            };
+
+            for (int iteration = 0; iteration < 500; iteration++)
+            {
+                const size_t rows = next() % 5;
+                const size_t columns = next() % 5;
+                std::vector<std::vector<std::optional<int64_t>>> costs(rows, std::vector<std::optional<int64_t>>(columns));
+                for (auto& row : costs)
+                {
+                    for (auto& cost : row)
+                    {
+                        if (next() % 3 != 0)
+                        {
+                            cost = static_cast<int64_t>(next() % 20000);
+                        }
+                    }
+                }
+
+                // Act
+                const auto result = Utils::AssignMinCost(costs);
+
+                // Assert
+                std::vector<bool> used(columns, false);
+                int pairs = 0;
+                int64_t total = 0;
+                for (size_t row = 0; row < rows; row++)
+                {
+                    if (result[row].has_value())
+                    {
+                        const size_t column = result[row].value();
+                        Assert::IsFalse(used[column]);
+                        Assert::IsTrue(costs[row][column].has_value());
+                        used[column] = true;
+                        pairs++;
+                        total += costs[row][column].value();
+                    }
+                }
+
+                int bestPairs = 0;
+                int64_t bestTotal = 0;
+                std::vector<bool> taken(columns, false);
+                auto search = [&](auto& self, size_t row, int currentPairs, int64_t currentTotal) -> void {
+                    if (row == rows)
+                    {
+                        if (currentPairs > bestPairs || (currentPairs == bestPairs && currentTotal < bestTotal))
+                        {
+                            bestPairs = currentPairs;
+                            bestTotal = currentTotal;
+                        }
+                        return;
+                    }
+
+                    self(self, row + 1, currentPairs, currentTotal);
+                    for (size_t column = 0; column < columns; column++)
+                    {
+                        if (!taken[column] && costs[row][column].has_value())
+                        {
+                            taken[column] = true;
+                            self(self, row + 1, currentPairs + 1, currentTotal + costs[row][column].value());
+                            taken[column] = false;
+                        }
+                    }
+                };
+                search(search, 0, 0, 0);
+
+                Assert::AreEqual(bestPairs, pairs);
+                Assert::AreEqual(bestTotal, total);
+            }
+        }
+    };
+}
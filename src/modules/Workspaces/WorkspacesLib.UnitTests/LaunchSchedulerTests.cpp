@@ -0,0 +1,205 @@
+#include "pch.h"
+#include <WorkspacesLib/LaunchScheduler.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std::chrono_literals;
+
+namespace WorkspacesLibUnitTests
+{
+    // Launches apps without starting anything: a launch takes launchTime, and
+    // the window of a launched app appears windowTime later, unless it's std::nullopt
+    class SimulatedLauncher
+    {
+    public:
+        struct App
+        {
+            std::chrono::milliseconds launchTime{ 0 };
+            std::optional<std::chrono::milliseconds> windowTime{ 0ms };
+            bool fails = false;
+        };
+
+        SimulatedLauncher(Utils::LaunchScheduler& scheduler, std::vector<App> apps) :
+            m_scheduler(scheduler), m_apps(std::move(apps))
+        {
+        }
+
+        ~SimulatedLauncher()
+        {
+            for (auto& thread : m_windowThreads)
+            {
+                thread.join();
+            }
+        }
+
+        bool Launch(size_t index)
+        {
+            const auto& app = m_apps[index];
+            const int running = ++m_running;
+            int maxRunning = m_maxRunning;
+            while (running > maxRunning && !m_maxRunning.compare_exchange_weak(maxRunning, running))
+            {
+            }
+
+            std::this_thread::sleep_for(app.launchTime);
+            m_launched++;
+            m_running--;
+
+            if (app.fails)
+            {
+                return false;
+            }
+
+            if (app.windowTime.has_value())
+            {
+                std::lock_guard lock(m_mutex);
+                m_windowThreads.emplace_back([this, index, windowTime = app.windowTime.value()]() {
+                    std::this_thread::sleep_for(windowTime);
+                    m_scheduler.WindowAppeared(index);
+                });
+            }
+
+            return true;
+        }
+
+        int MaxRunning() const
+        {
+            return m_maxRunning;
+        }
+
+        int Launched() const
+        {
+            return m_launched;
+        }
+
+    private:
+        Utils::LaunchScheduler& m_scheduler;
+        std::vector<App> m_apps;
+        std::atomic<int> m_running{ 0 };
+        std::atomic<int> m_maxRunning{ 0 };
+        std::atomic<int> m_launched{ 0 };
+        std::mutex m_mutex;
+        std::vector<std::thread> m_windowThreads;
+    };
+
+    TEST_CLASS(LaunchSchedulerTests)
+    {
+    public:
+        TEST_METHOD(IndependentApps_LaunchConcurrently)
+        {
+            // Arrange
+            Utils::LaunchScheduler scheduler(std::vector<std::vector<size_t>>(4), { .parallelism = 4 });
+            SimulatedLauncher launcher(scheduler, std::vector<SimulatedLauncher::App>(4, { .launchTime = 200ms }));
+
+            // Act
+            const auto start = std::chrono::steady_clock::now();
+            scheduler.Run([&](size_t index) { return launcher.Launch(index); });
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            // Assert
+            Assert::AreEqual(4, launcher.Launched());
+            Assert::AreEqual(4, launcher.MaxRunning());
+            Assert::IsTrue(elapsed < 600ms);
+        }
+
+        TEST_METHOD(Parallelism_LimitsConcurrentLaunches)
+        {
+            // Arrange
+            Utils::LaunchScheduler scheduler(std::vector<std::vector<size_t>>(6), { .parallelism = 2 });
+            SimulatedLauncher launcher(scheduler, std::vector<SimulatedLauncher::App>(6, { .launchTime = 50ms }));
+
+            // Act
+            scheduler.Run([&](size_t index) { return launcher.Launch(index); });
+
+            // Assert
+            Assert::AreEqual(6, launcher.Launched());
+            Assert::AreEqual(2, launcher.MaxRunning());
+        }
+
+        TEST_METHOD(Dependency_WaitsForWindowAndDelay)
+        {
+            // Arrange
+            Utils::LaunchScheduler scheduler({ {}, { 0 } }, { .parallelism = 4, .windowTimeout = 10s, .dependencyDelay = 100ms });
+            SimulatedLauncher launcher(scheduler, { { .windowTime = 200ms }, { .windowTime = 0ms } });
+
+            // Act
+            scheduler.Run([&](size_t index) { return launcher.Launch(index); });
+            const auto timings = scheduler.Timings();
+
+            // Assert
+            Assert::IsTrue(timings[0].windowAppeared.has_value());
+            Assert::IsTrue(timings[1].started.value() >= timings[0].windowAppeared.value() + 100ms);
+            Assert::IsTrue(timings[1].started.value() < 5s);
+        }
+
+        TEST_METHOD(Dependency_WindowNeverAppears_WaitsForTimeout)
+        {
+            // Arrange
+            Utils::LaunchScheduler scheduler({ {}, { 0 } }, { .parallelism = 4, .windowTimeout = 200ms, .dependencyDelay = 50ms });
+            SimulatedLauncher launcher(scheduler, { { .windowTime = std::nullopt }, { .windowTime = std::nullopt } });
+
+            // Act
+            scheduler.Run([&](size_t index) { return launcher.Launch(index); });
+            const auto timings = scheduler.Timings();
+
+            // Assert
+            Assert::AreEqual(2, launcher.Launched());
+            Assert::IsTrue(timings[1].started.value() >= timings[0].launched.value() + 250ms);
+        }
+
+        TEST_METHOD(Dependency_FailedLaunch_IsNotWaitedFor)
+        {
+            // Arrange
+            Utils::LaunchScheduler scheduler({ {}, { 0 } }, { .parallelism = 4, .windowTimeout = 10s, .dependencyDelay = 10s });
+            SimulatedLauncher launcher(scheduler, { { .fails = true }, {} });
+
+            // Act
+            const auto start = std::chrono::steady_clock::now();
+            scheduler.Run([&](size_t index) { return launcher.Launch(index); });
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            // Assert
+            Assert::AreEqual(2, launcher.Launched());
+            Assert::IsTrue(elapsed < 5s);
+        }
+
+        TEST_METHOD(Dependency_OnlyDependentAppsWait)
+        {
+            // Arrange
+            Utils::LaunchScheduler scheduler({ {}, { 0 }, {} }, { .parallelism = 1, .windowTimeout = 10s, .dependencyDelay = 0ms });
+            SimulatedLauncher launcher(scheduler, { { .windowTime = 300ms }, {}, {} });
+
+            // Act
+            scheduler.Run([&](size_t index) { return launcher.Launch(index); });
+            const auto timings = scheduler.Timings();
+
+            // Assert
+            Assert::IsTrue(timings[2].started.value() < timings[1].started.value());
+        }
+
+        TEST_METHOD(Cancel_SkipsWaitingApps)
+        {
+            // Arrange
+            Utils::LaunchScheduler scheduler({ {}, { 0 } }, { .parallelism = 4, .windowTimeout = 10s, .dependencyDelay = 0ms });
+            SimulatedLauncher launcher(scheduler, { { .windowTime = std::nullopt }, {} });
+            std::thread canceler([&]() {
+                std::this_thread::sleep_for(100ms);
+                scheduler.Cancel();
+            });
+
+            // Act
+            const auto start = std::chrono::steady_clock::now();
+            scheduler.Run([&](size_t index) { return launcher.Launch(index); });
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            canceler.join();
+
+            // Assert
+            Assert::AreEqual(1, launcher.Launched());
+            Assert::IsFalse(scheduler.Timings()[1].started.has_value());
+            Assert::IsTrue(elapsed < 5s);
+        }
+    };
+}
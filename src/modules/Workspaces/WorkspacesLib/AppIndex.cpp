@@ -0,0 +1,78 @@
+#include "pch.h"
+#include "AppIndex.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <filesystem>
+
+namespace Utils
+{
+    namespace Apps
+    {
+        namespace
+        {
+            std::wstring ToUpper(std::wstring value)
+            {
+                std::transform(value.begin(), value.end(), value.begin(), towupper);
+                return value;
+            }
+        }
+
+        AppIndex::AppIndex(AppList apps) :
+            m_apps(std::move(apps))
+        {
+            std::vector<std::wstring> installPaths;
+            installPaths.reserve(m_apps.size());
+            for (uint32_t i = 0; i < m_apps.size(); i++)
+            {
+                const auto& appData = m_apps[i];
+                m_firstByName.try_emplace(ToUpper(appData.name), i);
+                installPaths.push_back(ToUpper(appData.installPath));
+
+                if (!appData.installPath.empty())
+                {
+                    const std::filesystem::path installPath(appData.installPath);
+                    m_lastByFilename.insert_or_assign(installPath.filename().wstring(), i);
+                    m_firstByInstallFolder.try_emplace(ToUpper(installPath.parent_path().wstring()), i);
+                }
+            }
+
+            m_installPaths = aho_corasick(installPaths);
+        }
+
+        const AppList& AppIndex::Apps() const noexcept
+        {
+            return m_apps;
+        }
+
+        const AppData* AppIndex::FindInstallPathIn(std::wstring_view pathUpper) const
+        {
+            // Apps without an install path have an empty pattern, which never matches.
+            // Several install paths can be part of the path, the first app wins.
+            uint32_t first = UINT32_MAX;
+            m_installPaths.for_each_match(pathUpper, [&first](uint32_t app, size_t) {
+                first = (std::min)(first, app);
+            });
+
+            return first != UINT32_MAX ? &m_apps[first] : nullptr;
+        }
+
+        const AppData* AppIndex::FindLastByFilename(const std::wstring& filename) const
+        {
+            const auto found = m_lastByFilename.find(filename);
+            return found != m_lastByFilename.end() ? &m_apps[found->second] : nullptr;
+        }
+
+        const AppData* AppIndex::FindByName(const std::wstring& nameUpper) const
+        {
+            const auto found = m_firstByName.find(nameUpper);
+            return found != m_firstByName.end() ? &m_apps[found->second] : nullptr;
+        }
+
+        const AppData* AppIndex::FindByInstallFolder(const std::wstring& folderUpper) const
+        {
+            const auto found = m_firstByInstallFolder.find(folderUpper);
+            return found != m_firstByInstallFolder.end() ? &m_apps[found->second] : nullptr;
+        }
+    }
+}
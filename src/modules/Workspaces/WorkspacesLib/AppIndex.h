@@ -0,0 +1,50 @@
+#pragma once
+
+#include <common/utils/aho_corasick.h>
+#include <WorkspacesLib/AppUtils.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Utils
+{
+    namespace Apps
+    {
+        // The installed apps with the lookups GetApp needs. The keys are
+        // uppercased once when the index is built, so a lookup doesn't depend on
+        // the number of apps. Build it once per apps list.
+        class AppIndex
+        {
+        public:
+            explicit AppIndex(AppList apps);
+
+            const AppList& Apps() const noexcept;
+
+            // The first app with an install path that is part of the path.
+            // pathUpper must be uppercase.
+            const AppData* FindInstallPathIn(std::wstring_view pathUpper) const;
+
+            // The last app with an install path that has this file name
+            const AppData* FindLastByFilename(const std::wstring& filename) const;
+
+            // The first app with this name. nameUpper must be uppercase.
+            const AppData* FindByName(const std::wstring& nameUpper) const;
+
+            // The first app with an install path in this folder. folderUpper must be uppercase.
+            const AppData* FindByInstallFolder(const std::wstring& folderUpper) const;
+
+        private:
+            AppList m_apps;
+
+            // Over the uppercase install paths, numbered like the apps
+            aho_corasick m_installPaths;
+
+            std::unordered_map<std::wstring, uint32_t> m_lastByFilename;
+            std::unordered_map<std::wstring, uint32_t> m_firstByName;
+            std::unordered_map<std::wstring, uint32_t> m_firstByInstallFolder;
+        };
+    }
+}
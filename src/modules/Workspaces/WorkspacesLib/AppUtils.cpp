@@ -1,5 +1,7 @@
 #include "pch.h"
 #include "AppUtils.h"
+#include "AppIndex.h"
+#include "AppsCache.h"
 #include "SteamHelper.h"
 
 #include <atlbase.h>
@@ -218,7 +220,8 @@ namespace Utils
 
         AppList GetAppsList()
         {
-            return IterateAppsFolder();
+            static AppsCache cache(WorkspacesData::AppsCacheFile(), std::make_unique<AppsFolderSource>());
+            return cache.GetApps();
         }
 
         DWORD GetParentPid(DWORD pid)
@@ -243,7 +246,7 @@ namespace Utils
             return res;
         }
 
-        std::optional<AppData> GetApp(const std::wstring& appPath, DWORD pid, const AppList& apps)
+        std::optional<AppData> GetApp(const std::wstring& appPath, DWORD pid, const AppIndex& apps)
         {
             std::wstring appPathUpper(appPath);
             std::transform(appPathUpper.begin(), appPathUpper.end(), appPathUpper.begin(), towupper);
@@ -283,40 +286,27 @@ namespace Utils
             }
 
             // search in apps list
-            std::optional<AppData> appDataPlanB{ std::nullopt };
-            for (const auto& appData : apps)
+            if (const auto appData = apps.FindInstallPathIn(appPathUpper))
             {
-                if (!appData.installPath.empty())
+                // Update the install path to keep .exe in the path
+                std::wstring installPathUpper(appData->installPath);
+                std::transform(installPathUpper.begin(), installPathUpper.end(), installPathUpper.begin(), towupper);
+                if (!installPathUpper.ends_with(NonLocalizable::Exe))
                 {
-                    std::wstring installPathUpper(appData.installPath);
-                    std::transform(installPathUpper.begin(), installPathUpper.end(), installPathUpper.begin(), towupper);
-
-                    if (appPathUpper.contains(installPathUpper))
-                    {
-                        // Update the install path to keep .exe in the path
-                        if (!installPathUpper.ends_with(NonLocalizable::Exe))
-                        {
-                            auto settingsAppData = appData;
-                            settingsAppData.installPath = appPath;
-                            return settingsAppData;
-                        }
-
-                        return appData;
-                    }
-
-                    // edge case, some apps (e.g., Gitkraken) have different .exe files in the subfolders.
-                    // apps list contains only one path, so in this case app is not found
-                    // remember the match and return it in case the loop is over and there are no direct matches
-                    if (std::filesystem::path(appPath).filename() == std::filesystem::path(appData.installPath).filename())
-                    {
-                        appDataPlanB = appData;
-                    }
+                    auto settingsAppData = *appData;
+                    settingsAppData.installPath = appPath;
+                    return settingsAppData;
                 }
+
+                return *appData;
             }
 
-            if (appDataPlanB.has_value())
+            // edge case, some apps (e.g., Gitkraken) have different .exe files in the subfolders.
+            // apps list contains only one path, so in this case app is not found
+            // use the last app with the same file name, if any
+            if (const auto appData = apps.FindLastByFilename(std::filesystem::path(appPath).filename().wstring()))
             {
-                return appDataPlanB.value();
+                return *appData;
             }
 
             // try by name if path not found
@@ -325,17 +315,11 @@ namespace Utils
             std::wstring exeNameUpper(exeName);
             std::transform(exeNameUpper.begin(), exeNameUpper.end(), exeNameUpper.begin(), towupper);
 
-            for (const auto& appData : apps)
+            if (const auto appData = apps.FindByName(exeNameUpper))
             {
-                std::wstring appNameUpper(appData.name);
-                std::transform(appNameUpper.begin(), appNameUpper.end(), appNameUpper.begin(), towupper);
-
-                if (appNameUpper == exeNameUpper)
-                {
-                    auto result = appData;
-                    result.installPath = appPath;
-                    return result;
-                }
+                auto result = *appData;
+                result.installPath = appPath;
+                return result;
             }
 
             // try with parent process (fix for Steam)
@@ -351,18 +335,9 @@ namespace Utils
                 {
                     Logger::info(L"original process is in the subfolder of the parent process");
 
-                    for (const auto& appData : apps)
+                    if (const auto appData = apps.FindByInstallFolder(parentDirUpper))
                     {
-                        if (!appData.installPath.empty())
-                        {
-                            std::wstring installDirUpper = std::filesystem::path(appData.installPath).parent_path().c_str();
-                            std::transform(installDirUpper.begin(), installDirUpper.end(), installDirUpper.begin(), towupper);
-
-                            if (installDirUpper == parentDirUpper)
-                            {
-                                return appData;
-                            }
-                        }
+                        return *appData;
                     }
                 }
             }
@@ -373,7 +348,7 @@ namespace Utils
             };
         }
 
-        std::optional<AppData> GetApp(HWND window, const AppList& apps)
+        std::optional<AppData> GetApp(HWND window, const AppIndex& apps)
         {
             std::wstring processPath = get_process_path(window);
 
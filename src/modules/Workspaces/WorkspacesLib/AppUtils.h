@@ -23,12 +23,18 @@ namespace Utils
 
         using AppList = std::vector<AppData>;
 
+        class AppIndex;
+
         const std::wstring& GetCurrentFolder();
         const std::wstring& GetCurrentFolderUpper();
 
+        // Enumerates the shell's Apps folder
+        AppList IterateAppsFolder();
+
+        // The installed apps, from the cache if it has them
         AppList GetAppsList();
-        std::optional<AppData> GetApp(const std::wstring& appPath, DWORD pid, const AppList& apps);
-        std::optional<AppData> GetApp(HWND window, const AppList& apps);
+        std::optional<AppData> GetApp(const std::wstring& appPath, DWORD pid, const AppIndex& apps);
+        std::optional<AppData> GetApp(HWND window, const AppIndex& apps);
 
         bool UpdateAppVersion(WorkspacesData::WorkspacesProject::Application& app, const AppList& installedApps);
         bool UpdateWorkspacesApps(WorkspacesData::WorkspacesProject& workspace, const AppList& installedApps);
@@ -0,0 +1,390 @@
+#include "pch.h"
+#include "AppsCache.h"
+
+#include <ShlObj.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <common/logger/logger.h>
+#include <common/utils/winapi_error.h>
+
+namespace Utils
+{
+    namespace Apps
+    {
+        namespace NonLocalizable
+        {
+            constexpr const wchar_t* UserPackagesKey = L"Software\\Classes\\Local Settings\\Software\\Microsoft\\Windows\\CurrentVersion\\AppModel\\Repository\\Packages";
+            constexpr const wchar_t* AllUserPackagesKey = L"SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Appx\\AppxAllUserStore";
+
+            constexpr char CacheMagic[4] = { 'W', 'S', 'A', 'C' };
+            constexpr uint32_t CacheVersion = 1;
+        }
+
+        namespace
+        {
+            // FNV-1a over everything that's added
+            class StampBuilder
+            {
+            public:
+                void Add(const void* data, size_t size)
+                {
+                    const auto bytes = static_cast<const unsigned char*>(data);
+                    for (size_t i = 0; i < size; i++)
+                    {
+                        m_stamp = (m_stamp ^ bytes[i]) * 1099511628211ull;
+                    }
+                }
+
+                template<typename T>
+                void Add(const T& value)
+                {
+                    Add(&value, sizeof(value));
+                }
+
+                uint64_t Get() const
+                {
+                    return m_stamp;
+                }
+
+            private:
+                uint64_t m_stamp = 14695981039346656037ull;
+            };
+
+            // Adding or removing a package adds or removes a subkey, which
+            // updates the key's last write time
+            void AddRegistryKey(StampBuilder& stamp, HKEY root, const wchar_t* path)
+            {
+                HKEY key{};
+                if (RegOpenKeyExW(root, path, 0, KEY_QUERY_VALUE, &key) != ERROR_SUCCESS)
+                {
+                    stamp.Add(0);
+                    return;
+                }
+
+                DWORD subKeys = 0;
+                FILETIME lastWriteTime{};
+                if (RegQueryInfoKeyW(key, nullptr, nullptr, nullptr, &subKeys, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &lastWriteTime) == ERROR_SUCCESS)
+                {
+                    stamp.Add(subKeys);
+                    stamp.Add(lastWriteTime);
+                }
+
+                RegCloseKey(key);
+            }
+
+            // Shortcuts in the Start menu folders are the Apps folder's unpackaged apps
+            void AddFolderTree(StampBuilder& stamp, const std::wstring& folder)
+            {
+                WIN32_FIND_DATAW data{};
+                HANDLE find = FindFirstFileExW((folder + L"\\*").c_str(), FindExInfoBasic, &data, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+                if (find == INVALID_HANDLE_VALUE)
+                {
+                    return;
+                }
+
+                do
+                {
+                    const std::wstring_view name = data.cFileName;
+                    if (name == L"." || name == L"..")
+                    {
+                        continue;
+                    }
+
+                    stamp.Add(name.data(), name.size() * sizeof(wchar_t));
+                    stamp.Add(data.ftLastWriteTime);
+                    stamp.Add(data.nFileSizeLow);
+
+                    if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && !(data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+                    {
+                        AddFolderTree(stamp, folder + L"\\" + std::wstring(name));
+                    }
+                } while (FindNextFileW(find, &data));
+
+                FindClose(find);
+            }
+
+            void AddKnownFolderTree(StampBuilder& stamp, REFKNOWNFOLDERID folderId)
+            {
+                PWSTR path = nullptr;
+                if (SUCCEEDED(SHGetKnownFolderPath(folderId, KF_FLAG_DEFAULT, nullptr, &path)))
+                {
+                    AddFolderTree(stamp, path);
+                }
+
+                CoTaskMemFree(path);
+            }
+
+            void WriteValue(std::string& data, const void* value, size_t size)
+            {
+                data.append(static_cast<const char*>(value), size);
+            }
+
+            template<typename T>
+            void WriteValue(std::string& data, const T& value)
+            {
+                WriteValue(data, &value, sizeof(value));
+            }
+
+            void WriteString(std::string& data, const std::wstring& value)
+            {
+                WriteValue(data, static_cast<uint32_t>(value.size()));
+                WriteValue(data, value.data(), value.size() * sizeof(wchar_t));
+            }
+
+            class Reader
+            {
+            public:
+                explicit Reader(std::string_view data) :
+                    m_data(data)
+                {
+                }
+
+                bool Read(void* value, size_t size)
+                {
+                    if (m_data.size() - m_position < size)
+                    {
+                        return false;
+                    }
+
+                    std::memcpy(value, m_data.data() + m_position, size);
+                    m_position += size;
+                    return true;
+                }
+
+                template<typename T>
+                bool Read(T& value)
+                {
+                    return Read(&value, sizeof(value));
+                }
+
+                bool ReadString(std::wstring& value)
+                {
+                    uint32_t length = 0;
+                    if (!Read(length) || (m_data.size() - m_position) / sizeof(wchar_t) < length)
+                    {
+                        return false;
+                    }
+
+                    value.resize(length);
+                    return Read(value.data(), length * sizeof(wchar_t));
+                }
+
+                bool AtEnd() const
+                {
+                    return m_position == m_data.size();
+                }
+
+            private:
+                std::string_view m_data;
+                size_t m_position = 0;
+            };
+        }
+
+        AppList AppsFolderSource::GetApps()
+        {
+            // Also called on the refresh thread, which has no apartment of its own
+            const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+            auto apps = IterateAppsFolder();
+            if (SUCCEEDED(hr))
+            {
+                CoUninitialize();
+            }
+
+            return apps;
+        }
+
+        uint64_t AppsFolderSource::GetStamp()
+        {
+            StampBuilder stamp;
+            AddRegistryKey(stamp, HKEY_CURRENT_USER, NonLocalizable::UserPackagesKey);
+            AddRegistryKey(stamp, HKEY_LOCAL_MACHINE, NonLocalizable::AllUserPackagesKey);
+            AddKnownFolderTree(stamp, FOLDERID_Programs);
+            AddKnownFolderTree(stamp, FOLDERID_CommonPrograms);
+            return stamp.Get();
+        }
+
+        std::string SerializeAppsCache(const CachedApps& cache)
+        {
+            std::string data;
+            WriteValue(data, NonLocalizable::CacheMagic, sizeof(NonLocalizable::CacheMagic));
+            WriteValue(data, NonLocalizable::CacheVersion);
+            WriteValue(data, cache.stamp);
+            WriteValue(data, static_cast<uint32_t>(cache.apps.size()));
+
+            for (const auto& app : cache.apps)
+            {
+                WriteString(data, app.name);
+                WriteString(data, app.installPath);
+                WriteString(data, app.packageFullName);
+                WriteString(data, app.appUserModelId);
+                WriteString(data, app.pwaAppId);
+                WriteString(data, app.protocolPath);
+                WriteValue(data, static_cast<uint8_t>(app.canLaunchElevated));
+            }
+
+            return data;
+        }
+
+        std::optional<CachedApps> DeserializeAppsCache(std::string_view data)
+        {
+            Reader reader(data);
+
+            char magic[sizeof(NonLocalizable::CacheMagic)]{};
+            uint32_t version = 0;
+            uint32_t count = 0;
+            CachedApps cache;
+            if (!reader.Read(magic, sizeof(magic)) ||
+                std::memcmp(magic, NonLocalizable::CacheMagic, sizeof(magic)) != 0 ||
+                !reader.Read(version) ||
+                version != NonLocalizable::CacheVersion ||
+                !reader.Read(cache.stamp) ||
+                !reader.Read(count))
+            {
+                return std::nullopt;
+            }
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                AppData app;
+                uint8_t canLaunchElevated = 0;
+                if (!reader.ReadString(app.name) ||
+                    !reader.ReadString(app.installPath) ||
+                    !reader.ReadString(app.packageFullName) ||
+                    !reader.ReadString(app.appUserModelId) ||
+                    !reader.ReadString(app.pwaAppId) ||
+                    !reader.ReadString(app.protocolPath) ||
+                    !reader.Read(canLaunchElevated))
+                {
+                    return std::nullopt;
+                }
+
+                app.canLaunchElevated = canLaunchElevated != 0;
+                cache.apps.push_back(std::move(app));
+            }
+
+            if (!reader.AtEnd())
+            {
+                return std::nullopt;
+            }
+
+            return cache;
+        }
+
+        AppsCache::AppsCache(std::wstring cacheFile, std::unique_ptr<AppSource> source) :
+            m_cacheFile(std::move(cacheFile)),
+            m_source(std::move(source))
+        {
+        }
+
+        AppsCache::~AppsCache()
+        {
+            WaitForRefresh();
+        }
+
+        AppList AppsCache::GetApps()
+        {
+            std::unique_lock lock(m_mutex);
+            if (m_apps.has_value())
+            {
+                return *m_apps;
+            }
+
+            const uint64_t stamp = m_source->GetStamp();
+            auto cache = Load();
+            if (!cache.has_value())
+            {
+                Logger::info(L"No installed apps cache, enumerating apps");
+                m_apps = Refresh(stamp);
+            }
+            else if (cache->stamp == stamp)
+            {
+                m_apps = std::move(cache->apps);
+            }
+            else
+            {
+                Logger::info(L"Installed apps changed, refreshing the cache in the background");
+                m_apps = std::move(cache->apps);
+                m_refreshThread = std::thread([this, stamp] {
+                    auto apps = Refresh(stamp);
+                    std::unique_lock lock(m_mutex);
+                    m_apps = std::move(apps);
+                });
+            }
+
+            return *m_apps;
+        }
+
+        void AppsCache::WaitForRefresh()
+        {
+            std::thread refreshThread;
+            {
+                std::unique_lock lock(m_mutex);
+                refreshThread = std::move(m_refreshThread);
+            }
+
+            if (refreshThread.joinable())
+            {
+                refreshThread.join();
+            }
+        }
+
+        AppList AppsCache::Refresh(uint64_t stamp)
+        {
+            CachedApps cache{ .stamp = stamp, .apps = m_source->GetApps() };
+
+            // An empty list usually means the enumeration failed, which shouldn't stick
+            if (!cache.apps.empty())
+            {
+                Save(cache);
+            }
+
+            return std::move(cache.apps);
+        }
+
+        std::optional<CachedApps> AppsCache::Load() const
+        {
+            std::ifstream file(m_cacheFile, std::ios::binary);
+            if (!file)
+            {
+                return std::nullopt;
+            }
+
+            const std::string data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+            auto cache = DeserializeAppsCache(data);
+            if (!cache.has_value())
+            {
+                Logger::warn(L"Installed apps cache is invalid");
+            }
+
+            return cache;
+        }
+
+        void AppsCache::Save(const CachedApps& cache) const
+        {
+            // Written next to the cache and moved over it, so other processes
+            // never read a partial file
+            const std::wstring tempFile = m_cacheFile + L"." + std::to_wstring(GetCurrentProcessId()) + L".tmp";
+            {
+                std::ofstream file(tempFile, std::ios::binary | std::ios::trunc);
+                const auto data = SerializeAppsCache(cache);
+                file.write(data.data(), data.size());
+                if (!file)
+                {
+                    Logger::error(L"Failed to write installed apps cache");
+                    file.close();
+                    DeleteFileW(tempFile.c_str());
+                    return;
+                }
+            }
+
+            if (!MoveFileExW(tempFile.c_str(), m_cacheFile.c_str(), MOVEFILE_REPLACE_EXISTING))
+            {
+                Logger::error(L"Failed to replace installed apps cache: {}", get_last_error_or_default(GetLastError()));
+                DeleteFileW(tempFile.c_str());
+            }
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <WorkspacesLib/AppUtils.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace Utils
+{
+    namespace Apps
+    {
+        // Where the installed apps come from
+        class AppSource
+        {
+        public:
+            virtual ~AppSource() = default;
+
+            // Enumerates the installed apps. Can take seconds.
+            virtual AppList GetApps() = 0;
+
+            // A value that changes whenever the installed apps may have changed. Cheap.
+            virtual uint64_t GetStamp() = 0;
+        };
+
+        // The apps of the shell's Apps folder. The stamp covers the package
+        // repository and the Start menu folders, which the Apps folder is built from.
+        class AppsFolderSource : public AppSource
+        {
+        public:
+            AppList GetApps() override;
+            uint64_t GetStamp() override;
+        };
+
+        struct CachedApps
+        {
+            uint64_t stamp = 0;
+            AppList apps;
+        };
+
+        std::string SerializeAppsCache(const CachedApps& cache);
+
+        // Returns std::nullopt if the data isn't a complete cache of this version
+        std::optional<CachedApps> DeserializeAppsCache(std::string_view data);
+
+        // Keeps the installed apps in a file, so that they don't have to be
+        // enumerated every time they're needed.
+        class AppsCache
+        {
+        public:
+            AppsCache(std::wstring cacheFile, std::unique_ptr<AppSource> source);
+
+            // Waits for a background refresh, so its result is saved
+            ~AppsCache();
+
+            AppsCache(const AppsCache&) = delete;
+            AppsCache& operator=(const AppsCache&) = delete;
+
+            // Returns the cached apps right away if there are any. If they're
+            // outdated, they're refreshed in the background and later calls
+            // return the refreshed list. Without a cache, enumerates the apps.
+            AppList GetApps();
+
+            // Waits until a background refresh, if any, is over
+            void WaitForRefresh();
+
+        private:
+            // Enumerates the apps and saves them with the stamp taken before
+            AppList Refresh(uint64_t stamp);
+
+            std::optional<CachedApps> Load() const;
+            void Save(const CachedApps& cache) const;
+
+            const std::wstring m_cacheFile;
+            const std::unique_ptr<AppSource> m_source;
+
+            std::mutex m_mutex;
+            std::optional<AppList> m_apps;
+            std::thread m_refreshThread;
+        };
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace Utils
+{
+    // Assigns each row at most one column, and each column at most one row.
+    // costs[row][column] is the cost of the pair, or std::nullopt if the pair
+    // isn't allowed. The assignment has as many pairs as possible, and among
+    // those the lowest total cost. Returns the column of every row.
+    //
+    // Solved with the Hungarian algorithm, where every row also gets a column
+    // of its own for staying unassigned, which costs more than all allowed
+    // pairs together. O(rows^2 * (rows + columns)).
+    inline std::vector<std::optional<size_t>> AssignMinCost(const std::vector<std::vector<std::optional<int64_t>>>& costs)
+    {
+        const size_t rows = costs.size();
+        const size_t columns = rows > 0 ? costs[0].size() : 0;
+
+        int64_t unassignedCost = 1;
+        for (const auto& row : costs)
+        {
+            int64_t rowMax = 0;
+            for (const auto& cost : row)
+            {
+                if (cost.has_value() && *cost > rowMax)
+                {
+                    rowMax = *cost;
+                }
+            }
+            unassignedCost += rowMax;
+        }
+        const int64_t forbiddenCost = unassignedCost + 1;
+
+        // 1-based, column 0 is the algorithm's own
+        const size_t width = columns + rows;
+        auto cost = [&](size_t row, size_t column) -> int64_t {
+            if (column > columns)
+            {
+                return unassignedCost;
+            }
+            const auto& value = costs[row - 1][column - 1];
+            return value.has_value() ? *value : forbiddenCost;
+        };
+
+        constexpr int64_t infinity = (std::numeric_limits<int64_t>::max)();
+        std::vector<int64_t> rowPotential(rows + 1, 0);
+        std::vector<int64_t> columnPotential(width + 1, 0);
+        std::vector<size_t> columnRow(width + 1, 0);
+        std::vector<size_t> way(width + 1, 0);
+
+        for (size_t row = 1; row <= rows; row++)
+        {
+            columnRow[0] = row;
+            size_t column = 0;
+            std::vector<int64_t> minimum(width + 1, infinity);
+            std::vector<bool> used(width + 1, false);
+
+            // Grows an alternating tree from the row until it reaches a free column
+            do
+            {
+                used[column] = true;
+                const size_t currentRow = columnRow[column];
+                int64_t delta = infinity;
+                size_t nextColumn = 0;
+                for (size_t j = 1; j <= width; j++)
+                {
+                    if (!used[j])
+                    {
+                        const int64_t reduced = cost(currentRow, j) - rowPotential[currentRow] - columnPotential[j];
+                        if (reduced < minimum[j])
+                        {
+                            minimum[j] = reduced;
+                            way[j] = column;
+                        }
+                        if (minimum[j] < delta)
+                        {
+                            delta = minimum[j];
+                            nextColumn = j;
+                        }
+                    }
+                }
+
+                for (size_t j = 0; j <= width; j++)
+                {
+                    if (used[j])
+                    {
+                        rowPotential[columnRow[j]] += delta;
+                        columnPotential[j] -= delta;
+                    }
+                    else
+                    {
+                        minimum[j] -= delta;
+                    }
+                }
+                column = nextColumn;
+            } while (columnRow[column] != 0);
+
+            // Flips the path back to the row
+            do
+            {
+                const size_t previous = way[column];
+                columnRow[column] = columnRow[previous];
+                column = previous;
+            } while (column != 0);
+        }
+
+        std::vector<std::optional<size_t>> result(rows);
+        for (size_t column = 1; column <= columns; column++)
+        {
+            if (columnRow[column] != 0 && costs[columnRow[column] - 1][column - 1].has_value())
+            {
+                result[columnRow[column] - 1] = column - 1;
+            }
+        }
+        return result;
+    }
+}
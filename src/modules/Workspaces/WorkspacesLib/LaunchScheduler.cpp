@@ -0,0 +1,207 @@
+#include "pch.h"
+#include "LaunchScheduler.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace Utils
+{
+    LaunchScheduler::LaunchScheduler(std::vector<std::vector<size_t>> dependencies, Options options) :
+        m_options(options),
+        m_apps(dependencies.size())
+    {
+        for (size_t i = 0; i < dependencies.size(); i++)
+        {
+            m_apps[i].dependencies = std::move(dependencies[i]);
+        }
+    }
+
+    void LaunchScheduler::Run(const std::function<bool(size_t)>& launch)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_start = Clock::now();
+        }
+
+        const size_t threadCount = std::clamp<size_t>(m_options.parallelism, 1, (std::max<size_t>)(m_apps.size(), 1));
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < threadCount; i++)
+        {
+            threads.emplace_back([&]() { Work(launch); });
+        }
+
+        Work(launch);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    void LaunchScheduler::WindowAppeared(size_t index)
+    {
+        std::lock_guard lock(m_mutex);
+        if (index >= m_apps.size())
+        {
+            return;
+        }
+
+        auto& app = m_apps[index];
+        if (!app.windowAppeared.has_value())
+        {
+            app.windowAppeared = Clock::now();
+        }
+
+        // if the launch hasn't returned yet, the app is done when it does
+        if (app.state == State::Launched)
+        {
+            app.state = State::Done;
+        }
+
+        m_condition.notify_all();
+    }
+
+    void LaunchScheduler::Cancel()
+    {
+        std::lock_guard lock(m_mutex);
+        for (auto& app : m_apps)
+        {
+            if (app.state == State::Waiting)
+            {
+                app.state = State::Canceled;
+            }
+        }
+
+        m_condition.notify_all();
+    }
+
+    std::vector<LaunchScheduler::Timing> LaunchScheduler::Timings() const
+    {
+        std::lock_guard lock(m_mutex);
+
+        auto sinceStart = [&](const std::optional<Clock::time_point>& time) -> std::optional<Clock::duration> {
+            if (time.has_value())
+            {
+                return time.value() - m_start;
+            }
+
+            return std::nullopt;
+        };
+
+        std::vector<Timing> timings;
+        timings.reserve(m_apps.size());
+        for (const auto& app : m_apps)
+        {
+            timings.push_back({ sinceStart(app.started), sinceStart(app.launched), sinceStart(app.windowAppeared) });
+        }
+
+        return timings;
+    }
+
+    void LaunchScheduler::Work(const std::function<bool(size_t)>& launch)
+    {
+        std::unique_lock lock(m_mutex);
+        while (true)
+        {
+            const auto now = Clock::now();
+            bool waiting = false;
+            std::optional<size_t> next;
+            std::optional<Clock::time_point> wakeUp;
+
+            // the apps start in their order, as soon as they can
+            for (size_t i = 0; i < m_apps.size() && !next.has_value(); i++)
+            {
+                if (m_apps[i].state != State::Waiting)
+                {
+                    continue;
+                }
+
+                waiting = true;
+                auto readyAt = ReadyAt(m_apps[i]);
+                if (!readyAt.has_value())
+                {
+                    continue;
+                }
+
+                if (readyAt.value() <= now)
+                {
+                    next = i;
+                }
+                else if (!wakeUp.has_value() || readyAt.value() < wakeUp.value())
+                {
+                    wakeUp = readyAt;
+                }
+            }
+
+            if (next.has_value())
+            {
+                auto& app = m_apps[next.value()];
+                app.state = State::Launching;
+                app.started = now;
+
+                lock.unlock();
+                const bool launched = launch(next.value());
+                lock.lock();
+
+                if (launched)
+                {
+                    app.launched = Clock::now();
+                    app.state = app.windowAppeared.has_value() ? State::Done : State::Launched;
+                }
+                else
+                {
+                    app.state = State::Done;
+                }
+
+                m_condition.notify_all();
+            }
+            else if (!waiting)
+            {
+                return;
+            }
+            else if (wakeUp.has_value())
+            {
+                m_condition.wait_until(lock, wakeUp.value());
+            }
+            else
+            {
+                m_condition.wait(lock);
+            }
+        }
+    }
+
+    std::optional<LaunchScheduler::Clock::time_point> LaunchScheduler::ReadyAt(const App& app) const
+    {
+        Clock::time_point readyAt{};
+        for (size_t index : app.dependencies)
+        {
+            if (index >= m_apps.size())
+            {
+                continue;
+            }
+
+            const auto& dependency = m_apps[index];
+            switch (dependency.state)
+            {
+            case State::Waiting:
+            case State::Launching:
+                return std::nullopt;
+            case State::Launched:
+                // the window hasn't appeared yet
+                readyAt = (std::max)(readyAt, dependency.launched.value() + m_options.windowTimeout + m_options.dependencyDelay);
+                break;
+            case State::Done:
+                // apps that failed to launch aren't waited for
+                if (dependency.launched.has_value())
+                {
+                    const auto settled = (std::min)(dependency.windowAppeared.value(), dependency.launched.value() + m_options.windowTimeout);
+                    readyAt = (std::max)(readyAt, settled + m_options.dependencyDelay);
+                }
+                break;
+            case State::Canceled:
+                break;
+            }
+        }
+
+        return readyAt;
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace Utils
+{
+    // Launches apps on several threads. An app only waits for the apps it
+    // depends on, e.g. the previous instance of the same app: until their
+    // windows appear or the timeout expires, and then for the dependency delay.
+    class LaunchScheduler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Options
+        {
+            // How many apps can be launched at the same time
+            size_t parallelism = 4;
+
+            // How long an app waits for the windows of the apps it depends on
+            std::chrono::milliseconds windowTimeout{ 3000 };
+
+            // How long an app waits after the windows of the apps it depends on appeared.
+            // Resolves an issue when Outlook does not launch when launching one after another.
+            // Launching Outlook instances with less than 1-second delay causes the second window not to appear
+            // even though there wasn't a launch error.
+            std::chrono::milliseconds dependencyDelay{ 1000 };
+        };
+
+        // Times since Run was called
+        struct Timing
+        {
+            std::optional<Clock::duration> started;
+            std::optional<Clock::duration> launched;
+            std::optional<Clock::duration> windowAppeared;
+        };
+
+        // dependencies[i] are the indices of the apps app i waits for. They can't depend on app i themselves.
+        LaunchScheduler(std::vector<std::vector<size_t>> dependencies, Options options);
+
+        LaunchScheduler(const LaunchScheduler&) = delete;
+        LaunchScheduler& operator=(const LaunchScheduler&) = delete;
+
+        // Calls launch(i) for every app, from up to options.parallelism threads at once,
+        // and returns when every app was launched or canceled. launch returns whether
+        // the app started; the windows of apps that didn't start aren't waited for.
+        void Run(const std::function<bool(size_t)>& launch);
+
+        // Tells that the window of the app appeared, or that it won't appear
+        void WindowAppeared(size_t index);
+
+        // The apps that haven't started yet won't be launched
+        void Cancel();
+
+        std::vector<Timing> Timings() const;
+
+    private:
+        enum class State
+        {
+            Waiting,
+            Launching,
+            Launched,
+            Done,
+            Canceled,
+        };
+
+        struct App
+        {
+            std::vector<size_t> dependencies;
+            State state = State::Waiting;
+            std::optional<Clock::time_point> started;
+            std::optional<Clock::time_point> launched;
+            std::optional<Clock::time_point> windowAppeared;
+        };
+
+        // Launches apps on the calling thread until none is left
+        void Work(const std::function<bool(size_t)>& launch);
+
+        // When the app can start, or std::nullopt if one of its dependencies hasn't been launched yet
+        std::optional<Clock::time_point> ReadyAt(const App& app) const;
+
+        const Options m_options;
+        std::vector<App> m_apps;
+        Clock::time_point m_start;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_condition;
+    };
+}
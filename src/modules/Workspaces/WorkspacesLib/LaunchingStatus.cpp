@@ -42,24 +42,6 @@ bool LaunchingStatus::AllLaunchedAndMoved() noexcept
     return true;
 }
 
-bool LaunchingStatus::AllInstancesOfTheAppLaunchedAndMoved(const WorkspacesData::WorkspacesProject::Application& application) noexcept
-{
-    std::shared_lock lock(m_mutex);
-
-    for (const auto& [app, state] : m_appsState)
-    {
-        if (app.name == application.name || app.path == application.path)
-        {
-            if (state.state == LaunchingState::Launched)
-            {
-                return false;
-            }
-        }
-    }
-
-    return true;
-}
-
 const WorkspacesData::LaunchingAppStateMap& LaunchingStatus::Get() noexcept
 {
     std::shared_lock lock(m_mutex);
@@ -77,20 +59,6 @@ std::optional<WorkspacesData::LaunchingAppState> LaunchingStatus::Get(const Work
     return std::nullopt;
 }
 
-std::optional<WorkspacesData::LaunchingAppState> LaunchingStatus::GetNext(LaunchingState state) noexcept
-{
-    std::shared_lock lock(m_mutex);
-    for (const auto& [app, appState] : m_appsState)
-    {
-        if (appState.state == state)
-        {
-            return appState;
-        }
-    }
-
-    return std::nullopt;
-}
-
 bool LaunchingStatus::IsWindowProcessed(HWND window) noexcept
 {
     std::shared_lock lock(m_mutex);
@@ -12,11 +12,9 @@ public:
 
     bool AllLaunched() noexcept;
     bool AllLaunchedAndMoved() noexcept;
-    bool AllInstancesOfTheAppLaunchedAndMoved(const WorkspacesData::WorkspacesProject::Application& app) noexcept;
 
     const WorkspacesData::LaunchingAppStateMap& Get() noexcept;
     std::optional<WorkspacesData::LaunchingAppState> Get(const WorkspacesData::WorkspacesProject::Application& app) noexcept;
-    std::optional<WorkspacesData::LaunchingAppState> GetNext(LaunchingState state) noexcept;
     
     bool IsWindowProcessed(HWND window) noexcept;
 
@@ -23,6 +23,12 @@ namespace WorkspacesData
         return settingsFolderPath + L"\\temp-workspaces.json";
     }
 
+    std::wstring AppsCacheFile()
+    {
+        std::wstring settingsFolderPath = PTSettingsHelper::get_module_save_folder_location(NonLocalizable::ModuleKey);
+        return settingsFolderPath + L"\\apps-cache.bin";
+    }
+
     RECT WorkspacesProject::Application::Position::toRect() const noexcept
     {
         return RECT{ .left = x, .top = y, .right = x + width, .bottom = y + height };
@@ -8,6 +8,7 @@ namespace WorkspacesData
 {
     std::wstring WorkspacesFile();
     std::wstring TempWorkspacesFile();
+    std::wstring AppsCacheFile();
 
     struct WorkspacesProject
     {
@@ -9,7 +9,7 @@
 #include <workspaces-common/WindowEnumerator.h>
 #include <workspaces-common/WindowFilter.h>
 
-#include <WorkspacesLib/AppUtils.h>
+#include <WorkspacesLib/AppIndex.h>
 #include <WorkspacesLib/PwaHelper.h>
 #include <WorkspacesLib/WindowUtils.h>
 #include <WindowProperties/WorkspacesWindowPropertyUtils.h>
@@ -48,7 +48,7 @@ namespace SnapshotUtils
         Utils::PwaHelper pwaHelper{};
         std::vector<WorkspacesData::WorkspacesProject::Application> apps{};
 
-        auto installedApps = Utils::Apps::GetAppsList();
+        const Utils::Apps::AppIndex installedApps(Utils::Apps::GetAppsList());
         auto windows = WindowEnumerator::Enumerate(WindowFilter::Filter);
 
         for (const auto window : windows)
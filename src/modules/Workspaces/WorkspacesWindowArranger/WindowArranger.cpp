@@ -12,6 +12,7 @@
 #include <workspaces-common/WindowUtils.h>
 
 #include <WindowProperties/WorkspacesWindowPropertyUtils.h>
+#include <WorkspacesLib/Assignment.h>
 #include <WorkspacesLib/PwaHelper.h>
 #include <WorkspacesLib/WindowUtils.h>
 
@@ -156,19 +157,23 @@ bool WindowArranger::TryMoveWindow(const WorkspacesData::WorkspacesProject::Appl
     return success;
 }
 
-std::optional<WindowWithDistance> WindowArranger::GetNearestWindow(const WorkspacesData::WorkspacesProject::Application& app, const std::vector<HWND>& movedWindows, Utils::PwaHelper& pwaHelper)
+std::vector<WindowWithAppData> WindowArranger::GetWindowsWithAppData(Utils::PwaHelper& pwaHelper) const
 {
-    std::optional<Utils::Apps::AppData> appDataNearest = std::nullopt;
-    WindowWithDistance nearestWindowWithDistance{};
-
+    // Titles are needed for the ApplicationFrameHost fix below, read them only once
+    std::vector<std::pair<DWORD, std::wstring>> pidsAndTitles;
+    pidsAndTitles.reserve(m_windowsBefore.size());
     for (HWND window : m_windowsBefore)
     {
-        if (WindowFilter::FilterPopup(window))
-        {
-            continue;
-        }
+        DWORD pid{};
+        GetWindowThreadProcessId(window, &pid);
+        pidsAndTitles.emplace_back(pid, WindowUtils::GetWindowTitle(window));
+    }
 
-        if (std::find(movedWindows.begin(), movedWindows.end(), window) != movedWindows.end())
+    std::vector<WindowWithAppData> result;
+    for (size_t i = 0; i < m_windowsBefore.size(); i++)
+    {
+        HWND window = m_windowsBefore[i];
+        if (WindowFilter::FilterPopup(window))
         {
             continue;
         }
@@ -179,38 +184,31 @@ std::optional<WindowWithDistance> WindowArranger::GetNearestWindow(const Workspa
             continue;
         }
 
-        DWORD pid{};
-        GetWindowThreadProcessId(window, &pid);
-        std::wstring title = WindowUtils::GetWindowTitle(window);
+        const auto& [pid, title] = pidsAndTitles[i];
 
         // fix for the packaged apps that are not caught when minimized, e.g. Settings, Microsoft ToDo, ...
         if (processPath.ends_with(NonLocalizable::ApplicationFrameHost))
         {
-            for (auto otherWindow : m_windowsBefore)
+            // searching for the window with the same title but different PID
+            const auto other = std::find_if(pidsAndTitles.begin(), pidsAndTitles.end(), [&](const auto& pidAndTitle) {
+                return pid != pidAndTitle.first && title == pidAndTitle.second;
+            });
+            if (other != pidsAndTitles.end())
             {
-                DWORD otherPid{};
-                GetWindowThreadProcessId(otherWindow, &otherPid);
-
-                // searching for the window with the same title but different PID
-                if (pid != otherPid && title == WindowUtils::GetWindowTitle(otherWindow))
-                {
-                    processPath = get_process_path(otherPid);
-                    break;
-                }
+                processPath = get_process_path(other->first);
             }
         }
 
         auto data = Utils::Apps::GetApp(processPath, pid, m_installedApps);
-
-        if (!data->IsSteamGame() && !WindowUtils::HasThickFrame(window))
+        if (!data.has_value())
         {
-            // Only care about steam games if it has no thick frame to remain consistent with
-            // the behavior as before.
             continue;
         }
 
-        if (!data.has_value())
+        if (!data->IsSteamGame() && !WindowUtils::HasThickFrame(window))
         {
+            // Only care about steam games if it has no thick frame to remain consistent with
+            // the behavior as before.
             continue;
         }
 
@@ -243,34 +241,12 @@ std::optional<WindowWithDistance> WindowArranger::GetNearestWindow(const Workspa
             }
         }
 
-        if ((app.name == appData.name || app.path == appData.installPath) && (app.pwaAppId == appData.pwaAppId))
-        {
-            if (!appDataNearest.has_value())
-            {
-                appDataNearest = data;
-                nearestWindowWithDistance.distance = PlacementHelper::CalculateDistance(app, window);
-                nearestWindowWithDistance.window = window;
-            }
-            else
-            {
-                int currentDistance = PlacementHelper::CalculateDistance(app, window);
-                if (currentDistance < nearestWindowWithDistance.distance)
-                {
-                    appDataNearest = data;
-                    nearestWindowWithDistance.distance = currentDistance;
-                    nearestWindowWithDistance.window = window;
-                }
-            }
-        }
-    }
-
-    if (appDataNearest.has_value())
-    {
-        return nearestWindowWithDistance;
+        result.push_back({ window, std::move(appData) });
     }
 
-    return std::nullopt;
+    return result;
 }
+
 WindowArranger::WindowArranger(WorkspacesData::WorkspacesProject project) :
     m_project(project),
     m_windowsBefore(WindowEnumerator::Enumerate(WindowFilter::Filter)),
@@ -282,56 +258,49 @@ WindowArranger::WindowArranger(WorkspacesData::WorkspacesProject project) :
     if (project.moveExistingWindows)
     {
         Logger::info(L"Moving existing windows");
-        bool isMovePhase = true;
-        bool movedAny = false;
-        std::vector<HWND> movedWindows;
-        std::vector<WorkspacesData::WorkspacesProject::Application> movedApps;
         Utils::PwaHelper pwaHelper{};
+        const auto windows = GetWindowsWithAppData(pwaHelper);
 
-        while (isMovePhase)
+        // The distance of every window an app could be moved from
+        std::vector<std::vector<std::optional<int64_t>>> distances(project.apps.size(), std::vector<std::optional<int64_t>>(windows.size()));
+        for (size_t appIndex = 0; appIndex < project.apps.size(); appIndex++)
         {
-            isMovePhase = false;
-            int minDistance = INT_MAX;
-            WorkspacesData::WorkspacesProject::Application appToMove;
-            HWND windowToMove = NULL;
-            for (auto& app : project.apps)
+            const auto& app = project.apps[appIndex];
+            for (size_t windowIndex = 0; windowIndex < windows.size(); windowIndex++)
             {
-                // move the apps which are set to "Move-If-Exists" and are already present (launched, running)
-                if (std::find(movedApps.begin(), movedApps.end(), app) != movedApps.end())
+                const auto& appData = windows[windowIndex].appData;
+                if ((app.name == appData.name || app.path == appData.installPath) && (app.pwaAppId == appData.pwaAppId))
                 {
-                    continue;
+                    distances[appIndex][windowIndex] = PlacementHelper::CalculateDistance(app, windows[windowIndex].window);
                 }
+            }
+        }
 
-                std::optional<WindowWithDistance> nearestWindowWithDistance;
-                nearestWindowWithDistance = GetNearestWindow(app, movedWindows, pwaHelper);
-                if (nearestWindowWithDistance.has_value())
-                {
-                    if (nearestWindowWithDistance.value().distance < minDistance)
-                    {
-                        minDistance = nearestWindowWithDistance.value().distance;
-                        appToMove = app;
-                        windowToMove = nearestWindowWithDistance.value().window;
-                    }
-                }
-                else
-                {
-                    Logger::info(L"The app {} is not found at launch, cannot be moved, has to be started", app.name);
-                    movedApps.push_back(app);
-                }
+        // move the apps which are set to "Move-If-Exists" and are already present (launched, running).
+        // As many apps as possible get a window, with the lowest total distance
+        const auto assignment = Utils::AssignMinCost(distances);
+
+        std::vector<std::pair<int64_t, size_t>> appsToMove;
+        for (size_t appIndex = 0; appIndex < project.apps.size(); appIndex++)
+        {
+            if (assignment[appIndex].has_value())
+            {
+                appsToMove.emplace_back(distances[appIndex][assignment[appIndex].value()].value(), appIndex);
             }
-            if (minDistance < INT_MAX)
+            else
             {
-                isMovePhase = true;
-                movedAny = true;
-                bool success = TryMoveWindow(appToMove, windowToMove);
-                movedApps.push_back(appToMove);
-                if (success)
-                {
-                    movedWindows.push_back(windowToMove);
-                }
+                Logger::info(L"The app {} is not found at launch, cannot be moved, has to be started", project.apps[appIndex].name);
             }
         }
 
+        // nearest first
+        std::sort(appsToMove.begin(), appsToMove.end());
+        for (const auto& [distance, appIndex] : appsToMove)
+        {
+            TryMoveWindow(project.apps[appIndex], windows[assignment[appIndex].value()].window);
+        }
+
+        const bool movedAny = !appsToMove.empty();
         if (movedAny)
         {
             // Wait if there were moved windows. This message might not arrive if sending immediately after the last "moved" message (status update)
@@ -2,16 +2,16 @@
 
 #include <WindowCreationHandler.h>
 
-#include <WorkspacesLib/AppUtils.h>
+#include <WorkspacesLib/AppIndex.h>
 #include <WorkspacesLib/IPCHelper.h>
 #include <WorkspacesLib/LaunchingStatus.h>
 #include <WorkspacesLib/PwaHelper.h>
 #include <WorkspacesLib/WorkspacesData.h>
 
-struct WindowWithDistance
+struct WindowWithAppData
 {
-    int distance;
     HWND window;
+    Utils::Apps::AppData appData;
 };
 
 class WindowArranger
@@ -24,11 +24,12 @@ private:
     const WorkspacesData::WorkspacesProject m_project;
     const std::vector<HWND> m_windowsBefore;
     const std::vector<WorkspacesData::WorkspacesProject::Monitor> m_monitors;
-    const Utils::Apps::AppList m_installedApps;
+    const Utils::Apps::AppIndex m_installedApps;
     //const WindowCreationHandler m_windowCreationHandler;
     IPCHelper m_ipcHelper;
     LaunchingStatus m_launchingStatus;
-    std::optional<WindowWithDistance> GetNearestWindow(const WorkspacesData::WorkspacesProject::Application& app, const std::vector<HWND>& movedWindows, Utils::PwaHelper& pwaHelper);
+    // Identifies the apps of the windows that were open before launching, once per window
+    std::vector<WindowWithAppData> GetWindowsWithAppData(Utils::PwaHelper& pwaHelper) const;
     bool TryMoveWindow(const WorkspacesData::WorkspacesProject::Application& app, HWND windowToMove);
 
     //void onWindowCreated(HWND window);
@@ -75,16 +75,16 @@ namespace WindowUtils
             return true;
         }
 
-        static std::vector<std::wstring> defaultExcludedApps = { 
-            NonLocalizable::CoreWindow, 
-            NonLocalizable::SearchUI, 
+        static const excluded_apps_matcher defaultExcludedApps{ {
+            NonLocalizable::CoreWindow,
+            NonLocalizable::SearchUI,
             NonLocalizable::HelpWindow,
-            NonLocalizable::WorkspacesEditor, 
+            NonLocalizable::WorkspacesEditor,
             NonLocalizable::WorkspacesLauncher,
             NonLocalizable::WorkspacesWindowArranger,
-            NonLocalizable::WorkspacesSnapshotTool, 
-        };
-        return (check_excluded_app(window, processPathUpper, defaultExcludedApps));
+            NonLocalizable::WorkspacesSnapshotTool,
+        } };
+        return defaultExcludedApps.is_excluded(window, processPathUpper);
     }
 
     inline RECT GetWindowRect(HWND window)
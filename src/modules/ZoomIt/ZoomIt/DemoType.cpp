@@ -12,15 +12,12 @@
 
 #include "pch.h"
 #include "DemoType.h"
+#include "DemoTypeScript.h"
 
 #define MAX_INDENT_DEPTH    100
 
 #define INDENT_SEEK_FLAG    L"x"
 
-#define END_CONTROL_LEN     5
-// Longest accepted control: [pause:000]
-#define MAX_CONTROL_LEN     11
-
 #define THIRD_TYPING_SPEED  static_cast<int>((MIN_TYPING_SPEED - MAX_TYPING_SPEED) / 3)
 #define TYPING_VARIANCE     ((float) 1.0)
 
@@ -65,6 +62,7 @@ size_t                  g_TextLen = 0;
 wchar_t*                g_ClipboardCache = nullptr;
 std::wstring            g_Text = L"";
 std::vector<size_t>     g_TextSegments;
+std::vector<DemoTypeCommand> g_Commands;
 std::wstring            g_BaselineIndentation = L"";
 std::atomic<size_t>     g_Index = 0;
 std::condition_variable g_EpochReady;
@@ -203,20 +201,10 @@ void PushInjection( const WORD vK, const wchar_t ch )
 
 //----------------------------------------------------------------------------
 //
-// IsNotPrintable
-//
-//----------------------------------------------------------------------------
-bool IsNotPrintable( wchar_t ch )
-{
-    return ch != L'\n' && ch != L'\t' && !iswprint( ch );
-}
-
-//----------------------------------------------------------------------------
-//
-// SendKeyInput
+// MakeKeyInput
 //
 //----------------------------------------------------------------------------
-void SendKeyInput( const WORD vK, const wchar_t ch, const bool keyup = false )
+INPUT MakeKeyInput( const WORD vK, const wchar_t ch, const bool keyup )
 {
     INPUT input = {0};
     input.type = INPUT_KEYBOARD;
@@ -243,7 +231,17 @@ void SendKeyInput( const WORD vK, const wchar_t ch, const bool keyup = false )
     {
         input.ki.dwFlags |= KEYEVENTF_KEYUP;
     }
+    return input;
+}
 
+//----------------------------------------------------------------------------
+//
+// SendKeyInput
+//
+//----------------------------------------------------------------------------
+void SendKeyInput( const WORD vK, const wchar_t ch, const bool keyup = false )
+{
+    INPUT input = MakeKeyInput( vK, ch, keyup );
     SendInput( 1, &input, sizeof( INPUT ) );
 
     // Add latency between keydown/up to accomodate notepad input handling
@@ -255,24 +253,29 @@ void SendKeyInput( const WORD vK, const wchar_t ch, const bool keyup = false )
 
 //----------------------------------------------------------------------------
 //
-// SendUnicodeKeyDown
-//
-//----------------------------------------------------------------------------
-void SendUnicodeKeyDown( const wchar_t ch )
-{
-    PushInjection( NULL, ch );
-    SendKeyInput ( NULL, ch );
-}
-
-//----------------------------------------------------------------------------
+// SendKeyPress
 //
-// SendUnicodeKeyUp
+// Sends the keydown and keyup as one batch unless the target needs latency
+// between them
 //
 //----------------------------------------------------------------------------
-void SendUnicodeKeyUp( const wchar_t ch )
+void SendKeyPress( const WORD vK, const wchar_t ch )
 {
-    PushInjection( NULL, ch );
-    SendKeyInput ( NULL, ch, true );
+    if( g_Notepad )
+    {
+        PushInjection( vK, ch );
+        SendKeyInput ( vK, ch );
+        PushInjection( vK, ch );
+        SendKeyInput ( vK, ch, true );
+        return;
+    }
+
+    INPUT inputs[2] = { MakeKeyInput( vK, ch, false ), MakeKeyInput( vK, ch, true ) };
+
+    // Both injections must be queued before the hook sees the first event
+    PushInjection( vK, ch );
+    PushInjection( vK, ch );
+    SendInput( 2, inputs, sizeof( INPUT ) );
 }
 
 //----------------------------------------------------------------------------
@@ -603,110 +606,76 @@ wchar_t InjectByClipboard( wchar_t lastCh, wchar_t ch, const std::wstring& overr
 //
 // HandleControlKeyword
 //
+// Control keywords are compiled when the script is loaded, so this is a
+// lookup into the command table rather than a parse.
+//
 //----------------------------------------------------------------------------
 bool HandleControlKeyword()
 {
-    size_t controlClose = g_Text.find( L']', g_Index );
-    size_t controlLen = controlClose - g_Index + 1;
+    const DemoTypeCommand* command = FindDemoTypeCommand( g_Commands, g_Index );
+    if( command == nullptr )
+    {
+        return false;
+    }
 
-    if( controlLen <= MAX_CONTROL_LEN )
+    switch( command->control )
     {
-        std::wstring control = g_Text.substr( g_Index, controlLen );
+    case DemoTypeControl::End:
+        g_End = true;
+        g_Index += command->length;
+        g_TextSegments.push_back( g_Index );
 
-        if( control == L"[end]" )
+        // In standard mode, [end] is interpreted as an immediate kill signal
+        if( !g_UserDriven )
         {
-            g_End = true;
-            g_Index += controlLen;
-            g_TextSegments.push_back( g_Index );
-
-            // In standard mode, [end] is interpreted as an immediate kill signal
-            if( !g_UserDriven )
-            {
-                g_EmitterState = KILL_STATE;
-            }
-
-            return true;
+            g_EmitterState = KILL_STATE;
         }
-        else if( control.substr( 0, 7 ) == L"[pause:" )
-        {
-            g_Index += controlLen;
-
-            if( g_UserDriven )
-            {
-                return true;
-            }
+        return true;
 
-            std::wistringstream iss(control.substr( 7, control.length() - 2 ));
-            unsigned int time;
+    case DemoTypeControl::Pause:
+        g_Index += command->length;
 
-            if( iss >> time )
+        if( !g_UserDriven )
+        {
+            // Pause but poll for termination
+            for( int i = 0; i < static_cast<int>(1000 / DEMOTYPE_REFRESH * command->payload); i++ )
             {
-                if( time > 0 )
+                if( g_EmitterState == KILL_STATE )
                 {
-                    // Pause but poll for termination
-                    for( int i = 0; i < static_cast<int>(1000 / DEMOTYPE_REFRESH * time); i++ )
-                    {
-                        if( g_EmitterState == KILL_STATE )
-                        {
-                            break;
-                        }
-                        std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
-                    }
-                    return true;
+                    break;
                 }
+                std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
             }
         }
-        else if( control == L"[paste]" )
-        {
-            size_t endControlOpen = g_Text.find( L"[/paste]", controlClose );
-            if( endControlOpen != std::wstring::npos )
-            {
-                size_t endControlClose = g_Text.find( L']', endControlOpen );
-                size_t endControlLen = endControlClose - g_Index + 1;
+        return true;
+
+    case DemoTypeControl::Paste:
+        InjectByClipboard( NULL, NULL, g_Text.substr( command->payload, command->payloadLength ) );
+        g_Index += command->length;
+        return true;
 
-                std::wstring pasteData = g_Text.substr( controlClose + 1, endControlOpen - controlClose - 1 );
-                InjectByClipboard( NULL, NULL, pasteData );
+    case DemoTypeControl::Enter:
+        SendKeyPress( VK_RETURN, NULL );
+        break;
 
-                g_Index += endControlLen;
-                return true;
-            }
-        }
-        else
-        {
-            if( control == L"[enter]" )
-            {
-                SendVirtualKeyDown( VK_RETURN );
-                SendVirtualKeyUp  ( VK_RETURN );
-            }
-            else if( control == L"[up]" )
-            {
-                SendVirtualKeyDown( VK_UP );
-                SendVirtualKeyUp  ( VK_UP );
-            }
-            else if( control == L"[down]" )
-            {
-                SendVirtualKeyDown( VK_DOWN );
-                SendVirtualKeyUp  ( VK_DOWN );
-            }
-            else if( control == L"[left]" )
-            {
-                SendVirtualKeyDown( VK_LEFT );
-                SendVirtualKeyUp  ( VK_LEFT );
-            }
-            else if( control == L"[right]" )
-            {
-                SendVirtualKeyDown( VK_RIGHT );
-                SendVirtualKeyUp  ( VK_RIGHT );
-            }
-            else
-            {
-                return false;
-            }
-            g_Index += controlLen;
-            return true;
-        }
+    case DemoTypeControl::Up:
+        SendKeyPress( VK_UP, NULL );
+        break;
+
+    case DemoTypeControl::Down:
+        SendKeyPress( VK_DOWN, NULL );
+        break;
+
+    case DemoTypeControl::Left:
+        SendKeyPress( VK_LEFT, NULL );
+        break;
+
+    case DemoTypeControl::Right:
+        SendKeyPress( VK_RIGHT, NULL );
+        break;
     }
-    return false;
+    g_Index += command->length;
+    return true;
 }
 
 //----------------------------------------------------------------------------
@@ -750,8 +719,7 @@ void HandleInjection( bool init = false )
     }
     else
     {
-        SendUnicodeKeyDown( ch );
-        SendUnicodeKeyUp  ( ch );
+        SendKeyPress( NULL, ch );
     }
     lastCh = ch;
     g_Index++;
@@ -1062,14 +1030,14 @@ void DemoTypeController()
     // Upon kill, hop to the next text segment if kill wasn't triggered by an [end]
     if( g_Index != 0 && !g_End )
     {
-        size_t nextEnd = g_Text.find( L"[end]", g_Index );
-        if( nextEnd == std::wstring::npos )
+        const DemoTypeCommand* nextEnd = FindNextDemoTypeEnd( g_Commands, g_Index );
+        if( nextEnd == nullptr )
         {
             g_Index = 0;
         }
         else
         {
-            g_Index = nextEnd + END_CONTROL_LEN;
+            g_Index = nextEnd->position + nextEnd->length;
             g_TextSegments.push_back( g_Index );
             if( g_Index >= g_TextLen )
             {
@@ -1081,46 +1049,6 @@ void DemoTypeController()
     g_Active = false;
 }
 
-//----------------------------------------------------------------------------
-//
-// TrimNewlineAroundControl
-//
-//----------------------------------------------------------------------------
-void TrimNewlineAroundControl( const std::wstring control, const bool trimLeft, const bool trimRight )
-{
-    const size_t controlLen = control.length();
-
-    // Seek first occurrence of `control` in `g_Text`
-    size_t nextControl = g_Text.find( control );
-
-    // Loop through each occurrence of `control` in `g_Text`
-    while( nextControl != std::wstring::npos )
-    {
-        // Erase the character to the left of `control` if it is a newline
-        if( trimLeft && nextControl > 0 && g_Text[nextControl - 1] == L'\n' )
-        {
-            g_Text.erase( nextControl - 1, 1 );
-            // Decrement `nextControl` to account for `g_Text` shrinking to left of `nextControl`
-            nextControl--;
-        }
-
-        // Erase the character to the right of `control` if it is a newline
-        if( trimRight && (nextControl + controlLen) < g_Text.length() && g_Text[nextControl + controlLen] == L'\n' )
-        {
-            g_Text.erase( nextControl + controlLen, 1 );
-        }
-
-        // Seek next occurrence of `control` in `g_Text`
-        nextControl = g_Text.find( control, nextControl + controlLen);
-
-        // Shrink `g_Text` to new size on last pass
-        if( nextControl == std::wstring::npos )
-        {
-            g_Text.shrink_to_fit();
-        }
-    }
-}
-
 //----------------------------------------------------------------------------
 //
 // CleanDemoTypeText
@@ -1128,53 +1056,11 @@ void TrimNewlineAroundControl( const std::wstring control, const bool trimLeft,
 //----------------------------------------------------------------------------
 bool CleanDemoTypeText()
 {
-    // Remove all unsupported characters from our text buffer
-    g_Text.erase( std::remove_if( g_Text.begin(), g_Text.end(), IsNotPrintable ), g_Text.end() );
-    g_Text.shrink_to_fit();
-
-    // Remove the first character if it is a newline
-    if( g_Text.length() > 0 && g_Text[0] == L'\n' )
-    {
-        g_Text.erase( 0, 1 );
-        g_Text.shrink_to_fit();
-    }
-
-    // Trim a newline character to the left and right of each [end] control
-    TrimNewlineAroundControl( L"[end]", true, true );
-
-    // Trim a newline character to the right of each [paste] control
-    TrimNewlineAroundControl( L"[paste]", false, true );
-
-    // Trim a newline character to the left of each [/paste] control
-    TrimNewlineAroundControl( L"[/paste]", true, false );
-
-    // Remove any dangling whitespace after the last [end]
-    size_t lastEnd = g_Text.rfind( L"[end]" );
-    if( lastEnd != std::wstring::npos )
-    {
-        for( size_t i = lastEnd + END_CONTROL_LEN; i < g_Text.length(); i++ )
-        {
-            if( iswprint( g_Text[i] ) && g_Text[i] != L' ' )
-            {
-                break;
-            }
-            else if( i >= g_Text.length() - 1 )
-            {
-                g_Text.erase( lastEnd + END_CONTROL_LEN );
-                g_Text.shrink_to_fit();
-            }
-        }
-    }
+    CleanDemoTypeScript( g_Text );
+    CompileDemoTypeScript( g_Text, g_Commands );
 
     g_TextLen = g_Text.length();
-    if( g_TextLen > 0 )
-    {
-        return true;
-    }
-    else
-    {
-        return false;
-    }
+    return g_TextLen > 0;
 }
 
 //----------------------------------------------------------------------------
@@ -1242,108 +1128,39 @@ bool GetDemoTypeClipboard()
 //----------------------------------------------------------------------------
 int GetDemoTypeFile( const TCHAR* filePath )
 {
-    std::ifstream file(filePath, std::ios::binary);
-    if( !file.is_open() )
+    wil::unique_hfile hFile( CreateFile( filePath, GENERIC_READ, FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr ) );
+    if( !hFile )
     {
         return ERROR_LOADING_FILE;
     }
 
     // Confirm file size doesn't exceed MAX_INPUT_SIZE
-    file.seekg( 0, std::ios::end );
-    std::streampos size = file.tellg();
-    file.seekg( 0, std::ios::beg );
-    if( size <= 0 || size > MAX_INPUT_SIZE )
+    LARGE_INTEGER size;
+    if( !GetFileSizeEx( hFile.get(), &size ) )
+    {
+        return ERROR_LOADING_FILE;
+    }
+    if( size.QuadPart <= 0 || size.QuadPart > MAX_INPUT_SIZE )
     {
         return FILE_SIZE_OVERFLOW;
     }
 
-    // Grab the potential Byte Order Mark
-    // Which identifies the encoding pattern
-    char byteOrderMark[3];
-    file.read( byteOrderMark, 3 );
-    file.seekg( 0, std::ios::beg );
-
-    // UTF-16 is a variable-length character encoding pattern
-    //   - code points are encoded with one or two 16-bit code units
-    //   - 16-bit code units are composed of byte pairs subject to endianness
-    //      - Little-endian Byte Order Mark {0xFF, 0xFE, ...}
-    //      -    Big-endian Byte Order Mark {0xFE, 0xFF, ...}
-
-    // UTF-8 is a variable-length character encoding pattern
-    //   - code points are encoded with one to four 8-bit code units
-    //   - optional Byte Order Mark {0xEF, 0xBB, 0xBF, ...}
-
-    // UTF-16LE
-    if( byteOrderMark[0] == static_cast<char>(0xFF)
-     && byteOrderMark[1] == static_cast<char>(0xFE) )
+    // Decode straight out of a mapped view rather than copying through streams
+    wil::unique_handle hMapping( CreateFileMapping( hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr ) );
+    if( !hMapping )
     {
-        // Truncate the Byte Order Mark
-        file.seekg( 2 );
-
-        char bytePair[2];
-        wchar_t codeUnit;
-        while( file.read( bytePair, 2 ) )
-        {
-            // Squash each little-endian byte pair into a 2-byte code unit
-            //   if bytePair[0] = 0xff
-            //   if bytePair[1] = 0x00
-            //         codeUnit = 0x00ff
-            codeUnit = (static_cast<wchar_t>(bytePair[1]) << 8)
-                      | static_cast<wchar_t>(bytePair[0]);
-
-            g_Text += codeUnit;
-        }
+        return ERROR_LOADING_FILE;
     }
-    // UTF-16BE
-    else if( byteOrderMark[0] == static_cast<char>(0xFE)
-          && byteOrderMark[1] == static_cast<char>(0xFF) )
+    wil::unique_mapview_ptr<uint8_t> view( static_cast<uint8_t*>(MapViewOfFile( hMapping.get(), FILE_MAP_READ, 0, 0, 0 )) );
+    if( !view )
     {
-        // Truncate the Byte Order Mark
-        file.seekg( 2 );
-
-        char bytePair[2];
-        wchar_t codeUnit;
-        while( file.read( bytePair, 2 ) )
-        {
-            // Squash each big-endian byte pair into a 2-byte code unit
-            //   if bytePair[0] = 0xff
-            //   if bytePair[1] = 0x00
-            //         codeUnit = 0xff00
-            codeUnit = (static_cast<wchar_t>(bytePair[0]) << 8)
-                      | static_cast<wchar_t>(bytePair[1]);
-
-            g_Text += codeUnit;
-        }
+        return ERROR_LOADING_FILE;
     }
-    // UTF-8
-    else
-    {
-        // If UTF-8 with BOM, truncate the Byte Order Mark
-        if( byteOrderMark[0] == static_cast<char>(0xEF)
-         && byteOrderMark[1] == static_cast<char>(0xBB)
-         && byteOrderMark[2] == static_cast<char>(0xBF) )
-        {
-            file.seekg( 3 );
-        }
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string narrowText = buffer.str();
-
-        // Determine the size our wide string will need to be to accomodate the conversion
-        int wideSize = MultiByteToWideChar( CP_UTF8, 0, narrowText.c_str(), -1, nullptr, 0 );
-        if( wideSize <= 0 )
-        {
-            return ERROR_LOADING_FILE;
-        }
-
-        g_Text.resize( wideSize );
-
-        // Map the multi-byte capable char string onto the wide char string
-        if( MultiByteToWideChar( CP_UTF8, 0, narrowText.c_str(), -1, &g_Text[0], wideSize ) <= 0 )
-        {
-            return ERROR_LOADING_FILE;
-        }
+    if( !DecodeDemoTypeScript( view.get(), static_cast<size_t>(size.QuadPart), g_Text ) )
+    {
+        return ERROR_LOADING_FILE;
     }
 
     g_Index = 0;
@@ -0,0 +1,372 @@
+//============================================================================
+//
+// Zoomit
+// Copyright (C) Mark Russinovich
+// Sysinternals - www.sysinternals.com
+//
+// DemoType script decoding, cleanup and control keyword compilation.
+//
+// The Microsoft Corporation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+//============================================================================
+
+#include "DemoTypeScript.h"
+
+#include <algorithm>
+#include <cwctype>
+
+// Longest accepted control: [pause:000]
+#define MAX_CONTROL_LEN     11
+
+#define END_CONTROL         L"[end]"
+#define PASTE_CONTROL       L"[paste]"
+#define END_PASTE_CONTROL   L"[/paste]"
+#define PAUSE_CONTROL       L"[pause:"
+
+namespace
+{
+    constexpr wchar_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+    template <size_t N>
+    constexpr size_t TokenLength( const wchar_t (&)[N] )
+    {
+        return N - 1;
+    }
+
+    template <size_t N>
+    bool MatchesAt( const wchar_t* text, size_t length, size_t position, const wchar_t (&token)[N] )
+    {
+        return length - position >= TokenLength( token ) &&
+               std::char_traits<wchar_t>::compare( text + position, token, TokenLength( token ) ) == 0;
+    }
+
+    void AppendCodePoint( std::wstring& text, uint32_t codePoint )
+    {
+        if( codePoint >= 0x10000 )
+        {
+            codePoint -= 0x10000;
+            text.push_back( static_cast<wchar_t>(0xD800 + (codePoint >> 10)) );
+            text.push_back( static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)) );
+        }
+        else
+        {
+            text.push_back( static_cast<wchar_t>(codePoint) );
+        }
+    }
+
+    void DecodeUtf8( const uint8_t* data, size_t size, std::wstring& text )
+    {
+        size_t i = 0;
+        while( i < size )
+        {
+            const uint8_t lead = data[i];
+            if( lead < 0x80 )
+            {
+                text.push_back( static_cast<wchar_t>(lead) );
+                i++;
+                continue;
+            }
+
+            size_t trail;
+            uint32_t codePoint;
+            uint32_t minimum;
+            if( (lead & 0xE0) == 0xC0 )
+            {
+                trail = 1, codePoint = lead & 0x1F, minimum = 0x80;
+            }
+            else if( (lead & 0xF0) == 0xE0 )
+            {
+                trail = 2, codePoint = lead & 0x0F, minimum = 0x800;
+            }
+            else if( (lead & 0xF8) == 0xF0 )
+            {
+                trail = 3, codePoint = lead & 0x07, minimum = 0x10000;
+            }
+            else
+            {
+                text.push_back( REPLACEMENT_CHARACTER );
+                i++;
+                continue;
+            }
+
+            size_t consumed = 1;
+            while( consumed <= trail && i + consumed < size && (data[i + consumed] & 0xC0) == 0x80 )
+            {
+                codePoint = (codePoint << 6) | (data[i + consumed] & 0x3F);
+                consumed++;
+            }
+
+            if( consumed <= trail || codePoint < minimum || codePoint > 0x10FFFF
+             || (codePoint >= 0xD800 && codePoint <= 0xDFFF) )
+            {
+                text.push_back( REPLACEMENT_CHARACTER );
+            }
+            else
+            {
+                AppendCodePoint( text, codePoint );
+            }
+            i += consumed;
+        }
+    }
+
+    void DecodeUtf16( const uint8_t* data, size_t size, bool bigEndian, std::wstring& text )
+    {
+        text.reserve( size / 2 );
+        for( size_t i = 0; i + 1 < size; i += 2 )
+        {
+            const wchar_t low = data[bigEndian ? i + 1 : i];
+            const wchar_t high = data[bigEndian ? i : i + 1];
+            text.push_back( static_cast<wchar_t>((high << 8) | low) );
+        }
+    }
+
+    bool IsSupported( wchar_t ch )
+    {
+        return ch == L'\n' || ch == L'\t' || iswprint( ch );
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// DecodeDemoTypeScript
+//
+// Supported encoding: UTF-8, UTF-8 with BOM, UTF-16LE, UTF-16BE
+//
+//----------------------------------------------------------------------------
+bool DecodeDemoTypeScript( const uint8_t* data, size_t size, std::wstring& text )
+{
+    text.clear();
+    if( data == nullptr || size == 0 )
+    {
+        return false;
+    }
+
+    if( size >= 2 && data[0] == 0xFF && data[1] == 0xFE )
+    {
+        DecodeUtf16( data + 2, size - 2, false, text );
+    }
+    else if( size >= 2 && data[0] == 0xFE && data[1] == 0xFF )
+    {
+        DecodeUtf16( data + 2, size - 2, true, text );
+    }
+    else
+    {
+        if( size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF )
+        {
+            data += 3;
+            size -= 3;
+        }
+
+        // UTF-8 never produces more code units than bytes
+        text.reserve( size );
+        DecodeUtf8( data, size, text );
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------
+//
+// CleanDemoTypeScript
+//
+//----------------------------------------------------------------------------
+void CleanDemoTypeScript( std::wstring& text )
+{
+    // Remove all unsupported characters from our text buffer
+    text.erase( std::remove_if( text.begin(), text.end(),
+        []( wchar_t ch ) { return !IsSupported( ch ); } ), text.end() );
+
+    const wchar_t* input = text.c_str();
+    const size_t inputLen = text.length();
+    std::wstring output;
+    output.reserve( inputLen );
+
+    // Remove the first character if it is a newline
+    size_t i = (inputLen > 0 && input[0] == L'\n') ? 1 : 0;
+
+    // Trim a newline character to the left and right of each [end], to the
+    // right of each [paste] and to the left of each [/paste]
+    bool skipNewline = false;
+    while( i < inputLen )
+    {
+        const wchar_t ch = input[i];
+        if( skipNewline )
+        {
+            skipNewline = false;
+            if( ch == L'\n' )
+            {
+                i++;
+                continue;
+            }
+        }
+
+        if( ch == L'[' )
+        {
+            const bool end = MatchesAt( input, inputLen, i, END_CONTROL );
+            const bool paste = !end && MatchesAt( input, inputLen, i, PASTE_CONTROL );
+            const bool endPaste = !end && !paste && MatchesAt( input, inputLen, i, END_PASTE_CONTROL );
+
+            if( end || paste || endPaste )
+            {
+                if( (end || endPaste) && !output.empty() && output.back() == L'\n' )
+                {
+                    output.pop_back();
+                }
+
+                const size_t controlLen = end ? TokenLength( END_CONTROL )
+                                        : paste ? TokenLength( PASTE_CONTROL )
+                                                : TokenLength( END_PASTE_CONTROL );
+                output.append( input + i, controlLen );
+                i += controlLen;
+                skipNewline = end || paste;
+                continue;
+            }
+        }
+
+        output.push_back( ch );
+        i++;
+    }
+
+    // Remove any dangling whitespace after the last [end]
+    size_t lastEnd = output.rfind( END_CONTROL );
+    if( lastEnd != std::wstring::npos )
+    {
+        size_t tail = lastEnd + TokenLength( END_CONTROL );
+        if( std::all_of( output.begin() + tail, output.end(),
+            []( wchar_t ch ) { return ch == L' ' || !iswprint( ch ); } ) )
+        {
+            output.erase( tail );
+        }
+    }
+
+    text.swap( output );
+}
+
+//----------------------------------------------------------------------------
+//
+// CompileDemoTypeScript
+//
+//----------------------------------------------------------------------------
+void CompileDemoTypeScript( const std::wstring& text, std::vector<DemoTypeCommand>& commands )
+{
+    static const struct
+    {
+        const wchar_t*  keyword;
+        DemoTypeControl control;
+    } simpleControls[] = {
+        { L"[end]",   DemoTypeControl::End   },
+        { L"[enter]", DemoTypeControl::Enter },
+        { L"[up]",    DemoTypeControl::Up    },
+        { L"[down]",  DemoTypeControl::Down  },
+        { L"[left]",  DemoTypeControl::Left  },
+        { L"[right]", DemoTypeControl::Right },
+    };
+
+    commands.clear();
+
+    const wchar_t* input = text.c_str();
+    const size_t inputLen = text.length();
+    for( size_t open = text.find( L'[' ); open != std::wstring::npos; open = text.find( L'[', open + 1 ) )
+    {
+        // Controls are short, so only look a few characters ahead for the close
+        const size_t limit = std::min( inputLen, open + MAX_CONTROL_LEN );
+        size_t close = open + 1;
+        while( close < limit && input[close] != L']' )
+        {
+            close++;
+        }
+        if( close >= limit )
+        {
+            continue;
+        }
+
+        const size_t controlLen = close - open + 1;
+        DemoTypeCommand command{ open, controlLen, 0, 0, DemoTypeControl::End };
+        bool matched = false;
+
+        for( const auto& simple : simpleControls )
+        {
+            if( std::char_traits<wchar_t>::length( simple.keyword ) == controlLen
+             && std::char_traits<wchar_t>::compare( input + open, simple.keyword, controlLen ) == 0 )
+            {
+                command.control = simple.control;
+                matched = true;
+                break;
+            }
+        }
+
+        if( !matched && MatchesAt( input, inputLen, open, PAUSE_CONTROL ) )
+        {
+            // A time that doesn't parse still makes a pause keyword, which is
+            // skipped without pausing
+            size_t seconds = 0;
+            size_t digit = open + TokenLength( PAUSE_CONTROL );
+            while( digit < close && iswspace( input[digit] ) )
+            {
+                digit++;
+            }
+            while( digit < close && iswdigit( input[digit] ) )
+            {
+                seconds = seconds * 10 + (input[digit] - L'0');
+                digit++;
+            }
+            command.control = DemoTypeControl::Pause;
+            command.payload = seconds;
+            matched = true;
+        }
+        else if( !matched && controlLen == TokenLength( PASTE_CONTROL )
+              && MatchesAt( input, inputLen, open, PASTE_CONTROL ) )
+        {
+            const size_t endPaste = text.find( END_PASTE_CONTROL, close );
+            if( endPaste != std::wstring::npos )
+            {
+                command.control = DemoTypeControl::Paste;
+                command.payload = close + 1;
+                command.payloadLength = endPaste - close - 1;
+                command.length = endPaste + TokenLength( END_PASTE_CONTROL ) - open;
+                matched = true;
+            }
+        }
+
+        if( matched )
+        {
+            commands.push_back( command );
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// FindDemoTypeCommand
+//
+//----------------------------------------------------------------------------
+const DemoTypeCommand* FindDemoTypeCommand( const std::vector<DemoTypeCommand>& commands, size_t position )
+{
+    auto command = std::lower_bound( commands.begin(), commands.end(), position,
+        []( const DemoTypeCommand& command, size_t position ) { return command.position < position; } );
+
+    if( command != commands.end() && command->position == position )
+    {
+        return &*command;
+    }
+    return nullptr;
+}
+
+//----------------------------------------------------------------------------
+//
+// FindNextDemoTypeEnd
+//
+//----------------------------------------------------------------------------
+const DemoTypeCommand* FindNextDemoTypeEnd( const std::vector<DemoTypeCommand>& commands, size_t position )
+{
+    auto command = std::lower_bound( commands.begin(), commands.end(), position,
+        []( const DemoTypeCommand& command, size_t position ) { return command.position < position; } );
+
+    for( ; command != commands.end(); command++ )
+    {
+        if( command->control == DemoTypeControl::End )
+        {
+            return &*command;
+        }
+    }
+    return nullptr;
+}
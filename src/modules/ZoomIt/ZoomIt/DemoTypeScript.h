@@ -0,0 +1,62 @@
+//============================================================================
+//
+// Zoomit
+// Copyright (C) Mark Russinovich
+// Sysinternals - www.sysinternals.com
+//
+// DemoType script decoding, cleanup and control keyword compilation.
+//
+// This file has no Windows dependencies so that the parser can be
+// exercised headlessly.
+//
+// The Microsoft Corporation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+//============================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class DemoTypeControl : uint8_t
+{
+    End,
+    Pause,
+    Paste,
+    Enter,
+    Up,
+    Down,
+    Left,
+    Right
+};
+
+// A control keyword found in the cleaned script text. Plain text between
+// controls is injected straight from the text buffer.
+struct DemoTypeCommand
+{
+    size_t          position;       // Index of the opening '['
+    size_t          length;         // Characters consumed, including a [paste] body and [/paste]
+    size_t          payload;        // [paste] body start or [pause:n] seconds
+    size_t          payloadLength;  // [paste] body length
+    DemoTypeControl control;
+};
+
+// Decodes UTF-8 (with or without BOM), UTF-16LE or UTF-16BE script bytes
+// into UTF-16 code units.
+bool DecodeDemoTypeScript( const uint8_t* data, size_t size, std::wstring& text );
+
+// Strips unsupported characters and the newlines around [end], after
+// [paste] and before [/paste] in a single pass.
+void CleanDemoTypeScript( std::wstring& text );
+
+// Builds the position-ordered table of control keywords in the text.
+void CompileDemoTypeScript( const std::wstring& text, std::vector<DemoTypeCommand>& commands );
+
+// Returns the control keyword starting at position, or nullptr if the
+// character there is plain text.
+const DemoTypeCommand* FindDemoTypeCommand( const std::vector<DemoTypeCommand>& commands, size_t position );
+
+// Returns the first [end] at or after position, or nullptr if there is none.
+const DemoTypeCommand* FindNextDemoTypeEnd( const std::vector<DemoTypeCommand>& commands, size_t position );
@@ -0,0 +1,247 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Tiled software scaler for the static zoom view
+//
+//==============================================================================
+#include "ZoomTileCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // Zoom levels are quantized so that float noise from the telescoping
+    // animation doesn't produce distinct cache keys for the same level.
+    constexpr float ZoomQuantum = 1024.0f;
+
+    inline int32_t QuantizeZoom( float zoomLevel )
+    {
+        return static_cast<int32_t>( std::lround( zoomLevel * ZoomQuantum ) );
+    }
+
+    inline uint32_t LerpPixel( uint32_t a, uint32_t b, uint32_t weight )
+    {
+        // weight is 0..256; blend red/blue and alpha/green pairs in parallel
+        const uint32_t inverse = 256 - weight;
+        const uint32_t rb = ( ( ( a & 0x00FF00FF ) * inverse + ( b & 0x00FF00FF ) * weight ) >> 8 ) & 0x00FF00FF;
+        const uint32_t ag = ( ( ( ( a >> 8 ) & 0x00FF00FF ) * inverse + ( ( b >> 8 ) & 0x00FF00FF ) * weight ) ) & 0xFF00FF00;
+        return rb | ag;
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// ZoomTileCache::ZoomTileCache
+//
+//----------------------------------------------------------------------------
+ZoomTileCache::ZoomTileCache( size_t maxTiles ) :
+    m_maxTiles( std::max<size_t>( maxTiles, 1 ) )
+{
+}
+
+//----------------------------------------------------------------------------
+//
+// ZoomTileCache::SetSource
+//
+//----------------------------------------------------------------------------
+void ZoomTileCache::SetSource( const uint32_t* pixels, int width, int height, int stride )
+{
+    m_tiles.clear();
+    m_index.clear();
+
+    m_sourceWidth = std::max( width, 0 );
+    m_sourceHeight = std::max( height, 0 );
+    m_source.resize( static_cast<size_t>( m_sourceWidth ) * m_sourceHeight );
+    for( int row = 0; row < m_sourceHeight; row++ )
+    {
+        memcpy( &m_source[static_cast<size_t>( row ) * m_sourceWidth],
+                pixels + static_cast<size_t>( row ) * stride,
+                m_sourceWidth * sizeof( uint32_t ) );
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// ZoomTileCache::Reset
+//
+//----------------------------------------------------------------------------
+void ZoomTileCache::Reset()
+{
+    m_tiles.clear();
+    m_index.clear();
+    m_source.clear();
+    m_source.shrink_to_fit();
+    m_sourceWidth = m_sourceHeight = 0;
+    m_frame.clear();
+    m_frame.shrink_to_fit();
+}
+
+//----------------------------------------------------------------------------
+//
+// ZoomTileCache::FrameBuffer
+//
+//----------------------------------------------------------------------------
+uint32_t* ZoomTileCache::FrameBuffer( int width, int height )
+{
+    m_frame.resize( static_cast<size_t>( std::max( width, 0 ) ) * std::max( height, 0 ) );
+    return m_frame.data();
+}
+
+//----------------------------------------------------------------------------
+//
+// ZoomTileCache::ScaleTile
+//
+// Scales the part of the source that maps to the given tile of the zoomed
+// canvas. Samples outside of the source are clamped to the edge.
+//
+//----------------------------------------------------------------------------
+void ZoomTileCache::ScaleTile( uint32_t* tile, int tileX, int tileY, float zoomLevel, bool smooth ) const
+{
+    const int originX = tileX * TileSize;
+    const int originY = tileY * TileSize;
+    const int maxX = m_sourceWidth - 1;
+    const int maxY = m_sourceHeight - 1;
+
+    if( !smooth )
+    {
+        int columns[TileSize];
+        for( int col = 0; col < TileSize; col++ )
+        {
+            int sx = static_cast<int>( ( originX + col + 0.5f ) / zoomLevel );
+            columns[col] = std::clamp( sx, 0, maxX );
+        }
+        for( int row = 0; row < TileSize; row++ )
+        {
+            int sy = std::clamp( static_cast<int>( ( originY + row + 0.5f ) / zoomLevel ), 0, maxY );
+            const uint32_t* srcRow = &m_source[static_cast<size_t>( sy ) * m_sourceWidth];
+            uint32_t* dstRow = tile + static_cast<size_t>( row ) * TileSize;
+            for( int col = 0; col < TileSize; col++ )
+            {
+                dstRow[col] = srcRow[columns[col]];
+            }
+        }
+        return;
+    }
+
+    int columns0[TileSize];
+    int columns1[TileSize];
+    uint32_t weights[TileSize];
+    for( int col = 0; col < TileSize; col++ )
+    {
+        float fx = std::max( ( originX + col + 0.5f ) / zoomLevel - 0.5f, 0.0f );
+        int sx = static_cast<int>( fx );
+        columns0[col] = std::min( sx, maxX );
+        columns1[col] = std::min( sx + 1, maxX );
+        weights[col] = static_cast<uint32_t>( ( fx - sx ) * 256.0f );
+    }
+    for( int row = 0; row < TileSize; row++ )
+    {
+        float fy = std::max( ( originY + row + 0.5f ) / zoomLevel - 0.5f, 0.0f );
+        int sy = static_cast<int>( fy );
+        const uint32_t rowWeight = static_cast<uint32_t>( ( fy - sy ) * 256.0f );
+        const uint32_t* srcRow0 = &m_source[static_cast<size_t>( std::min( sy, maxY ) ) * m_sourceWidth];
+        const uint32_t* srcRow1 = &m_source[static_cast<size_t>( std::min( sy + 1, maxY ) ) * m_sourceWidth];
+        uint32_t* dstRow = tile + static_cast<size_t>( row ) * TileSize;
+        for( int col = 0; col < TileSize; col++ )
+        {
+            uint32_t top = LerpPixel( srcRow0[columns0[col]], srcRow0[columns1[col]], weights[col] );
+            uint32_t bottom = LerpPixel( srcRow1[columns0[col]], srcRow1[columns1[col]], weights[col] );
+            dstRow[col] = LerpPixel( top, bottom, rowWeight );
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+//
+// ZoomTileCache::GetTile
+//
+// Returns the cached tile, scaling it on a miss. The least recently used
+// tile is recycled once the cache is full.
+//
+//----------------------------------------------------------------------------
+const uint32_t* ZoomTileCache::GetTile( const TileKey& key, float zoomLevel )
+{
+    auto found = m_index.find( key );
+    if( found != m_index.end() )
+    {
+        m_stats.tileHits++;
+        m_tiles.splice( m_tiles.begin(), m_tiles, found->second );
+        return found->second->pixels.data();
+    }
+
+    m_stats.tileMisses++;
+    if( m_tiles.size() >= m_maxTiles )
+    {
+        m_stats.tileEvictions++;
+        m_index.erase( m_tiles.back().key );
+        m_tiles.splice( m_tiles.begin(), m_tiles, std::prev( m_tiles.end() ) );
+    }
+    else
+    {
+        m_tiles.emplace_front();
+        m_tiles.front().pixels.resize( static_cast<size_t>( TileSize ) * TileSize );
+    }
+
+    Tile& tile = m_tiles.front();
+    tile.key = key;
+    m_index.emplace( key, m_tiles.begin() );
+    ScaleTile( tile.pixels.data(), key.tileX, key.tileY, zoomLevel, key.smooth );
+    return tile.pixels.data();
+}
+
+//----------------------------------------------------------------------------
+//
+// ZoomTileCache::Render
+//
+//----------------------------------------------------------------------------
+void ZoomTileCache::Render( uint32_t* dst, int dstWidth, int dstHeight, int dstStride,
+                            float zoomLevel, int srcX, int srcY, bool smooth )
+{
+    if( !HasSource() || dstWidth <= 0 || dstHeight <= 0 || zoomLevel <= 0 )
+    {
+        return;
+    }
+
+    // Use the quantized level for scaling too so that a tile's pixels only
+    // depend on its key.
+    const int32_t zoomKey = QuantizeZoom( zoomLevel );
+    const float zoom = zoomKey / ZoomQuantum;
+
+    // Position of the view in the zoomed canvas
+    const int viewX = static_cast<int>( std::lround( srcX * zoom ) );
+    const int viewY = static_cast<int>( std::lround( srcY * zoom ) );
+
+    const int firstTileX = viewX / TileSize;
+    const int firstTileY = viewY / TileSize;
+    const int lastTileX = ( viewX + dstWidth - 1 ) / TileSize;
+    const int lastTileY = ( viewY + dstHeight - 1 ) / TileSize;
+
+    // Room for the tiles of this frame and as many again, so that the tiles
+    // of the previous frame are still cached after a pan in any direction
+    const size_t visibleTiles = static_cast<size_t>( lastTileX - firstTileX + 1 ) * ( lastTileY - firstTileY + 1 );
+    m_maxTiles = std::max( m_maxTiles, 2 * visibleTiles );
+
+    for( int tileY = firstTileY; tileY <= lastTileY; tileY++ )
+    {
+        const int top = std::max( tileY * TileSize, viewY );
+        const int bottom = std::min( ( tileY + 1 ) * TileSize, viewY + dstHeight );
+
+        for( int tileX = firstTileX; tileX <= lastTileX; tileX++ )
+        {
+            const int left = std::max( tileX * TileSize, viewX );
+            const int right = std::min( ( tileX + 1 ) * TileSize, viewX + dstWidth );
+
+            const uint32_t* tile = GetTile( TileKey{ zoomKey, tileX, tileY, smooth }, zoom );
+            for( int row = top; row < bottom; row++ )
+            {
+                memcpy( dst + static_cast<size_t>( row - viewY ) * dstStride + ( left - viewX ),
+                        tile + static_cast<size_t>( row - tileY * TileSize ) * TileSize + ( left - tileX * TileSize ),
+                        ( right - left ) * sizeof( uint32_t ) );
+            }
+        }
+    }
+}
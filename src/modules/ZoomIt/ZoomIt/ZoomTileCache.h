@@ -0,0 +1,109 @@
+//==============================================================================
+//
+// Zoomit
+// Sysinternals - www.sysinternals.com
+//
+// Tiled software scaler for the static zoom view. Scaled tiles are cached by
+// zoom level and tile position so that panning at a fixed zoom level only
+// scales the tiles that scroll into view.
+//
+// This file has no Windows dependencies so it can be exercised headlessly.
+//
+//==============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+class ZoomTileCache
+{
+public:
+    // Edge length of a tile in zoomed (destination) pixels
+    static constexpr int TileSize = 128;
+
+    struct Stats
+    {
+        uint64_t tileHits = 0;
+        uint64_t tileMisses = 0;
+        uint64_t tileEvictions = 0;
+    };
+
+    // maxTiles is a minimum: the cache grows to hold twice the tiles of the
+    // largest view it renders, so that a frame never evicts its own tiles.
+    explicit ZoomTileCache( size_t maxTiles = 256 );
+
+    // Copies the unzoomed source frame (32bpp, top-down, stride in pixels)
+    // and drops every cached tile.
+    void SetSource( const uint32_t* pixels, int width, int height, int stride );
+
+    // Drops the source frame, every cached tile and the frame buffer.
+    void Reset();
+
+    // A width x height pixel buffer for the caller to render the view into.
+    // It is reused from frame to frame and released by Reset.
+    uint32_t* FrameBuffer( int width, int height );
+
+    bool HasSource() const { return !m_source.empty(); }
+    int SourceWidth() const { return m_sourceWidth; }
+    int SourceHeight() const { return m_sourceHeight; }
+
+    // Renders the source region starting at (srcX, srcY) scaled by
+    // zoomLevel into dst, which is dstWidth x dstHeight pixels with a stride
+    // of dstStride pixels. Smooth selects bilinear filtering, otherwise
+    // nearest neighbor is used.
+    void Render( uint32_t* dst, int dstWidth, int dstHeight, int dstStride,
+                 float zoomLevel, int srcX, int srcY, bool smooth );
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    struct TileKey
+    {
+        int32_t zoom;
+        int32_t tileX;
+        int32_t tileY;
+        bool smooth;
+
+        bool operator==( const TileKey& other ) const
+        {
+            return zoom == other.zoom && tileX == other.tileX &&
+                   tileY == other.tileY && smooth == other.smooth;
+        }
+    };
+
+    struct TileKeyHash
+    {
+        size_t operator()( const TileKey& key ) const
+        {
+            uint64_t value = ( static_cast<uint64_t>( static_cast<uint32_t>( key.zoom ) ) << 33 ) ^
+                             ( static_cast<uint64_t>( static_cast<uint32_t>( key.tileX ) ) << 17 ) ^
+                             static_cast<uint64_t>( static_cast<uint32_t>( key.tileY ) ) ^
+                             ( key.smooth ? 0x8000000000000000ull : 0 );
+            return std::hash<uint64_t>{}( value );
+        }
+    };
+
+    struct Tile
+    {
+        TileKey key;
+        std::vector<uint32_t> pixels;
+    };
+
+    const uint32_t* GetTile( const TileKey& key, float zoomLevel );
+    void ScaleTile( uint32_t* tile, int tileX, int tileY, float zoomLevel, bool smooth ) const;
+
+    std::vector<uint32_t> m_source;
+    int m_sourceWidth = 0;
+    int m_sourceHeight = 0;
+
+    std::vector<uint32_t> m_frame;
+
+    size_t m_maxTiles;
+    std::list<Tile> m_tiles;
+    std::unordered_map<TileKey, std::list<Tile>::iterator, TileKeyHash> m_index;
+    Stats m_stats;
+};
@@ -16,6 +16,7 @@
 #include "WindowsVersions.h"
 #include "ZoomItSettings.h"
 #include "GifRecordingSession.h"
+#include "ZoomTileCache.h"
 
 #ifdef __ZOOMIT_POWERTOYS__
 #include <common/interop/shared_constants.h>
@@ -167,6 +168,7 @@ BOOLEAN g_running = TRUE;
 BOOL	g_RecordToggle = FALSE;
 BOOL	g_RecordCropping = FALSE;
 SelectRectangle g_SelectRectangle;
+ZoomTileCache	g_ZoomTileCache;
 std::wstring	g_RecordingSaveLocation;
 std::wstring	g_RecordingSaveLocationGIF;
 winrt::IDirect3DDevice	g_RecordDevice{ nullptr };
@@ -1315,6 +1317,53 @@ void ScaleImage( HDC hdcDst, float xDst, float yDst, float wDst, float hDst,
 }
 
 
+//----------------------------------------------------------------------------
+//
+// DrawZoomedTiles
+//
+// Renders the zoomed view through the tile cache so that panning at a fixed
+// zoom level only scales the newly exposed tiles. The source bitmap is
+// snapshotted the first time it's painted after the cache was reset.
+//
+//----------------------------------------------------------------------------
+BOOLEAN DrawZoomedTiles( HDC hdcDst, HDC hdcSrc, int width, int height,
+                         float zoomLevel, int x, int y )
+{
+    BITMAPINFO bitmapInfo = {};
+    bitmapInfo.bmiHeader.biSize = sizeof bitmapInfo.bmiHeader;
+    bitmapInfo.bmiHeader.biWidth = width;
+    bitmapInfo.bmiHeader.biHeight = -height;
+    bitmapInfo.bmiHeader.biPlanes = 1;
+    bitmapInfo.bmiHeader.biBitCount = 32;
+    bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+    if( !g_ZoomTileCache.HasSource() ||
+        g_ZoomTileCache.SourceWidth() != width ||
+        g_ZoomTileCache.SourceHeight() != height ) {
+
+        void* bits;
+        wil::unique_hbitmap hSnapshot( CreateDIBSection( hdcSrc, &bitmapInfo, DIB_RGB_COLORS, &bits, NULL, 0 ));
+        wil::unique_hdc hdcSnapshot( CreateCompatibleDC( hdcSrc ));
+        if( !hSnapshot || !hdcSnapshot ) {
+
+            return FALSE;
+        }
+        auto hOld = SelectObject( hdcSnapshot.get(), hSnapshot.get() );
+        BitBlt( hdcSnapshot.get(), 0, 0, width, height, hdcSrc, 0, 0, SRCCOPY );
+        GdiFlush();
+        g_ZoomTileCache.SetSource( static_cast<const uint32_t*>(bits), width, height, width );
+        SelectObject( hdcSnapshot.get(), hOld );
+    }
+
+    uint32_t* zoomedBits = g_ZoomTileCache.FrameBuffer( width, height );
+    g_ZoomTileCache.Render( zoomedBits, width, height, width,
+                            zoomLevel, x, y, g_SmoothImage != FALSE );
+
+    return SetDIBitsToDevice( hdcDst, 0, 0, width, height, 0, 0, 0, height,
+                              zoomedBits, &bitmapInfo, DIB_RGB_COLORS ) != 0;
+}
+
+
 //----------------------------------------------------------------------------
 //
 // GetEncoderClsid
@@ -4048,6 +4097,7 @@ LRESULT APIENTRY MainWndProc(
             DeleteDC( hdcScreenCursorCompat );
             DeleteDC( hdcScreenSaveCompat );
             DeleteObject( hbmpCompat );
+            g_ZoomTileCache.Reset();
             DeleteObject (hbmpCursorCompat );
             DeleteObject( hbmpDrawingCompat );
             DeleteObject( hDrawingPen );
@@ -4818,6 +4868,8 @@ LRESULT APIENTRY MainWndProc(
                     BitBlt( hdcScreenSaveCompat, 0, 0, bmp.bmWidth, bmp.bmHeight, hdcSource,
                         captured ? 0 : monInfo.rcMonitor.left, captured ? 0 : monInfo.rcMonitor.top, SRCCOPY|CAPTUREBLT );
 
+                    g_ZoomTileCache.Reset();
+
                     if( captured )
                     {
                         OutputDebug(L"Captured screen\n");
@@ -6943,6 +6995,18 @@ LRESULT APIENTRY MainWndProc(
                         SRCCOPY);
             }
 #else
+            // Annotations modify the source bitmap, so only pan through the
+            // tile cache when the view is static and not animating
+            if( g_Drawing ) {
+
+                g_ZoomTileCache.Reset();
+
+            } else if( zoomLevel == zoomTelescopeTarget &&
+                       DrawZoomedTiles( ps.hdc, hdcScreenCompat, width, height, zoomLevel, x, y )) {
+
+                EndPaint( hWnd, &ps );
+                return TRUE;
+            }
 #if SCALE_HALFTONE
             SetStretchBltMode( hDc, zoomLevel == zoomTelescopeTarget ? HALFTONE : COLORONCOLOR );
 #else
@@ -195,6 +195,7 @@ void AlwaysOnTopSettings::LoadSettings()
             if (m_settings.excludedApps != excludedApps)
             {
                 m_settings.excludedApps = excludedApps;
+                m_excludedApps.set_apps(m_settings.excludedApps);
                 NotifyObservers(SettingId::ExcludeApps);
             }
         }
@@ -4,6 +4,7 @@
 
 #include <common/SettingsAPI/FileWatcher.h>
 #include <common/SettingsAPI/settings_objects.h>
+#include <common/utils/excluded_apps.h>
 
 #include <SettingsConstants.h>
 
@@ -35,6 +36,12 @@ public:
         return instance().m_settings;
     }
 
+    // Built from settings().excludedApps
+    static inline const excluded_apps_matcher& excludedApps()
+    {
+        return instance().m_excludedApps;
+    }
+
     void InitFileWatcher();
     static std::wstring GetSettingsFileName();
 
@@ -49,6 +56,7 @@ private:
 
     winrt::Windows::UI::ViewManagement::UISettings m_uiSettings;
     Settings m_settings;
+    excluded_apps_matcher m_excludedApps;
     std::unique_ptr<FileWatcher> m_settingsFileWatcher;
     std::unordered_set<SettingsObserver*> m_observers;
 
@@ -228,6 +228,7 @@ void FancyZonesSettings::LoadSettings()
             {
                 m_settings.excludedApps = apps;
                 m_settings.excludedAppsArray = excludedApps;
+                m_excludedApps.set_apps(m_settings.excludedAppsArray);
                 NotifyObservers(SettingId::ExcludedApps);
             }
         }
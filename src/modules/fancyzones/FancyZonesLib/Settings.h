@@ -4,6 +4,7 @@
 
 #include <common/SettingsAPI/settings_helpers.h>
 #include <common/SettingsAPI/settings_objects.h>
+#include <common/utils/excluded_apps.h>
 
 #include <FancyZonesLib/ModuleConstants.h>
 #include <FancyZonesLib/SettingsConstants.h>
@@ -69,6 +70,12 @@ public:
         return instance().m_settings;
     }
 
+    // Built from settings().excludedAppsArray
+    static inline const excluded_apps_matcher& excludedApps()
+    {
+        return instance().m_excludedApps;
+    }
+
     inline static std::wstring GetSettingsFileName()
     {
         std::wstring saveFolderPath = PTSettingsHelper::get_module_save_folder_location(NonLocalizable::ModuleKey);
@@ -83,6 +90,7 @@ public:
     inline void SetSettings(const Settings& settings)
     {
         m_settings = settings;
+        m_excludedApps.set_apps(m_settings.excludedAppsArray);
     }
 #endif
 
@@ -96,6 +104,7 @@ private:
     ~FancyZonesSettings() = default;
 
     Settings m_settings;
+    excluded_apps_matcher m_excludedApps;
     std::unique_ptr<FileWatcher> m_settingsFileWatcher;
     std::unordered_set<SettingsObserver*> m_observers;
 
@@ -161,7 +161,7 @@ bool FancyZonesWindowUtils::IsExcluded(HWND window)
 
 bool FancyZonesWindowUtils::IsExcludedByUser(const HWND& hwnd, const std::wstring& processPath) noexcept
 {
-    return (check_excluded_app(hwnd, processPath, FancyZonesSettings::settings().excludedAppsArray));
+    return FancyZonesSettings::excludedApps().is_excluded(hwnd, processPath);
 }
 
 bool FancyZonesWindowUtils::IsExcludedByDefault(const HWND& hwnd, const std::wstring& processPath) noexcept
@@ -184,8 +184,8 @@ bool FancyZonesWindowUtils::IsExcludedByDefault(const HWND& hwnd, const std::wst
         return true;
     }
 
-    static std::vector<std::wstring> defaultExcludedApps = { NonLocalizable::PowerToysAppFZEditor, NonLocalizable::CoreWindow, NonLocalizable::SearchUI };
-    return (check_excluded_app(hwnd, processPath, defaultExcludedApps));
+    static const excluded_apps_matcher defaultExcludedApps{ { NonLocalizable::PowerToysAppFZEditor, NonLocalizable::CoreWindow, NonLocalizable::SearchUI } };
+    return defaultExcludedApps.is_excluded(hwnd, processPath);
 }
 
 void FancyZonesWindowUtils::SwitchToWindow(HWND window) noexcept
@@ -113,7 +113,7 @@ namespace winrt::PowerToys::PowerAccentKeyboardService::implementation
         }
         {
             std::lock_guard<std::mutex> lock(m_mutex_excluded_apps);
-            m_settings.excludedApps = std::move(excludedApps);
+            m_settings.excludedApps.set_apps(excludedApps);
             m_prevForegroundAppExcl = { NULL, false };
         }
     }
@@ -142,7 +142,7 @@ namespace winrt::PowerToys::PowerAccentKeyboardService::implementation
             auto processPath = get_process_path(foregroundApp);
             CharUpperBuffW(processPath.data(), static_cast<DWORD>(processPath.length()));
             m_prevForegroundAppExcl = { foregroundApp,
-                                        check_excluded_app(foregroundApp, processPath, m_settings.excludedApps) };
+                                        m_settings.excludedApps.is_excluded(foregroundApp, processPath) };
 
             return m_prevForegroundAppExcl.second;
         }
@@ -2,24 +2,24 @@
 #include "GcodeThumbnailProvider.h"
 
 #include <filesystem>
-#include <fstream>
-#include <shellapi.h>
 #include <Shlwapi.h>
 #include <string>
 
 #include <wil/com.h>
 
-#include <common/utils/process_path.h>
 #include <common/interop/shared_constants.h>
 #include <common/logger/logger.h>
 #include <common/SettingsAPI/settings_helpers.h>
-#include <common/utils/process_path.h>
+#include <common/utils/gpo.h>
+
+#include "../ThumbnailProviderCommon/GcodeThumbnail.h"
+#include "../ThumbnailProviderCommon/ThumbnailCache.h"
 
 extern HINSTANCE g_hInst;
 extern long g_cDllRef;
 
 GcodeThumbnailProvider::GcodeThumbnailProvider() :
-    m_cRef(1), m_pStream(NULL), m_process(NULL)
+    m_cRef(1), m_pStream(NULL)
 {
     std::filesystem::path logFilePath(PTSettingsHelper::get_local_low_folder_location());
     logFilePath.append(LogSettings::gcodeThumbLogPath);
@@ -30,6 +30,12 @@ GcodeThumbnailProvider::GcodeThumbnailProvider() :
 
 GcodeThumbnailProvider::~GcodeThumbnailProvider()
 {
+    if (m_pStream)
+    {
+        m_pStream->Release();
+        m_pStream = NULL;
+    }
+
     InterlockedDecrement(&g_cDllRef);
 }
 
@@ -92,110 +98,56 @@ IFACEMETHODIMP GcodeThumbnailProvider::Initialize(IStream* pStream, DWORD grfMod
 
 IFACEMETHODIMP GcodeThumbnailProvider::GetThumbnail(UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha)
 {
-    // Read stream into the buffer
-    char buffer[4096];
-    ULONG cbRead;
-
     Logger::trace(L"Begin");
 
-    GUID guid;
-    if (CoCreateGuid(&guid) == S_OK)
+    if (!m_pStream)
     {
-        wil::unique_cotaskmem_string guidString;
-        if (SUCCEEDED(StringFromCLSID(guid, &guidString)))
-        {
-            Logger::info(L"Read stream and save to tmp file.");
-
-            // {CLSID} -> CLSID
-            std::wstring guid = std::wstring(guidString.get()).substr(1, std::wstring(guidString.get()).size() - 2);
-            std::wstring filePath = PTSettingsHelper::get_local_low_folder_location() + L"\\GCodeThumbnail-Temp\\";
-            if (!std::filesystem::exists(filePath))
-            {
-                std::filesystem::create_directories(filePath);
-            }
-
-            std::wstring fileName = filePath + guid + L".gcode";
-            
-            // Write data to tmp file
-            std::fstream file;
-            file.open(fileName, std::ios_base::out | std::ios_base::binary);
-
-            if (!file.is_open())
-            {
-                return 0;
-            }
-
-            while (true)
-            {
-                auto result = m_pStream->Read(buffer, 4096, &cbRead);
-
-                file.write(buffer, cbRead);
-                if (result == S_FALSE)
-                {               
-                    break;
-                }
-            }
-            file.close();
+        return E_UNEXPECTED;
+    }
 
-            m_pStream->Release();
-            m_pStream = NULL;
+    // Release the stream on every path; it is not needed once scanned.
+    wil::com_ptr_nothrow<IStream> stream;
+    stream.attach(m_pStream);
+    m_pStream = NULL;
 
-            try
-            {
-                Logger::info(L"Start GcodeThumbnailProvider.exe");
-
-                STARTUPINFO info = { sizeof(info) };
-                std::wstring cmdLine{ L"\"" + fileName + L"\"" };
-                cmdLine += L" ";
-                cmdLine += std::to_wstring(cx);
-
-                std::wstring appPath = get_module_folderpath(g_hInst) + L"\\PowerToys.GcodeThumbnailProvider.exe";
-
-                SHELLEXECUTEINFO sei{ sizeof(sei) };
-                sei.fMask = { SEE_MASK_NOCLOSEPROCESS | SEE_MASK_FLAG_NO_UI };
-                sei.lpFile = appPath.c_str();
-                sei.lpParameters = cmdLine.c_str();
-                sei.nShow = SW_SHOWDEFAULT;
-                ShellExecuteEx(&sei);
-                m_process = sei.hProcess;
-                WaitForSingleObject(m_process, INFINITE);
-                std::filesystem::remove(fileName);
-
-
-                std::wstring fileNameBmp = filePath + guid + L".bmp";
-                if (std::filesystem::exists(fileNameBmp))
-                {
-                    *phbmp = static_cast<HBITMAP>(LoadImage(NULL, fileNameBmp.c_str(), IMAGE_BITMAP, 0, 0, LR_LOADFROMFILE));
-                    *pdwAlpha = WTS_ALPHATYPE::WTSAT_ARGB;
-                    std::filesystem::remove(fileNameBmp);
-                }
-                else
-                {
-                    Logger::info(L"Bmp file not generated.");
-                    return E_FAIL;
-                }
-            }
-            catch (std::exception& e)
-            {
-                std::wstring errorMessage = std::wstring{ winrt::to_hstring(e.what()) };
-                Logger::error(L"Failed to start GcodeThumbnailProvider.exe. Error: {}", errorMessage);
-            }
-        }
+    if (powertoys_gpo::getConfiguredGcodeThumbnailsEnabledValue() == powertoys_gpo::gpo_rule_configured_disabled)
+    {
+        Logger::info(L"Gcode thumbnails are disabled by group policy.");
+        return E_FAIL;
     }
 
-    // ensure releasing the stream (not all if branches contain it)
-    if (m_pStream)
+    if (cx == 0 || cx > MaxThumbnailSize)
     {
-        m_pStream->Release();
-        m_pStream = NULL;
+        return E_INVALIDARG;
     }
 
-    return S_OK;
-}
+    auto render = [&](ThumbnailCommon::ThumbnailImage& image) {
+        // Only the header comments are read; the toolpath is never touched.
+        const ThumbnailCommon::EmbeddedThumbnail thumbnail = ThumbnailCommon::FindGcodeThumbnail([&](char* buffer, size_t size) {
+            return ThumbnailCommon::ReadStream(stream.get(), buffer, size);
+        });
+        if (thumbnail.empty())
+        {
+            Logger::info(L"No embedded thumbnail found.");
+            return E_FAIL;
+        }
 
+        if (!ThumbnailCommon::DecodeEmbeddedThumbnail(thumbnail, cx, image))
+        {
+            Logger::error(L"Failed to decode embedded thumbnail.");
+            return E_FAIL;
+        }
+        return S_OK;
+    };
 
-#pragma endregion
+    const HRESULT hr = ThumbnailCommon::GetCachedThumbnail(stream.get(), cx, ThumbnailCommon::ThumbnailProvider::Gcode, 0, render, phbmp);
+    if (FAILED(hr))
+    {
+        return hr;
+    }
 
-#pragma region Helper Functions
+    *pdwAlpha = WTS_ALPHATYPE::WTSAT_ARGB;
+    return S_OK;
+}
 
 #pragma endregion
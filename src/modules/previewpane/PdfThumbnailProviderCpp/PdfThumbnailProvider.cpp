@@ -14,6 +14,8 @@
 #include <common/SettingsAPI/settings_helpers.h>
 #include <common/utils/process_path.h>
 
+#include "../ThumbnailProviderCommon/ThumbnailCache.h"
+
 extern HINSTANCE g_hInst;
 extern long g_cDllRef;
 
@@ -97,6 +99,21 @@ IFACEMETHODIMP PdfThumbnailProvider::GetThumbnail(UINT cx, HBITMAP* phbmp, WTS_A
 
     Logger::trace(L"Begin");
 
+    // Serve unchanged files without starting the renderer process
+    ThumbnailCommon::ThumbnailCacheKey cacheKey;
+    const bool cacheable = m_pStream && ThumbnailCommon::ThumbnailCache::ComputeKey(m_pStream, cx, ThumbnailCommon::ThumbnailProvider::Pdf, 0, cacheKey);
+    if (cacheable)
+    {
+        if (HBITMAP cached = ThumbnailCommon::GetCachedThumbnailBitmap(cacheKey))
+        {
+            m_pStream->Release();
+            m_pStream = NULL;
+            *phbmp = cached;
+            *pdwAlpha = WTS_ALPHATYPE::WTSAT_ARGB;
+            return S_OK;
+        }
+    }
+
     GUID guid;
     if (CoCreateGuid(&guid) == S_OK)
     {
@@ -163,9 +180,14 @@ IFACEMETHODIMP PdfThumbnailProvider::GetThumbnail(UINT cx, HBITMAP* phbmp, WTS_A
                 std::wstring fileNameBmp = filePath + guid + L".bmp";
                 if (std::filesystem::exists(fileNameBmp))
                 {
-                    *phbmp = static_cast<HBITMAP>(LoadImage(NULL, fileNameBmp.c_str(), IMAGE_BITMAP, 0, 0, LR_LOADFROMFILE));
+                    *phbmp = static_cast<HBITMAP>(LoadImage(NULL, fileNameBmp.c_str(), IMAGE_BITMAP, 0, 0, LR_LOADFROMFILE | LR_CREATEDIBSECTION));
                     *pdwAlpha = WTS_ALPHATYPE::WTSAT_ARGB;
                     std::filesystem::remove(fileNameBmp);
+
+                    if (cacheable && *phbmp)
+                    {
+                        ThumbnailCommon::CacheThumbnailBitmap(cacheKey, *phbmp);
+                    }
                 }
                 else
                 {
@@ -33,5 +33,6 @@ private:
     // Provided during initialization.
     IStream* m_pStream;
 
-    HANDLE m_process;
+    // Same limit as the managed provider used to enforce.
+    static constexpr UINT MaxThumbnailSize = 10000;
 };
\ No newline at end of file
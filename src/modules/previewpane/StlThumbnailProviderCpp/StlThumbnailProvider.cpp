@@ -2,8 +2,6 @@
 #include "StlThumbnailProvider.h"
 
 #include <filesystem>
-#include <fstream>
-#include <shellapi.h>
 #include <Shlwapi.h>
 #include <string>
 
@@ -12,13 +10,49 @@
 #include <common/interop/shared_constants.h>
 #include <common/logger/logger.h>
 #include <common/SettingsAPI/settings_helpers.h>
-#include <common/utils/process_path.h>
+#include <common/utils/color.h>
+#include <common/utils/gpo.h>
+
+#include "../ThumbnailProviderCommon/StlRasterizer.h"
+#include "../ThumbnailProviderCommon/ThumbnailCache.h"
 
 extern HINSTANCE g_hInst;
 extern long g_cDllRef;
 
+namespace
+{
+    const wchar_t JSON_KEY_PROPERTIES[] = L"properties";
+    const wchar_t JSON_KEY_VALUE[] = L"value";
+    const wchar_t JSON_KEY_STL_THUMBNAIL_COLOR[] = L"stl-thumbnail-color-setting";
+
+    // Matches the default of the File Explorer settings page.
+    constexpr uint32_t DefaultMaterialColor = 0xFFC924;
+
+    uint32_t GetMaterialColor()
+    {
+        try
+        {
+            auto props = PTSettingsHelper::load_module_settings(L"File Explorer").GetNamedObject(JSON_KEY_PROPERTIES);
+            const auto colorString = props.GetNamedObject(JSON_KEY_STL_THUMBNAIL_COLOR).GetNamedString(JSON_KEY_VALUE);
+
+            uint8_t r;
+            uint8_t g;
+            uint8_t b;
+            if (checkValidRGB(colorString, &r, &g, &b))
+            {
+                return (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b;
+            }
+        }
+        catch (...)
+        {
+        }
+
+        return DefaultMaterialColor;
+    }
+}
+
 StlThumbnailProvider::StlThumbnailProvider() :
-    m_cRef(1), m_pStream(NULL), m_process(NULL)
+    m_cRef(1), m_pStream(NULL)
 {
     std::filesystem::path logFilePath(PTSettingsHelper::get_local_low_folder_location());
     logFilePath.append(LogSettings::stlThumbLogPath);
@@ -29,6 +63,12 @@ StlThumbnailProvider::StlThumbnailProvider() :
 
 StlThumbnailProvider::~StlThumbnailProvider()
 {
+    if (m_pStream)
+    {
+        m_pStream->Release();
+        m_pStream = NULL;
+    }
+
     InterlockedDecrement(&g_cDllRef);
 }
 
@@ -91,108 +131,65 @@ IFACEMETHODIMP StlThumbnailProvider::Initialize(IStream* pStream, DWORD grfMode)
 
 IFACEMETHODIMP StlThumbnailProvider::GetThumbnail(UINT cx, HBITMAP* phbmp, WTS_ALPHATYPE* pdwAlpha)
 {
-    // Read stream into the buffer
-    char buffer[4096];
-    ULONG cbRead;
-
     Logger::trace(L"Begin");
 
-    GUID guid;
-    if (CoCreateGuid(&guid) == S_OK)
+    if (!m_pStream)
     {
-        wil::unique_cotaskmem_string guidString;
-        if (SUCCEEDED(StringFromCLSID(guid, &guidString)))
-        {
-            Logger::info(L"Read stream and save to tmp file.");
-            
-            // {CLSID} -> CLSID
-            std::wstring guid = std::wstring(guidString.get()).substr(1, std::wstring(guidString.get()).size() - 2);
-            std::wstring filePath = PTSettingsHelper::get_local_low_folder_location() + L"\\StlThumbnail-Temp\\";
-            if (!std::filesystem::exists(filePath))
-            {
-                std::filesystem::create_directories(filePath);
-            }
+        return E_UNEXPECTED;
+    }
 
-            std::wstring fileName = filePath + guid + L".stl";
+    // Release the stream on every path; it is not needed once read.
+    wil::com_ptr_nothrow<IStream> stream;
+    stream.attach(m_pStream);
+    m_pStream = NULL;
 
-            // Write data to tmp file
-            std::fstream file;
-            file.open(fileName, std::ios_base::out | std::ios_base::binary);
+    if (powertoys_gpo::getConfiguredStlThumbnailsEnabledValue() == powertoys_gpo::gpo_rule_configured_disabled)
+    {
+        Logger::info(L"Stl thumbnails are disabled by group policy.");
+        return E_FAIL;
+    }
 
-            if (!file.is_open())
-            {
-                return 0;
-            }
+    if (cx == 0 || cx > MaxThumbnailSize)
+    {
+        return E_INVALIDARG;
+    }
 
-            while (true)
-            {
-                auto result = m_pStream->Read(buffer, 4096, &cbRead);
+    // The size tells binary files whose header starts with "solid" apart
+    // from ASCII ones; the reader copes without it.
+    STATSTG stat = {};
+    const uint64_t streamSize = SUCCEEDED(stream->Stat(&stat, STATFLAG_NONAME)) ? stat.cbSize.QuadPart : 0;
 
-                file.write(buffer, cbRead);
-                if (result == S_FALSE)
-                {
-                    break;
-                }
-            }
-            file.close();
+    // A different material color is a different thumbnail
+    const uint32_t color = GetMaterialColor();
 
-            m_pStream->Release();
-            m_pStream = NULL;
+    auto render = [&](ThumbnailCommon::ThumbnailImage& image) {
+        ThumbnailCommon::StlMesh mesh;
+        auto reader = [&](char* buffer, size_t size) {
+            return ThumbnailCommon::ReadStream(stream.get(), buffer, size);
+        };
+        if (!ThumbnailCommon::ReadStlMesh(reader, streamSize, mesh))
+        {
+            Logger::info(L"Stream is not a valid STL model.");
+            return E_FAIL;
+        }
 
-            try
-            {
-                Logger::info(L"Start StlThumbnailProvider.exe");
-                
-                STARTUPINFO info = { sizeof(info) };
-                std::wstring cmdLine{ L"\"" + fileName + L"\"" };
-                cmdLine += L" ";
-                cmdLine += std::to_wstring(cx);
-
-                std::wstring appPath = get_module_folderpath(g_hInst) + L"\\PowerToys.StlThumbnailProvider.exe";
-
-                SHELLEXECUTEINFO sei{ sizeof(sei) };
-                sei.fMask = { SEE_MASK_NOCLOSEPROCESS | SEE_MASK_FLAG_NO_UI };
-                sei.lpFile = appPath.c_str();
-                sei.lpParameters = cmdLine.c_str();
-                sei.nShow = SW_SHOWDEFAULT;
-                ShellExecuteEx(&sei);
-                m_process = sei.hProcess;
-                WaitForSingleObject(m_process, INFINITE);
-                std::filesystem::remove(fileName);
-
-                std::wstring fileNameBmp = filePath + guid + L".bmp";
-                if (std::filesystem::exists(fileNameBmp))
-                {
-                    *phbmp = static_cast<HBITMAP>(LoadImage(NULL, fileNameBmp.c_str(), IMAGE_BITMAP, 0, 0, LR_LOADFROMFILE));
-                    *pdwAlpha = WTS_ALPHATYPE::WTSAT_ARGB;
-                    std::filesystem::remove(fileNameBmp);
-                }
-                else
-                {
-                    Logger::info(L"Bmp file not generated.");
-                    return E_FAIL;
-                }
-            }
-            catch (std::exception& e)
-            {
-                std::wstring errorMessage = std::wstring{ winrt::to_hstring(e.what()) };
-                Logger::error(L"Failed to start StlThumbnailProvider.exe. Error: {}", errorMessage);
-            }
+        if (mesh.stride > 1)
+        {
+            Logger::info(L"Rendering {} of {} triangles.", mesh.triangles.size(), mesh.sourceTriangles);
         }
-    }
 
-    // ensure releasing the stream (not all if branches contain it)
-    if (m_pStream)
+        ThumbnailCommon::RenderStlThumbnail(mesh, cx, color, image);
+        return S_OK;
+    };
+
+    const HRESULT hr = ThumbnailCommon::GetCachedThumbnail(stream.get(), cx, ThumbnailCommon::ThumbnailProvider::Stl, color, render, phbmp);
+    if (FAILED(hr))
     {
-        m_pStream->Release();
-        m_pStream = NULL;
+        return hr;
     }
 
+    *pdwAlpha = WTS_ALPHATYPE::WTSAT_ARGB;
     return S_OK;
 }
 
 #pragma endregion
-
-#pragma region Helper Functions
-
-#pragma endregion
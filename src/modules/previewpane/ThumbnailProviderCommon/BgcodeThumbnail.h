@@ -0,0 +1,162 @@
+#pragma once
+
+// Thumbnail extraction from binary G-code (.bgcode) files by walking the
+// block table (https://github.com/prusa3d/libbgcode/blob/main/doc/specifications.md).
+//
+// Thumbnail blocks sit between the metadata blocks and the G-code blocks, so
+// the walk stops at the first G-code block; block payloads that are not the
+// preferred thumbnail are skipped without being read.
+
+#include "EmbeddedThumbnail.h"
+
+#include <cstdint>
+#include <utility>
+
+namespace ThumbnailCommon
+{
+    namespace Bgcode
+    {
+        constexpr uint32_t MagicNumber = 'G' | 'C' << 8 | 'D' << 16 | 'E' << 24;
+        constexpr uint32_t Version = 1;
+
+        enum BlockType : uint16_t
+        {
+            FileMetadataBlock = 0,
+            GCodeBlock = 1,
+            SlicerMetadataBlock = 2,
+            PrinterMetadataBlock = 3,
+            PrintMetadataBlock = 4,
+            ThumbnailBlock = 5,
+        };
+
+        enum ThumbnailFormat : uint16_t
+        {
+            Png = 0,
+            Jpg = 1,
+            Qoi = 2,
+        };
+
+        constexpr uint16_t NoCompression = 0;
+        constexpr uint16_t ChecksumCrc32 = 1;
+        constexpr uint32_t ChecksumSize = 4;
+
+        // Parameters of a thumbnail block: format, width and height.
+        constexpr uint32_t ThumbnailParamsSize = 6;
+
+        // Parameters of every other block: encoding.
+        constexpr uint32_t BlockParamsSize = 2;
+
+        constexpr uint32_t MaxThumbnailBytes = 32 * 1024 * 1024;
+
+        inline uint16_t ReadUInt16(const uint8_t* bytes)
+        {
+            return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+        }
+
+        inline uint32_t ReadUInt32(const uint8_t* bytes)
+        {
+            return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+                   (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+        }
+
+        inline EmbeddedImageFormat ToImageFormat(uint16_t format)
+        {
+            switch (format)
+            {
+            case Png:
+                return EmbeddedImageFormat::Png;
+            case Jpg:
+                return EmbeddedImageFormat::Jpg;
+            case Qoi:
+                return EmbeddedImageFormat::Qoi;
+            default:
+                return EmbeddedImageFormat::Unknown;
+            }
+        }
+    }
+
+    // Finds the preferred thumbnail of a binary G-code stream.
+    // The reader provides:
+    //   bool Read(void* buffer, size_t size)  - reads exactly size bytes
+    //   bool Skip(uint64_t size)              - moves forward size bytes
+    // Thumbnails compressed inside the container are ignored; the reference
+    // encoder never compresses them since the images are already compressed.
+    template<typename Reader>
+    EmbeddedThumbnail FindBgcodeThumbnail(Reader& reader)
+    {
+        EmbeddedThumbnail best;
+
+        uint8_t header[10];
+        if (!reader.Read(header, sizeof(header)) ||
+            Bgcode::ReadUInt32(header) != Bgcode::MagicNumber ||
+            Bgcode::ReadUInt32(header + 4) != Bgcode::Version)
+        {
+            return best;
+        }
+        const bool hasChecksum = Bgcode::ReadUInt16(header + 8) == Bgcode::ChecksumCrc32;
+
+        for (;;)
+        {
+            uint8_t block[12];
+            if (!reader.Read(block, 8))
+            {
+                break;
+            }
+
+            const uint16_t type = Bgcode::ReadUInt16(block);
+            const uint16_t compression = Bgcode::ReadUInt16(block + 2);
+            uint32_t size = Bgcode::ReadUInt32(block + 4);
+            if (compression != Bgcode::NoCompression)
+            {
+                if (!reader.Read(block + 8, 4))
+                {
+                    break;
+                }
+                size = Bgcode::ReadUInt32(block + 8);
+            }
+
+            if (type == Bgcode::GCodeBlock || type > Bgcode::ThumbnailBlock)
+            {
+                break;
+            }
+
+            if (type == Bgcode::ThumbnailBlock)
+            {
+                uint8_t params[Bgcode::ThumbnailParamsSize];
+                if (!reader.Read(params, sizeof(params)))
+                {
+                    break;
+                }
+
+                const EmbeddedImageFormat format = Bgcode::ToImageFormat(Bgcode::ReadUInt16(params));
+                if (compression == Bgcode::NoCompression && size <= Bgcode::MaxThumbnailBytes &&
+                    IsBetterThumbnail(format, size, best))
+                {
+                    EmbeddedThumbnail candidate;
+                    candidate.format = format;
+                    candidate.data.resize(size);
+                    if (!reader.Read(candidate.data.data(), size))
+                    {
+                        break;
+                    }
+                    best = std::move(candidate);
+                }
+                else if (!reader.Skip(size))
+                {
+                    break;
+                }
+            }
+            else if (!reader.Skip(static_cast<uint64_t>(Bgcode::BlockParamsSize) + size))
+            {
+                break;
+            }
+
+            if (hasChecksum && !reader.Skip(Bgcode::ChecksumSize))
+            {
+                break;
+            }
+        }
+
+        return best;
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+// Thumbnail images embedded by slicers in G-code and binary G-code files.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ThumbnailCommon
+{
+    // Ordered by preference, the same way the managed helpers rank them.
+    enum class EmbeddedImageFormat
+    {
+        Unknown,
+        Jpg,
+        Qoi,
+        Png,
+    };
+
+    struct EmbeddedThumbnail
+    {
+        EmbeddedImageFormat format = EmbeddedImageFormat::Unknown;
+        std::vector<uint8_t> data;
+
+        bool empty() const { return format == EmbeddedImageFormat::Unknown || data.empty(); }
+    };
+
+    // True if a thumbnail of the given format and encoded size should replace
+    // the current best one: better format first, then the larger image.
+    inline bool IsBetterThumbnail(EmbeddedImageFormat format, size_t size, const EmbeddedThumbnail& best)
+    {
+        if (format == EmbeddedImageFormat::Unknown)
+        {
+            return false;
+        }
+        if (best.empty())
+        {
+            return true;
+        }
+        if (format != best.format)
+        {
+            return format > best.format;
+        }
+        return size > best.data.size();
+    }
+
+    // Appends the bytes encoded by a run of base64 text, keeping the decoder
+    // state so the text can arrive in several pieces. Whitespace is skipped;
+    // returns false on any other character outside the base64 alphabet.
+    class Base64Decoder
+    {
+    public:
+        bool Append(const char* text, size_t length, std::vector<uint8_t>& output)
+        {
+            for (size_t i = 0; i < length; i++)
+            {
+                const char ch = text[i];
+                if (ch == '=')
+                {
+                    m_padding = true;
+                    continue;
+                }
+
+                const int value = Decode(ch);
+                if (value < 0)
+                {
+                    if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n')
+                    {
+                        continue;
+                    }
+                    return false;
+                }
+                if (m_padding)
+                {
+                    return false;
+                }
+
+                m_bits = (m_bits << 6) | static_cast<uint32_t>(value);
+                m_bitCount += 6;
+                if (m_bitCount >= 8)
+                {
+                    m_bitCount -= 8;
+                    output.push_back(static_cast<uint8_t>(m_bits >> m_bitCount));
+                }
+            }
+            return true;
+        }
+
+        void Reset()
+        {
+            m_bits = 0;
+            m_bitCount = 0;
+            m_padding = false;
+        }
+
+    private:
+        static int Decode(char ch)
+        {
+            if (ch >= 'A' && ch <= 'Z')
+            {
+                return ch - 'A';
+            }
+            if (ch >= 'a' && ch <= 'z')
+            {
+                return ch - 'a' + 26;
+            }
+            if (ch >= '0' && ch <= '9')
+            {
+                return ch - '0' + 52;
+            }
+            if (ch == '+')
+            {
+                return 62;
+            }
+            if (ch == '/')
+            {
+                return 63;
+            }
+            return -1;
+        }
+
+        uint32_t m_bits = 0;
+        int m_bitCount = 0;
+        bool m_padding = false;
+    };
+}
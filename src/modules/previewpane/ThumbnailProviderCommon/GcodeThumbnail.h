@@ -0,0 +1,252 @@
+#pragma once
+
+// Streaming extraction of the base64 thumbnails that slicers write into the
+// header comments of a G-code file:
+//
+//   ; thumbnail[_JPG|_QOI] begin 300x300 12345
+//   ; iVBORw0KGgoAAAANSUhEUgAAASwAAAEsCAYAAAB5fY51AAAgAElEQVR4nOy9...
+//   ; thumbnail[_JPG|_QOI] end
+//
+// Slicers emit every thumbnail before the first move, so scanning stops at
+// the first G0-G3 command instead of reading what is often hundreds of
+// megabytes of toolpath.
+
+#include "EmbeddedThumbnail.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace ThumbnailCommon
+{
+    class GcodeThumbnailScanner
+    {
+    public:
+        // Encoded thumbnails larger than this are ignored.
+        static constexpr size_t MaxThumbnailBytes = 32 * 1024 * 1024;
+
+        // Comment lines are short; anything longer is truncated to this.
+        static constexpr size_t MaxLineLength = 4096;
+
+        // Consumes the next chunk of the file. Returns false once the
+        // header has been scanned and the rest of the file can be skipped.
+        bool Feed(const char* data, size_t size)
+        {
+            const char* end = data + size;
+            while (data < end && !m_done)
+            {
+                const char* newline = static_cast<const char*>(memchr(data, '\n', end - data));
+                const char* lineEnd = newline ? newline : end;
+
+                if (m_line.empty() && !m_lineTruncated && newline)
+                {
+                    // Whole line inside the chunk: no need to copy it
+                    ProcessLine(data, lineEnd - data, false);
+                }
+                else
+                {
+                    AppendToLine(data, lineEnd - data);
+                    if (newline)
+                    {
+                        ProcessLine(m_line.data(), m_line.size(), m_lineTruncated);
+                        m_line.clear();
+                        m_lineTruncated = false;
+                    }
+                }
+
+                data = newline ? newline + 1 : end;
+            }
+            return !m_done;
+        }
+
+        // Processes a final line that was not terminated by a newline.
+        void Finish()
+        {
+            if (!m_line.empty())
+            {
+                ProcessLine(m_line.data(), m_line.size(), m_lineTruncated);
+                m_line.clear();
+            }
+            m_done = true;
+        }
+
+        bool IsDone() const { return m_done; }
+
+        // The preferred thumbnail found so far; empty if there is none.
+        EmbeddedThumbnail TakeBest() { return std::move(m_best); }
+
+    private:
+        static bool StartsWith(const char* text, size_t length, const char* prefix)
+        {
+            const size_t prefixLength = strlen(prefix);
+            return length >= prefixLength && memcmp(text, prefix, prefixLength) == 0;
+        }
+
+        static bool EqualsIgnoreCase(const char* text, size_t length, const char* value)
+        {
+            if (length != strlen(value))
+            {
+                return false;
+            }
+            for (size_t i = 0; i < length; i++)
+            {
+                const char ch = (text[i] >= 'a' && text[i] <= 'z') ? static_cast<char>(text[i] - 'a' + 'A') : text[i];
+                if (ch != value[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static bool IsMoveCommand(const char* text, size_t length)
+        {
+            size_t i = 0;
+            while (i < length && (text[i] == ' ' || text[i] == '\t'))
+            {
+                i++;
+            }
+            if (length - i < 2 || (text[i] != 'G' && text[i] != 'g') || text[i + 1] < '0' || text[i + 1] > '3')
+            {
+                return false;
+            }
+            return length - i == 2 || text[i + 2] < '0' || text[i + 2] > '9';
+        }
+
+        void AppendToLine(const char* data, size_t length)
+        {
+            const size_t room = MaxLineLength - m_line.size();
+            if (length > room)
+            {
+                length = room;
+                m_lineTruncated = true;
+            }
+            m_line.append(data, length);
+        }
+
+        void ProcessLine(const char* line, size_t length, bool truncated)
+        {
+            if (length > 0 && line[length - 1] == '\r')
+            {
+                length--;
+            }
+
+            if (StartsWith(line, length, "; thumbnail"))
+            {
+                // "; thumbnail<suffix> <keyword> ..."
+                const char* suffix = line + 11;
+                const char* lineEnd = line + length;
+                const char* space = static_cast<const char*>(memchr(suffix, ' ', lineEnd - suffix));
+                if (!space)
+                {
+                    return;
+                }
+                const char* keyword = space + 1;
+                const char* keywordEnd = static_cast<const char*>(memchr(keyword, ' ', lineEnd - keyword));
+                const size_t keywordLength = (keywordEnd ? keywordEnd : lineEnd) - keyword;
+
+                if (keywordLength == 5 && memcmp(keyword, "begin", 5) == 0)
+                {
+                    BeginCapture(ParseFormat(suffix, space - suffix));
+                }
+                else if (keywordLength == 3 && memcmp(keyword, "end", 3) == 0)
+                {
+                    EndCapture();
+                }
+                return;
+            }
+
+            if (m_capturing)
+            {
+                // Base64 payload lines are "; <data>"
+                const size_t skip = std::min<size_t>(length, 2);
+                if (truncated || m_capture.data.size() > MaxThumbnailBytes ||
+                    !m_base64.Append(line + skip, length - skip, m_capture.data))
+                {
+                    m_captureValid = false;
+                }
+                return;
+            }
+
+            if (IsMoveCommand(line, length))
+            {
+                m_done = true;
+            }
+        }
+
+        static EmbeddedImageFormat ParseFormat(const char* suffix, size_t length)
+        {
+            if (length == 0)
+            {
+                return EmbeddedImageFormat::Png;
+            }
+            if (EqualsIgnoreCase(suffix, length, "_JPG"))
+            {
+                return EmbeddedImageFormat::Jpg;
+            }
+            if (EqualsIgnoreCase(suffix, length, "_QOI"))
+            {
+                return EmbeddedImageFormat::Qoi;
+            }
+            return EmbeddedImageFormat::Unknown;
+        }
+
+        void BeginCapture(EmbeddedImageFormat format)
+        {
+            m_capturing = true;
+            m_captureValid = format != EmbeddedImageFormat::Unknown;
+            m_capture.format = format;
+            m_capture.data.clear();
+            m_base64.Reset();
+        }
+
+        void EndCapture()
+        {
+            if (!m_capturing)
+            {
+                return;
+            }
+            m_capturing = false;
+            if (m_captureValid && IsBetterThumbnail(m_capture.format, m_capture.data.size(), m_best))
+            {
+                std::swap(m_best, m_capture);
+            }
+            m_capture.data.clear();
+        }
+
+        std::string m_line;
+        bool m_lineTruncated = false;
+        bool m_done = false;
+
+        bool m_capturing = false;
+        bool m_captureValid = false;
+        EmbeddedThumbnail m_capture;
+        Base64Decoder m_base64;
+
+        EmbeddedThumbnail m_best;
+    };
+
+    // Scans a G-code stream for its preferred embedded thumbnail.
+    // read(buffer, size) returns the number of bytes read, 0 at end of stream.
+    template<typename Reader>
+    EmbeddedThumbnail FindGcodeThumbnail(Reader&& read)
+    {
+        GcodeThumbnailScanner scanner;
+        char buffer[64 * 1024];
+        for (;;)
+        {
+            const size_t bytesRead = read(buffer, sizeof(buffer));
+            if (bytesRead == 0)
+            {
+                scanner.Finish();
+                break;
+            }
+            if (!scanner.Feed(buffer, bytesRead))
+            {
+                break;
+            }
+        }
+        return scanner.TakeBest();
+    }
+}
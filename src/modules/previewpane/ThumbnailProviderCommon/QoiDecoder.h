@@ -0,0 +1,325 @@
+#pragma once
+
+// Streaming QOI decoder (https://qoiformat.org/qoi-specification.pdf).
+//
+// Data is fed in arbitrarily sized chunks and decoded rows are handed to a
+// callback as soon as they are complete, so a thumbnail can be downscaled
+// while the stream is read without ever holding the full image in memory.
+
+#include "ThumbnailImage.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+namespace ThumbnailCommon
+{
+    class QoiDecoder
+    {
+    public:
+        static constexpr size_t HeaderSize = 14;
+        static constexpr uint64_t MaxPixels = 400000000;
+
+        // Rows wider than this are rejected rather than allocating an
+        // unbounded row buffer.
+        static constexpr uint32_t MaxWidth = 1u << 20;
+
+        struct Header
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint8_t channels = 0;
+            uint8_t colorspace = 0;
+        };
+
+        enum class State
+        {
+            Header,
+            Pixels,
+            Done,
+            Error,
+        };
+
+        // Returns false if the header was rejected; decoding stops.
+        using HeaderCallback = bool (*)(void* context, const Header& header);
+        using RowCallback = void (*)(void* context, const uint32_t* row, uint32_t y);
+
+        QoiDecoder(void* context, HeaderCallback onHeader, RowCallback onRow) :
+            m_context(context), m_onHeader(onHeader), m_onRow(onRow)
+        {
+        }
+
+        State GetState() const { return m_state; }
+        const Header& GetHeader() const { return m_header; }
+
+        // Consumes the next chunk of the file. Returns false once decoding has
+        // failed; returns true while more data is wanted or once all rows
+        // have been produced (GetState() == State::Done).
+        bool Feed(const uint8_t* data, size_t size)
+        {
+            while (size > 0 && m_state == State::Header)
+            {
+                const size_t take = std::min(size, HeaderSize - m_pendingSize);
+                memcpy(m_pending + m_pendingSize, data, take);
+                m_pendingSize += take;
+                data += take;
+                size -= take;
+                if (m_pendingSize == HeaderSize)
+                {
+                    m_pendingSize = 0;
+                    ParseHeader();
+                }
+            }
+
+            if (m_state != State::Pixels)
+            {
+                return m_state != State::Error;
+            }
+
+            // Finish an op that was split across chunks
+            if (m_pendingSize > 0)
+            {
+                const size_t needed = OpLength(m_pending[0]);
+                const size_t take = std::min(size, needed - m_pendingSize);
+                memcpy(m_pending + m_pendingSize, data, take);
+                m_pendingSize += take;
+                data += take;
+                size -= take;
+                if (m_pendingSize < needed)
+                {
+                    return true;
+                }
+                m_pendingSize = 0;
+                DecodeOp(m_pending);
+            }
+
+            const uint8_t* end = data + size;
+            while (m_state == State::Pixels)
+            {
+                if (m_run > 0)
+                {
+                    EmitRun();
+                    continue;
+                }
+                if (data == end)
+                {
+                    break;
+                }
+
+                const size_t length = OpLength(*data);
+                if (static_cast<size_t>(end - data) < length)
+                {
+                    m_pendingSize = end - data;
+                    memcpy(m_pending, data, m_pendingSize);
+                    break;
+                }
+                DecodeOp(data);
+                data += length;
+            }
+
+            return m_state != State::Error;
+        }
+
+    private:
+        static constexpr uint8_t OpIndex = 0x00;
+        static constexpr uint8_t OpDiff = 0x40;
+        static constexpr uint8_t OpLuma = 0x80;
+        static constexpr uint8_t OpRun = 0xC0;
+        static constexpr uint8_t OpRgb = 0xFE;
+        static constexpr uint8_t OpRgba = 0xFF;
+        static constexpr uint8_t Mask2 = 0xC0;
+
+        static size_t OpLength(uint8_t op)
+        {
+            if (op == OpRgba)
+            {
+                return 5;
+            }
+            if (op == OpRgb)
+            {
+                return 4;
+            }
+            return (op & Mask2) == OpLuma ? 2 : 1;
+        }
+
+        static uint32_t ReadBigEndian(const uint8_t* bytes)
+        {
+            return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+        }
+
+        void ParseHeader()
+        {
+            if (memcmp(m_pending, "qoif", 4) != 0)
+            {
+                m_state = State::Error;
+                return;
+            }
+
+            m_header.width = ReadBigEndian(m_pending + 4);
+            m_header.height = ReadBigEndian(m_pending + 8);
+            m_header.channels = m_pending[12];
+            m_header.colorspace = m_pending[13];
+
+            if (m_header.width == 0 || m_header.height == 0 || m_header.width > MaxWidth ||
+                static_cast<uint64_t>(m_header.width) * m_header.height > MaxPixels ||
+                m_header.channels < 3 || m_header.channels > 4 || m_header.colorspace > 1 ||
+                !m_onHeader(m_context, m_header))
+            {
+                m_state = State::Error;
+                return;
+            }
+
+            m_row.resize(m_header.width);
+            m_state = State::Pixels;
+        }
+
+        void DecodeOp(const uint8_t* op)
+        {
+            const uint8_t b1 = op[0];
+            if (b1 == OpRgb)
+            {
+                m_r = op[1];
+                m_g = op[2];
+                m_b = op[3];
+            }
+            else if (b1 == OpRgba)
+            {
+                m_r = op[1];
+                m_g = op[2];
+                m_b = op[3];
+                m_a = op[4];
+            }
+            else
+            {
+                switch (b1 & Mask2)
+                {
+                case OpIndex:
+                {
+                    const uint32_t pixel = m_index[b1];
+                    m_b = static_cast<uint8_t>(pixel);
+                    m_g = static_cast<uint8_t>(pixel >> 8);
+                    m_r = static_cast<uint8_t>(pixel >> 16);
+                    m_a = static_cast<uint8_t>(pixel >> 24);
+                    break;
+                }
+                case OpDiff:
+                    m_r = static_cast<uint8_t>(m_r + ((b1 >> 4) & 0x03) - 2);
+                    m_g = static_cast<uint8_t>(m_g + ((b1 >> 2) & 0x03) - 2);
+                    m_b = static_cast<uint8_t>(m_b + (b1 & 0x03) - 2);
+                    break;
+                case OpLuma:
+                {
+                    const int dg = (b1 & 0x3F) - 32;
+                    const uint8_t b2 = op[1];
+                    m_r = static_cast<uint8_t>(m_r + dg - 8 + ((b2 >> 4) & 0x0F));
+                    m_g = static_cast<uint8_t>(m_g + dg);
+                    m_b = static_cast<uint8_t>(m_b + dg - 8 + (b2 & 0x0F));
+                    break;
+                }
+                default:
+                    // OpRun stores the pixel once and repeats it run more times
+                    m_run = b1 & 0x3F;
+                    break;
+                }
+            }
+
+            const uint32_t pixel = MakeBgra(m_r, m_g, m_b, m_a);
+            m_index[(m_r * 3 + m_g * 5 + m_b * 7 + m_a * 11) & 63] = pixel;
+            Emit(pixel);
+        }
+
+        void EmitRun()
+        {
+            const uint32_t pixel = MakeBgra(m_r, m_g, m_b, m_a);
+            while (m_run > 0 && m_state == State::Pixels)
+            {
+                m_run--;
+                Emit(pixel);
+            }
+        }
+
+        void Emit(uint32_t pixel)
+        {
+            m_row[m_x++] = pixel;
+            if (m_x == m_header.width)
+            {
+                m_onRow(m_context, m_row.data(), m_y);
+                m_x = 0;
+                if (++m_y == m_header.height)
+                {
+                    m_state = State::Done;
+                }
+            }
+        }
+
+        void* m_context;
+        HeaderCallback m_onHeader;
+        RowCallback m_onRow;
+
+        State m_state = State::Header;
+        Header m_header;
+
+        uint8_t m_pending[HeaderSize] = {};
+        size_t m_pendingSize = 0;
+
+        uint8_t m_r = 0;
+        uint8_t m_g = 0;
+        uint8_t m_b = 0;
+        uint8_t m_a = 255;
+        uint32_t m_index[64] = {};
+        uint32_t m_run = 0;
+
+        std::vector<uint32_t> m_row;
+        uint32_t m_x = 0;
+        uint32_t m_y = 0;
+    };
+
+    // Decodes a QOI stream straight into a thumbnail that fits in cx x cx.
+    // read(buffer, size) returns the number of bytes read, 0 at end of stream.
+    // Reading stops as soon as the last row has been decoded.
+    template<typename Reader>
+    bool DecodeQoiThumbnail(Reader&& read, uint32_t cx, ThumbnailImage& image)
+    {
+        struct Context
+        {
+            uint32_t cx;
+            std::optional<ThumbnailScaler> scaler;
+        } context{ cx, std::nullopt };
+
+        QoiDecoder decoder(
+            &context,
+            [](void* state, const QoiDecoder::Header& header) {
+                auto& ctx = *static_cast<Context*>(state);
+                uint32_t width;
+                uint32_t height;
+                FitThumbnailSize(header.width, header.height, ctx.cx, width, height);
+                ctx.scaler.emplace(header.width, header.height, width, height);
+                return true;
+            },
+            [](void* state, const uint32_t* row, uint32_t) {
+                static_cast<Context*>(state)->scaler->AddRow(row);
+            });
+
+        uint8_t buffer[64 * 1024];
+        while (decoder.GetState() == QoiDecoder::State::Header || decoder.GetState() == QoiDecoder::State::Pixels)
+        {
+            const size_t bytesRead = read(buffer, sizeof(buffer));
+            if (bytesRead == 0 || !decoder.Feed(buffer, bytesRead))
+            {
+                break;
+            }
+        }
+
+        // A truncated image still makes a usable thumbnail once a few rows
+        // have been decoded; anything else is rejected.
+        if (!context.scaler || decoder.GetState() == QoiDecoder::State::Error || context.scaler->RowsAdded() == 0)
+        {
+            return false;
+        }
+
+        image = context.scaler->Finish();
+        return true;
+    }
+}
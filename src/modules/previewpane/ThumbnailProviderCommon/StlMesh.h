@@ -0,0 +1,323 @@
+#pragma once
+
+// Streaming STL reader for the thumbnail rasterizer. Binary and ASCII files
+// are read in chunks; very large meshes are decimated while they are read so
+// memory stays bounded no matter how many triangles the file holds.
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace ThumbnailCommon
+{
+    struct StlTriangle
+    {
+        float v[3][3];
+    };
+
+    struct StlMesh
+    {
+        // Triangles kept for rendering; every stride-th triangle of the file.
+        std::vector<StlTriangle> triangles;
+
+        // Bounds of every triangle in the file, kept or not.
+        float min[3] = { INFINITY, INFINITY, INFINITY };
+        float max[3] = { -INFINITY, -INFINITY, -INFINITY };
+
+        uint64_t sourceTriangles = 0;
+        uint64_t stride = 1;
+
+        bool empty() const { return triangles.empty(); }
+    };
+
+    // Collects triangles into a mesh, keeping at most maxTriangles of them.
+    // Once the budget is reached every other kept triangle is dropped and the
+    // sampling stride doubles, so the kept set stays evenly spread over the
+    // file.
+    class StlMeshBuilder
+    {
+    public:
+        static constexpr size_t DefaultMaxTriangles = 1 << 20;
+
+        explicit StlMeshBuilder(StlMesh& mesh, size_t maxTriangles = DefaultMaxTriangles) :
+            m_mesh(mesh), m_maxTriangles(std::max<size_t>(maxTriangles, 2))
+        {
+            m_mesh = StlMesh{};
+        }
+
+        // Starts with a stride that already fits the budget when the triangle
+        // count is known up front.
+        void Reserve(uint64_t triangleCount)
+        {
+            while (triangleCount / m_mesh.stride > m_maxTriangles)
+            {
+                m_mesh.stride *= 2;
+            }
+            m_mesh.triangles.reserve(static_cast<size_t>(std::min<uint64_t>(triangleCount / m_mesh.stride + 1, m_maxTriangles)));
+        }
+
+        void Add(const float (&v)[3][3])
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    if (!std::isfinite(v[i][axis]))
+                    {
+                        return;
+                    }
+                }
+            }
+
+            for (int i = 0; i < 3; i++)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    m_mesh.min[axis] = std::min(m_mesh.min[axis], v[i][axis]);
+                    m_mesh.max[axis] = std::max(m_mesh.max[axis], v[i][axis]);
+                }
+            }
+
+            if (m_mesh.sourceTriangles++ % m_mesh.stride != 0)
+            {
+                return;
+            }
+
+            if (m_mesh.triangles.size() == m_maxTriangles)
+            {
+                size_t kept = 0;
+                for (size_t i = 0; i < m_mesh.triangles.size(); i += 2)
+                {
+                    m_mesh.triangles[kept++] = m_mesh.triangles[i];
+                }
+                m_mesh.triangles.resize(kept);
+                m_mesh.stride *= 2;
+
+                // The current triangle sits at an odd multiple of the old
+                // stride unless the new stride divides its index.
+                if ((m_mesh.sourceTriangles - 1) % m_mesh.stride != 0)
+                {
+                    return;
+                }
+            }
+
+            StlTriangle triangle;
+            memcpy(triangle.v, v, sizeof(triangle.v));
+            m_mesh.triangles.push_back(triangle);
+        }
+
+    private:
+        StlMesh& m_mesh;
+        size_t m_maxTriangles;
+    };
+
+    // Line based parser for ASCII STL. Only "vertex x y z" lines matter;
+    // every three of them make a triangle.
+    class StlAsciiParser
+    {
+    public:
+        explicit StlAsciiParser(StlMeshBuilder& builder) :
+            m_builder(builder)
+        {
+        }
+
+        void Feed(const char* data, size_t size)
+        {
+            const char* end = data + size;
+            while (data < end)
+            {
+                const char* newline = static_cast<const char*>(memchr(data, '\n', end - data));
+                const char* lineEnd = newline ? newline : end;
+
+                if (m_line.empty() && newline)
+                {
+                    ParseLine(data, lineEnd);
+                }
+                else
+                {
+                    if (m_line.size() < MaxLineLength)
+                    {
+                        m_line.append(data, std::min<size_t>(lineEnd - data, MaxLineLength - m_line.size()));
+                    }
+                    if (newline)
+                    {
+                        ParseLine(m_line.data(), m_line.data() + m_line.size());
+                        m_line.clear();
+                    }
+                }
+
+                data = newline ? newline + 1 : end;
+            }
+        }
+
+        void Finish()
+        {
+            if (!m_line.empty())
+            {
+                ParseLine(m_line.data(), m_line.data() + m_line.size());
+                m_line.clear();
+            }
+        }
+
+    private:
+        static constexpr size_t MaxLineLength = 256;
+
+        static const char* SkipSpaces(const char* p, const char* end)
+        {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            {
+                p++;
+            }
+            return p;
+        }
+
+        void ParseLine(const char* p, const char* end)
+        {
+            p = SkipSpaces(p, end);
+            if (end - p < 6 || memcmp(p, "vertex", 6) != 0)
+            {
+                return;
+            }
+            p += 6;
+
+            for (int axis = 0; axis < 3; axis++)
+            {
+                p = SkipSpaces(p, end);
+                if (p < end && *p == '+')
+                {
+                    p++;
+                }
+                const auto result = std::from_chars(p, end, m_vertices[m_vertexCount][axis]);
+                if (result.ec != std::errc{})
+                {
+                    // Drop the partial facet
+                    m_vertexCount = 0;
+                    return;
+                }
+                p = result.ptr;
+            }
+
+            if (++m_vertexCount == 3)
+            {
+                m_builder.Add(m_vertices);
+                m_vertexCount = 0;
+            }
+        }
+
+        StlMeshBuilder& m_builder;
+        std::string m_line;
+        float m_vertices[3][3] = {};
+        int m_vertexCount = 0;
+    };
+
+    // Reads an STL stream into mesh. read(buffer, size) returns the number of
+    // bytes read, 0 at end of stream. streamSize is the total size if known
+    // (0 otherwise); it tells binary files whose header starts with "solid"
+    // apart from ASCII ones.
+    template<typename Reader>
+    bool ReadStlMesh(Reader&& read, uint64_t streamSize, StlMesh& mesh, size_t maxTriangles = StlMeshBuilder::DefaultMaxTriangles)
+    {
+        constexpr size_t BinaryHeaderSize = 84;
+        constexpr size_t BinaryTriangleSize = 50;
+
+        StlMeshBuilder builder(mesh, maxTriangles);
+
+        std::vector<char> buffer(64 * 1024);
+        size_t filled = 0;
+        while (filled < BinaryHeaderSize)
+        {
+            const size_t bytesRead = read(buffer.data() + filled, buffer.size() - filled);
+            if (bytesRead == 0)
+            {
+                break;
+            }
+            filled += bytesRead;
+        }
+
+        uint32_t binaryCount = 0;
+        if (filled >= BinaryHeaderSize)
+        {
+            memcpy(&binaryCount, buffer.data() + 80, sizeof(binaryCount));
+        }
+
+        bool ascii = filled >= 5 && memcmp(buffer.data(), "solid", 5) == 0;
+        if (ascii && filled >= BinaryHeaderSize)
+        {
+            if (streamSize != 0)
+            {
+                ascii = streamSize != BinaryHeaderSize + static_cast<uint64_t>(binaryCount) * BinaryTriangleSize;
+            }
+            else
+            {
+                // Binary headers that start with "solid" still hold a raw
+                // triangle count, which is hardly ever printable text.
+                ascii = std::all_of(buffer.data(), buffer.data() + BinaryHeaderSize, [](char ch) {
+                    return ch == '\n' || ch == '\r' || ch == '\t' || (ch >= 0x20 && ch < 0x7F);
+                });
+            }
+        }
+
+        if (ascii)
+        {
+            StlAsciiParser parser(builder);
+            parser.Feed(buffer.data(), filled);
+            for (;;)
+            {
+                const size_t bytesRead = read(buffer.data(), buffer.size());
+                if (bytesRead == 0)
+                {
+                    break;
+                }
+                parser.Feed(buffer.data(), bytesRead);
+            }
+            parser.Finish();
+            return !mesh.empty();
+        }
+
+        if (filled < BinaryHeaderSize)
+        {
+            return false;
+        }
+
+        builder.Reserve(binaryCount);
+
+        // Keep whole triangles at the front of the buffer between reads
+        size_t offset = BinaryHeaderSize;
+        uint64_t remaining = binaryCount;
+        while (remaining > 0)
+        {
+            while (remaining > 0 && filled - offset >= BinaryTriangleSize)
+            {
+                float v[3][3];
+                memcpy(v, buffer.data() + offset + 12, sizeof(v)); // Skip the facet normal
+                builder.Add(v);
+                offset += BinaryTriangleSize;
+                remaining--;
+            }
+            if (remaining == 0)
+            {
+                break;
+            }
+
+            const size_t leftover = filled - offset;
+            memmove(buffer.data(), buffer.data() + offset, leftover);
+            offset = 0;
+            filled = leftover;
+
+            const size_t bytesRead = read(buffer.data() + filled, buffer.size() - filled);
+            if (bytesRead == 0)
+            {
+                // Truncated file: render what was read
+                break;
+            }
+            filled += bytesRead;
+        }
+
+        return !mesh.empty();
+    }
+}
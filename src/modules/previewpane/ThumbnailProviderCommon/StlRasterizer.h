@@ -0,0 +1,247 @@
+#pragma once
+
+// CPU z-buffer rasterizer for STL thumbnails. The camera matches the one the
+// managed provider set up with HelixToolkit: a 20 degree perspective view from
+// the (-1, -2, 1) direction with Z up, zoomed to the extents of the mesh.
+//
+// The image is split into horizontal bands rendered by separate threads, so
+// no pixel is ever written by two threads and nothing needs merging.
+
+#include "StlMesh.h"
+#include "ThumbnailImage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace ThumbnailCommon
+{
+    namespace StlRender
+    {
+        struct Vec3
+        {
+            float x;
+            float y;
+            float z;
+        };
+
+        inline Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+        inline float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+        inline Vec3 Cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+        inline Vec3 Normalize(const Vec3& v)
+        {
+            const float length = std::sqrt(Dot(v, v));
+            return length > 0 ? Vec3{ v.x / length, v.y / length, v.z / length } : Vec3{ 0, 0, 0 };
+        }
+
+        constexpr float FieldOfViewDegrees = 20.0f;
+        constexpr float AmbientLight = 0.25f;
+        constexpr float KeyLight = 0.6f;
+        constexpr float FillLight = 0.25f;
+
+        // Runs work(begin, end) over [0, count) split across threadCount threads.
+        template<typename Work>
+        void ParallelFor(size_t count, unsigned threadCount, Work&& work)
+        {
+            if (threadCount <= 1 || count < threadCount)
+            {
+                work(size_t{ 0 }, count);
+                return;
+            }
+
+            std::vector<std::thread> threads;
+            threads.reserve(threadCount - 1);
+            const size_t chunk = (count + threadCount - 1) / threadCount;
+            for (unsigned i = 1; i < threadCount; i++)
+            {
+                const size_t begin = std::min(count, i * chunk);
+                const size_t end = std::min(count, begin + chunk);
+                try
+                {
+                    threads.emplace_back([&work, begin, end] { work(begin, end); });
+                }
+                catch (const std::system_error&)
+                {
+                    // Out of threads: do this part on the calling thread
+                    work(begin, end);
+                }
+            }
+            work(size_t{ 0 }, std::min(count, chunk));
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+        }
+    }
+
+    // Renders the mesh into a size x size image with a transparent background.
+    // The mesh triangles are transformed to screen space in place. color is
+    // the material color as 0xRRGGBB. threadCount 0 picks one per core.
+    inline bool RenderStlThumbnail(StlMesh& mesh, uint32_t size, uint32_t color, ThumbnailImage& image, unsigned threadCount = 0)
+    {
+        using namespace StlRender;
+
+        if (mesh.empty() || size == 0)
+        {
+            return false;
+        }
+
+        if (threadCount == 0)
+        {
+            threadCount = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+        }
+
+        // Camera, zoomed to fit the bounding box like HelixToolkit's ZoomExtents
+        const Vec3 center = { (mesh.min[0] + mesh.max[0]) / 2, (mesh.min[1] + mesh.max[1]) / 2, (mesh.min[2] + mesh.max[2]) / 2 };
+        const Vec3 extent = { mesh.max[0] - mesh.min[0], mesh.max[1] - mesh.min[1], mesh.max[2] - mesh.min[2] };
+        const float radius = std::max(std::sqrt(Dot(extent, extent)) / 2, 1e-6f);
+        const float halfFov = FieldOfViewDegrees * 3.14159265f / 360.0f;
+        const float distance = radius / std::tan(halfFov);
+
+        const Vec3 forward = Normalize({ 1, 2, -1 });
+        const Vec3 right = Normalize(Cross(forward, { 0, 0, 1 }));
+        const Vec3 up = Cross(right, forward);
+        const Vec3 eye = { center.x - forward.x * distance, center.y - forward.y * distance, center.z - forward.z * distance };
+        const float half = static_cast<float>(size) / 2;
+        const float focal = half / std::tan(halfFov);
+
+        // Lights are fixed relative to the camera: a key light from the upper
+        // left and a dimmer fill light from the right.
+        const Vec3 keyLight = Normalize({ -right.x + up.x - forward.x, -right.y + up.y - forward.y, -right.z + up.z - forward.z });
+        const Vec3 fillLight = Normalize({ right.x - forward.x, right.y - forward.y, right.z - forward.z });
+
+        const float red = static_cast<float>((color >> 16) & 0xFF);
+        const float green = static_cast<float>((color >> 8) & 0xFF);
+        const float blue = static_cast<float>(color & 0xFF);
+
+        // Shade each triangle and project its vertices to (x, y, 1 / depth)
+        std::vector<uint32_t> colors(mesh.triangles.size());
+        ParallelFor(mesh.triangles.size(), threadCount, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                auto& v = mesh.triangles[i].v;
+                const Vec3 p0 = { v[0][0], v[0][1], v[0][2] };
+                const Vec3 p1 = { v[1][0], v[1][1], v[1][2] };
+                const Vec3 p2 = { v[2][0], v[2][1], v[2][2] };
+
+                // Two sided lighting: STL winding and normals are unreliable
+                const Vec3 normal = Normalize(Cross(p1 - p0, p2 - p0));
+                const float light = std::min(1.0f, AmbientLight + KeyLight * std::fabs(Dot(normal, keyLight)) + FillLight * std::fabs(Dot(normal, fillLight)));
+                colors[i] = MakeBgra(static_cast<uint8_t>(red * light), static_cast<uint8_t>(green * light), static_cast<uint8_t>(blue * light), 255);
+
+                for (int k = 0; k < 3; k++)
+                {
+                    const Vec3 relative = Vec3{ v[k][0], v[k][1], v[k][2] } - eye;
+                    const float depth = std::max(Dot(relative, forward), 1e-6f);
+                    v[k][0] = half + Dot(relative, right) / depth * focal;
+                    v[k][1] = half - Dot(relative, up) / depth * focal;
+                    v[k][2] = 1.0f / depth;
+                }
+            }
+        });
+
+        image.width = size;
+        image.height = size;
+        image.pixels.assign(static_cast<size_t>(size) * size, 0);
+        std::vector<float> depthBuffer(static_cast<size_t>(size) * size, 0.0f);
+
+        // At least a few rows per band so thin bands do not multiply the
+        // per-triangle rejection work for nothing.
+        const unsigned bands = std::max(1u, std::min(threadCount, size / 16));
+        ParallelFor(bands, bands, [&](size_t firstBand, size_t lastBand) {
+            for (size_t band = firstBand; band < lastBand; band++)
+            {
+                const int bandTop = static_cast<int>(band * size / bands);
+                const int bandBottom = static_cast<int>((band + 1) * size / bands);
+
+                for (size_t i = 0; i < mesh.triangles.size(); i++)
+                {
+                    const auto& v = mesh.triangles[i].v;
+                    const float minX = std::min({ v[0][0], v[1][0], v[2][0] });
+                    const float maxX = std::max({ v[0][0], v[1][0], v[2][0] });
+                    const float minY = std::min({ v[0][1], v[1][1], v[2][1] });
+                    const float maxY = std::max({ v[0][1], v[1][1], v[2][1] });
+                    if (maxX < 0 || maxY < static_cast<float>(bandTop) || minX >= static_cast<float>(size) || minY >= static_cast<float>(bandBottom))
+                    {
+                        continue;
+                    }
+
+                    const int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+                    const int x1 = std::min(static_cast<int>(size) - 1, static_cast<int>(std::floor(maxX)));
+                    const int y0 = std::max(bandTop, static_cast<int>(std::floor(minY)));
+                    const int y1 = std::min(bandBottom - 1, static_cast<int>(std::floor(maxY)));
+
+                    if (x0 == x1 && y0 == y1)
+                    {
+                        // Sub-pixel triangle: splat it instead of sampling,
+                        // which would often miss the pixel center entirely.
+                        const float depth = (v[0][2] + v[1][2] + v[2][2]) / 3;
+                        const size_t index = static_cast<size_t>(y0) * size + x0;
+                        if (depth > depthBuffer[index])
+                        {
+                            depthBuffer[index] = depth;
+                            image.pixels[index] = colors[i];
+                        }
+                        continue;
+                    }
+
+                    const float area = (v[1][0] - v[0][0]) * (v[2][1] - v[0][1]) - (v[1][1] - v[0][1]) * (v[2][0] - v[0][0]);
+                    if (area == 0)
+                    {
+                        continue;
+                    }
+                    const float sign = area > 0 ? 1.0f : -1.0f;
+                    const float inverseArea = 1.0f / std::fabs(area);
+
+                    // Edge functions at the first pixel center and their steps
+                    const float px = static_cast<float>(x0) + 0.5f;
+                    const float py = static_cast<float>(y0) + 0.5f;
+                    float w[3];
+                    float stepX[3];
+                    float stepY[3];
+                    for (int e = 0; e < 3; e++)
+                    {
+                        const auto& a = v[(e + 1) % 3];
+                        const auto& b = v[(e + 2) % 3];
+                        w[e] = sign * ((b[0] - a[0]) * (py - a[1]) - (b[1] - a[1]) * (px - a[0]));
+                        stepX[e] = -sign * (b[1] - a[1]);
+                        stepY[e] = sign * (b[0] - a[0]);
+                    }
+
+                    for (int y = y0; y <= y1; y++)
+                    {
+                        float e0 = w[0];
+                        float e1 = w[1];
+                        float e2 = w[2];
+                        float* depthRow = &depthBuffer[static_cast<size_t>(y) * size];
+                        uint32_t* colorRow = &image.pixels[static_cast<size_t>(y) * size];
+                        for (int x = x0; x <= x1; x++)
+                        {
+                            if (e0 >= 0 && e1 >= 0 && e2 >= 0)
+                            {
+                                const float depth = (e0 * v[0][2] + e1 * v[1][2] + e2 * v[2][2]) * inverseArea;
+                                if (depth > depthRow[x])
+                                {
+                                    depthRow[x] = depth;
+                                    colorRow[x] = colors[i];
+                                }
+                            }
+                            e0 += stepX[0];
+                            e1 += stepX[1];
+                            e2 += stepX[2];
+                        }
+                        w[0] += stepY[0];
+                        w[1] += stepY[1];
+                        w[2] += stepY[2];
+                    }
+                }
+            }
+        });
+
+        return true;
+    }
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+// Windows glue for the portable thumbnail decoders: reading the shell stream,
+// decoding formats handled by WIC and handing the decoded pixels back to
+// Explorer as a DIB section.
+
+#include "EmbeddedThumbnail.h"
+#include "QoiDecoder.h"
+#include "ThumbnailImage.h"
+
+#include <windows.h>
+#include <objidl.h>
+#include <Shlwapi.h>
+#include <wincodec.h>
+
+#include <wil/com.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace ThumbnailCommon
+{
+    // Reads up to size bytes from the stream. Returns 0 at end of stream or
+    // on error so it can be used directly as a decoder reader.
+    inline size_t ReadStream(IStream* stream, void* buffer, size_t size)
+    {
+        ULONG bytesRead = 0;
+        const HRESULT hr = stream->Read(buffer, static_cast<ULONG>(size), &bytesRead);
+        return FAILED(hr) ? 0 : bytesRead;
+    }
+
+    // Sequential reader over an IStream for decoders that need exact reads
+    // and forward seeks.
+    class StreamReader
+    {
+    public:
+        explicit StreamReader(IStream* stream) :
+            m_stream(stream)
+        {
+        }
+
+        bool Read(void* buffer, size_t size)
+        {
+            ULONG bytesRead = 0;
+            return SUCCEEDED(m_stream->Read(buffer, static_cast<ULONG>(size), &bytesRead)) && bytesRead == size;
+        }
+
+        bool Skip(uint64_t size)
+        {
+            LARGE_INTEGER offset;
+            offset.QuadPart = static_cast<LONGLONG>(size);
+            return SUCCEEDED(m_stream->Seek(offset, STREAM_SEEK_CUR, nullptr));
+        }
+
+    private:
+        IStream* m_stream;
+    };
+
+    // Decodes a PNG or JPEG image in memory with WIC, scaled to fit in
+    // cx x cx.
+    inline bool DecodeWicThumbnail(const uint8_t* data, size_t size, uint32_t cx, ThumbnailImage& image)
+    {
+        wil::com_ptr_nothrow<IStream> stream;
+        stream.attach(SHCreateMemStream(data, static_cast<UINT>(size)));
+        wil::com_ptr_nothrow<IWICImagingFactory> factory;
+        wil::com_ptr_nothrow<IWICBitmapDecoder> decoder;
+        wil::com_ptr_nothrow<IWICBitmapFrameDecode> frame;
+        if (!stream ||
+            FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory))) ||
+            FAILED(factory->CreateDecoderFromStream(stream.get(), nullptr, WICDecodeMetadataCacheOnDemand, &decoder)) ||
+            FAILED(decoder->GetFrame(0, &frame)))
+        {
+            return false;
+        }
+
+        UINT width = 0;
+        UINT height = 0;
+        if (FAILED(frame->GetSize(&width, &height)) || width == 0 || height == 0)
+        {
+            return false;
+        }
+
+        uint32_t fitWidth;
+        uint32_t fitHeight;
+        FitThumbnailSize(width, height, cx, fitWidth, fitHeight);
+
+        wil::com_ptr_nothrow<IWICBitmapSource> source = frame;
+        wil::com_ptr_nothrow<IWICBitmapScaler> scaler;
+        if (fitWidth != width || fitHeight != height)
+        {
+            if (FAILED(factory->CreateBitmapScaler(&scaler)) ||
+                FAILED(scaler->Initialize(frame.get(), fitWidth, fitHeight, WICBitmapInterpolationModeHighQualityCubic)))
+            {
+                return false;
+            }
+            source = scaler;
+        }
+
+        wil::com_ptr_nothrow<IWICFormatConverter> converter;
+        if (FAILED(factory->CreateFormatConverter(&converter)) ||
+            FAILED(converter->Initialize(source.get(), GUID_WICPixelFormat32bppBGRA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom)))
+        {
+            return false;
+        }
+
+        image.width = fitWidth;
+        image.height = fitHeight;
+        image.pixels.resize(static_cast<size_t>(fitWidth) * fitHeight);
+        return SUCCEEDED(converter->CopyPixels(nullptr,
+                                               static_cast<UINT>(fitWidth * sizeof(uint32_t)),
+                                               static_cast<UINT>(image.pixels.size() * sizeof(uint32_t)),
+                                               reinterpret_cast<BYTE*>(image.pixels.data())));
+    }
+
+    // Decodes a thumbnail embedded by a slicer, scaled to fit in cx x cx.
+    inline bool DecodeEmbeddedThumbnail(const EmbeddedThumbnail& thumbnail, uint32_t cx, ThumbnailImage& image)
+    {
+        switch (thumbnail.format)
+        {
+        case EmbeddedImageFormat::Png:
+        case EmbeddedImageFormat::Jpg:
+            return DecodeWicThumbnail(thumbnail.data.data(), thumbnail.data.size(), cx, image);
+
+        case EmbeddedImageFormat::Qoi:
+        {
+            size_t offset = 0;
+            auto reader = [&](uint8_t* buffer, size_t size) {
+                const size_t count = std::min(size, thumbnail.data.size() - offset);
+                memcpy(buffer, thumbnail.data.data() + offset, count);
+                offset += count;
+                return count;
+            };
+            return DecodeQoiThumbnail(reader, cx, image);
+        }
+
+        default:
+            return false;
+        }
+    }
+
+    // Reads the pixels of a 32bpp bitmap, such as one loaded from a .bmp file
+    // written by a renderer process.
+    inline bool ReadThumbnailBitmap(HBITMAP bitmap, ThumbnailImage& image)
+    {
+        BITMAP info = {};
+        if (!bitmap || GetObject(bitmap, sizeof(info), &info) == 0 || info.bmWidth <= 0 || info.bmHeight == 0 || info.bmBitsPixel != 32)
+        {
+            return false;
+        }
+
+        const uint32_t width = static_cast<uint32_t>(info.bmWidth);
+        const uint32_t height = static_cast<uint32_t>(std::abs(info.bmHeight));
+
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+        bmi.bmiHeader.biWidth = static_cast<LONG>(width);
+        bmi.bmiHeader.biHeight = -static_cast<LONG>(height);
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        image.width = width;
+        image.height = height;
+        image.pixels.resize(static_cast<size_t>(width) * height);
+
+        HDC dc = GetDC(NULL);
+        const int lines = GetDIBits(dc, bitmap, 0, height, image.pixels.data(), &bmi, DIB_RGB_COLORS);
+        ReleaseDC(NULL, dc);
+        return lines == static_cast<int>(height);
+    }
+
+    // Creates a 32bpp top-down DIB section holding the image. Returns NULL on
+    // failure; the caller owns the bitmap on success.
+    inline HBITMAP CreateThumbnailBitmap(const ThumbnailImage& image)
+    {
+        if (image.empty())
+        {
+            return NULL;
+        }
+
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+        bmi.bmiHeader.biWidth = static_cast<LONG>(image.width);
+        bmi.bmiHeader.biHeight = -static_cast<LONG>(image.height);
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+
+        void* bits = nullptr;
+        HBITMAP bitmap = CreateDIBSection(NULL, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+        if (bitmap && bits)
+        {
+            memcpy(bits, image.pixels.data(), image.pixels.size() * sizeof(uint32_t));
+        }
+        return bitmap;
+    }
+}
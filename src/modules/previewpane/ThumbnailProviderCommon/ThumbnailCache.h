@@ -0,0 +1,347 @@
+#pragma once
+
+// Persistent thumbnail cache shared by all the native thumbnail providers.
+//
+// The store lives in a memory-mapped file under the user's PowerToys
+// LocalAppData folder, which low integrity processes can't write to, and is
+// shared by every process that hosts a provider; a byte range lock on the
+// file serializes access between them. Entries are keyed by a hash of the
+// head and tail of the file, its last write time and its size, so unchanged
+// files are served without running the decoder or renderer again. Streams
+// that don't report a last write time are hashed whole instead.
+
+#include "ThumbnailBitmap.h"
+#include "ThumbnailCacheStore.h"
+
+#include <windows.h>
+#include <objidl.h>
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include <wil/resource.h>
+
+#include <common/logger/logger.h>
+#include <common/SettingsAPI/settings_helpers.h>
+
+namespace ThumbnailCommon
+{
+    enum class ThumbnailProvider : uint32_t
+    {
+        Svg = 1,
+        Pdf = 2,
+        Qoi = 3,
+        Stl = 4,
+        Gcode = 5,
+        Bgcode = 6,
+    };
+
+    class ThumbnailCache
+    {
+    public:
+        static constexpr uint32_t SlotCount = 4096;
+        static constexpr uint64_t DataCapacity = 64ull * 1024 * 1024;
+
+        // Bytes hashed from each end of the file.
+        static constexpr ULONG SampleSize = 64 * 1024;
+
+        static ThumbnailCache& Instance()
+        {
+            static ThumbnailCache cache;
+            return cache;
+        }
+
+        // Builds the key for the stream and rewinds it. variant folds in any
+        // setting that changes the rendered output. Returns false, leaving
+        // the stream where it was, if the stream cannot seek or be measured.
+        static bool ComputeKey(IStream* stream, UINT cx, ThumbnailProvider provider, uint64_t variant, ThumbnailCacheKey& key)
+        {
+            STATSTG stat = {};
+            if (FAILED(stream->Stat(&stat, STATFLAG_NONAME)))
+            {
+                return false;
+            }
+            const uint64_t size = stat.cbSize.QuadPart;
+
+            std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[SampleSize]);
+            if (!buffer)
+            {
+                return false;
+            }
+
+            uint64_t hash = HashBytes(&variant, sizeof(variant), size);
+
+            // An edit that keeps the size and both ends of the file only shows
+            // in the last write time
+            const bool hasWriteTime = stat.mtime.dwLowDateTime != 0 || stat.mtime.dwHighDateTime != 0;
+            if (hasWriteTime)
+            {
+                hash = HashBytes(&stat.mtime, sizeof(stat.mtime), hash);
+            }
+            else if (size > 2 * SampleSize)
+            {
+                return ComputeFullKey(stream, buffer.get(), size, hash, cx, provider, key);
+            }
+
+            // Tail first: a failed seek here leaves the stream untouched
+            LARGE_INTEGER position;
+            position.QuadPart = static_cast<LONGLONG>(size > SampleSize ? size - SampleSize : 0);
+            if (FAILED(stream->Seek(position, STREAM_SEEK_SET, nullptr)))
+            {
+                return false;
+            }
+            ULONG bytesRead = 0;
+            if (SUCCEEDED(stream->Read(buffer.get(), SampleSize, &bytesRead)))
+            {
+                hash = HashBytes(buffer.get(), bytesRead, hash);
+            }
+
+            position.QuadPart = 0;
+            bytesRead = 0;
+            if (FAILED(stream->Seek(position, STREAM_SEEK_SET, nullptr)) ||
+                FAILED(stream->Read(buffer.get(), SampleSize, &bytesRead)) ||
+                FAILED(stream->Seek(position, STREAM_SEEK_SET, nullptr)))
+            {
+                return false;
+            }
+            hash = HashBytes(buffer.get(), bytesRead, hash);
+
+            key.contentHash = hash;
+            key.streamSize = size;
+            key.cx = cx;
+            key.provider = static_cast<uint32_t>(provider);
+            return true;
+        }
+
+        bool Lookup(const ThumbnailCacheKey& key, ThumbnailImage& image)
+        {
+            auto lock = Lock();
+            return lock && m_store->Lookup(key, image);
+        }
+
+        bool Insert(const ThumbnailCacheKey& key, const ThumbnailImage& image)
+        {
+            auto lock = Lock();
+            return lock && m_store->Insert(key, image);
+        }
+
+        std::optional<ThumbnailCacheStore::Stats> GetStats()
+        {
+            auto lock = Lock();
+            if (!lock)
+            {
+                return std::nullopt;
+            }
+            return m_store->GetStats();
+        }
+
+    private:
+        // Hashes the whole stream and rewinds it, for streams without a last
+        // write time.
+        static bool ComputeFullKey(IStream* stream, uint8_t* buffer, uint64_t size, uint64_t hash, UINT cx, ThumbnailProvider provider, ThumbnailCacheKey& key)
+        {
+            LARGE_INTEGER position;
+            position.QuadPart = 0;
+            if (FAILED(stream->Seek(position, STREAM_SEEK_SET, nullptr)))
+            {
+                return false;
+            }
+
+            ULONG bytesRead = 0;
+            do
+            {
+                if (FAILED(stream->Read(buffer, SampleSize, &bytesRead)))
+                {
+                    stream->Seek(position, STREAM_SEEK_SET, nullptr);
+                    return false;
+                }
+                hash = HashBytes(buffer, bytesRead, hash);
+            } while (bytesRead == SampleSize);
+
+            if (FAILED(stream->Seek(position, STREAM_SEEK_SET, nullptr)))
+            {
+                return false;
+            }
+
+            key.contentHash = hash;
+            key.streamSize = size;
+            key.cx = cx;
+            key.provider = static_cast<uint32_t>(provider);
+            return true;
+        }
+
+        // Holds both the in-process mutex and the cross-process file lock.
+        class ScopedLock
+        {
+        public:
+            ScopedLock(std::unique_lock<std::mutex> guard, HANDLE file) :
+                m_guard(std::move(guard)), m_file(file)
+            {
+                OVERLAPPED overlapped = {};
+                m_locked = m_file != NULL && LockFileEx(m_file, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped);
+            }
+
+            ~ScopedLock()
+            {
+                if (m_locked)
+                {
+                    OVERLAPPED overlapped = {};
+                    UnlockFileEx(m_file, 0, 1, 0, &overlapped);
+                }
+            }
+
+            ScopedLock(const ScopedLock&) = delete;
+            ScopedLock& operator=(const ScopedLock&) = delete;
+
+            explicit operator bool() const { return m_locked; }
+
+        private:
+            std::unique_lock<std::mutex> m_guard;
+            HANDLE m_file;
+            bool m_locked = false;
+        };
+
+        ThumbnailCache()
+        {
+            try
+            {
+                Open();
+            }
+            catch (...)
+            {
+                Logger::error(L"Failed to open the thumbnail cache.");
+                m_store.reset();
+            }
+        }
+
+        ScopedLock Lock()
+        {
+            return ScopedLock(std::unique_lock<std::mutex>(m_mutex), m_store ? m_file.get() : NULL);
+        }
+
+        void Open()
+        {
+            // Not LocalLow: a low integrity process could plant entries there.
+            // Earlier versions kept the cache there, so drop that copy.
+            std::error_code err;
+            std::filesystem::remove_all(std::filesystem::path(PTSettingsHelper::get_local_low_folder_location()) / L"ThumbnailCache", err);
+
+            std::filesystem::path folder(PTSettingsHelper::get_root_save_folder_location());
+            folder.append(L"ThumbnailCache");
+            std::filesystem::create_directories(folder);
+            const std::wstring path = (folder / L"thumbnails.cache").wstring();
+
+            m_file.reset(CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NOT_CONTENT_INDEXED, nullptr));
+            if (!m_file)
+            {
+                Logger::warn(L"Thumbnail cache file could not be opened: {}", GetLastError());
+                return;
+            }
+
+            // The mapping grows the file to the full size on first use
+            const uint64_t size = ThumbnailCacheStore::RegionSize(SlotCount, DataCapacity);
+            m_mapping.reset(CreateFileMappingW(m_file.get(), nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr));
+            if (!m_mapping)
+            {
+                Logger::warn(L"Thumbnail cache file could not be mapped: {}", GetLastError());
+                return;
+            }
+
+            m_view.reset(MapViewOfFile(m_mapping.get(), FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, static_cast<SIZE_T>(size)));
+            if (!m_view)
+            {
+                Logger::warn(L"Thumbnail cache view could not be mapped: {}", GetLastError());
+                return;
+            }
+
+            OVERLAPPED overlapped = {};
+            if (LockFileEx(m_file.get(), LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped))
+            {
+                m_store.emplace(m_view.get(), SlotCount, DataCapacity);
+                UnlockFileEx(m_file.get(), 0, 1, 0, &overlapped);
+            }
+        }
+
+        std::mutex m_mutex;
+        wil::unique_hfile m_file;
+        wil::unique_handle m_mapping;
+        wil::unique_mapview_ptr<void> m_view;
+        std::optional<ThumbnailCacheStore> m_store;
+    };
+
+    // For providers that produce the bitmap some other way: returns the cached
+    // thumbnail for key as a new bitmap, or NULL on a miss.
+    inline HBITMAP GetCachedThumbnailBitmap(const ThumbnailCacheKey& key)
+    {
+        try
+        {
+            ThumbnailImage image;
+            return ThumbnailCache::Instance().Lookup(key, image) ? CreateThumbnailBitmap(image) : NULL;
+        }
+        catch (const std::bad_alloc&)
+        {
+            return NULL;
+        }
+    }
+
+    // Adds a copy of the bitmap to the cache under key.
+    inline void CacheThumbnailBitmap(const ThumbnailCacheKey& key, HBITMAP bitmap)
+    {
+        try
+        {
+            ThumbnailImage image;
+            if (ReadThumbnailBitmap(bitmap, image))
+            {
+                ThumbnailCache::Instance().Insert(key, image);
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+        }
+    }
+
+    // Serves the thumbnail from the cache, or calls render(image) to produce
+    // it, caches the result and returns it as a bitmap.
+    template<typename Render>
+    HRESULT GetCachedThumbnail(IStream* stream, UINT cx, ThumbnailProvider provider, uint64_t variant, Render&& render, HBITMAP* phbmp)
+    {
+        ThumbnailImage image;
+        ThumbnailCacheKey key;
+        const bool cacheable = ThumbnailCache::ComputeKey(stream, cx, provider, variant, key);
+        try
+        {
+            if (cacheable && ThumbnailCache::Instance().Lookup(key, image))
+            {
+                Logger::trace(L"Thumbnail cache hit.");
+            }
+            else
+            {
+                const HRESULT hr = render(image);
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+                if (cacheable)
+                {
+                    ThumbnailCache::Instance().Insert(key, image);
+                }
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+            Logger::error(L"Out of memory while creating thumbnail.");
+            return E_OUTOFMEMORY;
+        }
+
+        *phbmp = CreateThumbnailBitmap(image);
+        if (!*phbmp)
+        {
+            Logger::error(L"Failed to create thumbnail bitmap.");
+            return E_FAIL;
+        }
+        return S_OK;
+    }
+}
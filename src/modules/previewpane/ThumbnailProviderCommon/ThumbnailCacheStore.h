@@ -0,0 +1,418 @@
+#pragma once
+
+// Thumbnail cache store laid out in a single flat memory region, so the same
+// code serves a memory-mapped file shared by every thumbnail provider process.
+//
+//   [StoreHeader][Slot x slotCount][pixel data ...]
+//
+// Slots form an open addressing hash table keyed by the content hash. Pixel
+// blocks are appended to the data area; when it runs out, the least recently
+// used entries are evicted in one batch down to a low watermark and the
+// survivors are compacted to the front. The store does no locking of its own.
+
+#include "ThumbnailImage.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ThumbnailCommon
+{
+    // Identifies one rendering of one file: the provider, a hash of the file
+    // content and last write time (and of any setting that changes the
+    // output), its size and the requested thumbnail size.
+    struct ThumbnailCacheKey
+    {
+        uint64_t contentHash = 0;
+        uint64_t streamSize = 0;
+        uint32_t cx = 0;
+        uint32_t provider = 0;
+
+        bool operator==(const ThumbnailCacheKey& other) const
+        {
+            return contentHash == other.contentHash && streamSize == other.streamSize && cx == other.cx && provider == other.provider;
+        }
+    };
+
+    // 64-bit MurmurHash2 (MurmurHash64A); fast and well distributed, which is
+    // all a cache key needs.
+    inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+    {
+        constexpr uint64_t m = 0xc6a4a7935bd1e995ull;
+        constexpr int r = 47;
+
+        uint64_t h = seed ^ (size * m);
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        const uint8_t* end = bytes + (size & ~static_cast<size_t>(7));
+        for (; bytes != end; bytes += 8)
+        {
+            uint64_t k;
+            memcpy(&k, bytes, sizeof(k));
+            k *= m;
+            k ^= k >> r;
+            k *= m;
+            h ^= k;
+            h *= m;
+        }
+
+        switch (size & 7)
+        {
+        case 7:
+            h ^= static_cast<uint64_t>(bytes[6]) << 48;
+            [[fallthrough]];
+        case 6:
+            h ^= static_cast<uint64_t>(bytes[5]) << 40;
+            [[fallthrough]];
+        case 5:
+            h ^= static_cast<uint64_t>(bytes[4]) << 32;
+            [[fallthrough]];
+        case 4:
+            h ^= static_cast<uint64_t>(bytes[3]) << 24;
+            [[fallthrough]];
+        case 3:
+            h ^= static_cast<uint64_t>(bytes[2]) << 16;
+            [[fallthrough]];
+        case 2:
+            h ^= static_cast<uint64_t>(bytes[1]) << 8;
+            [[fallthrough]];
+        case 1:
+            h ^= static_cast<uint64_t>(bytes[0]);
+            h *= m;
+            break;
+        }
+
+        h ^= h >> r;
+        h *= m;
+        h ^= h >> r;
+        return h;
+    }
+
+    class ThumbnailCacheStore
+    {
+    public:
+        static constexpr uint32_t Magic = 0x43485450; // "PTHC"
+        static constexpr uint32_t Version = 1;
+
+        struct Stats
+        {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t inserts = 0;
+            uint64_t evictions = 0;
+            uint64_t compactions = 0;
+        };
+
+        // Size of the region needed for the given table and data capacity.
+        static size_t RegionSize(uint32_t slotCount, uint64_t dataCapacity)
+        {
+            return DataOffset(slotCount) + static_cast<size_t>(dataCapacity);
+        }
+
+        // Attaches to a region of RegionSize(slotCount, dataCapacity) bytes.
+        // A region that does not hold a valid store of exactly this shape,
+        // that was left mid-compaction by a crashed process, or whose slots
+        // point outside the used data area, is reset.
+        ThumbnailCacheStore(void* region, uint32_t slotCount, uint64_t dataCapacity) :
+            m_header(static_cast<StoreHeader*>(region)),
+            m_slots(reinterpret_cast<Slot*>(static_cast<uint8_t*>(region) + sizeof(StoreHeader))),
+            m_data(static_cast<uint8_t*>(region) + DataOffset(slotCount)),
+            m_slotCount(slotCount),
+            m_dataCapacity(dataCapacity)
+        {
+            if (m_header->magic != Magic || m_header->version != Version || m_header->slotCount != slotCount ||
+                m_header->dataCapacity != dataCapacity || m_header->compacting != 0 ||
+                m_header->dataUsed > dataCapacity || m_header->entryCount > slotCount || !SlotsAreConsistent())
+            {
+                Reset();
+            }
+        }
+
+        void Reset()
+        {
+            memset(m_slots, 0, sizeof(Slot) * m_slotCount);
+            StoreHeader header{};
+            header.magic = Magic;
+            header.version = Version;
+            header.slotCount = m_slotCount;
+            header.dataCapacity = m_dataCapacity;
+            *m_header = header;
+        }
+
+        // Copies the cached image for key into image. Returns false on a miss.
+        bool Lookup(const ThumbnailCacheKey& key, ThumbnailImage& image)
+        {
+            RecoverIfInterrupted();
+            Slot* slot = Find(key);
+            if (!slot)
+            {
+                m_header->stats.misses++;
+                return false;
+            }
+
+            slot->lastUse = ++m_header->clock;
+            image.width = slot->width;
+            image.height = slot->height;
+            image.pixels.resize(static_cast<size_t>(slot->width) * slot->height);
+            memcpy(image.pixels.data(), m_data + slot->offset, image.pixels.size() * sizeof(uint32_t));
+            m_header->stats.hits++;
+            return true;
+        }
+
+        // Adds the image for key, evicting least recently used entries as
+        // needed. Images larger than a quarter of the store are not cached.
+        bool Insert(const ThumbnailCacheKey& key, const ThumbnailImage& image)
+        {
+            const uint64_t bytes = static_cast<uint64_t>(image.width) * image.height * sizeof(uint32_t);
+            if (image.empty() || image.pixels.size() * sizeof(uint32_t) != bytes || bytes > m_dataCapacity / 4)
+            {
+                return false;
+            }
+
+            RecoverIfInterrupted();
+
+            if (Slot* existing = Find(key))
+            {
+                existing->lastUse = ++m_header->clock;
+                return true;
+            }
+
+            const uint64_t allocation = AlignUp(bytes);
+            if (m_header->entryCount >= MaxEntries() || m_header->dataUsed > m_dataCapacity || m_dataCapacity - m_header->dataUsed < allocation)
+            {
+                EvictAndCompact(allocation);
+            }
+
+            const uint64_t offset = m_header->dataUsed;
+            memcpy(m_data + offset, image.pixels.data(), static_cast<size_t>(bytes));
+
+            m_header->dataUsed = offset + allocation;
+            m_header->liveBytes += allocation;
+            m_header->entryCount++;
+            m_header->stats.inserts++;
+
+            // Publish the slot only after its pixels and the header are in place,
+            // so an interrupted insert never leaves a slot in unaccounted space
+            Slot slot{};
+            slot.contentHash = key.contentHash;
+            slot.streamSize = key.streamSize;
+            slot.cx = key.cx;
+            slot.provider = key.provider;
+            slot.width = image.width;
+            slot.height = image.height;
+            slot.offset = offset;
+            slot.lastUse = ++m_header->clock;
+            slot.used = 1;
+            Place(slot);
+            return true;
+        }
+
+        Stats GetStats() const { return m_header->stats; }
+        uint32_t EntryCount() const { return m_header->entryCount; }
+        uint64_t LiveBytes() const { return m_header->liveBytes; }
+
+    private:
+        struct StoreHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t slotCount;
+            uint32_t compacting;
+            uint64_t dataCapacity;
+            uint64_t dataUsed;
+            uint64_t liveBytes;
+            uint64_t clock;
+            uint32_t entryCount;
+            uint32_t reserved;
+            Stats stats;
+        };
+
+        struct Slot
+        {
+            uint64_t contentHash;
+            uint64_t streamSize;
+            uint32_t cx;
+            uint32_t provider;
+            uint32_t width;
+            uint32_t height;
+            uint64_t offset;
+            uint64_t lastUse;
+            uint32_t used;
+            uint32_t reserved;
+        };
+
+        static_assert(sizeof(StoreHeader) % 16 == 0);
+        static_assert(sizeof(Slot) % 8 == 0);
+
+        static constexpr uint64_t Alignment = 16;
+
+        static uint64_t AlignUp(uint64_t value) { return (value + Alignment - 1) & ~(Alignment - 1); }
+
+        static size_t DataOffset(uint32_t slotCount)
+        {
+            return static_cast<size_t>(AlignUp(sizeof(StoreHeader) + static_cast<uint64_t>(sizeof(Slot)) * slotCount));
+        }
+
+        // Another process sharing the region died while compacting it
+        void RecoverIfInterrupted()
+        {
+            if (m_header->compacting != 0)
+            {
+                Reset();
+            }
+        }
+
+        // Keep the table at most three quarters full so probes stay short
+        uint32_t MaxEntries() const { return m_slotCount - m_slotCount / 4; }
+
+        size_t HomeSlot(uint64_t contentHash) const { return static_cast<size_t>(contentHash % m_slotCount); }
+
+        bool Matches(const Slot& slot, const ThumbnailCacheKey& key) const
+        {
+            return slot.contentHash == key.contentHash && slot.streamSize == key.streamSize && slot.cx == key.cx && slot.provider == key.provider;
+        }
+
+        Slot* Find(const ThumbnailCacheKey& key)
+        {
+            size_t index = HomeSlot(key.contentHash);
+            for (uint32_t probe = 0; probe < m_slotCount; probe++)
+            {
+                Slot& slot = m_slots[index];
+                if (!slot.used)
+                {
+                    return nullptr;
+                }
+                if (Matches(slot, key))
+                {
+                    // Never trust a block that would read past the data area
+                    return SlotInBounds(slot) ? &slot : nullptr;
+                }
+                index = (index + 1) % m_slotCount;
+            }
+            return nullptr;
+        }
+
+        // The slot's pixels lie within the used part of the data area. The
+        // region is shared and writable, so this is checked before any copy.
+        bool SlotInBounds(const Slot& slot) const
+        {
+            const uint64_t dataUsed = m_header->dataUsed;
+            if (dataUsed > m_dataCapacity)
+            {
+                return false;
+            }
+            const uint64_t pixels = static_cast<uint64_t>(slot.width) * slot.height;
+            return pixels <= dataUsed / sizeof(uint32_t) && slot.offset <= dataUsed - pixels * sizeof(uint32_t);
+        }
+
+        // Every used slot is in bounds, and the entry count and live bytes in
+        // the header add up to what the slots hold.
+        bool SlotsAreConsistent() const
+        {
+            uint32_t entries = 0;
+            uint64_t liveBytes = 0;
+            for (uint32_t i = 0; i < m_slotCount; i++)
+            {
+                const Slot& slot = m_slots[i];
+                if (!slot.used)
+                {
+                    continue;
+                }
+                if (!SlotInBounds(slot))
+                {
+                    return false;
+                }
+                entries++;
+                liveBytes += AlignUp(static_cast<uint64_t>(slot.width) * slot.height * sizeof(uint32_t));
+            }
+            return entries == m_header->entryCount && liveBytes == m_header->liveBytes && liveBytes <= m_header->dataUsed;
+        }
+
+        void Place(const Slot& slot)
+        {
+            size_t index = HomeSlot(slot.contentHash);
+            while (m_slots[index].used)
+            {
+                index = (index + 1) % m_slotCount;
+            }
+            m_slots[index] = slot;
+        }
+
+        // Evicts the least recently used entries until both the table and the
+        // data area have room to spare, then packs the survivors to the front
+        // of the data area and rebuilds the table.
+        void EvictAndCompact(uint64_t needed)
+        {
+            // Blocks are moved to and from where the slots say, so a store that
+            // was damaged since it was attached is dropped rather than compacted
+            if (m_header->dataUsed > m_dataCapacity || !SlotsAreConsistent())
+            {
+                Reset();
+                return;
+            }
+
+            std::vector<Slot> live;
+            live.reserve(m_header->entryCount);
+            for (uint32_t i = 0; i < m_slotCount; i++)
+            {
+                if (m_slots[i].used)
+                {
+                    live.push_back(m_slots[i]);
+                }
+            }
+
+            std::sort(live.begin(), live.end(), [](const Slot& a, const Slot& b) { return a.lastUse > b.lastUse; });
+
+            // Free a quarter of the store at once so this does not run again
+            // on the very next insert.
+            const uint64_t byteBudget = m_dataCapacity - std::min(m_dataCapacity, needed + m_dataCapacity / 4);
+            const uint32_t entryBudget = MaxEntries() - std::max(1u, MaxEntries() / 4);
+            uint64_t keptBytes = 0;
+            size_t kept = 0;
+            while (kept < live.size() && kept < entryBudget)
+            {
+                const uint64_t bytes = AlignUp(static_cast<uint64_t>(live[kept].width) * live[kept].height * sizeof(uint32_t));
+                if (keptBytes + bytes > byteBudget)
+                {
+                    break;
+                }
+                keptBytes += bytes;
+                kept++;
+            }
+            m_header->stats.evictions += live.size() - kept;
+            live.resize(kept);
+
+            // Move blocks down in offset order so a move never overwrites a
+            // block that has not been moved yet.
+            std::sort(live.begin(), live.end(), [](const Slot& a, const Slot& b) { return a.offset < b.offset; });
+
+            m_header->compacting = 1;
+            memset(m_slots, 0, sizeof(Slot) * m_slotCount);
+            uint64_t cursor = 0;
+            for (Slot& slot : live)
+            {
+                const uint64_t bytes = static_cast<uint64_t>(slot.width) * slot.height * sizeof(uint32_t);
+                if (slot.offset != cursor)
+                {
+                    memmove(m_data + cursor, m_data + slot.offset, static_cast<size_t>(bytes));
+                    slot.offset = cursor;
+                }
+                cursor += AlignUp(bytes);
+                Place(slot);
+            }
+
+            m_header->dataUsed = cursor;
+            m_header->liveBytes = cursor;
+            m_header->entryCount = static_cast<uint32_t>(live.size());
+            m_header->stats.compactions++;
+            m_header->compacting = 0;
+        }
+
+        StoreHeader* m_header;
+        Slot* m_slots;
+        uint8_t* m_data;
+        uint32_t m_slotCount;
+        uint64_t m_dataCapacity;
+    };
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+// Portable thumbnail pixel buffer and streaming scaler shared by the native
+// thumbnail providers. Nothing in here depends on Windows so decoders built on
+// top of it can be exercised on any platform.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ThumbnailCommon
+{
+    // 32bpp top-down pixels laid out as BGRA, matching a DIB section with
+    // straight (non-premultiplied) alpha.
+    struct ThumbnailImage
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint32_t> pixels;
+
+        bool empty() const { return width == 0 || height == 0; }
+    };
+
+    inline uint32_t MakeBgra(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+    {
+        return static_cast<uint32_t>(b) | (static_cast<uint32_t>(g) << 8) | (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(a) << 24);
+    }
+
+    // Size that fits width x height into a cx x cx square while keeping the
+    // aspect ratio, the same way the managed providers compute it.
+    inline void FitThumbnailSize(uint32_t width, uint32_t height, uint32_t cx, uint32_t& fitWidth, uint32_t& fitHeight)
+    {
+        const double scale = std::min(static_cast<double>(cx) / width, static_cast<double>(cx) / height);
+        fitWidth = std::max<uint32_t>(1, static_cast<uint32_t>(width * scale));
+        fitHeight = std::max<uint32_t>(1, static_cast<uint32_t>(height * scale));
+    }
+
+    // Scales an image that arrives one row at a time. Downscaling averages
+    // every source pixel into its destination pixel (weighted by alpha) as the
+    // rows stream in, so only one destination row of accumulators is kept.
+    // Upscaling buffers the (small) source and filters it bilinearly.
+    class ThumbnailScaler
+    {
+    public:
+        ThumbnailScaler(uint32_t sourceWidth, uint32_t sourceHeight, uint32_t targetWidth, uint32_t targetHeight) :
+            m_sourceWidth(sourceWidth),
+            m_sourceHeight(sourceHeight),
+            m_upscale(targetWidth > sourceWidth || targetHeight > sourceHeight)
+        {
+            m_image.width = targetWidth;
+            m_image.height = targetHeight;
+            m_image.pixels.resize(static_cast<size_t>(targetWidth) * targetHeight);
+
+            if (m_upscale)
+            {
+                m_source.reserve(static_cast<size_t>(sourceWidth) * sourceHeight);
+                return;
+            }
+
+            m_columns.resize(sourceWidth);
+            for (uint32_t x = 0; x < sourceWidth; x++)
+            {
+                m_columns[x] = static_cast<uint32_t>(static_cast<uint64_t>(x) * targetWidth / sourceWidth);
+            }
+            m_sums.resize(static_cast<size_t>(targetWidth));
+        }
+
+        void AddRow(const uint32_t* row)
+        {
+            if (m_upscale)
+            {
+                m_source.insert(m_source.end(), row, row + m_sourceWidth);
+                m_nextRow++;
+                return;
+            }
+
+            const uint32_t targetRow = static_cast<uint32_t>(static_cast<uint64_t>(m_nextRow) * m_image.height / m_sourceHeight);
+            if (targetRow != m_currentTargetRow)
+            {
+                FlushRow();
+                m_currentTargetRow = targetRow;
+            }
+
+            for (uint32_t x = 0; x < m_sourceWidth; x++)
+            {
+                const uint32_t pixel = row[x];
+                const uint64_t alpha = pixel >> 24;
+                Sum& sum = m_sums[m_columns[x]];
+                sum.b += (pixel & 0xFF) * alpha;
+                sum.g += ((pixel >> 8) & 0xFF) * alpha;
+                sum.r += ((pixel >> 16) & 0xFF) * alpha;
+                sum.a += alpha;
+                sum.count++;
+            }
+            m_nextRow++;
+        }
+
+        uint32_t RowsAdded() const { return m_nextRow; }
+
+        ThumbnailImage Finish()
+        {
+            if (m_upscale)
+            {
+                Upscale();
+            }
+            else
+            {
+                FlushRow();
+            }
+            return std::move(m_image);
+        }
+
+    private:
+        struct Sum
+        {
+            uint64_t b = 0;
+            uint64_t g = 0;
+            uint64_t r = 0;
+            uint64_t a = 0;
+            uint64_t count = 0;
+        };
+
+        void FlushRow()
+        {
+            if (m_currentTargetRow >= m_image.height)
+            {
+                return;
+            }
+
+            uint32_t* target = &m_image.pixels[static_cast<size_t>(m_currentTargetRow) * m_image.width];
+            for (uint32_t x = 0; x < m_image.width; x++)
+            {
+                Sum& sum = m_sums[x];
+                if (sum.count != 0 && sum.a != 0)
+                {
+                    target[x] = MakeBgra(static_cast<uint8_t>(sum.r / sum.a),
+                                         static_cast<uint8_t>(sum.g / sum.a),
+                                         static_cast<uint8_t>(sum.b / sum.a),
+                                         static_cast<uint8_t>(sum.a / sum.count));
+                }
+                else
+                {
+                    target[x] = 0;
+                }
+                sum = {};
+            }
+        }
+
+        void Upscale()
+        {
+            if (m_source.size() < static_cast<size_t>(m_sourceWidth) * m_sourceHeight)
+            {
+                // Truncated input: leave the missing rows transparent
+                m_source.resize(static_cast<size_t>(m_sourceWidth) * m_sourceHeight, 0);
+            }
+
+            const float scaleX = static_cast<float>(m_sourceWidth) / m_image.width;
+            const float scaleY = static_cast<float>(m_sourceHeight) / m_image.height;
+            for (uint32_t y = 0; y < m_image.height; y++)
+            {
+                const float fy = std::max((y + 0.5f) * scaleY - 0.5f, 0.0f);
+                const uint32_t y0 = std::min(static_cast<uint32_t>(fy), m_sourceHeight - 1);
+                const uint32_t y1 = std::min(y0 + 1, m_sourceHeight - 1);
+                const float wy = fy - y0;
+                for (uint32_t x = 0; x < m_image.width; x++)
+                {
+                    const float fx = std::max((x + 0.5f) * scaleX - 0.5f, 0.0f);
+                    const uint32_t x0 = std::min(static_cast<uint32_t>(fx), m_sourceWidth - 1);
+                    const uint32_t x1 = std::min(x0 + 1, m_sourceWidth - 1);
+                    const float wx = fx - x0;
+
+                    const uint32_t p00 = m_source[static_cast<size_t>(y0) * m_sourceWidth + x0];
+                    const uint32_t p01 = m_source[static_cast<size_t>(y0) * m_sourceWidth + x1];
+                    const uint32_t p10 = m_source[static_cast<size_t>(y1) * m_sourceWidth + x0];
+                    const uint32_t p11 = m_source[static_cast<size_t>(y1) * m_sourceWidth + x1];
+
+                    uint32_t result = 0;
+                    for (int shift = 0; shift < 32; shift += 8)
+                    {
+                        const float top = ((p00 >> shift) & 0xFF) * (1 - wx) + ((p01 >> shift) & 0xFF) * wx;
+                        const float bottom = ((p10 >> shift) & 0xFF) * (1 - wx) + ((p11 >> shift) & 0xFF) * wx;
+                        const uint32_t channel = static_cast<uint32_t>(top * (1 - wy) + bottom * wy + 0.5f);
+                        result |= std::min<uint32_t>(channel, 255) << shift;
+                    }
+                    m_image.pixels[static_cast<size_t>(y) * m_image.width + x] = result;
+                }
+            }
+        }
+
+        uint32_t m_sourceWidth;
+        uint32_t m_sourceHeight;
+        bool m_upscale;
+        uint32_t m_nextRow = 0;
+        uint32_t m_currentTargetRow = 0;
+        std::vector<uint32_t> m_columns;
+        std::vector<Sum> m_sums;
+        std::vector<uint32_t> m_source;
+        ThumbnailImage m_image;
+    };
+}
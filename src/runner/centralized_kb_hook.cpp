@@ -1,44 +1,90 @@
 #include "pch.h"
 #include "centralized_kb_hook.h"
+#include "hotkey_table.h"
 #include <common/debug_control.h>
 #include <common/utils/winapi_error.h>
 #include <common/logger/logger.h>
 #include <common/interop/shared_constants.h>
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 namespace CentralizedKeyboardHook
 {
-    struct HotkeyDescriptor
-    {
-        Hotkey hotkey;
-        std::wstring moduleName;
-        std::function<bool()> action;
+    // Hotkeys as registered, guarded by mutex.
+    std::vector<HotkeyDescriptor> hotkeyDescriptors;
+    std::vector<PressedKeyDescriptor> pressedKeyDescriptors;
+    std::mutex mutex;
 
-        bool operator<(const HotkeyDescriptor& other) const
-        {
-            return hotkey < other.hotkey;
-        };
-    };
+    // The published table, and tables replaced while the hook or a timer was
+    // still reading them. Both guarded by mutex.
+    std::unique_ptr<const HotkeyTable> publishedTable;
+    std::vector<std::unique_ptr<const HotkeyTable>> retiredTables;
+
+    std::atomic<const HotkeyTable*> currentTable;
+    std::atomic<int> activeReaders;
 
-    std::multiset<HotkeyDescriptor> hotkeyDescriptors;
-    std::mutex mutex;
     HHOOK hHook{};
 
-    // To store information about handling pressed keys.
-    struct PressedKeyDescriptor
+    // Gives access to the current table for as long as it lives. Tables are
+    // only freed when no reader is active, so a table stays valid even if
+    // an action registers hotkeys while it runs.
+    class TableReader
     {
-        DWORD virtualKey; // Virtual Key code of the key we're keeping track of.
-        std::wstring moduleName;
-        std::function<bool()> action;
-        UINT_PTR idTimer; // Timer ID for calling SET_TIMER with.
-        UINT millisecondsToPress; // How much time the key must be pressed.
-        bool operator<(const PressedKeyDescriptor& other) const
+    public:
+        TableReader() noexcept
         {
-            // We'll use the virtual key as the real key, since looking for a hit with the key is done in the more time sensitive path (low level keyboard hook).
-            return virtualKey < other.virtualKey;
-        };
+            activeReaders.fetch_add(1);
+            table = currentTable.load();
+        }
+
+        ~TableReader()
+        {
+            activeReaders.fetch_sub(1);
+        }
+
+        TableReader(const TableReader&) = delete;
+        TableReader& operator=(const TableReader&) = delete;
+
+        const HotkeyTable& operator*() const noexcept
+        {
+            return *table;
+        }
+
+        const HotkeyTable* operator->() const noexcept
+        {
+            return table;
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return table != nullptr;
+        }
+
+    private:
+        const HotkeyTable* table;
     };
-    std::multiset<PressedKeyDescriptor> pressedKeyDescriptors;
-    std::mutex pressedKeyMutex;
+
+    // Builds a table from the registered hotkeys and publishes it. Must be
+    // called with mutex held.
+    void PublishTable()
+    {
+        auto table = std::make_unique<HotkeyTable>(hotkeyDescriptors, pressedKeyDescriptors);
+
+        if (publishedTable)
+        {
+            retiredTables.push_back(std::move(publishedTable));
+        }
+        publishedTable = std::move(table);
+        currentTable.store(publishedTable.get());
+
+        // A reader that starts after this check loads the new table
+        if (activeReaders.load() == 0)
+        {
+            retiredTables.clear();
+        }
+    }
 
     // keep track of last pressed key, to detect repeated keys and if there are more keys pressed.
     const DWORD VK_DISABLED = CommonSharedConstants::VK_DISABLED;
@@ -62,17 +108,15 @@ namespace CentralizedKeyboardHook
         UINT_PTR idTimer,
         DWORD /*dwTime*/)
     {
-        std::multiset<PressedKeyDescriptor> copy;
-        {
-            // Make a copy, to look for the action to call.
-            std::unique_lock lock{ pressedKeyMutex };
-            copy = pressedKeyDescriptors;
-        }
-        for (const auto& it : copy)
+        TableReader table;
+        if (table)
         {
-            if (it.idTimer == idTimer)
+            for (const auto& it : table->pressedKeys)
             {
-                it.action();
+                if (it.idTimer == idTimer)
+                {
+                    it.action();
+                }
             }
         }
 
@@ -94,19 +138,22 @@ namespace CentralizedKeyboardHook
             return CallNextHookEx(hHook, nCode, wParam, lParam);
         }
 
+        TableReader table;
+        if (!table)
+        {
+            return CallNextHookEx(hHook, nCode, wParam, lParam);
+        }
+
         // Check if the keys are pressed.
-        if (!pressedKeyDescriptors.empty())
+        if (!table->pressedKeys.empty())
         {
             bool wasKeyPressed = vkCodePressed != VK_DISABLED;
-            // Hold the lock for the shortest possible duration
             if ((wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN))
             {
                 if (!wasKeyPressed)
                 {
                     // If no key was pressed before, let's start a timer to take into account this new key.
-                    std::unique_lock lock{ pressedKeyMutex };
-                    PressedKeyDescriptor dummy{ .virtualKey = keyPressInfo.vkCode };
-                    auto [it, last] = pressedKeyDescriptors.equal_range(dummy);
+                    auto [it, last] = table->PressedKeyRange(keyPressInfo.vkCode);
                     for (; it != last; ++it)
                     {
                         SetTimer(runnerWindow, it->idTimer, it->millisecondsToPress, PressedKeyTimerProc);
@@ -115,9 +162,7 @@ namespace CentralizedKeyboardHook
                 else if (vkCodePressed != keyPressInfo.vkCode)
                 {
                     // If a different key was pressed, let's clear the timers we have started for the previous key.
-                    std::unique_lock lock{ pressedKeyMutex };
-                    PressedKeyDescriptor dummy{ .virtualKey = vkCodePressed };
-                    auto [it, last] = pressedKeyDescriptors.equal_range(dummy);
+                    auto [it, last] = table->PressedKeyRange(vkCodePressed);
                     for (; it != last; ++it)
                     {
                         KillTimer(runnerWindow, it->idTimer);
@@ -127,9 +172,7 @@ namespace CentralizedKeyboardHook
             }
             if (wParam == WM_KEYUP || wParam == WM_SYSKEYUP)
             {
-                std::unique_lock lock{ pressedKeyMutex };
-                PressedKeyDescriptor dummy{ .virtualKey = keyPressInfo.vkCode };
-                auto [it, last] = pressedKeyDescriptors.equal_range(dummy);
+                auto [it, last] = table->PressedKeyRange(keyPressInfo.vkCode);
                 for (; it != last; ++it)
                 {
                     KillTimer(runnerWindow, it->idTimer);
@@ -143,12 +186,18 @@ namespace CentralizedKeyboardHook
             return CallNextHookEx(hHook, nCode, wParam, lParam);
         }
 
+        const auto key = static_cast<unsigned char>(keyPressInfo.vkCode);
+        if (!table->IsHotkeyKey(key))
+        {
+            return CallNextHookEx(hHook, nCode, wParam, lParam);
+        }
+
         Hotkey hotkey{
             .win = (GetAsyncKeyState(VK_LWIN) & 0x8000) || (GetAsyncKeyState(VK_RWIN) & 0x8000),
             .ctrl = static_cast<bool>(GetAsyncKeyState(VK_CONTROL) & 0x8000),
             .shift = static_cast<bool>(GetAsyncKeyState(VK_SHIFT) & 0x8000),
             .alt = static_cast<bool>(GetAsyncKeyState(VK_MENU) & 0x8000),
-            .key = static_cast<unsigned char>(keyPressInfo.vkCode)
+            .key = key
         };
 
         if (hotkey == Hotkey{})
@@ -156,21 +205,10 @@ namespace CentralizedKeyboardHook
             return CallNextHookEx(hHook, nCode, wParam, lParam);
         }
 
-        std::function<bool()> action;
-        {
-            // Hold the lock for the shortest possible duration
-            std::unique_lock lock{ mutex };
-            HotkeyDescriptor dummy{ .hotkey = hotkey };
-            auto it = hotkeyDescriptors.find(dummy);
-            if (it != hotkeyDescriptors.end())
-            {
-                action = it->action;
-            }
-        }
-
-        if (action)
+        const HotkeyDescriptor* descriptor = table->Find(hotkey);
+        if (descriptor && descriptor->action)
         {
-            if (action())
+            if (descriptor->action())
             {
                 // After invoking the hotkey send a dummy key to prevent Start Menu from activating
                 INPUT dummyEvent[1] = {};
@@ -191,7 +229,8 @@ namespace CentralizedKeyboardHook
     {
         Logger::trace(L"Register hotkey action for {}", moduleName);
         std::unique_lock lock{ mutex };
-        hotkeyDescriptors.insert({ .hotkey = hotkey, .moduleName = moduleName, .action = std::move(action) });
+        hotkeyDescriptors.push_back({ .hotkey = hotkey, .moduleName = moduleName, .action = std::move(action) });
+        PublishTable();
     }
 
     void AddPressedKeyAction(const std::wstring& moduleName, const DWORD vk, const UINT milliseconds, std::function<bool()>&& action) noexcept
@@ -201,43 +240,18 @@ namespace CentralizedKeyboardHook
         const UINT upperId = hash & 0xFFFF;
         const UINT lowerId = vk & 0xFFFF; // The key to press can be the lower ID.
         const UINT timerId = upperId << 16 | lowerId;
-        std::unique_lock lock{ pressedKeyMutex };
-        pressedKeyDescriptors.insert({ .virtualKey = vk, .moduleName = moduleName, .action = std::move(action), .idTimer = timerId, .millisecondsToPress = milliseconds });
+        std::unique_lock lock{ mutex };
+        pressedKeyDescriptors.push_back({ .virtualKey = vk, .moduleName = moduleName, .action = std::move(action), .idTimer = timerId, .millisecondsToPress = milliseconds });
+        PublishTable();
     }
 
     void ClearModuleHotkeys(const std::wstring& moduleName) noexcept
     {
         Logger::trace(L"UnRegister hotkey action for {}", moduleName);
-        {
-            std::unique_lock lock{ mutex };
-            auto it = hotkeyDescriptors.begin();
-            while (it != hotkeyDescriptors.end())
-            {
-                if (it->moduleName == moduleName)
-                {
-                    it = hotkeyDescriptors.erase(it);
-                }
-                else
-                {
-                    ++it;
-                }
-            }
-        }
-        {
-            std::unique_lock lock{ pressedKeyMutex };
-            auto it = pressedKeyDescriptors.begin();
-            while (it != pressedKeyDescriptors.end())
-            {
-                if (it->moduleName == moduleName)
-                {
-                    it = pressedKeyDescriptors.erase(it);
-                }
-                else
-                {
-                    ++it;
-                }
-            }
-        }
+        std::unique_lock lock{ mutex };
+        std::erase_if(hotkeyDescriptors, [&](const HotkeyDescriptor& descriptor) { return descriptor.moduleName == moduleName; });
+        std::erase_if(pressedKeyDescriptors, [&](const PressedKeyDescriptor& descriptor) { return descriptor.moduleName == moduleName; });
+        PublishTable();
     }
 
     void Start() noexcept
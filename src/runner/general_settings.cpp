@@ -4,9 +4,11 @@
 #include "tray_icon.h"
 #include "Generated files/resource.h"
 #include "hotkey_conflict_detector.h"
+#include "settings_window.h"
 
 #include <common/SettingsAPI/settings_helpers.h>
 #include "powertoy_module.h"
+#include "module_loader.h"
 #include <common/themes/windows_colors.h>
 
 #include "trace.h"
@@ -172,6 +174,12 @@ GeneralSettings get_general_settings()
         settings.isModulesEnabledMap[name] = powertoy->is_enabled();
     }
 
+    // Modules that were disabled at startup are not loaded until enabled
+    for (const auto& name : deferred_powertoy_keys())
+    {
+        settings.isModulesEnabledMap[name] = false;
+    }
+
     return settings;
 }
 
@@ -253,6 +261,10 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
                 continue;
             }
             const std::wstring name{ enabled_element.Key().c_str() };
+            if (value.GetBoolean())
+            {
+                load_deferred_powertoy(name);
+            }
             const bool found = modules().find(name) != modules().end();
             if (!found)
             {
@@ -277,6 +289,7 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
             {
                 Logger::info(L"apply_general_settings: Enabling powertoy {}", name);
                 powertoy->enable();
+                forget_applied_module_settings(name);
                 auto& hkmng = HotkeyConflictDetector::HotkeyConflictManager::GetInstance();
                 hkmng.EnableHotkeyByModule(name);
             }
@@ -284,6 +297,7 @@ void apply_general_settings(const json::JsonObject& general_configs, bool save)
             {
                 Logger::info(L"apply_general_settings: Disabling powertoy {}", name);
                 powertoy->disable();
+                forget_applied_module_settings(name);
                 auto& hkmng = HotkeyConflictDetector::HotkeyConflictManager::GetInstance();
                 hkmng.DisableHotkeyByModule(name);
             }
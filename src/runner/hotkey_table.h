@@ -0,0 +1,108 @@
+#pragma once
+#include <Windows.h>
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../modules/interface/powertoy_module_interface.h"
+
+namespace CentralizedKeyboardHook
+{
+    using Hotkey = PowertoyModuleIface::Hotkey;
+
+    struct HotkeyDescriptor
+    {
+        Hotkey hotkey;
+        std::wstring moduleName;
+        std::function<bool()> action;
+    };
+
+    // To store information about handling pressed keys.
+    struct PressedKeyDescriptor
+    {
+        DWORD virtualKey; // Virtual Key code of the key we're keeping track of.
+        std::wstring moduleName;
+        std::function<bool()> action;
+        UINT_PTR idTimer; // Timer ID for calling SET_TIMER with.
+        UINT millisecondsToPress; // How much time the key must be pressed.
+    };
+
+    // The hotkeys as the hook sees them. A table is never modified once
+    // published; registering or clearing hotkeys builds and publishes a new
+    // one, so the hook finds its action with one atomic load, an array index
+    // and no lock or allocation.
+    struct HotkeyTable
+    {
+        static constexpr size_t KeyCount = 256;
+        static constexpr size_t ModifierCombinations = 16;
+
+        static size_t SlotIndex(const Hotkey& hotkey) noexcept
+        {
+            const size_t modifiers = (hotkey.win ? 1 : 0) | (hotkey.ctrl ? 2 : 0) | (hotkey.shift ? 4 : 0) | (hotkey.alt ? 8 : 0);
+            return modifiers * KeyCount + hotkey.key;
+        }
+
+        HotkeyTable(std::vector<HotkeyDescriptor> hotkeyDescriptors, std::vector<PressedKeyDescriptor> pressedKeyDescriptors) :
+            hotkeys(std::move(hotkeyDescriptors)), pressedKeys(std::move(pressedKeyDescriptors))
+        {
+            for (size_t i = 0; i < hotkeys.size() && i < UINT16_MAX; i++)
+            {
+                const auto& hotkey = hotkeys[i].hotkey;
+                auto& slot = slots[SlotIndex(hotkey)];
+
+                // When several modules register the same hotkey, the first one wins
+                if (slot == 0)
+                {
+                    slot = static_cast<uint16_t>(i + 1);
+                }
+                hotkeyKeys.set(hotkey.key);
+            }
+
+            std::stable_sort(pressedKeys.begin(), pressedKeys.end(), [](const PressedKeyDescriptor& a, const PressedKeyDescriptor& b) {
+                return a.virtualKey < b.virtualKey;
+            });
+        }
+
+        // Whether the key is part of any hotkey. Any other key can be passed
+        // on without reading the modifier state.
+        bool IsHotkeyKey(unsigned char key) const noexcept
+        {
+            return hotkeyKeys.test(key);
+        }
+
+        // The descriptor that handles the hotkey, or nullptr.
+        const HotkeyDescriptor* Find(const Hotkey& hotkey) const noexcept
+        {
+            const uint16_t slot = slots[SlotIndex(hotkey)];
+            return slot != 0 ? &hotkeys[slot - 1] : nullptr;
+        }
+
+        // The pressed key descriptors for one virtual key.
+        std::pair<std::vector<PressedKeyDescriptor>::const_iterator, std::vector<PressedKeyDescriptor>::const_iterator> PressedKeyRange(DWORD virtualKey) const noexcept
+        {
+            return std::equal_range(pressedKeys.begin(), pressedKeys.end(), PressedKeyDescriptor{ .virtualKey = virtualKey }, [](const PressedKeyDescriptor& a, const PressedKeyDescriptor& b) {
+                return a.virtualKey < b.virtualKey;
+            });
+        }
+
+        // In registration order.
+        std::vector<HotkeyDescriptor> hotkeys;
+
+        // Index into hotkeys plus one for every modifiers and key combination,
+        // 0 if the combination is not a hotkey.
+        std::array<uint16_t, ModifierCombinations * KeyCount> slots{};
+
+        // Keys that are part of at least one hotkey.
+        std::bitset<KeyCount> hotkeyKeys;
+
+        // Sorted by virtual key.
+        std::vector<PressedKeyDescriptor> pressedKeys;
+    };
+}
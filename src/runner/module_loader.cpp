@@ -0,0 +1,444 @@
+#include "pch.h"
+#include "module_loader.h"
+#include "powertoy_module.h"
+#include "hotkey_conflict_detector.h"
+
+#include <atomic>
+#include <map>
+#include <system_error>
+
+#include <common/logger/logger.h>
+#include <common/SettingsAPI/settings_helpers.h>
+#include <common/utils/gpo.h>
+#include <common/version/version.h>
+
+namespace
+{
+    struct KnownModule
+    {
+        std::wstring_view path;
+        // Enabled state policy of the module, the same rule its
+        // gpo_policy_enabled_configuration() returns. nullptr if it has none.
+        powertoys_gpo::gpo_rule_configured_t (*gpo_rule)();
+    };
+
+    // Every module the runner ships, in registration order.
+    const KnownModule known_modules[] = {
+        { L"PowerToys.FancyZonesModuleInterface.dll", powertoys_gpo::getConfiguredFancyZonesEnabledValue },
+        { L"PowerToys.powerpreview.dll", nullptr },
+        { L"WinUI3Apps/PowerToys.ImageResizerExt.dll", powertoys_gpo::getConfiguredImageResizerEnabledValue },
+        { L"PowerToys.KeyboardManager.dll", powertoys_gpo::getConfiguredKeyboardManagerEnabledValue },
+        { L"PowerToys.Launcher.dll", powertoys_gpo::getConfiguredPowerLauncherEnabledValue },
+        { L"WinUI3Apps/PowerToys.PowerRenameExt.dll", powertoys_gpo::getConfiguredPowerRenameEnabledValue },
+        { L"PowerToys.ShortcutGuideModuleInterface.dll", powertoys_gpo::getConfiguredShortcutGuideEnabledValue },
+        { L"PowerToys.ColorPicker.dll", powertoys_gpo::getConfiguredColorPickerEnabledValue },
+        { L"PowerToys.AwakeModuleInterface.dll", powertoys_gpo::getConfiguredAwakeEnabledValue },
+        { L"PowerToys.FindMyMouse.dll", powertoys_gpo::getConfiguredFindMyMouseEnabledValue },
+        { L"PowerToys.MouseHighlighter.dll", powertoys_gpo::getConfiguredMouseHighlighterEnabledValue },
+        { L"PowerToys.MouseJump.dll", powertoys_gpo::getConfiguredMouseJumpEnabledValue },
+        { L"PowerToys.AlwaysOnTopModuleInterface.dll", powertoys_gpo::getConfiguredAlwaysOnTopEnabledValue },
+        { L"PowerToys.MousePointerCrosshairs.dll", powertoys_gpo::getConfiguredMousePointerCrosshairsEnabledValue },
+        { L"PowerToys.CursorWrap.dll", powertoys_gpo::getConfiguredCursorWrapEnabledValue },
+        { L"PowerToys.PowerAccentModuleInterface.dll", powertoys_gpo::getConfiguredQuickAccentEnabledValue },
+        { L"PowerToys.PowerOCRModuleInterface.dll", powertoys_gpo::getConfiguredTextExtractorEnabledValue },
+        { L"PowerToys.AdvancedPasteModuleInterface.dll", powertoys_gpo::getConfiguredAdvancedPasteEnabledValue },
+        { L"WinUI3Apps/PowerToys.FileLocksmithExt.dll", powertoys_gpo::getConfiguredFileLocksmithEnabledValue },
+        { L"WinUI3Apps/PowerToys.RegistryPreviewExt.dll", powertoys_gpo::getConfiguredRegistryPreviewEnabledValue },
+        { L"WinUI3Apps/PowerToys.MeasureToolModuleInterface.dll", powertoys_gpo::getConfiguredScreenRulerEnabledValue },
+        { L"WinUI3Apps/PowerToys.NewPlus.ShellExtension.dll", powertoys_gpo::getConfiguredNewPlusEnabledValue },
+        { L"WinUI3Apps/PowerToys.HostsModuleInterface.dll", powertoys_gpo::getConfiguredHostsFileEditorEnabledValue },
+        { L"WinUI3Apps/PowerToys.Peek.dll", powertoys_gpo::getConfiguredPeekEnabledValue },
+        { L"WinUI3Apps/PowerToys.EnvironmentVariablesModuleInterface.dll", powertoys_gpo::getConfiguredEnvironmentVariablesEnabledValue },
+        { L"PowerToys.MouseWithoutBordersModuleInterface.dll", powertoys_gpo::getConfiguredMouseWithoutBordersEnabledValue },
+        { L"PowerToys.CropAndLockModuleInterface.dll", powertoys_gpo::getConfiguredCropAndLockEnabledValue },
+        { L"PowerToys.CmdNotFoundModuleInterface.dll", powertoys_gpo::getConfiguredCmdNotFoundEnabledValue },
+        { L"PowerToys.WorkspacesModuleInterface.dll", powertoys_gpo::getConfiguredWorkspacesEnabledValue },
+        { L"PowerToys.CmdPalModuleInterface.dll", powertoys_gpo::getConfiguredCmdPalEnabledValue },
+        { L"PowerToys.ZoomItModuleInterface.dll", powertoys_gpo::getConfiguredZoomItEnabledValue },
+        { L"PowerToys.LightSwitchModuleInterface.dll", powertoys_gpo::getConfiguredLightSwitchEnabledValue },
+    };
+
+    struct CachedHotkey
+    {
+        int id;
+        PowertoyModuleIface::Hotkey hotkey;
+    };
+
+    // What the runner needs to know about a module without loading it.
+    struct ModuleDescriptor
+    {
+        std::wstring key;
+        bool enabled_by_default = true;
+        std::vector<CachedHotkey> hotkeys;
+    };
+
+    struct DeferredModule
+    {
+        std::wstring_view path;
+        ModuleDescriptor descriptor;
+    };
+
+    namespace descriptor_keys
+    {
+        const wchar_t VERSION[] = L"version";
+        const wchar_t MODULES[] = L"modules";
+        const wchar_t KEY[] = L"key";
+        const wchar_t ENABLED_BY_DEFAULT[] = L"enabled_by_default";
+        const wchar_t HOTKEYS[] = L"hotkeys";
+        const wchar_t ID[] = L"id";
+        const wchar_t WIN[] = L"win";
+        const wchar_t CTRL[] = L"ctrl";
+        const wchar_t SHIFT[] = L"shift";
+        const wchar_t ALT[] = L"alt";
+        const wchar_t CODE[] = L"code";
+    }
+
+    using steady_clock = std::chrono::steady_clock;
+
+    double elapsed_ms(steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(steady_clock::now() - start).count();
+    }
+
+    std::map<std::wstring, DeferredModule>& deferred_modules()
+    {
+        static std::map<std::wstring, DeferredModule> deferred;
+        return deferred;
+    }
+
+    // Module key of every loaded module, by DLL path.
+    std::map<std::wstring_view, std::wstring>& loaded_modules()
+    {
+        static std::map<std::wstring_view, std::wstring> loaded;
+        return loaded;
+    }
+
+    // The descriptors as they are in the file, so that it's only rewritten
+    // when a module's hotkeys or policy change
+    std::wstring& saved_descriptors()
+    {
+        static std::wstring saved;
+        return saved;
+    }
+
+    std::wstring descriptors_file_path()
+    {
+        return PTSettingsHelper::get_root_save_folder_location() + L"\\module_descriptors.json";
+    }
+
+    json::JsonObject descriptor_to_json(const ModuleDescriptor& descriptor)
+    {
+        using namespace descriptor_keys;
+
+        json::JsonArray hotkeys;
+        for (const auto& [id, hotkey] : descriptor.hotkeys)
+        {
+            json::JsonObject hotkey_json;
+            hotkey_json.SetNamedValue(ID, json::value(id));
+            hotkey_json.SetNamedValue(WIN, json::value(hotkey.win));
+            hotkey_json.SetNamedValue(CTRL, json::value(hotkey.ctrl));
+            hotkey_json.SetNamedValue(SHIFT, json::value(hotkey.shift));
+            hotkey_json.SetNamedValue(ALT, json::value(hotkey.alt));
+            hotkey_json.SetNamedValue(CODE, json::value(static_cast<int>(hotkey.key)));
+            hotkeys.Append(hotkey_json);
+        }
+
+        json::JsonObject result;
+        result.SetNamedValue(KEY, json::value(descriptor.key));
+        result.SetNamedValue(ENABLED_BY_DEFAULT, json::value(descriptor.enabled_by_default));
+        result.SetNamedValue(HOTKEYS, hotkeys);
+        return result;
+    }
+
+    ModuleDescriptor descriptor_from_json(const json::JsonObject& descriptor_json)
+    {
+        using namespace descriptor_keys;
+
+        ModuleDescriptor descriptor;
+        descriptor.key = descriptor_json.GetNamedString(KEY);
+        descriptor.enabled_by_default = descriptor_json.GetNamedBoolean(ENABLED_BY_DEFAULT);
+        for (const auto& value : descriptor_json.GetNamedArray(HOTKEYS))
+        {
+            const auto hotkey_json = value.GetObjectW();
+            CachedHotkey cached{};
+            cached.id = static_cast<int>(hotkey_json.GetNamedNumber(ID));
+            cached.hotkey.win = hotkey_json.GetNamedBoolean(WIN);
+            cached.hotkey.ctrl = hotkey_json.GetNamedBoolean(CTRL);
+            cached.hotkey.shift = hotkey_json.GetNamedBoolean(SHIFT);
+            cached.hotkey.alt = hotkey_json.GetNamedBoolean(ALT);
+            cached.hotkey.key = static_cast<unsigned char>(hotkey_json.GetNamedNumber(CODE));
+            descriptor.hotkeys.push_back(cached);
+        }
+        return descriptor;
+    }
+
+    // Describes a loaded module; only the hotkeys the module registers with
+    // the conflict detector are kept.
+    ModuleDescriptor describe_module(PowertoyModule& powertoy)
+    {
+        ModuleDescriptor descriptor;
+        descriptor.key = powertoy->get_key();
+        descriptor.enabled_by_default = powertoy->is_enabled_by_default();
+
+        const size_t hotkey_count = powertoy->get_hotkeys(nullptr, 0);
+        std::vector<PowertoyModuleIface::Hotkey> hotkeys(hotkey_count);
+        powertoy->get_hotkeys(hotkeys.data(), hotkey_count);
+        for (size_t i = 0; i < hotkey_count; i++)
+        {
+            if (hotkeys[i].isShown)
+            {
+                descriptor.hotkeys.push_back({ static_cast<int>(i), hotkeys[i] });
+            }
+        }
+        return descriptor;
+    }
+
+    // Descriptors cached by this version of PowerToys, by DLL path. Another
+    // version may ship modules with different keys or defaults, so its
+    // descriptors are ignored.
+    std::map<std::wstring, ModuleDescriptor> read_module_descriptors()
+    {
+        std::map<std::wstring, ModuleDescriptor> result;
+        const auto file = json::from_file(descriptors_file_path());
+        if (!file)
+        {
+            return result;
+        }
+
+        try
+        {
+            if (file->GetNamedString(descriptor_keys::VERSION) != get_product_version())
+            {
+                Logger::info(L"Module descriptors are from another version, loading all modules");
+                return result;
+            }
+
+            for (const auto& element : file->GetNamedObject(descriptor_keys::MODULES))
+            {
+                result.emplace(element.Key().c_str(), descriptor_from_json(element.Value().GetObjectW()));
+            }
+            saved_descriptors() = file->Stringify().c_str();
+        }
+        catch (...)
+        {
+            Logger::warn(L"Module descriptors are malformed, loading all modules");
+            result.clear();
+        }
+        return result;
+    }
+
+    bool should_be_enabled(const KnownModule& known, const ModuleDescriptor& descriptor, const json::JsonObject& enabled)
+    {
+        // Same precedence as start_enabled_powertoys: policy, then the user's
+        // choice, then the module's default.
+        const auto gpo_rule = known.gpo_rule ? known.gpo_rule() : powertoys_gpo::gpo_rule_configured_not_configured;
+        if (gpo_rule == powertoys_gpo::gpo_rule_configured_enabled || gpo_rule == powertoys_gpo::gpo_rule_configured_disabled)
+        {
+            return gpo_rule == powertoys_gpo::gpo_rule_configured_enabled;
+        }
+
+        if (json::has(enabled, descriptor.key, json::JsonValueType::Boolean))
+        {
+            return enabled.GetNamedBoolean(descriptor.key);
+        }
+
+        return descriptor.enabled_by_default;
+    }
+
+    void defer_module(const KnownModule& known, ModuleDescriptor descriptor)
+    {
+        // Keep the hotkeys of the disabled module visible to the conflict
+        // detector, as they would be if the module were loaded.
+        auto& hkmng = HotkeyConflictDetector::HotkeyConflictManager::GetInstance();
+        for (const auto& [id, hotkey] : descriptor.hotkeys)
+        {
+            hkmng.AddHotkey(hotkey, descriptor.key.c_str(), id, false);
+        }
+
+        auto key = descriptor.key;
+        deferred_modules().insert_or_assign(std::move(key), DeferredModule{ known.path, std::move(descriptor) });
+    }
+
+    // Maps the DLLs into the process on a few worker threads. Mapping is
+    // where the time goes (file system filters scan every image), and the
+    // loader runs it in parallel; DllMain calls are serialized by the loader.
+    // Returns the handles, which keep the DLLs loaded until they are released.
+    std::vector<HMODULE> preload_libraries(const std::vector<const KnownModule*>& to_load, std::vector<double>& timings)
+    {
+        std::vector<HMODULE> handles(to_load.size(), nullptr);
+        timings.assign(to_load.size(), 0.0);
+
+        std::atomic_size_t next = 0;
+        auto worker = [&] {
+            for (size_t i = next++; i < to_load.size(); i = next++)
+            {
+                const auto start = steady_clock::now();
+                handles[i] = LoadLibraryW(to_load[i]->path.data());
+                timings[i] = elapsed_ms(start);
+            }
+        };
+
+        const size_t thread_count = std::min<size_t>(std::clamp(std::thread::hardware_concurrency(), 1u, 8u), to_load.size());
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < thread_count; i++)
+        {
+            try
+            {
+                threads.emplace_back(worker);
+            }
+            catch (const std::system_error&)
+            {
+                // The remaining work is picked up by the threads that did start
+                break;
+            }
+        }
+        worker();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        return handles;
+    }
+}
+
+std::vector<std::wstring> load_powertoys(const json::JsonObject& general_settings)
+{
+    const auto start = steady_clock::now();
+
+    json::JsonObject enabled;
+    if (json::has(general_settings, L"enabled"))
+    {
+        enabled = general_settings.GetNamedObject(L"enabled");
+    }
+
+    auto descriptors = read_module_descriptors();
+
+    std::vector<const KnownModule*> to_load;
+    for (const auto& known : known_modules)
+    {
+        auto it = descriptors.find(std::wstring{ known.path });
+        if (it != descriptors.end() && !should_be_enabled(known, it->second, enabled))
+        {
+            Logger::info(L"Deferring load of disabled module {}", it->second.key);
+            defer_module(known, std::move(it->second));
+            continue;
+        }
+        to_load.push_back(&known);
+    }
+
+    std::vector<double> map_timings;
+    auto preloaded = preload_libraries(to_load, map_timings);
+    const double map_ms = elapsed_ms(start);
+
+    // Create the modules in list order on this thread: module constructors
+    // register hotkeys and may create windows, and the registration order
+    // must not depend on which DLL finished mapping first.
+    std::vector<std::wstring> failures;
+    for (size_t i = 0; i < to_load.size(); i++)
+    {
+        const auto path = to_load[i]->path;
+        const auto create_start = steady_clock::now();
+        try
+        {
+            auto pt_module = load_powertoy(path);
+            std::wstring key = pt_module->get_key();
+            loaded_modules()[path] = key;
+            modules().emplace(std::move(key), std::move(pt_module));
+            Logger::info(L"Loaded {} in {:.1f} ms (mapped in {:.1f} ms)", path, elapsed_ms(create_start), map_timings[i]);
+        }
+        catch (...)
+        {
+            failures.emplace_back(path);
+        }
+
+        if (preloaded[i])
+        {
+            FreeLibrary(preloaded[i]);
+        }
+    }
+
+    Logger::info(L"Loaded {} modules in {:.1f} ms ({:.1f} ms mapping DLLs), deferred {}", modules().size(), elapsed_ms(start), map_ms, deferred_modules().size());
+
+    save_module_descriptors();
+    return failures;
+}
+
+bool load_deferred_powertoy(const std::wstring& key)
+{
+    if (modules().contains(key))
+    {
+        return true;
+    }
+
+    auto it = deferred_modules().find(key);
+    if (it == deferred_modules().end())
+    {
+        return false;
+    }
+
+    const auto path = it->second.path;
+    const auto start = steady_clock::now();
+    try
+    {
+        auto pt_module = load_powertoy(path);
+        std::wstring loaded_key = pt_module->get_key();
+        loaded_modules()[path] = loaded_key;
+        modules().emplace(std::move(loaded_key), std::move(pt_module));
+        deferred_modules().erase(it);
+        Logger::info(L"Loaded deferred module {} in {:.1f} ms", path, elapsed_ms(start));
+    }
+    catch (...)
+    {
+        Logger::error(L"Failed to load deferred module {}", path);
+        return false;
+    }
+
+    save_module_descriptors();
+    return modules().contains(key);
+}
+
+std::vector<std::wstring> deferred_powertoy_keys()
+{
+    std::vector<std::wstring> keys;
+    for (const auto& [key, deferred] : deferred_modules())
+    {
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+void save_module_descriptors()
+{
+    try
+    {
+        json::JsonObject modules_json;
+        for (const auto& [path, key] : loaded_modules())
+        {
+            auto it = modules().find(key);
+            if (it != modules().end())
+            {
+                modules_json.SetNamedValue(path, descriptor_to_json(describe_module(it->second)));
+            }
+        }
+        for (const auto& [key, deferred] : deferred_modules())
+        {
+            modules_json.SetNamedValue(deferred.path, descriptor_to_json(deferred.descriptor));
+        }
+
+        json::JsonObject root;
+        root.SetNamedValue(descriptor_keys::VERSION, json::value(get_product_version()));
+        root.SetNamedValue(descriptor_keys::MODULES, modules_json);
+
+        std::wstring descriptors{ root.Stringify().c_str() };
+        if (descriptors == saved_descriptors())
+        {
+            return;
+        }
+        json::to_file(descriptors_file_path(), root);
+        saved_descriptors() = std::move(descriptors);
+    }
+    catch (...)
+    {
+        Logger::warn(L"Failed to save module descriptors");
+    }
+}
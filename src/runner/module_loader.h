@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include <common/utils/json.h>
+
+// Startup loading of the PowerToys module DLLs.
+//
+// Modules that are disabled are not loaded at startup. For each of them the
+// runner keeps a descriptor (key, default enabled state and hotkeys) cached
+// from the last time the module was loaded, and loads the module when it is
+// enabled or its config or a custom action is sent to it. Until then its
+// settings come from its settings file. Modules without a cached descriptor
+// are always loaded.
+
+// Loads the modules that will be enabled into modules(), in the order of the
+// known modules list. The DLLs are mapped in parallel; the modules themselves
+// are created on the calling thread. Returns the modules that failed to load.
+std::vector<std::wstring> load_powertoys(const json::JsonObject& general_settings);
+
+// Loads the deferred module with this key. Returns true if it is in modules()
+// afterwards, whether it was just loaded or already there.
+bool load_deferred_powertoy(const std::wstring& key);
+
+// Keys of the modules that are known but not loaded; all of them are disabled.
+std::vector<std::wstring> deferred_powertoy_keys();
+
+// Refreshes the descriptor cache from the loaded modules.
+void save_module_descriptors();
@@ -8,6 +8,9 @@
 #include <common/SettingsAPI/settings_helpers.h>
 #include <filesystem>
 #include "powertoy_module.h"
+#include "module_loader.h"
+#include "tray_icon.h"
+#include "trace.h"
 
 using JsonObject = winrt::Windows::Data::Json::JsonObject;
 using JsonValue = winrt::Windows::Data::Json::JsonValue;
@@ -38,7 +41,8 @@ void update_last_send_time(time_t time)
     json::to_file(get_info_file_path(), settings);
 }
 
-void send()
+// Runs on the main UI thread, the only one that adds to modules()
+void send_on_main_ui_thread(PVOID)
 {
     for (auto& [name, powertoy] : modules())
     {
@@ -54,6 +58,41 @@ void send()
             }
         }
     }
+
+    // Modules deferred at startup aren't loaded just for telemetry; their
+    // enabled state is reported from the saved general settings instead.
+    const auto deferred = deferred_powertoy_keys();
+    if (deferred.empty())
+    {
+        return;
+    }
+
+    json::JsonObject enabled;
+    try
+    {
+        const auto general_settings = PTSettingsHelper::load_general_settings();
+        if (json::has(general_settings, L"enabled", json::JsonValueType::Object))
+        {
+            enabled = general_settings.GetNamedObject(L"enabled");
+        }
+    }
+    catch (...)
+    {
+        Logger::warn(L"Failed to read the enabled state of deferred modules");
+    }
+
+    for (const auto& name : deferred)
+    {
+        Trace::DeferredModuleSettings(name, enabled.GetNamedBoolean(name, false));
+    }
+}
+
+void send()
+{
+    if (!dispatch_run_on_main_ui_thread(send_on_main_ui_thread, nullptr))
+    {
+        Logger::warn(L"Failed to schedule settings telemetry");
+    }
 }
 
 void run_interval()
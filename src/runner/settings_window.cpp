@@ -5,6 +5,7 @@
 #include <aclapi.h>
 
 #include "powertoy_module.h"
+#include "module_loader.h"
 #include <common/interop/two_way_pipe_message_ipc.h>
 #include <common/interop/shared_constants.h>
 #include "tray_icon.h"
@@ -17,6 +18,7 @@
 
 #include <common/utils/json.h>
 #include <common/SettingsAPI/settings_helpers.cpp>
+#include <common/SettingsAPI/settings_diff.h>
 #include <common/version/version.h>
 #include <common/version/helper.h>
 #include <common/logger/logger.h>
@@ -36,6 +38,7 @@ TwoWayPipeMessageIPC* current_settings_ipc = NULL;
 std::mutex ipc_mutex;
 std::atomic_bool g_isLaunchInProgress = false;
 std::atomic_bool isUpdateCheckThreadRunning = false;
+PTSettingsHelper::applied_settings_cache applied_module_settings;
 HANDLE g_terminateSettingsEvent = CreateEventW(nullptr, false, false, CommonSharedConstants::TERMINATE_SETTINGS_SHARED_EVENT);
 
 json::JsonObject get_power_toys_settings()
@@ -52,6 +55,21 @@ json::JsonObject get_power_toys_settings()
             Logger::error(L"get_power_toys_settings(): got malformed json for {} module", name);
         }
     }
+
+    // Settings shows the configuration of every module, enabled or not. The
+    // modules deferred at startup aren't loaded for that: their settings are
+    // read from their settings files.
+    for (const auto& name : deferred_powertoy_keys())
+    {
+        try
+        {
+            result.SetNamedValue(name, PTSettingsHelper::load_module_settings(name));
+        }
+        catch (...)
+        {
+            Logger::error(L"get_power_toys_settings(): failed to read the settings of deferred module {}", name);
+        }
+    }
     return result;
 }
 
@@ -138,7 +156,7 @@ std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObjec
             {
             }
         }
-        else if (modules().find(name) != modules().end())
+        else if (load_deferred_powertoy(name))
         {
             const auto element = powertoy_element.Value().Stringify();
             modules().at(name)->call_custom_action(element.c_str());
@@ -150,6 +168,15 @@ std::optional<std::wstring> dispatch_json_action_to_module(const json::JsonObjec
 
 void send_json_config_to_module(const std::wstring& module_key, const std::wstring& settings)
 {
+    // Settings UI resends the settings of a module that didn't change, which
+    // would otherwise re-apply them and re-register the module's hotkeys.
+    if (!applied_module_settings.update(module_key, settings))
+    {
+        return;
+    }
+
+    load_deferred_powertoy(module_key);
+
     auto moduleIt = modules().find(module_key);
     if (moduleIt != modules().end())
     {
@@ -161,6 +188,11 @@ void send_json_config_to_module(const std::wstring& module_key, const std::wstri
     }
 }
 
+void forget_applied_module_settings(const std::wstring& module_key)
+{
+    applied_module_settings.forget(module_key);
+}
+
 void dispatch_json_config_to_modules(const json::JsonObject& powertoys_configs)
 {
     for (const auto& powertoy_element : powertoys_configs)
@@ -168,6 +200,10 @@ void dispatch_json_config_to_modules(const json::JsonObject& powertoys_configs)
         const auto element = powertoy_element.Value().Stringify();
         send_json_config_to_module(powertoy_element.Key().c_str(), element.c_str());
     }
+
+    // Keep the cached hotkeys of modules that may be disabled next startup.
+    // The file is only written when they changed.
+    save_module_descriptors();
 };
 
 void dispatch_received_json(const std::wstring& json_to_parse)
@@ -41,6 +41,10 @@ enum class ESettingsWindowNames
 std::string ESettingsWindowNames_to_string(ESettingsWindowNames value);
 ESettingsWindowNames ESettingsWindowNames_from_string(std::string value);
 
+// Makes the next settings sent to the module apply in full, for when the
+// module may have reloaded or changed its settings on its own.
+void forget_applied_module_settings(const std::wstring& module_key);
+
 void open_settings_window(std::optional<std::wstring> settings_window, bool show_flyout, const std::optional<POINT>& flyout_position);
 void close_settings_window();
 
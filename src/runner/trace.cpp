@@ -55,3 +55,15 @@ void Trace::SettingsChanged(const GeneralSettings& settings)
         TraceLoggingBoolean(TRUE, "UTCReplace_AppSessionGuid"),
         TraceLoggingKeyword(PROJECT_KEYWORD_MEASURE));
 }
+
+void Trace::DeferredModuleSettings(const std::wstring& moduleKey, bool enabled)
+{
+    TraceLoggingWriteWrapper(
+        g_hProvider,
+        "Runner_DeferredModuleSettings",
+        TraceLoggingWideString(moduleKey.c_str(), "ModuleKey"),
+        TraceLoggingBoolean(enabled, "Enabled"),
+        ProjectTelemetryPrivacyDataTag(ProjectTelemetryTag_ProductAndServicePerformance),
+        TraceLoggingBoolean(TRUE, "UTCReplace_AppSessionGuid"),
+        TraceLoggingKeyword(PROJECT_KEYWORD_MEASURE));
+}
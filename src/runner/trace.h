@@ -9,4 +9,7 @@ class Trace : public telemetry::TraceBase
 public:
     static void EventLaunch(const std::wstring& versionNumber, bool isProcessElevated);
     static void SettingsChanged(const GeneralSettings& settings);
+
+    // Settings telemetry of a module that was deferred at startup and isn't loaded
+    static void DeferredModuleSettings(const std::wstring& moduleKey, bool enabled);
 };
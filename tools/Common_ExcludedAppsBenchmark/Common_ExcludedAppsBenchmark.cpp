@@ -0,0 +1,159 @@
+// Benchmark of excluded_apps_matcher.
+//
+// Replays a stream of window events against 400 excluded app names, each
+// event being a window of one of 41 processes, most of them the same few,
+// and compares:
+//   - check_excluded_app: each name searched in the process path, then in
+//     the window title,
+//   - excluded_apps_matcher::is_excluded: one scan of the path, memoized
+//     per path, then one scan of the title.
+// Both read the title of the same window. It checks that both give the same
+// result for every event, and first compares matches_path with
+// find_app_name_in_path on random short paths and names over a small
+// alphabet, where names overlap and repeat a lot.
+//
+// The Visual Studio project reads the title of a real hidden window.
+// Elsewhere it builds with posix/Windows.h, which stands in for the window
+// calls:
+//   g++ -std=c++23 -O2 -Iposix -I../../src Common_ExcludedAppsBenchmark.cpp
+//
+// Usage: Common_ExcludedAppsBenchmark [events]
+
+#include <Windows.h>
+
+#include <common/utils/excluded_apps.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    const wchar_t* const title = L"Some document - Editor with a fairly typical window title";
+
+    std::wstring RandomText(std::mt19937& rng, size_t length, std::wstring_view alphabet)
+    {
+        std::wstring text;
+        for (size_t i = 0; i < length; i++)
+        {
+            text += alphabet[rng() % alphabet.length()];
+        }
+        return text;
+    }
+
+    // Returns the number of mismatches
+    int CompareWithFindAppNameInPath(std::mt19937& rng)
+    {
+        int mismatches = 0;
+        for (int i = 0; i < 20000; i++)
+        {
+            std::vector<std::wstring> apps;
+            for (size_t app = 0, count = 1 + rng() % 6; app < count; app++)
+            {
+                apps.push_back(RandomText(rng, 1 + rng() % 4, L"AB\\."));
+            }
+
+            const excluded_apps_matcher matcher(apps);
+            for (int j = 0; j < 10; j++)
+            {
+                const std::wstring path = RandomText(rng, rng() % 14, L"AB\\.");
+                if (find_app_name_in_path(path, apps) != matcher.matches_path(path))
+                {
+                    mismatches++;
+                }
+            }
+        }
+        return mismatches;
+    }
+
+#ifdef _WIN32
+    HWND CreateTitledWindow()
+    {
+        return CreateWindowExW(0, L"STATIC", title, WS_POPUP, 0, 0, 0, 0, nullptr, nullptr, GetModuleHandleW(nullptr), nullptr);
+    }
+#else
+    HWND CreateTitledWindow()
+    {
+        static std::wstring text = title;
+        return &text;
+    }
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 200000;
+    std::mt19937 rng(1);
+
+    const int pathMismatches = CompareWithFindAppNameInPath(rng);
+
+    const std::wstring_view letters = L"ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::vector<std::wstring> apps;
+    for (int i = 0; i < 400; i++)
+    {
+        apps.push_back(RandomText(rng, 5 + rng() % 10, letters) + (i % 2 ? L".EXE" : L""));
+    }
+
+    // Paths are uppercase, as the modules pass them
+    std::vector<std::wstring> processes;
+    for (int i = 0; i < 40; i++)
+    {
+        processes.push_back(L"C:\\PROGRAM FILES\\" + RandomText(rng, 10, L"ABCDEFGHIJKLMNOPQRSTUVWXYZ ") + L"\\" + RandomText(rng, 8, letters) + L".EXE");
+    }
+    processes.push_back(L"C:\\PROGRAM FILES\\X\\" + apps[17]);
+
+    // Most events come from a few processes
+    std::vector<size_t> events;
+    for (size_t i = 0; i < count; i++)
+    {
+        events.push_back(rng() % 5 ? rng() % 4 : rng() % processes.size());
+    }
+
+    const HWND window = CreateTitledWindow();
+
+    std::vector<bool> referenceResults;
+    referenceResults.reserve(count);
+    auto start = Clock::now();
+    for (const size_t process : events)
+    {
+        referenceResults.push_back(check_excluded_app(window, processes[process], apps));
+    }
+    const double referenceNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+
+    std::vector<bool> matcherResults;
+    matcherResults.reserve(count);
+    start = Clock::now();
+    const excluded_apps_matcher matcher(apps);
+    for (const size_t process : events)
+    {
+        matcherResults.push_back(matcher.is_excluded(window, processes[process]));
+    }
+    const double matcherNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+
+#ifdef _WIN32
+    DestroyWindow(window);
+#endif
+
+    size_t excluded = 0;
+    for (const bool result : matcherResults)
+    {
+        excluded += result;
+    }
+
+    std::printf("%zu apps, %zu processes, %zu events, %zu excluded\n\n", apps.size(), processes.size(), count, excluded);
+    std::printf("%-22s %10.0f ns/event\n", "check_excluded_app", referenceNs);
+    std::printf("%-22s %10.0f ns/event (including the build)\n", "excluded_apps_matcher", matcherNs);
+
+    if (pathMismatches != 0 || referenceResults != matcherResults)
+    {
+        std::printf("\nMISMATCH: %d random paths, and the event results %s\n", pathMismatches, referenceResults == matcherResults ? "match" : "differ");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,32 @@
+// Stands in for the window calls excluded_apps.h makes, so the benchmark can
+// run where there is no Windows.h. A window handle points to its title.
+#pragma once
+#include <cwchar>
+#include <cwctype>
+#include <string>
+
+typedef void* HWND;
+typedef wchar_t WCHAR;
+typedef unsigned long DWORD;
+
+inline int GetWindowTextW(HWND hwnd, WCHAR* text, int max_count)
+{
+    if (!hwnd || max_count <= 0)
+    {
+        return 0;
+    }
+    const auto& title = *static_cast<const std::wstring*>(hwnd);
+    const int length = static_cast<int>(title.length() < static_cast<size_t>(max_count) ? title.length() : max_count - 1);
+    wmemcpy(text, title.data(), length);
+    text[length] = L'\0';
+    return length;
+}
+
+inline DWORD CharUpperBuffW(WCHAR* text, DWORD length)
+{
+    for (DWORD i = 0; i < length; i++)
+    {
+        text[i] = static_cast<WCHAR>(towupper(text[i]));
+    }
+    return length;
+}
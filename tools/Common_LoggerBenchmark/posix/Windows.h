@@ -0,0 +1,137 @@
+// Stands in for the Windows thread pool calls async_sink makes, so the
+// benchmark can run where there is no Windows.h. Timers and work items run
+// their callback on a new thread; waits join those threads.
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define CALLBACK
+#define TRUE 1
+#define GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT 0x2
+#define GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS 0x4
+
+typedef void* PVOID;
+typedef void* HMODULE;
+typedef const wchar_t* LPCWSTR;
+typedef unsigned long DWORD;
+typedef int BOOL;
+typedef unsigned long long ULONGLONG;
+typedef long long LONGLONG;
+
+union ULARGE_INTEGER
+{
+    struct
+    {
+        DWORD LowPart;
+        DWORD HighPart;
+    };
+    ULONGLONG QuadPart;
+};
+
+struct FILETIME
+{
+    DWORD dwLowDateTime;
+    DWORD dwHighDateTime;
+};
+
+struct TP_CALLBACK_ENVIRON
+{
+};
+
+typedef void* PTP_CALLBACK_INSTANCE;
+
+struct thread_pool_object
+{
+    std::function<void()> callback;
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+    std::atomic<int> generation = 0;
+};
+
+typedef thread_pool_object* PTP_TIMER;
+typedef thread_pool_object* PTP_WORK;
+
+inline BOOL GetModuleHandleExW(DWORD, LPCWSTR, HMODULE* module)
+{
+    *module = nullptr;
+    return 0;
+}
+
+inline void InitializeThreadpoolEnvironment(TP_CALLBACK_ENVIRON*) {}
+inline void DestroyThreadpoolEnvironment(TP_CALLBACK_ENVIRON*) {}
+inline void SetThreadpoolCallbackLibrary(TP_CALLBACK_ENVIRON*, HMODULE) {}
+
+inline PTP_TIMER CreateThreadpoolTimer(void (*callback)(PTP_CALLBACK_INSTANCE, PVOID, PTP_TIMER), PVOID context, TP_CALLBACK_ENVIRON*)
+{
+    auto timer = new thread_pool_object;
+    timer->callback = [=] { callback(nullptr, context, timer); };
+    return timer;
+}
+
+inline PTP_WORK CreateThreadpoolWork(void (*callback)(PTP_CALLBACK_INSTANCE, PVOID, PTP_WORK), PVOID context, TP_CALLBACK_ENVIRON*)
+{
+    auto work = new thread_pool_object;
+    work->callback = [=] { callback(nullptr, context, work); };
+    return work;
+}
+
+// Only relative due times are supported; a later call cancels the pending one
+inline void SetThreadpoolTimer(PTP_TIMER timer, FILETIME* due, DWORD, DWORD)
+{
+    const int generation = ++timer->generation;
+    if (!due)
+    {
+        return;
+    }
+    ULARGE_INTEGER time;
+    time.LowPart = due->dwLowDateTime;
+    time.HighPart = due->dwHighDateTime;
+    const auto delay = std::chrono::microseconds(-static_cast<LONGLONG>(time.QuadPart) / 10);
+
+    std::lock_guard lock(timer->mutex);
+    timer->threads.emplace_back([timer, generation, delay] {
+        std::this_thread::sleep_for(delay);
+        if (timer->generation == generation)
+        {
+            timer->callback();
+        }
+    });
+}
+
+inline void SubmitThreadpoolWork(PTP_WORK work)
+{
+    std::lock_guard lock(work->mutex);
+    work->threads.emplace_back([work] { work->callback(); });
+}
+
+inline void wait_for_callbacks(thread_pool_object* object)
+{
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard lock(object->mutex);
+        threads.swap(object->threads);
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+inline void WaitForThreadpoolTimerCallbacks(PTP_TIMER timer, BOOL) { wait_for_callbacks(timer); }
+inline void WaitForThreadpoolWorkCallbacks(PTP_WORK work, BOOL) { wait_for_callbacks(work); }
+
+inline void CloseThreadpoolTimer(PTP_TIMER timer)
+{
+    wait_for_callbacks(timer);
+    delete timer;
+}
+
+inline void CloseThreadpoolWork(PTP_WORK work)
+{
+    wait_for_callbacks(work);
+    delete work;
+}
@@ -0,0 +1,394 @@
+// Benchmark of common/utils/json_native.h.
+//
+// Generates documents shaped like the FancyZones applied-layouts,
+// custom-layouts and app-zone-history files and a Keyboard Manager
+// default.json, or reads the files given on the command line, and times
+// for each:
+//   - document::parse followed by a walk over every value,
+//   - the SAX parse alone, on a copy of the text,
+//   - writing the document back.
+// It checks that the written text parses back to an equal document.
+//
+// With "fuzz", it instead mutates the documents at random and parses,
+// walks and writes whatever still parses, for running under sanitizers.
+//
+// Usage: Common_NativeJsonBenchmark [files...]
+//        Common_NativeJsonBenchmark fuzz [iterations]
+
+#include "../../src/common/utils/json_native.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Fixture
+    {
+        std::string name;
+        std::string text;
+    };
+
+    // Counts values without building anything
+    struct CountingHandler
+    {
+        size_t count = 0;
+
+        void null() { count++; }
+        void boolean(bool) { count++; }
+        void number(double) { count++; }
+        void string(std::string_view) { count++; }
+        void key(std::string_view) { count++; }
+        void start_object() { count++; }
+        void end_object() {}
+        void start_array() { count++; }
+        void end_array() {}
+    };
+
+    size_t Walk(json::native::value_ref value)
+    {
+        size_t count = 1;
+        if (value.is_object())
+        {
+            for (const auto [key, member] : value.members())
+            {
+                count += key.size() + Walk(member);
+            }
+        }
+        else if (value.is_array())
+        {
+            for (const auto element : value.elements())
+            {
+                count += Walk(element);
+            }
+        }
+        return count;
+    }
+
+    std::string Guid(std::mt19937& rng)
+    {
+        char text[40];
+        std::snprintf(text, sizeof(text), "{%08X-%04X-%04X-%04X-%04X%08X}", static_cast<unsigned>(rng()), static_cast<unsigned>(rng() & 0xFFFF), static_cast<unsigned>(rng() & 0xFFFF), static_cast<unsigned>(rng() & 0xFFFF), static_cast<unsigned>(rng() & 0xFFFF), static_cast<unsigned>(rng()));
+        return text;
+    }
+
+    void WriteDevice(json::native::writer& writer, std::mt19937& rng)
+    {
+        char monitor[16];
+        std::snprintf(monitor, sizeof(monitor), "DELA0%02u", static_cast<unsigned>(rng() % 100));
+        char instance[40];
+        std::snprintf(instance, sizeof(instance), "4&%x&0&UID%u", static_cast<unsigned>(rng()), static_cast<unsigned>(rng() % 9999 + 1));
+        char serial[16];
+        std::snprintf(serial, sizeof(serial), "%08X", static_cast<unsigned>(rng()));
+
+        writer.start_object();
+        writer.key("monitor").value(std::string_view(monitor));
+        writer.key("monitor-instance").value(std::string_view(instance));
+        writer.key("monitor-number").value(static_cast<int>(rng() % 4 + 1));
+        writer.key("serial-number").value(std::string_view(serial));
+        writer.key("virtual-desktop").value(std::string_view(Guid(rng)));
+        writer.end_object();
+    }
+
+    void WriteIntArray(json::native::writer& writer, std::initializer_list<int> values)
+    {
+        writer.start_array();
+        for (const int value : values)
+        {
+            writer.value(value);
+        }
+        writer.end_array();
+    }
+
+    std::string AppliedLayouts(std::mt19937& rng)
+    {
+        static const char* types[] = { "custom", "grid", "columns", "rows", "priority-grid" };
+        json::native::writer writer;
+        writer.start_object().key("applied-layouts").start_array();
+        for (int i = 0; i < 400; i++)
+        {
+            writer.start_object().key("device");
+            WriteDevice(writer, rng);
+            writer.key("applied-layout").start_object();
+            writer.key("uuid").value(std::string_view(Guid(rng)));
+            writer.key("type").value(std::string_view(types[rng() % 5]));
+            writer.key("show-spacing").value(true);
+            writer.key("spacing").value(16);
+            writer.key("zone-count").value(static_cast<int>(rng() % 8 + 1));
+            writer.key("sensitivity-radius").value(20);
+            writer.end_object().end_object();
+        }
+        writer.end_array().end_object();
+        return writer.str();
+    }
+
+    std::string CustomLayouts(std::mt19937& rng)
+    {
+        json::native::writer writer;
+        writer.start_object().key("custom-layouts").start_array();
+        for (int i = 0; i < 300; i++)
+        {
+            writer.start_object();
+            writer.key("uuid").value(std::string_view(Guid(rng)));
+            if (i % 2)
+            {
+                // Escapes and non-ASCII text, as layout names have
+                writer.key("name").value(L"Layout \u00e9 \"" + std::to_wstring(i) + L"\"\n");
+                writer.key("type").value(std::string_view("grid"));
+                writer.key("info").start_object();
+                writer.key("rows").value(3);
+                writer.key("columns").value(3);
+                writer.key("rows-percentage");
+                WriteIntArray(writer, { 3333, 3333, 3334 });
+                writer.key("columns-percentage");
+                WriteIntArray(writer, { 3333, 3333, 3334 });
+                writer.key("cell-child-map").start_array();
+                WriteIntArray(writer, { 0, 1, 2 });
+                WriteIntArray(writer, { 3, 4, 5 });
+                WriteIntArray(writer, { 6, 7, 8 });
+                writer.end_array();
+                writer.key("show-spacing").value(true);
+                writer.key("spacing").value(10);
+                writer.key("sensitivity-radius").value(20);
+                writer.end_object();
+            }
+            else
+            {
+                writer.key("name").value(L"Canvas " + std::to_wstring(i) + L" \U0001F600");
+                writer.key("type").value(std::string_view("canvas"));
+                writer.key("info").start_object();
+                writer.key("ref-width").value(2560);
+                writer.key("ref-height").value(1440);
+                writer.key("zones").start_array();
+                for (int zone = 0; zone < 8; zone++)
+                {
+                    writer.start_object();
+                    writer.key("X").value(static_cast<int>(rng() % 2000));
+                    writer.key("Y").value(static_cast<int>(rng() % 1000));
+                    writer.key("width").value(static_cast<int>(rng() % 800 + 100));
+                    writer.key("height").value(static_cast<int>(rng() % 800 + 100));
+                    writer.end_object();
+                }
+                writer.end_array();
+                writer.key("sensitivity-radius").value(20);
+                writer.end_object();
+            }
+            writer.end_object();
+        }
+        writer.end_array().end_object();
+        return writer.str();
+    }
+
+    std::string AppZoneHistory(std::mt19937& rng)
+    {
+        json::native::writer writer;
+        writer.start_object().key("app-zone-history").start_array();
+        for (int i = 0; i < 500; i++)
+        {
+            writer.start_object();
+            writer.key("app-path").value(L"C:\\Program Files\\App" + std::to_wstring(i) + L"\\app" + std::to_wstring(i) + L".exe");
+            writer.key("history").start_array();
+            for (int entry = 0; entry < 3; entry++)
+            {
+                writer.start_object();
+                writer.key("zone-index-set");
+                WriteIntArray(writer, { static_cast<int>(rng() % 6) });
+                writer.key("device");
+                WriteDevice(writer, rng);
+                writer.key("zoneset-uuid").value(std::string_view(Guid(rng)));
+                writer.end_object();
+            }
+            writer.end_array().end_object();
+        }
+        writer.end_array().end_object();
+        return writer.str();
+    }
+
+    std::string KeyboardManagerDefault(std::mt19937& rng)
+    {
+        const auto keys = [&](int first, int range) { return std::to_string(first) + ";" + std::to_string(65 + rng() % range); };
+
+        json::native::writer writer;
+        writer.start_object();
+        writer.key("remapKeys").start_object().key("inProcess").start_array();
+        for (int i = 0; i < 200; i++)
+        {
+            writer.start_object();
+            writer.key("originalKeys").value(std::string_view(std::to_string(8 + rng() % 247)));
+            writer.key("newRemapKeys").value(std::string_view(keys(static_cast<int>(8 + rng() % 247), 26)));
+            writer.end_object();
+        }
+        writer.end_array().end_object();
+        writer.key("remapKeysToText").start_object().key("inProcess").start_array().end_array().end_object();
+        writer.key("remapShortcuts").start_object().key("global").start_array();
+        for (int i = 0; i < 300; i++)
+        {
+            writer.start_object();
+            writer.key("originalKeys").value(std::string_view(keys(17, 26)));
+            writer.key("exactMatch").value(false);
+            writer.key("newRemapKeys").value(std::string_view(keys(18, 26)));
+            writer.key("operationType").value(0);
+            writer.end_object();
+        }
+        writer.end_array().key("appSpecific").start_array();
+        for (int i = 0; i < 200; i++)
+        {
+            writer.start_object();
+            writer.key("originalKeys").value(std::string_view(keys(91, 26)));
+            writer.key("newRemapKeys").value(std::string_view(keys(17, 26)));
+            writer.key("targetApp").value(std::string_view("msedge.exe"));
+            writer.end_object();
+        }
+        writer.end_array().end_object();
+        writer.key("remapShortcutsToText").start_object().key("global").start_array().end_array().key("appSpecific").start_array().end_array().end_object();
+        writer.end_object();
+        return writer.str();
+    }
+
+    std::vector<Fixture> GenerateFixtures()
+    {
+        std::mt19937 rng(7);
+        std::vector<Fixture> fixtures;
+        fixtures.push_back({ "applied-layouts", AppliedLayouts(rng) });
+        fixtures.push_back({ "custom-layouts", CustomLayouts(rng) });
+        fixtures.push_back({ "app-zone-history", AppZoneHistory(rng) });
+        fixtures.push_back({ "kbm default.json", KeyboardManagerDefault(rng) });
+        return fixtures;
+    }
+
+    double UsPerRun(Clock::time_point start, int runs)
+    {
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / runs;
+    }
+
+    int Fuzz(const std::vector<Fixture>& fixtures, int iterations)
+    {
+        static const char inserted[] = "{}[]\",:\\u0";
+        std::mt19937 rng(1);
+        int parsed = 0;
+        size_t sink = 0;
+        for (int i = 0; i < iterations; i++)
+        {
+            std::string text = fixtures[i % fixtures.size()].text;
+            const int mutations = 1 + rng() % 8;
+            for (int m = 0; m < mutations && !text.empty(); m++)
+            {
+                const size_t at = rng() % text.size();
+                switch (rng() % 3)
+                {
+                case 0:
+                    text[at] = static_cast<char>(rng());
+                    break;
+                case 1:
+                    text.erase(at, 1);
+                    break;
+                default:
+                    text.insert(at, 1, inserted[rng() % (sizeof(inserted) - 1)]);
+                    break;
+                }
+            }
+
+            if (const auto doc = json::native::document::parse(std::move(text)))
+            {
+                parsed++;
+                json::native::writer writer;
+                writer.value(doc->root());
+                sink += Walk(doc->root()) + writer.str().size();
+            }
+        }
+        std::printf("%d iterations, %d still parsed [%zu]\n", iterations, parsed, sink % 10);
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<Fixture> fixtures;
+    if (argc > 1 && std::string(argv[1]) == "fuzz")
+    {
+        fixtures = GenerateFixtures();
+        return Fuzz(fixtures, argc > 2 ? std::max(std::atoi(argv[2]), 1) : 40000);
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file)
+        {
+            std::printf("Cannot read %s\n", argv[i]);
+            return 1;
+        }
+        fixtures.push_back({ argv[i], std::string(std::istreambuf_iterator<char>(file), {}) });
+    }
+    if (fixtures.empty())
+    {
+        fixtures = GenerateFixtures();
+    }
+
+    constexpr int runs = 200;
+    bool mismatch = false;
+    size_t sink = 0;
+    std::printf("%-20s %10s %24s %12s %12s\n", "", "size", "parse+walk", "SAX", "write");
+    for (const auto& fixture : fixtures)
+    {
+        const auto parsed = json::native::document::parse(fixture.text);
+        if (!parsed)
+        {
+            std::printf("%-20s does not parse\n", fixture.name.c_str());
+            mismatch = true;
+            continue;
+        }
+
+        auto start = Clock::now();
+        for (int i = 0; i < runs; i++)
+        {
+            const auto doc = json::native::document::parse(fixture.text);
+            sink += Walk(doc->root());
+        }
+        const double dom = UsPerRun(start, runs);
+
+        start = Clock::now();
+        for (int i = 0; i < runs; i++)
+        {
+            std::string copy = fixture.text;
+            CountingHandler handler;
+            json::native::parse(copy.data(), copy.size(), handler);
+            sink += handler.count;
+        }
+        const double sax = UsPerRun(start, runs);
+
+        std::string written;
+        start = Clock::now();
+        for (int i = 0; i < runs; i++)
+        {
+            json::native::writer writer;
+            writer.value(parsed->root());
+            written = writer.str();
+        }
+        const double write = UsPerRun(start, runs);
+
+        const auto reparsed = json::native::document::parse(written);
+        if (!reparsed || !json::native::equal(parsed->root(), reparsed->root()))
+        {
+            mismatch = true;
+        }
+
+        std::printf("%-20s %7zu KB %9.1f us (%5.0f MB/s) %9.1f us %9.1f us\n", fixture.name.c_str(), fixture.text.size() / 1024, dom, fixture.text.size() / dom, sax, write);
+    }
+    std::printf("[%zu]\n", sink % 10);
+
+    if (mismatch)
+    {
+        std::printf("\nMISMATCH: a document did not parse or did not round-trip\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,420 @@
+// Throughput benchmark of the TwoWayPipeMessageIPC message path.
+//
+// Sends JSON-like messages of a few sizes, one at a time or in bursts, over
+// a message-mode transport and compares:
+//   - the path before the framing change: std::wstring messages copied
+//     through a mutex and condition variable queue on both sides, one
+//     UTF-16 write per message,
+//   - the current path: messages framed as UTF-8 into spsc_ring, queued
+//     frames batched into one write, and frames decoded on the reading side.
+// It checks that every message arrives, in order, with the text it was
+// sent with.
+//
+// The transport is a message-mode named pipe on Windows and a
+// SOCK_SEQPACKET socketpair elsewhere; both keep message boundaries. One
+// connection is kept open for the whole run, so the numbers are for the
+// queues, the framing and the batching, not for connecting.
+//
+// Usage: Common_PipeIpcBenchmark [messages]
+
+#include "../../src/common/interop/pipe_message_framing.h"
+#include "../../src/common/interop/spsc_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t max_batch_bytes = 64 * 1024;
+
+    // The queue TwoWayPipeMessageIPC used before the framing change
+    class AsyncMessageQueue
+    {
+    public:
+        void queue_message(std::wstring message)
+        {
+            queue_mutex.lock();
+            message_queue.push(message);
+            queue_mutex.unlock();
+            message_ready.notify_one();
+        }
+
+        std::wstring pop_message()
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            while (message_queue.empty() && !interrupted)
+            {
+                message_ready.wait(lock);
+            }
+            if (interrupted)
+            {
+                return std::wstring(L"");
+            }
+            std::wstring message = message_queue.front();
+            message_queue.pop();
+            return message;
+        }
+
+        void interrupt()
+        {
+            queue_mutex.lock();
+            interrupted = true;
+            queue_mutex.unlock();
+            message_ready.notify_all();
+        }
+
+    private:
+        std::mutex queue_mutex;
+        std::queue<std::wstring> message_queue;
+        std::condition_variable message_ready;
+        bool interrupted = false;
+    };
+
+    // One message-mode connection. write sends one message; read receives
+    // one whole message into buffer, growing it as needed.
+    class Transport
+    {
+    public:
+#ifdef _WIN32
+        Transport()
+        {
+            const std::wstring name = L"\\\\.\\pipe\\Common_PipeIpcBenchmark_" + std::to_wstring(GetCurrentProcessId()) + L"_" + std::to_wstring(counter++);
+            server = CreateNamedPipeW(name.c_str(), PIPE_ACCESS_INBOUND, PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT, 1, 4 << 20, 4 << 20, 0, nullptr);
+            client = CreateFileW(name.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+            ConnectNamedPipe(server, nullptr);
+        }
+
+        ~Transport()
+        {
+            CloseHandle(client);
+            CloseHandle(server);
+        }
+
+        void write(const void* data, size_t size)
+        {
+            DWORD written = 0;
+            WriteFile(client, data, static_cast<DWORD>(size), &written, nullptr);
+        }
+
+        bool read(std::string& buffer)
+        {
+            buffer.resize((std::max)(buffer.capacity(), size_t{ 1024 }));
+            size_t received = 0;
+            while (true)
+            {
+                DWORD bytesRead = 0;
+                const BOOL ok = ReadFile(server, buffer.data() + received, static_cast<DWORD>(buffer.size() - received), &bytesRead, nullptr);
+                received += bytesRead;
+                if (ok)
+                {
+                    break;
+                }
+                DWORD bytesLeft = 0;
+                if (GetLastError() != ERROR_MORE_DATA || !PeekNamedPipe(server, nullptr, 0, nullptr, nullptr, &bytesLeft))
+                {
+                    return false;
+                }
+                buffer.resize(received + (bytesLeft != 0 ? bytesLeft : 1024));
+            }
+            buffer.resize(received);
+            return true;
+        }
+
+        // Unblocks a pending read
+        void close_writer()
+        {
+            CloseHandle(client);
+            client = INVALID_HANDLE_VALUE;
+        }
+
+    private:
+        static inline int counter = 0;
+        HANDLE server;
+        HANDLE client;
+#else
+        Transport()
+        {
+            socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds);
+            int size = 4 << 20;
+            for (const int fd : fds)
+            {
+                setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+                setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+            }
+        }
+
+        ~Transport()
+        {
+            close(fds[0]);
+            close(fds[1]);
+        }
+
+        void write(const void* data, size_t size)
+        {
+            ::send(fds[0], data, size, 0);
+        }
+
+        bool read(std::string& buffer)
+        {
+            buffer.resize((std::max)(buffer.capacity(), size_t{ 1024 }));
+            while (true)
+            {
+                const ssize_t size = recv(fds[1], buffer.data(), buffer.size(), MSG_PEEK | MSG_TRUNC);
+                if (size <= 0)
+                {
+                    return false;
+                }
+                if (static_cast<size_t>(size) <= buffer.size())
+                {
+                    buffer.resize(recv(fds[1], buffer.data(), buffer.size(), 0));
+                    return true;
+                }
+                buffer.resize(size);
+            }
+        }
+
+        void close_writer()
+        {
+            shutdown(fds[0], SHUT_RDWR);
+        }
+
+    private:
+        int fds[2];
+#endif
+    };
+
+    std::wstring MakeMessage(size_t size, int id)
+    {
+        std::wstring message = L"{\"id\":" + std::to_wstring(id) + L",\"text\":\"\u00e9";
+        message.resize((std::max)(size, message.size() + 2) - 2, L'x');
+        return message + L"\"}";
+    }
+
+    int MessageId(std::wstring_view message)
+    {
+        return std::stoi(std::wstring(message.substr(6, 10)));
+    }
+
+    struct Result
+    {
+        double messagesPerSecond;
+        double medianLatencyUs;
+        size_t writes;
+        bool intact;
+    };
+
+    // Sends count messages in bursts of burst, each burst waiting for the
+    // one before it to arrive, then has finish stop the threads and collect
+    // the latencies.
+    template<typename Send, typename Finish>
+    Result Run(size_t size, int count, int burst, Send&& send, Finish&& finish, std::vector<Clock::time_point>& sent, std::atomic<int>& received)
+    {
+        const auto start = Clock::now();
+        for (int i = 0; i < count; i++)
+        {
+            std::wstring message = MakeMessage(size, i);
+            sent[i] = Clock::now();
+            send(message);
+            if ((i + 1) % burst == 0)
+            {
+                while (received.load() < i + 1)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        while (received.load() < count)
+        {
+            std::this_thread::yield();
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        Result result = finish();
+        result.messagesPerSecond = count / seconds;
+        return result;
+    }
+
+    double Median(std::vector<double>& values)
+    {
+        std::sort(values.begin(), values.end());
+        return values.empty() ? 0 : values[values.size() / 2];
+    }
+
+    Result RunReference(size_t size, int count, int burst)
+    {
+        Transport transport;
+        AsyncMessageQueue output;
+        AsyncMessageQueue input;
+        std::vector<Clock::time_point> sent(count);
+        std::vector<double> latencies;
+        latencies.reserve(count);
+        std::atomic<int> received = 0;
+        std::atomic<size_t> writes = 0;
+        bool intact = true;
+
+        std::thread writer([&] {
+            for (int i = 0; i < count; i++)
+            {
+                const std::wstring message = output.pop_message();
+                if (message.empty())
+                {
+                    break;
+                }
+                transport.write(message.data(), message.size() * sizeof(wchar_t));
+                writes++;
+            }
+        });
+        std::thread reader([&] {
+            std::string buffer;
+            for (int i = 0; i < count && transport.read(buffer); i++)
+            {
+                input.queue_message(std::wstring(reinterpret_cast<const wchar_t*>(buffer.data()), buffer.size() / sizeof(wchar_t)));
+            }
+        });
+        std::thread consumer([&] {
+            for (int i = 0; i < count; i++)
+            {
+                const std::wstring message = input.pop_message();
+                const int id = MessageId(message);
+                latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent[id]).count());
+                intact = intact && id == i && message == MakeMessage(size, i);
+                received++;
+            }
+        });
+
+        const auto send = [&](const std::wstring& message) {
+            output.queue_message(message);
+        };
+        const auto finish = [&] {
+            consumer.join();
+            output.interrupt();
+            writer.join();
+            reader.join();
+            return Result{ 0, Median(latencies), writes.load(), intact };
+        };
+        return Run(size, count, burst, send, finish, sent, received);
+    }
+
+    Result RunFramed(size_t size, int count, int burst)
+    {
+        Transport transport;
+        spsc_ring<std::string, 1024> output;
+        spsc_ring<std::string, 1024> input;
+        std::mutex send_mutex;
+        std::string send_buffer;
+        std::vector<Clock::time_point> sent(count);
+        std::vector<double> latencies;
+        latencies.reserve(count);
+        std::atomic<int> received = 0;
+        std::atomic<size_t> writes = 0;
+        bool intact = true;
+
+        // As consume_output_queue_thread batches
+        std::thread writer([&] {
+            std::string frame;
+            std::string next_frame;
+            std::string batch;
+            while (output.pop(frame))
+            {
+                if (frame.size() >= max_batch_bytes || !output.try_pop(next_frame))
+                {
+                    transport.write(frame.data(), frame.size());
+                    writes++;
+                    continue;
+                }
+                batch.assign(frame);
+                batch += next_frame;
+                while (batch.size() < max_batch_bytes && output.try_pop(next_frame))
+                {
+                    batch += next_frame;
+                }
+                transport.write(batch.data(), batch.size());
+                writes++;
+            }
+        });
+        std::thread reader([&] {
+            std::string payload;
+            while (transport.read(payload) && input.push(payload))
+            {
+            }
+        });
+        std::thread consumer([&] {
+            std::string payload;
+            std::wstring message;
+            int expected = 0;
+            while (received.load() < count && input.pop(payload))
+            {
+                const bool complete = pipe_message_framing::for_each_frame(payload, [&](std::string_view frame) {
+                    message.clear();
+                    utf8::append_wide(frame, message);
+                    const int id = MessageId(message);
+                    latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent[id]).count());
+                    intact = intact && id == expected && message == MakeMessage(size, expected);
+                    expected++;
+                    received++;
+                });
+                intact = intact && complete;
+            }
+        });
+
+        const auto send = [&](const std::wstring& message) {
+            std::unique_lock lock(send_mutex);
+            send_buffer.clear();
+            pipe_message_framing::append_frame(send_buffer, message);
+            output.push(send_buffer);
+        };
+        const auto finish = [&] {
+            consumer.join();
+            output.interrupt();
+            input.interrupt();
+            writer.join();
+            transport.close_writer();
+            reader.join();
+            return Result{ 0, Median(latencies), writes.load(), intact };
+        };
+        return Run(size, count, burst, send, finish, sent, received);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int messages = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 100000;
+
+    bool mismatch = false;
+    std::printf("%-8s %-6s | %-32s | %-32s\n", "size", "burst", "reference (msg/s, p50, writes)", "framed (msg/s, p50, writes)");
+    for (const size_t size : { 64, 2048, 32768 })
+    {
+        for (const int burst : { 1, 64 })
+        {
+            const int count = size > 10000 ? (std::max)(messages / 5, 1) : messages;
+            const Result reference = RunReference(size, count, burst);
+            const Result framed = RunFramed(size, count, burst);
+            mismatch = mismatch || !reference.intact || !framed.intact;
+            std::printf("%-8zu %-6d | %9.0f %8.1f us %9zu | %9.0f %8.1f us %9zu\n", size, burst, reference.messagesPerSecond, reference.medianLatencyUs, reference.writes, framed.messagesPerSecond, framed.medianLatencyUs, framed.writes);
+        }
+    }
+
+    if (mismatch)
+    {
+        std::printf("\nMISMATCH: a message was lost, reordered or changed\n");
+        return 1;
+    }
+    return 0;
+}
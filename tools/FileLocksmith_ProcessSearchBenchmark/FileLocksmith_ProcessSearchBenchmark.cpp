@@ -0,0 +1,469 @@
+// Benchmark and fuzz test of FileLocksmith's ProcessSearch.
+//
+// A synthetic handle table of a few hundred processes, each with open files
+// and loaded modules spread over a tree of folders, changes a little between
+// scans, as it does while the Locksmith window reloads. For a selection of
+// folders and files it compares:
+//   - a new ProcessSearch for every scan, as a one-off search does,
+//   - one ProcessSearch scanned again, as a SearchSession does,
+//   - a reference that checks every file against every selected path.
+// It checks that all three find the same processes and files. The synthetic
+// table answers at once, so the numbers are for matching and for the
+// snapshot, not for querying handles.
+//
+// "fuzz [iterations]" runs small random tables and selections, with names
+// that differ in case or share prefixes, through a search that is scanned
+// again after every change, and compares it with the reference each time.
+//
+// "proc <path>..." searches the processes of this machine through
+// ProcHandleSource and times a first scan and a second one. It's only built
+// on Linux:
+//   g++ -std=c++20 -O2 -pthread -I../../src/modules/FileLocksmith/FileLocksmithLibInterop
+//       FileLocksmith_ProcessSearchBenchmark.cpp
+//       ../../src/modules/FileLocksmith/FileLocksmithLibInterop/ProcHandleSource.cpp
+// The Visual Studio project builds the other modes.
+//
+// Usage: FileLocksmith_ProcessSearchBenchmark [scans] | fuzz [iterations] | proc <path>...
+
+#include <HandleSource.h>
+#include <ProcessSearch.h>
+
+#ifndef _WIN32
+#include <ProcHandleSource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwctype>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    const std::wstring drive = L"C:";
+    const std::wstring device = L"\\Device\\HarddiskVolume3";
+
+    // Processes, open files and modules that only change between scans.
+    // Paths on drive C: have kernel names, others fail to translate.
+    class SyntheticHandleSource : public HandleSource
+    {
+    public:
+        std::vector<Process> process_list;
+        std::vector<OpenFile> files;
+        std::map<std::uint32_t, std::vector<std::wstring>> loaded_modules;
+        std::set<std::wstring> directories;
+
+        wchar_t path_separator() const override
+        {
+            return L'\\';
+        }
+
+        bool case_sensitive() const override
+        {
+            return false;
+        }
+
+        std::wstring canonical_name(const std::wstring& path) override
+        {
+            return path.starts_with(drive) ? device + path.substr(drive.length()) : std::wstring{};
+        }
+
+        bool is_directory(const std::wstring& path) override
+        {
+            return directories.contains(path);
+        }
+
+        std::vector<OpenFile> open_files() override
+        {
+            return files;
+        }
+
+        std::vector<Process> processes() override
+        {
+            return process_list;
+        }
+
+        std::vector<std::wstring> modules(std::uint32_t pid) override
+        {
+            const auto found = loaded_modules.find(pid);
+            return found != loaded_modules.end() ? found->second : std::vector<std::wstring>{};
+        }
+
+        std::wstring user(std::uint32_t pid) override
+        {
+            return L"user" + std::to_wstring(pid % 3);
+        }
+    };
+
+    std::wstring Folded(std::wstring_view text)
+    {
+        std::wstring result(text);
+        for (auto& c : result)
+        {
+            c = static_cast<wchar_t>(std::towupper(c));
+        }
+        return result;
+    }
+
+    size_t Components(std::wstring_view name)
+    {
+        return std::count(name.begin(), name.end(), L'\\') + 1;
+    }
+
+    // Matches a kernel name the slow way, with the rules KernelPathMatcher
+    // documents: exact matches first, then the outermost folder.
+    std::wstring ReferenceMatch(SyntheticHandleSource& source, const std::vector<std::wstring>& paths, const std::wstring& name)
+    {
+        const auto folded_name = Folded(name);
+        std::wstring exact;
+        bool exact_is_file = false;
+        std::wstring folder;
+        std::pair<size_t, size_t> folder_rank{ SIZE_MAX, SIZE_MAX };
+        for (const auto& path : paths)
+        {
+            const auto kernel_name = source.canonical_name(path);
+            if (kernel_name.empty())
+            {
+                continue;
+            }
+
+            const bool is_directory = source.is_directory(path);
+            const auto folded = Folded(kernel_name);
+            if (folded == folded_name && (exact.empty() || !exact_is_file || !is_directory))
+            {
+                exact = path;
+                exact_is_file = !is_directory;
+            }
+
+            if (!is_directory)
+            {
+                continue;
+            }
+            const auto prefix = folded.ends_with(L'\\') ? folded.substr(0, folded.length() - 1) : folded;
+            const std::pair rank{ Components(prefix), kernel_name.length() };
+            if (folded_name.starts_with(prefix + L'\\') && rank < folder_rank)
+            {
+                folder = path + name.substr(kernel_name.length());
+                folder_rank = rank;
+            }
+        }
+        return !exact.empty() ? exact : folder;
+    }
+
+    std::vector<ProcessResult> ReferenceScan(SyntheticHandleSource& source, const std::vector<std::wstring>& paths)
+    {
+        std::map<std::uint32_t, std::set<std::wstring>> found;
+        for (const auto& file : source.files)
+        {
+            if (auto path = ReferenceMatch(source, paths, file.name); !path.empty())
+            {
+                found[file.pid].insert(std::move(path));
+            }
+        }
+        for (const auto& [pid, modules] : source.loaded_modules)
+        {
+            for (const auto& module : modules)
+            {
+                const auto name = source.canonical_name(module);
+                if (auto path = name.empty() ? std::wstring{} : ReferenceMatch(source, paths, name); !path.empty())
+                {
+                    found[pid].insert(std::move(path));
+                }
+            }
+        }
+
+        std::vector<ProcessResult> result;
+        for (const auto& process : source.process_list)
+        {
+            if (const auto files = found.find(process.pid); files != found.end())
+            {
+                result.push_back({ process.name, process.pid, source.user(process.pid), { files->second.begin(), files->second.end() } });
+            }
+        }
+        return result;
+    }
+
+    bool SameResults(const std::vector<ProcessResult>& a, const std::vector<ProcessResult>& b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const ProcessResult& x, const ProcessResult& y) {
+            return x.pid == y.pid && x.name == y.name && x.user == y.user && x.files == y.files;
+        });
+    }
+
+    // Open files and modules of a machine with a few hundred processes
+    class Machine
+    {
+    public:
+        explicit Machine(std::mt19937& random_engine) :
+            rng(random_engine)
+        {
+            for (int project = 0; project < 50; project++)
+            {
+                const auto folder = drive + L"\\Users\\User\\Source\\Project" + std::to_wstring(project);
+                source.directories.insert(folder);
+                for (int file = 0; file < 200; file++)
+                {
+                    documents.push_back(folder + L"\\src\\File" + std::to_wstring(file) + L".cpp");
+                }
+            }
+            for (int module = 0; module < 400; module++)
+            {
+                libraries.push_back(drive + L"\\Windows\\System32\\Library" + std::to_wstring(module) + L".dll");
+            }
+            for (int app = 0; app < 40; app++)
+            {
+                libraries.push_back(drive + L"\\Program Files\\App" + std::to_wstring(app) + L"\\App.dll");
+            }
+
+            for (int i = 0; i < 300; i++)
+            {
+                start_process();
+            }
+        }
+
+        // Some files close and others open, and a process starts or exits
+        void step()
+        {
+            for (auto& file : source.files)
+            {
+                if (rng() % 50 == 0)
+                {
+                    file.name = source.canonical_name(documents[rng() % documents.size()]);
+                }
+            }
+            if (rng() % 2)
+            {
+                const size_t index = rng() % source.process_list.size();
+                source.loaded_modules.erase(source.process_list[index].pid);
+                std::erase_if(source.files, [pid = source.process_list[index].pid](const auto& file) { return file.pid == pid; });
+                source.process_list.erase(source.process_list.begin() + index);
+                start_process();
+            }
+        }
+
+        SyntheticHandleSource source;
+        std::vector<std::wstring> documents;
+
+    private:
+        void start_process()
+        {
+            const auto pid = next_pid;
+            next_pid += 4;
+            source.process_list.push_back({ pid, L"process" + std::to_wstring(pid) + L".exe" });
+            for (int i = 0; i < 40; i++)
+            {
+                source.files.push_back({ pid, source.canonical_name(documents[rng() % documents.size()]) });
+            }
+            auto& modules = source.loaded_modules[pid];
+            for (int i = 0; i < 60; i++)
+            {
+                modules.push_back(libraries[rng() % (i < 50 ? 100 : libraries.size())]);
+            }
+        }
+
+        std::mt19937& rng;
+        std::vector<std::wstring> libraries;
+        std::uint32_t next_pid = 1000;
+    };
+
+    int Benchmark(int scans)
+    {
+        std::mt19937 rng(1);
+        Machine machine(rng);
+        const std::vector<std::wstring> paths{
+            drive + L"\\Users\\User\\Source\\Project3",
+            drive + L"\\Users\\User\\Source\\Project17",
+            drive + L"\\Program Files\\App5",
+            machine.documents[4321],
+            machine.documents[9876],
+        };
+
+        double one_off_ms = 0;
+        double session_ms = 0;
+        double reference_ms = 0;
+        size_t found = 0;
+        bool mismatch = false;
+        ProcessSearch session(machine.source, paths);
+        for (int scan = 0; scan < scans; scan++)
+        {
+            machine.step();
+
+            auto start = Clock::now();
+            const auto one_off = ProcessSearch(machine.source, paths).scan();
+            one_off_ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            start = Clock::now();
+            const auto rescanned = session.scan();
+            session_ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            start = Clock::now();
+            const auto reference = ReferenceScan(machine.source, paths);
+            reference_ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            found += reference.size();
+            mismatch = mismatch || !SameResults(one_off, reference) || !SameResults(rescanned, reference);
+        }
+
+        std::printf("%zu processes, %zu open files, %d scans, %.1f processes found per scan\n\n", machine.source.process_list.size(), machine.source.files.size(), scans, static_cast<double>(found) / scans);
+        std::printf("%-28s %8.2f ms/scan\n", "new ProcessSearch per scan", one_off_ms / scans);
+        std::printf("%-28s %8.2f ms/scan\n", "ProcessSearch scanned again", session_ms / scans);
+        std::printf("%-28s %8.2f ms/scan\n", "reference", reference_ms / scans);
+
+        if (mismatch)
+        {
+            std::printf("\nMISMATCH: a search found other processes or files than the reference\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    std::wstring RandomPath(std::mt19937& rng)
+    {
+        static const wchar_t* const components[] = { L"a", L"A", L"ab", L"aB", L"b", L"" };
+        std::wstring path = rng() % 8 ? drive : std::wstring{ L"D:" };
+        for (size_t i = 0, count = 1 + rng() % 3; i < count; i++)
+        {
+            path += L'\\';
+            path += components[rng() % std::size(components)];
+        }
+        return path;
+    }
+
+    int Fuzz(int iterations)
+    {
+        std::mt19937 rng(7);
+        int mismatches = 0;
+        for (int iteration = 0; iteration < iterations; iteration++)
+        {
+            SyntheticHandleSource source;
+
+            // Kernel names equal but for case name the same file, so the
+            // selection keeps one of them
+            std::vector<std::wstring> paths;
+            std::set<std::wstring> folded_paths;
+            for (size_t i = 0, count = 1 + rng() % 4; i < count; i++)
+            {
+                auto path = RandomPath(rng) + (rng() % 6 ? L"" : L"\\");
+                if (folded_paths.insert(Folded(path)).second)
+                {
+                    if (rng() % 2)
+                    {
+                        source.directories.insert(path);
+                    }
+                    paths.push_back(std::move(path));
+                }
+            }
+
+            const auto random_name = [&] {
+                auto name = source.canonical_name(RandomPath(rng));
+                return name.empty() ? L"\\Device\\Other\\a" : name;
+            };
+
+            ProcessSearch search(source, paths);
+            std::uint32_t next_pid = 4;
+            for (int step = 0; step < 8; step++)
+            {
+                if (source.process_list.empty() || rng() % 3 == 0)
+                {
+                    source.process_list.push_back({ next_pid, L"p" + std::to_wstring(next_pid) });
+                    next_pid += 4;
+                }
+                if (source.process_list.size() > 1 && rng() % 4 == 0)
+                {
+                    const auto pid = source.process_list.front().pid;
+                    source.process_list.erase(source.process_list.begin());
+                    source.loaded_modules.erase(pid);
+                    std::erase_if(source.files, [pid](const auto& file) { return file.pid == pid; });
+                }
+
+                for (size_t i = 0, count = rng() % 4; i < count; i++)
+                {
+                    const auto pid = source.process_list[rng() % source.process_list.size()].pid;
+                    switch (rng() % 4)
+                    {
+                    case 0:
+                        source.files.push_back({ pid, random_name() });
+                        break;
+                    case 1:
+                        if (!source.files.empty())
+                        {
+                            source.files.erase(source.files.begin() + rng() % source.files.size());
+                        }
+                        break;
+                    case 2:
+                        source.loaded_modules[pid].push_back(RandomPath(rng));
+                        break;
+                    default:
+                        source.loaded_modules[pid].clear();
+                        break;
+                    }
+                }
+
+                if (!SameResults(search.scan(), ReferenceScan(source, paths)) && mismatches++ < 5)
+                {
+                    std::printf("mismatch at iteration %d, step %d\n", iteration, step);
+                }
+            }
+        }
+
+        std::printf("%d iterations, %d mismatches\n", iterations, mismatches);
+        if (mismatches != 0)
+        {
+            std::printf("\nMISMATCH: the search and the reference disagree\n");
+            return 1;
+        }
+        return 0;
+    }
+
+#ifndef _WIN32
+    int ScanThisMachine(int argc, char* argv[])
+    {
+        std::vector<std::wstring> paths;
+        for (int i = 2; i < argc; i++)
+        {
+            paths.emplace_back(argv[i], argv[i] + std::strlen(argv[i]));
+        }
+
+        ProcHandleSource source;
+        auto start = Clock::now();
+        ProcessSearch search(source, paths);
+        const auto first = search.scan();
+        const double first_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        start = Clock::now();
+        const auto second = search.scan();
+        const double second_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        for (const auto& process : second)
+        {
+            std::printf("%u %ls (%ls): %zu files\n", process.pid, process.name.c_str(), process.user.c_str(), process.files.size());
+        }
+        std::printf("\n%-12s %8.1f ms, %zu processes\n", "first scan", first_ms, first.size());
+        std::printf("%-12s %8.1f ms, %zu processes\n", "second scan", second_ms, second.size());
+        return 0;
+    }
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && std::strcmp(argv[1], "fuzz") == 0)
+    {
+        return Fuzz(argc > 2 ? std::max(std::atoi(argv[2]), 1) : 20000);
+    }
+#ifndef _WIN32
+    if (argc > 2 && std::strcmp(argv[1], "proc") == 0)
+    {
+        return ScanThisMachine(argc, argv);
+    }
+#endif
+    return Benchmark(argc > 1 ? std::max(std::atoi(argv[1]), 1) : 50);
+}
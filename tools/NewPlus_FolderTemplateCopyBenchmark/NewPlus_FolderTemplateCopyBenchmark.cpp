@@ -0,0 +1,277 @@
+// Benchmark of how New+ finishes copying a folder template.
+//
+// Copies a template tree with variables in the names of its folders and files
+// at every level, and compares what follows the copy:
+//   - the passes before helpers::copy::resolve_copied_folder: rename depth
+//     first, checking the disk for every resolved name, then walk the tree
+//     again to set the last write times,
+//   - resolve_copied_folder, which does both in one pass, on several threads.
+// The shell's copy (SHFileOperation) is stood in for by std::filesystem::copy
+// and is timed on its own. It first compares resolve_copied_folder on random
+// small trees, where resolved names collide with each other and with names
+// not renamed yet, against the same renaming done top down on one thread,
+// checking the disk as the old passes did.
+//
+// helpers_copy.h only uses std, so it builds anywhere:
+//   g++ -std=c++20 -O2 -pthread -I../../src/modules/NewPlus/NewShellExtensionContextMenu
+//       NewPlus_FolderTemplateCopyBenchmark.cpp
+//
+// Usage: NewPlus_FolderTemplateCopyBenchmark [runs]
+
+#include <helpers_copy.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    const std::wstring parent_variable = L"$PARENT_FOLDER_NAME";
+
+    std::wstring ResolveName(const std::filesystem::path& entry, const std::wstring& parent_name)
+    {
+        std::wstring name = entry.filename().wstring();
+        if (name == L"desktop.ini")
+        {
+            return name;
+        }
+
+        for (size_t position = 0; (position = name.find(parent_variable, position)) != std::wstring::npos; position += parent_name.size())
+        {
+            name.replace(position, parent_variable.size(), parent_name);
+        }
+        return name;
+    }
+
+    // As helpers::filesystem::make_unique_path_name
+    std::filesystem::path MakeUniquePathName(const std::filesystem::path& path)
+    {
+        std::filesystem::path unique_path = path;
+        for (int counter = 1; std::filesystem::exists(unique_path); counter++)
+        {
+            std::wstring name = path.stem().wstring() + L" (" + std::to_wstring(counter) + L")";
+            if (path.has_extension())
+            {
+                name += path.extension().wstring();
+            }
+            unique_path = path.parent_path() / name;
+        }
+        return unique_path;
+    }
+
+    // The rename pass before resolve_copied_folder: leaves first, so a folder's
+    // entries see its name before it is resolved
+    void RenameDepthFirst(const std::filesystem::path& folder)
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(folder))
+        {
+            if (entry.is_directory())
+            {
+                RenameDepthFirst(entry.path());
+            }
+        }
+
+        std::vector<std::filesystem::path> entries(std::filesystem::directory_iterator(folder), {});
+        for (const auto& entry : entries)
+        {
+            const std::wstring resolved_name = ResolveName(entry, folder.filename().wstring());
+            if (resolved_name != entry.filename().wstring())
+            {
+                std::filesystem::rename(entry, MakeUniquePathName(folder / resolved_name));
+            }
+        }
+    }
+
+    // The touch pass before resolve_copied_folder, as utilities::update_last_write_time
+    void UpdateLastWriteTime(const std::filesystem::path& folder, const std::filesystem::file_time_type write_time)
+    {
+        std::filesystem::last_write_time(folder, write_time);
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(folder))
+        {
+            std::filesystem::last_write_time(entry.path(), write_time);
+        }
+    }
+
+    // What resolve_copied_folder should do, on one thread
+    void ReferenceResolve(const std::filesystem::path& folder, const std::filesystem::file_time_type write_time)
+    {
+        std::vector<std::filesystem::path> entries(std::filesystem::directory_iterator(folder), {});
+        std::sort(entries.begin(), entries.end());
+        for (auto entry : entries)
+        {
+            const std::wstring resolved_name = ResolveName(entry, folder.filename().wstring());
+            if (resolved_name != entry.filename().wstring())
+            {
+                const auto renamed = MakeUniquePathName(folder / resolved_name);
+                std::filesystem::rename(entry, renamed);
+                entry = renamed;
+            }
+            if (std::filesystem::is_directory(entry))
+            {
+                ReferenceResolve(entry, write_time);
+            }
+            else
+            {
+                std::filesystem::last_write_time(entry, write_time);
+            }
+        }
+        std::filesystem::last_write_time(folder, write_time);
+    }
+
+    // The relative paths of the entries of a tree, and whether all of them have write_time
+    std::vector<std::filesystem::path> ListTree(const std::filesystem::path& folder, const std::filesystem::file_time_type write_time, bool& times_match)
+    {
+        times_match = std::filesystem::last_write_time(folder) == write_time;
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(folder))
+        {
+            paths.push_back(std::filesystem::relative(entry.path(), folder));
+            times_match = times_match && entry.last_write_time() == write_time;
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    void WriteFile(const std::filesystem::path& path, size_t size)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << std::string(size, 'x');
+    }
+
+    // Returns the number of trees that differ
+    int CompareOnRandomTrees(const std::filesystem::path& base, std::mt19937& rng)
+    {
+        const wchar_t* const names[] = { L"a", L"b", L"a (1)", L"b (1)", L"$PARENT_FOLDER_NAME", L"$PARENT_FOLDER_NAME (1)", L"x$PARENT_FOLDER_NAME", L"desktop.ini" };
+        const wchar_t* const extensions[] = { L"", L".txt" };
+
+        const auto make_tree = [&](const auto& self, const std::filesystem::path& folder, int depth) -> void {
+            std::filesystem::create_directories(folder);
+            for (size_t i = 0, count = rng() % 6; i < count; i++)
+            {
+                const auto path = folder / (std::wstring(names[rng() % std::size(names)]) + extensions[rng() % std::size(extensions)]);
+                if (std::filesystem::exists(path))
+                {
+                    continue;
+                }
+                if (depth > 0 && rng() % 3 == 0)
+                {
+                    self(self, path, depth - 1);
+                }
+                else
+                {
+                    WriteFile(path, 1);
+                }
+            }
+        };
+
+        int mismatches = 0;
+        const auto write_time = std::filesystem::file_time_type::clock::now() - std::chrono::hours(5);
+        for (int i = 0; i < 500; i++)
+        {
+            std::filesystem::remove_all(base);
+            make_tree(make_tree, base / "source", 3);
+            // Both copies are named "a", which their entries resolve to
+            const auto copy = base / "copy" / "a";
+            const auto reference = base / "reference" / "a";
+            std::filesystem::create_directories(copy.parent_path());
+            std::filesystem::create_directories(reference.parent_path());
+            std::filesystem::copy(base / "source", copy, std::filesystem::copy_options::recursive);
+            std::filesystem::copy(base / "source", reference, std::filesystem::copy_options::recursive);
+
+            newplus::helpers::copy::resolve_copied_folder(copy, ResolveName, write_time);
+            ReferenceResolve(reference, write_time);
+
+            bool times_match_copy = false;
+            bool times_match_reference = false;
+            if (ListTree(copy, write_time, times_match_copy) != ListTree(reference, write_time, times_match_reference) || !times_match_copy || !times_match_reference)
+            {
+                mismatches++;
+            }
+        }
+        return mismatches;
+    }
+
+    size_t MakeTemplate(const std::filesystem::path& folder, int depth)
+    {
+        std::filesystem::create_directories(folder);
+        size_t entries = 0;
+        for (int i = 0; i < 12; i++)
+        {
+            WriteFile(folder / ("File " + std::to_string(i) + " $PARENT_FOLDER_NAME.txt"), 512);
+            entries++;
+        }
+        if (depth > 0)
+        {
+            for (int i = 0; i < 6; i++)
+            {
+                entries += 1 + MakeTemplate(folder / ("Folder " + std::to_string(i) + " $PARENT_FOLDER_NAME"), depth - 1);
+            }
+        }
+        return entries;
+    }
+
+    double Milliseconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int runs = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 5;
+    const auto base = std::filesystem::temp_directory_path() / "NewPlus_FolderTemplateCopyBenchmark";
+    std::mt19937 rng(7);
+
+    const int mismatches = CompareOnRandomTrees(base, rng);
+
+    std::filesystem::remove_all(base);
+    const size_t entries = MakeTemplate(base / "template", 3);
+
+    Clock::duration copy{};
+    Clock::duration passes{};
+    Clock::duration one_pass{};
+    bool entry_counts_match = true;
+    for (int run = 0; run < runs; run++)
+    {
+        const auto before = base / ("before" + std::to_string(run));
+        const auto after = base / ("after" + std::to_string(run));
+
+        auto start = Clock::now();
+        std::filesystem::copy(base / "template", before, std::filesystem::copy_options::recursive);
+        copy += Clock::now() - start;
+        std::filesystem::copy(base / "template", after, std::filesystem::copy_options::recursive);
+
+        start = Clock::now();
+        RenameDepthFirst(before);
+        UpdateLastWriteTime(before, std::filesystem::file_time_type::clock::now());
+        passes += Clock::now() - start;
+
+        start = Clock::now();
+        newplus::helpers::copy::resolve_copied_folder(after, ResolveName, std::filesystem::file_time_type::clock::now());
+        one_pass += Clock::now() - start;
+
+        bool unused = false;
+        entry_counts_match = entry_counts_match && ListTree(before, {}, unused).size() == entries && ListTree(after, {}, unused).size() == entries;
+    }
+    std::filesystem::remove_all(base);
+
+    std::printf("%zu entries, %d runs\n\n", entries, runs);
+    std::printf("%-36s %10.1f ms\n", "copy", Milliseconds(copy) / runs);
+    std::printf("%-36s %10.1f ms\n", "rename, then set write times", Milliseconds(passes) / runs);
+    std::printf("%-36s %10.1f ms\n", "resolve_copied_folder", Milliseconds(one_pass) / runs);
+
+    if (mismatches != 0 || !entry_counts_match)
+    {
+        std::printf("\nMISMATCH: %d random trees, and the benchmark entry counts %s\n", mismatches, entry_counts_match ? "match" : "differ");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Stands in for the change notification calls template_index makes, with
+// inotify, so the benchmark can run where there is no Windows.h.
+#pragma once
+#include <filesystem>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+typedef void* HANDLE;
+typedef int BOOL;
+typedef unsigned long DWORD;
+typedef const wchar_t* LPCWSTR;
+
+#define FALSE 0
+#define TRUE 1
+#define INVALID_HANDLE_VALUE (reinterpret_cast<HANDLE>(-1))
+#define WAIT_OBJECT_0 0
+#define WAIT_TIMEOUT 258
+
+#define FILE_NOTIFY_CHANGE_FILE_NAME 0x1
+#define FILE_NOTIFY_CHANGE_DIR_NAME 0x2
+#define FILE_NOTIFY_CHANGE_ATTRIBUTES 0x4
+#define FILE_NOTIFY_CHANGE_LAST_WRITE 0x10
+
+namespace posix_change_notification
+{
+    inline int fd(HANDLE handle)
+    {
+        return static_cast<int>(reinterpret_cast<intptr_t>(handle)) - 1;
+    }
+}
+
+inline HANDLE FindFirstChangeNotificationW(LPCWSTR path, BOOL, DWORD)
+{
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        return INVALID_HANDLE_VALUE;
+    }
+    if (inotify_add_watch(fd, std::filesystem::path(path).c_str(), IN_CREATE | IN_DELETE | IN_MOVE | IN_ATTRIB | IN_MODIFY | IN_CLOSE_WRITE) < 0)
+    {
+        close(fd);
+        return INVALID_HANDLE_VALUE;
+    }
+    return reinterpret_cast<HANDLE>(static_cast<intptr_t>(fd) + 1);
+}
+
+inline DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds)
+{
+    pollfd poll_fd{ posix_change_notification::fd(handle), POLLIN, 0 };
+    return poll(&poll_fd, 1, static_cast<int>(milliseconds)) > 0 ? WAIT_OBJECT_0 : WAIT_TIMEOUT;
+}
+
+inline BOOL FindNextChangeNotification(HANDLE handle)
+{
+    char buffer[4096];
+    while (read(posix_change_notification::fd(handle), buffer, sizeof(buffer)) > 0)
+    {
+    }
+    return TRUE;
+}
+
+inline BOOL FindCloseChangeNotification(HANDLE handle)
+{
+    return close(posix_change_notification::fd(handle)) == 0;
+}
@@ -0,0 +1,20 @@
+// Stands in for SHGetFileInfo, which resolves no icon here.
+#pragma once
+#include <cstdint>
+
+#define MAX_PATH 260
+#define SHGFI_ICONLOCATION 0x1000
+
+struct SHFILEINFOW
+{
+    void* hIcon;
+    int iIcon;
+    unsigned long dwAttributes;
+    wchar_t szDisplayName[MAX_PATH];
+    wchar_t szTypeName[80];
+};
+
+inline uintptr_t SHGetFileInfoW(const wchar_t*, unsigned long, SHFILEINFOW*, unsigned int, unsigned int)
+{
+    return 0;
+}
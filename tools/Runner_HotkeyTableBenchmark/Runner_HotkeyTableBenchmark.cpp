@@ -0,0 +1,183 @@
+// Benchmark of the runner's keyboard hook hotkey lookup.
+//
+// Replays a stream of synthetic keystrokes against 40 registered hotkeys
+// and compares:
+//   - the lookup the hook did before HotkeyTable: read the modifier state,
+//     find the hotkey in a std::multiset under a mutex and copy its action,
+//   - HotkeyTable: skip keys that are in no hotkey, otherwise read the
+//     modifier state and index the slot array.
+// It checks that both pick the same action for every keystroke.
+//
+// Usage: Runner_HotkeyTableBenchmark [keystrokes]
+
+#include "../../src/runner/hotkey_table.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <set>
+
+using namespace CentralizedKeyboardHook;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Modifiers held for the keystroke being replayed. GetAsyncKeyState is
+    // still called, so that its cost is measured where the hook pays it.
+    Hotkey heldModifiers;
+
+    Hotkey ReadHotkey(unsigned char key)
+    {
+        const bool win = (GetAsyncKeyState(VK_LWIN) & 0x8000) || (GetAsyncKeyState(VK_RWIN) & 0x8000);
+        const bool ctrl = GetAsyncKeyState(VK_CONTROL) & 0x8000;
+        const bool shift = GetAsyncKeyState(VK_SHIFT) & 0x8000;
+        const bool alt = GetAsyncKeyState(VK_MENU) & 0x8000;
+        return Hotkey{
+            .win = win || heldModifiers.win,
+            .ctrl = ctrl || heldModifiers.ctrl,
+            .shift = shift || heldModifiers.shift,
+            .alt = alt || heldModifiers.alt,
+            .key = key
+        };
+    }
+
+    // The registrations as the hook kept them before HotkeyTable
+    struct OrderedHotkeyDescriptor
+    {
+        HotkeyDescriptor descriptor;
+
+        bool operator<(const OrderedHotkeyDescriptor& other) const
+        {
+            return descriptor.hotkey < other.descriptor.hotkey;
+        }
+    };
+
+    struct Keystroke
+    {
+        Hotkey modifiers;
+        unsigned char key;
+    };
+
+    double NsPerKeystroke(Clock::time_point start, size_t count)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 1000000;
+    std::mt19937 rng(7);
+
+    // 40 hotkeys with at least one modifier, as modules register them
+    std::vector<HotkeyDescriptor> descriptors;
+    for (int i = 0; i < 40; i++)
+    {
+        Hotkey hotkey{
+            .win = rng() % 2 == 0,
+            .ctrl = rng() % 2 == 0,
+            .shift = rng() % 3 == 0,
+            .alt = rng() % 3 == 0,
+            .key = static_cast<unsigned char>('A' + rng() % 26)
+        };
+        if (!hotkey.win && !hotkey.ctrl && !hotkey.shift && !hotkey.alt)
+        {
+            hotkey.ctrl = true;
+        }
+        descriptors.push_back({ hotkey, L"Module" + std::to_wstring(i % 12), [i] { return i % 2 == 0; } });
+    }
+
+    std::multiset<OrderedHotkeyDescriptor> ordered;
+    for (const auto& descriptor : descriptors)
+    {
+        ordered.insert({ descriptor });
+    }
+    std::mutex mutex;
+    const HotkeyTable table(descriptors, {});
+
+    // Typing: 3% of the keystrokes have modifiers held, and a third of
+    // those are registered hotkeys
+    std::vector<Keystroke> keystrokes(count);
+    for (auto& keystroke : keystrokes)
+    {
+        if (rng() % 100 < 3)
+        {
+            if (rng() % 3 == 0)
+            {
+                const auto& hotkey = descriptors[rng() % descriptors.size()].hotkey;
+                keystroke = { Hotkey{ .win = hotkey.win, .ctrl = hotkey.ctrl, .shift = hotkey.shift, .alt = hotkey.alt }, hotkey.key };
+            }
+            else
+            {
+                keystroke = { Hotkey{ .ctrl = true, .shift = rng() % 2 == 0 }, static_cast<unsigned char>('0' + rng() % 40) };
+            }
+        }
+        else
+        {
+            keystroke = { Hotkey{}, static_cast<unsigned char>(rng() % 2 ? 'A' + rng() % 26 : 0x20 + rng() % 16) };
+        }
+    }
+
+    std::vector<const void*> multisetActions(count, nullptr);
+    auto start = Clock::now();
+    for (size_t i = 0; i < count; i++)
+    {
+        heldModifiers = keystrokes[i].modifiers;
+        const Hotkey hotkey = ReadHotkey(keystrokes[i].key);
+        if (hotkey == Hotkey{})
+        {
+            continue;
+        }
+
+        std::function<bool()> action;
+        {
+            std::unique_lock lock{ mutex };
+            const auto it = ordered.find({ HotkeyDescriptor{ .hotkey = hotkey } });
+            if (it != ordered.end())
+            {
+                action = it->descriptor.action;
+                multisetActions[i] = &it->descriptor;
+            }
+        }
+    }
+    const double multisetNs = NsPerKeystroke(start, count);
+
+    std::vector<const void*> tableActions(count, nullptr);
+    start = Clock::now();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!table.IsHotkeyKey(keystrokes[i].key))
+        {
+            continue;
+        }
+
+        heldModifiers = keystrokes[i].modifiers;
+        const Hotkey hotkey = ReadHotkey(keystrokes[i].key);
+        if (hotkey == Hotkey{})
+        {
+            continue;
+        }
+        tableActions[i] = table.Find(hotkey);
+    }
+    const double tableNs = NsPerKeystroke(start, count);
+
+    // Same action: the first registration of the hotkey in both
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto* multiset = static_cast<const HotkeyDescriptor*>(multisetActions[i]);
+        const auto* indexed = static_cast<const HotkeyDescriptor*>(tableActions[i]);
+        if ((multiset == nullptr) != (indexed == nullptr) || (multiset && !(multiset->hotkey == indexed->hotkey && multiset->moduleName == indexed->moduleName)))
+        {
+            std::printf("MISMATCH at keystroke %zu\n", i);
+            return 1;
+        }
+    }
+
+    std::printf("%zu keystrokes, %zu hotkeys\n\n", count, descriptors.size());
+    std::printf("multiset      %8.1f ns per keystroke\n", multisetNs);
+    std::printf("HotkeyTable   %8.1f ns per keystroke\n", tableNs);
+    return 0;
+}
@@ -0,0 +1,236 @@
+// Benchmark of Workspaces' AppIndex.
+//
+// Looks up process paths in an installed apps list of a given size, half of
+// them apps of the list and half of them found by none of the passes, and
+// compares:
+//   - the passes GetApp made over the apps list before AppIndex, which
+//     uppercase every install path and name on every lookup,
+//   - the same passes through AppIndex, built once for the list.
+// It reports the time to build the index, and first compares both on random
+// short lists and paths, where install paths contain each other, share file
+// names and are missing, to check that both pick the same app in the same
+// pass.
+//
+// The Visual Studio project links WorkspacesLib. Elsewhere it builds with
+// posix/, which stands in for the Windows headers and for AppUtils.h:
+//   g++ -std=c++23 -O2 -Iposix -I../../src/modules/Workspaces -I../../src
+//       Workspaces_AppIndexBenchmark.cpp
+//       ../../src/modules/Workspaces/WorkspacesLib/AppIndex.cpp
+//
+// Usage: Workspaces_AppIndexBenchmark [apps]
+
+#include <WorkspacesLib/AppIndex.h>
+
+#include <algorithm>
+#include <chrono>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cwctype>
+#include <filesystem>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Utils::Apps;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    const std::wstring separator(1, std::filesystem::path::preferred_separator);
+
+    std::wstring ToUpper(std::wstring value)
+    {
+        std::transform(value.begin(), value.end(), value.begin(), towupper);
+        return value;
+    }
+
+    // Which pass found the app, and the app's position in the list
+    struct Found
+    {
+        int pass = 0;
+        size_t app = 0;
+
+        bool operator==(const Found&) const = default;
+    };
+
+    // The passes of GetApp before AppIndex
+    Found ReferenceLookup(const std::wstring& appPath, const std::wstring& parentDirUpper, const AppList& apps)
+    {
+        const auto appPathUpper = ToUpper(appPath);
+        std::optional<size_t> planB;
+        for (size_t i = 0; i < apps.size(); i++)
+        {
+            if (apps[i].installPath.empty())
+            {
+                continue;
+            }
+            if (appPathUpper.contains(ToUpper(apps[i].installPath)))
+            {
+                return { 1, i };
+            }
+            if (std::filesystem::path(appPath).filename() == std::filesystem::path(apps[i].installPath).filename())
+            {
+                planB = i;
+            }
+        }
+        if (planB)
+        {
+            return { 2, *planB };
+        }
+
+        const auto exeNameUpper = ToUpper(std::filesystem::path(appPath).stem().wstring());
+        for (size_t i = 0; i < apps.size(); i++)
+        {
+            if (ToUpper(apps[i].name) == exeNameUpper)
+            {
+                return { 3, i };
+            }
+        }
+
+        for (size_t i = 0; i < apps.size(); i++)
+        {
+            if (!apps[i].installPath.empty() && ToUpper(std::filesystem::path(apps[i].installPath).parent_path().wstring()) == parentDirUpper)
+            {
+                return { 4, i };
+            }
+        }
+        return {};
+    }
+
+    // The same passes as GetApp makes them now
+    Found IndexLookup(const std::wstring& appPath, const std::wstring& parentDirUpper, const AppIndex& index)
+    {
+        const AppData* first = index.Apps().data();
+        if (const auto appData = index.FindInstallPathIn(ToUpper(appPath)))
+        {
+            return { 1, static_cast<size_t>(appData - first) };
+        }
+        if (const auto appData = index.FindLastByFilename(std::filesystem::path(appPath).filename().wstring()))
+        {
+            return { 2, static_cast<size_t>(appData - first) };
+        }
+        if (const auto appData = index.FindByName(ToUpper(std::filesystem::path(appPath).stem().wstring())))
+        {
+            return { 3, static_cast<size_t>(appData - first) };
+        }
+        if (const auto appData = index.FindByInstallFolder(parentDirUpper))
+        {
+            return { 4, static_cast<size_t>(appData - first) };
+        }
+        return {};
+    }
+
+    // Returns the number of lookups that differ
+    int CompareOnRandomLists(std::mt19937& rng)
+    {
+        const wchar_t* const parts[] = { L"a", L"B", L"ab", L"Ba", L"c.exe", L"A.EXE", L"x", L"y.Exe", L"Y" };
+        const auto randomPath = [&](size_t components) {
+            std::wstring path;
+            for (size_t i = 0; i < components; i++)
+            {
+                if (rng() % 3)
+                {
+                    path += separator;
+                }
+                path += parts[rng() % std::size(parts)];
+            }
+            return path;
+        };
+
+        int mismatches = 0;
+        for (int i = 0; i < 20000; i++)
+        {
+            AppList apps;
+            for (size_t app = 0, count = 1 + rng() % 8; app < count; app++)
+            {
+                apps.push_back({ .name = rng() % 2 ? parts[rng() % std::size(parts)] : randomPath(1), .installPath = rng() % 5 ? randomPath(1 + rng() % 4) : L"" });
+            }
+
+            const AppIndex index(apps);
+            for (int j = 0; j < 10; j++)
+            {
+                const auto path = randomPath(1 + rng() % 6);
+                const auto parentDirUpper = ToUpper(randomPath(1 + rng() % 3));
+                if (!(ReferenceLookup(path, parentDirUpper, apps) == IndexLookup(path, parentDirUpper, index)))
+                {
+                    mismatches++;
+                }
+            }
+        }
+        return mismatches;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::setlocale(LC_ALL, "");
+    const size_t appCount = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 1000;
+    std::mt19937 rng(7);
+
+    const int mismatches = CompareOnRandomLists(rng);
+
+    const std::wstring programFiles = L"C:" + separator + L"Program Files" + separator;
+    AppList apps;
+    for (size_t i = 0; i < appCount; i++)
+    {
+        const auto folder = programFiles + L"Vendor" + std::to_wstring(i % 50) + separator + L"App" + std::to_wstring(i);
+        apps.push_back({ .name = L"App Name " + std::to_wstring(i), .installPath = i % 3 ? folder + separator + L"app" + std::to_wstring(i) + L".exe" : folder });
+    }
+
+    std::vector<std::wstring> paths;
+    for (size_t i = 0; i < 200; i++)
+    {
+        const auto& installPath = apps[i * 5 % appCount].installPath;
+        if (i % 2 == 0)
+        {
+            paths.push_back(L"C:" + separator + L"Users" + separator + L"User" + separator + L"Tool" + std::to_wstring(i) + L".exe");
+        }
+        else
+        {
+            paths.push_back(installPath.ends_with(L".exe") ? installPath : installPath + separator + L"bin" + separator + L"tool.exe");
+        }
+    }
+    const std::wstring parentDirUpper = L"C:" + separator + L"NOT AN INSTALL FOLDER";
+
+    constexpr int rounds = 5;
+    std::vector<Found> referenceResults;
+    auto start = Clock::now();
+    for (int round = 0; round < rounds; round++)
+    {
+        for (const auto& path : paths)
+        {
+            referenceResults.push_back(ReferenceLookup(path, parentDirUpper, apps));
+        }
+    }
+    const double referenceUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / (rounds * paths.size());
+
+    start = Clock::now();
+    const AppIndex index(apps);
+    const double buildUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    std::vector<Found> indexResults;
+    start = Clock::now();
+    for (int round = 0; round < rounds; round++)
+    {
+        for (const auto& path : paths)
+        {
+            indexResults.push_back(IndexLookup(path, parentDirUpper, index));
+        }
+    }
+    const double indexUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / (rounds * paths.size());
+
+    std::printf("%zu apps, %zu paths, half of them not in the list\n\n", apps.size(), paths.size());
+    std::printf("%-16s %10.2f us/lookup\n", "apps list", referenceUs);
+    std::printf("%-16s %10.2f us/lookup\n", "AppIndex", indexUs);
+    std::printf("%-16s %10.0f us\n", "AppIndex build", buildUs);
+
+    if (mismatches != 0 || referenceResults != indexResults)
+    {
+        std::printf("\nMISMATCH: %d random lookups, and the benchmark lookups %s\n", mismatches, referenceResults == indexResults ? "match" : "differ");
+        return 1;
+    }
+    return 0;
+}
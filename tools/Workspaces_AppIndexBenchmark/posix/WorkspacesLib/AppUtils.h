@@ -0,0 +1,24 @@
+// Stands in for AppUtils.h, which needs Windows: only the apps list that
+// AppIndex is built from.
+#pragma once
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+    namespace Apps
+    {
+        struct AppData
+        {
+            std::wstring name;
+            std::wstring installPath;
+            std::wstring packageFullName;
+            std::wstring appUserModelId;
+            std::wstring pwaAppId;
+            std::wstring protocolPath;
+            bool canLaunchElevated = false;
+        };
+
+        using AppList = std::vector<AppData>;
+    }
+}
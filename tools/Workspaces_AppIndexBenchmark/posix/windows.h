@@ -0,0 +1,3 @@
+// Stands in for the Windows headers WorkspacesLib's pch.h includes, so the
+// benchmark can build AppIndex.cpp where there are none.
+#pragma once
@@ -0,0 +1,180 @@
+// Headless benchmark of ZoomIt's DemoType script parser.
+//
+// Builds a synthetic script of source code with [end], [pause:n] and
+// [enter] keywords, and compares:
+//   - the cleanup and keyword parsing DemoType did before the command
+//     table: repeated find/erase passes per keyword, then a substring
+//     compare at every '[' while typing,
+//   - DecodeDemoTypeScript, CleanDemoTypeScript and CompileDemoTypeScript
+//     at load time, then a FindDemoTypeCommand lookup at every '['.
+// It checks that both cleanups produce the same text.
+//
+// Usage: ZoomIt_DemoTypeBenchmark [lines]
+
+#include "../../src/modules/ZoomIt/ZoomIt/DemoTypeScript.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cwctype>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t MaxControlLength = 32;
+    constexpr size_t EndControlLength = 5;
+
+    std::string MakeScript(int lines)
+    {
+        std::string script;
+        for (int i = 0; i < lines; i++)
+        {
+            script += "    int value" + std::to_string(i) + " = Compute(x[" + std::to_string(i % 7) + "], y); // comment\n";
+            if (i % 100 == 99)
+            {
+                script += "[end]\n";
+            }
+            if (i % 37 == 0)
+            {
+                script += "[pause:1]";
+            }
+            if (i % 53 == 0)
+            {
+                script += "[enter]";
+            }
+        }
+        return script;
+    }
+
+    // The cleanup as DemoType did it before CleanDemoTypeScript
+    void TrimNewlineAroundControl(std::wstring& text, const std::wstring& control, bool trimLeft, bool trimRight)
+    {
+        const size_t controlLen = control.length();
+        size_t nextControl = text.find(control);
+        while (nextControl != std::wstring::npos)
+        {
+            if (trimLeft && nextControl > 0 && text[nextControl - 1] == L'\n')
+            {
+                text.erase(nextControl - 1, 1);
+                nextControl--;
+            }
+            if (trimRight && nextControl + controlLen < text.length() && text[nextControl + controlLen] == L'\n')
+            {
+                text.erase(nextControl + controlLen, 1);
+            }
+            nextControl = text.find(control, nextControl + controlLen);
+        }
+    }
+
+    void ReferenceClean(std::wstring& text)
+    {
+        text.erase(std::remove_if(text.begin(), text.end(), [](wchar_t ch) { return ch != L'\n' && ch != L'\t' && !iswprint(ch); }), text.end());
+        if (!text.empty() && text[0] == L'\n')
+        {
+            text.erase(0, 1);
+        }
+        TrimNewlineAroundControl(text, L"[end]", true, true);
+        TrimNewlineAroundControl(text, L"[paste]", false, true);
+        TrimNewlineAroundControl(text, L"[/paste]", true, false);
+
+        const size_t lastEnd = text.rfind(L"[end]");
+        if (lastEnd != std::wstring::npos)
+        {
+            for (size_t i = lastEnd + EndControlLength; i < text.length(); i++)
+            {
+                if (iswprint(text[i]) && text[i] != L' ')
+                {
+                    break;
+                }
+                else if (i >= text.length() - 1)
+                {
+                    text.erase(lastEnd + EndControlLength);
+                }
+            }
+        }
+    }
+
+    // The keyword match HandleControlKeyword did at every '[' before the
+    // command table, without its side effects
+    bool ReferenceIsControl(const std::wstring& text, size_t index)
+    {
+        const size_t controlClose = text.find(L']', index);
+        const size_t controlLen = controlClose - index + 1;
+        if (controlLen > MaxControlLength)
+        {
+            return false;
+        }
+
+        const std::wstring control = text.substr(index, controlLen);
+        return control == L"[end]" || control.substr(0, 7) == L"[pause:" || control == L"[paste]" ||
+               control == L"[enter]" || control == L"[up]" || control == L"[down]" ||
+               control == L"[left]" || control == L"[right]";
+    }
+
+    double Ms(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int lines = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 40000;
+    const std::string script = MakeScript(lines);
+
+    std::wstring decoded;
+    DecodeDemoTypeScript(reinterpret_cast<const uint8_t*>(script.data()), script.size(), decoded);
+
+    // Load: cleanup only for the reference, cleanup and compile for the table
+    std::wstring reference = decoded;
+    auto start = Clock::now();
+    ReferenceClean(reference);
+    const double referenceLoad = Ms(start);
+
+    std::wstring text;
+    std::vector<DemoTypeCommand> commands;
+    start = Clock::now();
+    DecodeDemoTypeScript(reinterpret_cast<const uint8_t*>(script.data()), script.size(), text);
+    CleanDemoTypeScript(text);
+    CompileDemoTypeScript(text, commands);
+    const double tableLoad = Ms(start);
+
+    // Typing: a keyword check at every '['
+    size_t referenceControls = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < reference.length(); i++)
+    {
+        if (reference[i] == L'[' && ReferenceIsControl(reference, i))
+        {
+            referenceControls++;
+        }
+    }
+    const double referenceTyping = Ms(start);
+
+    size_t tableControls = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < text.length(); i++)
+    {
+        if (text[i] == L'[' && FindDemoTypeCommand(commands, i))
+        {
+            tableControls++;
+        }
+    }
+    const double tableTyping = Ms(start);
+
+    std::printf("%zu bytes, %zu characters, %zu keywords\n\n", script.size(), text.length(), commands.size());
+    std::printf("%-14s %12s %12s\n", "", "load", "typing");
+    std::printf("%-14s %9.3f ms %9.3f ms\n", "reference", referenceLoad, referenceTyping);
+    std::printf("%-14s %9.3f ms %9.3f ms\n", "command table", tableLoad, tableTyping);
+
+    if (reference != text || referenceControls != tableControls)
+    {
+        std::printf("\nMISMATCH: the cleaned texts or keyword counts differ\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+// Headless benchmark of ZoomIt's tiled static zoom renderer.
+//
+// Pans a synthetic screen at a fixed zoom level, a few pixels per frame the
+// way the zoomed view follows the mouse, and compares:
+//   - rendering every frame through ZoomTileCache and copying it to a DIB,
+//     as DrawZoomedTiles does,
+//   - scaling every tile again each frame (a cold cache),
+//   - StretchBlt of the whole view, the path the tile cache replaced.
+//
+// Usage: ZoomIt_TileCacheBenchmark [frames]
+
+#include "../../src/modules/ZoomIt/ZoomIt/ZoomTileCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Resolution
+    {
+        const char* name;
+        int width;
+        int height;
+    };
+
+    constexpr Resolution Resolutions[] = {
+        { "1080p", 1920, 1080 },
+        { "1440p", 2560, 1440 },
+        { "4K", 3840, 2160 },
+    };
+
+    constexpr float ZoomLevel = 2.0f;
+
+    // Text-like content: mostly flat background with short runs of detail
+    std::vector<uint32_t> MakeScreen(int width, int height)
+    {
+        std::vector<uint32_t> screen(static_cast<size_t>(width) * height);
+        uint32_t state = 12345;
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                state = state * 1664525 + 1013904223;
+                const bool ink = (y % 24) < 14 && (x % 9) < 6 && (state >> 28) < 6;
+                screen[static_cast<size_t>(y) * width + x] = ink ? 0xFF202020 : 0xFFF3F3F3 - (y / 64) * 0x010101;
+            }
+        }
+        return screen;
+    }
+
+    // Source positions of the view for each frame: a drift of a few pixels
+    // per frame that turns around at the edges of the screen
+    std::vector<std::pair<int, int>> MakePan(int width, int height, int frames)
+    {
+        const int maxX = width - static_cast<int>(width / ZoomLevel);
+        const int maxY = height - static_cast<int>(height / ZoomLevel);
+        std::vector<std::pair<int, int>> pan;
+        int x = maxX / 2, y = maxY / 2, dx = 3, dy = 2;
+        for (int i = 0; i < frames; i++)
+        {
+            if (i % 40 == 0)
+            {
+                dx = (i / 40) % 2 ? -dx : dx;
+                dy = (i / 80) % 2 ? -dy : dy;
+            }
+            x = std::clamp(x + dx, 0, maxX);
+            y = std::clamp(y + dy, 0, maxY);
+            pan.emplace_back(x, y);
+        }
+        return pan;
+    }
+
+    double MsPerFrame(Clock::time_point start, int frames)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int frames = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 300;
+    std::printf("%d frames panned at %.1fx\n\n", frames, ZoomLevel);
+    std::printf("%-6s %-8s %12s %10s %12s %12s\n", "screen", "filter", "tile cache", "hit rate", "cold tiles", "StretchBlt");
+
+    for (const auto& resolution : Resolutions)
+    {
+        const int width = resolution.width;
+        const int height = resolution.height;
+        const auto screen = MakeScreen(width, height);
+        const auto pan = MakePan(width, height, frames);
+        std::vector<uint32_t> zoomed(screen.size());
+
+#ifdef _WIN32
+        BITMAPINFO bitmapInfo = {};
+        bitmapInfo.bmiHeader.biSize = sizeof bitmapInfo.bmiHeader;
+        bitmapInfo.bmiHeader.biWidth = width;
+        bitmapInfo.bmiHeader.biHeight = -height;
+        bitmapInfo.bmiHeader.biPlanes = 1;
+        bitmapInfo.bmiHeader.biBitCount = 32;
+        bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+        void* sourceBits = nullptr;
+        void* targetBits = nullptr;
+        HDC sourceDc = CreateCompatibleDC(nullptr);
+        HDC targetDc = CreateCompatibleDC(nullptr);
+        HBITMAP sourceBitmap = CreateDIBSection(sourceDc, &bitmapInfo, DIB_RGB_COLORS, &sourceBits, nullptr, 0);
+        HBITMAP targetBitmap = CreateDIBSection(targetDc, &bitmapInfo, DIB_RGB_COLORS, &targetBits, nullptr, 0);
+        std::copy(screen.begin(), screen.end(), static_cast<uint32_t*>(sourceBits));
+        HGDIOBJ oldSource = SelectObject(sourceDc, sourceBitmap);
+        HGDIOBJ oldTarget = SelectObject(targetDc, targetBitmap);
+#endif
+
+        for (bool smooth : { false, true })
+        {
+            ZoomTileCache cache;
+            cache.SetSource(screen.data(), width, height, width);
+            auto start = Clock::now();
+            for (const auto& [x, y] : pan)
+            {
+                cache.Render(zoomed.data(), width, height, width, ZoomLevel, x, y, smooth);
+#ifdef _WIN32
+                SetDIBitsToDevice(targetDc, 0, 0, width, height, 0, 0, 0, height, zoomed.data(), &bitmapInfo, DIB_RGB_COLORS);
+#endif
+            }
+            const double cached = MsPerFrame(start, frames);
+            const auto& stats = cache.GetStats();
+            const double hitRate = 100.0 * stats.tileHits / std::max<uint64_t>(stats.tileHits + stats.tileMisses, 1);
+
+            start = Clock::now();
+            for (const auto& [x, y] : pan)
+            {
+                ZoomTileCache cold;
+                cold.SetSource(screen.data(), width, height, width);
+                cold.Render(zoomed.data(), width, height, width, ZoomLevel, x, y, smooth);
+            }
+            const double uncached = MsPerFrame(start, frames);
+
+            char stretched[32] = "n/a";
+#ifdef _WIN32
+            SetStretchBltMode(targetDc, smooth ? HALFTONE : COLORONCOLOR);
+            start = Clock::now();
+            for (const auto& [x, y] : pan)
+            {
+                StretchBlt(targetDc, 0, 0, width, height, sourceDc, x, y, static_cast<int>(width / ZoomLevel), static_cast<int>(height / ZoomLevel), SRCCOPY);
+            }
+            GdiFlush();
+            std::snprintf(stretched, sizeof(stretched), "%.3f ms", MsPerFrame(start, frames));
+#endif
+
+            std::printf("%-6s %-8s %9.3f ms %9.1f%% %9.3f ms %12s\n",
+                        resolution.name,
+                        smooth ? "bilinear" : "nearest",
+                        cached,
+                        hitRate,
+                        uncached,
+                        stretched);
+        }
+
+#ifdef _WIN32
+        SelectObject(sourceDc, oldSource);
+        SelectObject(targetDc, oldTarget);
+        DeleteObject(sourceBitmap);
+        DeleteObject(targetBitmap);
+        DeleteDC(sourceDc);
+        DeleteDC(targetDc);
+#endif
+    }
+
+    return 0;
+}